@@ -306,6 +306,13 @@ installers.  The most commonly-used variables are:
 
   The following compression methods may take advantage of multiple cores:
 
+  ``gzip``
+    .. versionadded:: 3.25
+
+    Compressed in independent blocks like ``pigz`` does.  The result
+    is a single gzip stream slightly larger than one compressed on a
+    single thread.
+
   ``xz``
     Supported if CMake is built with a ``liblzma`` that supports
     parallel compression.
@@ -324,6 +331,11 @@ installers.  The most commonly-used variables are:
 
   Other compression methods ignore this value and use only one thread.
 
+  .. versionadded:: 3.25
+
+    The Archive generators also read the files to package on this
+    many threads ahead of compressing them.
+
 Variables for Source Package Generators
 ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
 
@@ -2,6 +2,7 @@
    file Copyright.txt or https://cmake.org/licensing for details.  */
 #include "cmCPackArchiveGenerator.h"
 
+#include <cstddef>
 #include <cstring>
 #include <map>
 #include <ostream>
@@ -125,8 +126,13 @@ int cmCPackArchiveGenerator::addOneComponentToArchive(
     filePrefix += installPrefix->substr(1);
     filePrefix += "/";
   }
+  std::vector<std::string> paths;
+  paths.reserve(component->Files.size());
   for (std::string const& file : component->Files) {
-    std::string rp = filePrefix + file;
+    paths.push_back(filePrefix + file);
+  }
+  archive.PrefetchFiles(paths);
+  for (std::string const& rp : paths) {
     cmCPackLogger(cmCPackLog::LOG_DEBUG, "Adding file: " << rp << std::endl);
     archive.Add(rp, 0, nullptr, false);
     if (!archive) {
@@ -194,6 +200,14 @@ int cmCPackArchiveGenerator::PackageComponents(bool ignoreGroup)
           // Add the files of this component to the archive
           this->addOneComponentToArchive(archive, comp);
         }
+        if (!archive.Close()) {
+          cmCPackLogger(cmCPackLog::LOG_ERROR,
+                        "Problem to finish archive <"
+                          << packageFileName
+                          << ">, ERROR = " << archive.GetError()
+                          << std::endl);
+          return 0;
+        }
       }
       // add the generated package to package file names list
       this->packageFileNames.push_back(std::move(packageFileName));
@@ -220,6 +234,14 @@ int cmCPackArchiveGenerator::PackageComponents(bool ignoreGroup)
           DECLARE_AND_OPEN_ARCHIVE(packageFileName, archive);
           // Add the files of this component to the archive
           this->addOneComponentToArchive(archive, &(comp.second));
+          if (!archive.Close()) {
+            cmCPackLogger(cmCPackLog::LOG_ERROR,
+                          "Problem to finish archive <"
+                            << packageFileName
+                            << ">, ERROR = " << archive.GetError()
+                            << std::endl);
+            return 0;
+          }
         }
         // add the generated package to package file names list
         this->packageFileNames.push_back(std::move(packageFileName));
@@ -241,6 +263,14 @@ int cmCPackArchiveGenerator::PackageComponents(bool ignoreGroup)
         DECLARE_AND_OPEN_ARCHIVE(packageFileName, archive);
         // Add the files of this component to the archive
         this->addOneComponentToArchive(archive, &(comp.second));
+        if (!archive.Close()) {
+          cmCPackLogger(cmCPackLog::LOG_ERROR,
+                        "Problem to finish archive <"
+                          << packageFileName
+                          << ">, ERROR = " << archive.GetError()
+                          << std::endl);
+          return 0;
+        }
       }
       // add the generated package to package file names list
       this->packageFileNames.push_back(std::move(packageFileName));
@@ -310,10 +340,16 @@ int cmCPackArchiveGenerator::PackageFiles()
                     << std::strerror(workdir.GetLastResult()) << std::endl);
     return 0;
   }
+  std::vector<std::string> paths;
+  paths.reserve(this->files.size());
   for (std::string const& file : this->files) {
     // Get the relative path to the file
-    std::string rp = cmSystemTools::RelativePath(this->toplevel, file);
-    archive.Add(rp, 0, nullptr, false);
+    paths.push_back(cmSystemTools::RelativePath(this->toplevel, file));
+  }
+  archive.PrefetchFiles(paths);
+  for (std::size_t i = 0; i < paths.size(); ++i) {
+    std::string const& file = this->files[i];
+    archive.Add(paths[i], 0, nullptr, false);
     if (!archive) {
       cmCPackLogger(cmCPackLog::LOG_ERROR,
                     "Problem while adding file <"
@@ -322,7 +358,13 @@ int cmCPackArchiveGenerator::PackageFiles()
       return 0;
     }
   }
-  // The destructor of cmArchiveWrite will close and finish the write
+  if (!archive.Close()) {
+    cmCPackLogger(cmCPackLog::LOG_ERROR,
+                  "Problem to finish archive <"
+                    << this->packageFileNames[0]
+                    << ">, ERROR = " << archive.GetError() << std::endl);
+    return 0;
+  }
   return 1;
 }
 
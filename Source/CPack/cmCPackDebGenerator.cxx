@@ -3,12 +3,14 @@
 #include "cmCPackDebGenerator.h"
 
 #include <algorithm>
+#include <cstddef>
 #include <cstring>
 #include <map>
 #include <ostream>
 #include <set>
 #include <stdexcept>
 #include <utility>
+#include <vector>
 
 #include "cmsys/Glob.hxx"
 
@@ -282,15 +284,21 @@ std::string DebGenerator::generateMD5File() const
   out.Open(md5filename, false, true);
 
   std::string topLevelWithTrailingSlash = cmStrCat(this->TemporaryDir, '/');
+  std::vector<std::string> files;
   for (std::string const& file : this->PackageFiles) {
     // hash only regular files
     if (cmSystemTools::FileIsDirectory(file) ||
         cmSystemTools::FileIsSymlink(file)) {
       continue;
     }
+    files.push_back(file);
+  }
 
-    std::string output =
-      cmSystemTools::ComputeFileHash(file, cmCryptoHash::AlgoMD5);
+  std::vector<std::string> const hashes =
+    cmCryptoHash::HashFiles(cmCryptoHash::AlgoMD5, files);
+  for (std::size_t i = 0; i < files.size(); ++i) {
+    std::string const& file = files[i];
+    std::string output = hashes[i];
     if (output.empty()) {
       cmCPackLogger(cmCPackLog::LOG_ERROR,
                     "Problem computing the md5 of " << file << std::endl);
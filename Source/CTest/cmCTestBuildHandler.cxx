@@ -198,6 +198,7 @@ void cmCTestBuildHandler::Initialize()
   this->ErrorExceptionRegex.clear();
   this->WarningMatchRegex.clear();
   this->WarningExceptionRegex.clear();
+  this->Prefilter = cmCTestLiteralPrefilter();
   this->BuildProcessingQueue.clear();
   this->BuildProcessingErrorQueue.clear();
   this->BuildOutputLogSize = 0;
@@ -375,9 +376,12 @@ int cmCTestBuildHandler::ProcessHandler()
                          "Add " #strings ": " << s << std::endl,              \
                          this->Quiet);                                        \
       (regexes).emplace_back(s);                                              \
+      this->Prefilter.Add(s);                                                 \
     }                                                                         \
   } while (false)
 
+  this->Prefilter = cmCTestLiteralPrefilter();
+
   cmCTestBuildHandlerPopulateRegexVector(this->CustomErrorMatches,
                                          this->ErrorMatchRegex);
   cmCTestBuildHandlerPopulateRegexVector(this->CustomErrorExceptions,
@@ -386,6 +390,7 @@ int cmCTestBuildHandler::ProcessHandler()
                                          this->WarningMatchRegex);
   cmCTestBuildHandlerPopulateRegexVector(this->CustomWarningExceptions,
                                          this->WarningExceptionRegex);
+  this->Prefilter.Compile();
 
   // Determine source and binary tree substitutions to simplify the output.
   this->SimplifySourceDir.clear();
@@ -1105,13 +1110,21 @@ int cmCTestBuildHandler::ProcessSingleLine(const char* data)
   int warningLine = 0;
   int errorLine = 0;
 
+  // Find the expressions that may match in one pass over the line.
+  size_t const errorExceptionBase = this->ErrorMatchRegex.size();
+  size_t const warningBase =
+    errorExceptionBase + this->ErrorExceptionRegex.size();
+  size_t const warningExceptionBase =
+    warningBase + this->WarningMatchRegex.size();
+  this->Prefilter.Scan(line);
+
   // Check for regular expressions
 
   if (!this->ErrorQuotaReached) {
     // Errors
     int wrxCnt = 0;
     for (cmsys::RegularExpression& rx : this->ErrorMatchRegex) {
-      if (rx.find(line.c_str())) {
+      if (this->Prefilter.IsCandidate(wrxCnt) && rx.find(line.c_str())) {
         errorLine = 1;
         cmCTestOptionalLog(this->CTest, DEBUG,
                            "  Error Line: " << line << " (matches: "
@@ -1125,7 +1138,9 @@ int cmCTestBuildHandler::ProcessSingleLine(const char* data)
     // Error exceptions
     wrxCnt = 0;
     for (cmsys::RegularExpression& rx : this->ErrorExceptionRegex) {
-      if (rx.find(line.c_str())) {
+      if (errorLine &&
+          this->Prefilter.IsCandidate(errorExceptionBase + wrxCnt) &&
+          rx.find(line.c_str())) {
         errorLine = 0;
         cmCTestOptionalLog(this->CTest, DEBUG,
                            "  Not an error Line: "
@@ -1142,7 +1157,8 @@ int cmCTestBuildHandler::ProcessSingleLine(const char* data)
     // Warnings
     int wrxCnt = 0;
     for (cmsys::RegularExpression& rx : this->WarningMatchRegex) {
-      if (rx.find(line.c_str())) {
+      if (this->Prefilter.IsCandidate(warningBase + wrxCnt) &&
+          rx.find(line.c_str())) {
         warningLine = 1;
         cmCTestOptionalLog(this->CTest, DEBUG,
                            "  Warning Line: "
@@ -1158,7 +1174,9 @@ int cmCTestBuildHandler::ProcessSingleLine(const char* data)
     wrxCnt = 0;
     // Warning exceptions
     for (cmsys::RegularExpression& rx : this->WarningExceptionRegex) {
-      if (rx.find(line.c_str())) {
+      if (warningLine &&
+          this->Prefilter.IsCandidate(warningExceptionBase + wrxCnt) &&
+          rx.find(line.c_str())) {
         warningLine = 0;
         cmCTestOptionalLog(this->CTest, DEBUG,
                            "  Not a warning Line: "
@@ -14,6 +14,7 @@
 #include "cmsys/RegularExpression.hxx"
 
 #include "cmCTestGenericHandler.h"
+#include "cmCTestLiteralPrefilter.h"
 #include "cmDuration.h"
 #include "cmProcessOutput.h"
 
@@ -110,6 +111,9 @@ private:
   std::vector<cmsys::RegularExpression> ErrorExceptionRegex;
   std::vector<cmsys::RegularExpression> WarningMatchRegex;
   std::vector<cmsys::RegularExpression> WarningExceptionRegex;
+  // Literals of the four lists above, in order, to skip expressions that
+  // cannot match a line.
+  cmCTestLiteralPrefilter Prefilter;
 
   using t_BuildProcessingQueueType = std::deque<char>;
 
@@ -0,0 +1,564 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file Copyright.txt or https://cmake.org/licensing for details.  */
+#include "cmCTestCoordinator.h"
+
+#include <algorithm>
+#include <deque>
+#include <list>
+#include <utility>
+
+#include <cm/memory>
+
+#include "cmFileLock.h"
+#include "cmFileLockResult.h"
+#include "cmStringAlgorithms.h"
+#include "cmSystemTools.h"
+
+// Messages are lines of words separated by spaces:
+//
+//   resources <type>,<id>,<slots>...       sent to each process connecting
+//   acquire <test> <slots> <group>,<type>,<slots>...
+//   grant <test> <group>,<type>,<id>,<slots>...
+//   release <test>
+
+namespace {
+std::size_t const kBufferSize = 1024;
+// Times to try again, 100ms apart, to connect to a coordinator that has
+// not started listening yet or has just stopped.
+int const kMaxAttempts = 50;
+
+struct WriteRequest
+{
+  uv_write_t Request;
+  std::string Data;
+};
+
+void Write(uv_stream_t* stream, std::string data)
+{
+  auto req = cm::make_unique<WriteRequest>();
+  req->Data = std::move(data);
+  req->Request.data = req.get();
+  uv_buf_t buf =
+    uv_buf_init(&req->Data[0], static_cast<unsigned int>(req->Data.size()));
+  int status =
+    uv_write(&req->Request, stream, &buf, 1, [](uv_write_t* r, int) {
+      delete static_cast<WriteRequest*>(r->data);
+    });
+  if (status == 0) {
+    req.release();
+  }
+}
+
+// Append the complete lines read to the given vector.
+void SplitLines(std::string& input, char const* data, std::size_t size,
+                std::vector<std::string>& lines)
+{
+  input.append(data, size);
+  std::string::size_type start = 0;
+  std::string::size_type end;
+  while ((end = input.find('\n', start)) != std::string::npos) {
+    lines.emplace_back(input, start, end - start);
+    start = end + 1;
+  }
+  input.erase(0, start);
+}
+
+bool ParseIndex(std::string const& word, unsigned long& value)
+{
+  return cmStrToULong(word, &value) && value <= 0x7fffffff;
+}
+}
+
+class cmCTestCoordinator::Server
+{
+public:
+  Server(uv_loop_t& loop, std::size_t slots,
+         cmCTestResourceAllocator const& resources, cmFileLock lock)
+    : Loop(loop)
+    , TotalSlots(std::max<std::size_t>(slots, 1))
+    , ResourceAllocator(resources)
+    , Capacity(resources.GetResources())
+    , Lock(std::move(lock))
+  {
+  }
+
+  int Listen(std::string const& path)
+  {
+    int status = this->Listener.init(this->Loop, 0, this);
+    if (status == 0) {
+      status = uv_pipe_bind(this->Listener, path.c_str());
+    }
+    if (status == 0) {
+      status = uv_listen(this->Listener, 16, &Server::OnConnectionCB);
+    }
+    if (status != 0) {
+      this->Listener.reset();
+    }
+    return status;
+  }
+
+  std::size_t GetConnectionCount() const { return this->Connections.size(); }
+
+  // Stop listening once the process serving is done and nobody is left.
+  void SetLocalDone()
+  {
+    this->LocalDone = true;
+    this->CheckDone();
+  }
+
+private:
+  struct Grant
+  {
+    std::size_t Slots;
+    Allocations Allocated;
+  };
+
+  struct Connection
+  {
+    Server* Owner;
+    cm::uv_pipe_ptr Pipe;
+    std::vector<char> Buf;
+    std::string Input;
+    std::map<int, Grant> Grants;
+  };
+
+  struct Request
+  {
+    Connection* From;
+    int Test;
+    std::size_t Slots;
+    Allocations Needed;
+  };
+
+  static void OnConnectionCB(uv_stream_t* stream, int status)
+  {
+    auto* self = static_cast<Server*>(stream->data);
+    if (status == 0) {
+      self->Accept();
+    }
+  }
+
+  static void OnAllocateCB(uv_handle_t* handle, size_t /*suggested_size*/,
+                           uv_buf_t* buf)
+  {
+    auto* connection = static_cast<Connection*>(handle->data);
+    connection->Buf.resize(kBufferSize);
+    *buf = uv_buf_init(connection->Buf.data(),
+                       static_cast<unsigned int>(connection->Buf.size()));
+  }
+
+  static void OnReadCB(uv_stream_t* stream, ssize_t nread,
+                       const uv_buf_t* buf)
+  {
+    auto* connection = static_cast<Connection*>(stream->data);
+    Server* self = connection->Owner;
+    if (nread == 0) {
+      return;
+    }
+    if (nread < 0) {
+      self->Close(connection);
+      return;
+    }
+    std::vector<std::string> lines;
+    SplitLines(connection->Input, buf->base, static_cast<std::size_t>(nread),
+               lines);
+    for (std::string const& line : lines) {
+      if (!self->Receive(*connection, line)) {
+        self->Close(connection);
+        return;
+      }
+    }
+  }
+
+  void Accept()
+  {
+    auto connection = cm::make_unique<Connection>();
+    connection->Owner = this;
+    connection->Pipe.init(this->Loop, 0, connection.get());
+    if (uv_accept(this->Listener, connection->Pipe) != 0 ||
+        uv_read_start(connection->Pipe, &Server::OnAllocateCB,
+                      &Server::OnReadCB) != 0) {
+      return;
+    }
+
+    std::string message = "resources";
+    for (auto const& type : this->Capacity) {
+      for (auto const& unit : type.second) {
+        message += cmStrCat(' ', type.first, ',', unit.first, ',',
+                            unit.second.Total);
+      }
+    }
+    Write(connection->Pipe, message + "\n");
+    this->Connections.push_back(std::move(connection));
+  }
+
+  bool Receive(Connection& connection, std::string const& line)
+  {
+    std::vector<std::string> words = cmSystemTools::SplitString(line, ' ');
+    unsigned long test;
+    unsigned long slots;
+    if (words.size() == 2 && words[0] == "release" &&
+        ParseIndex(words[1], test)) {
+      auto grant = connection.Grants.find(static_cast<int>(test));
+      if (grant == connection.Grants.end()) {
+        return false;
+      }
+      this->Free(grant->second);
+      connection.Grants.erase(grant);
+      this->Schedule();
+      return true;
+    }
+    if (words.size() < 3 || words[0] != "acquire" ||
+        !ParseIndex(words[1], test) || !ParseIndex(words[2], slots)) {
+      return false;
+    }
+
+    Request request{ &connection, static_cast<int>(test),
+                     std::min<std::size_t>(slots, this->TotalSlots),
+                     Allocations() };
+    for (std::size_t i = 3; i < words.size(); ++i) {
+      std::vector<std::string> fields =
+        cmSystemTools::SplitString(words[i], ',');
+      unsigned long group;
+      if (fields.size() != 3 || !ParseIndex(fields[0], group) ||
+          !ParseIndex(fields[2], slots) || !this->Capacity.count(fields[1])) {
+        return false;
+      }
+      request.Needed[fields[1]].push_back(
+        { group, static_cast<int>(slots), "" });
+    }
+    // A request that could never be granted would hold up all others.
+    for (auto const& it : request.Needed) {
+      auto needed = it.second;
+      if (!cmAllocateCTestResourcesRoundRobin(this->Capacity.at(it.first),
+                                              needed)) {
+        return false;
+      }
+    }
+    this->Queue.push_back(std::move(request));
+    this->Schedule();
+    return true;
+  }
+
+  // Grant requests in order for as long as the first one fits.
+  void Schedule()
+  {
+    while (!this->Queue.empty()) {
+      Request& request = this->Queue.front();
+      if (this->UsedSlots + request.Slots > this->TotalSlots) {
+        return;
+      }
+      auto const& available = this->ResourceAllocator.GetResources();
+      for (auto& it : request.Needed) {
+        if (!cmAllocateCTestResourcesRoundRobin(available.at(it.first),
+                                                it.second)) {
+          return;
+        }
+      }
+
+      std::string message = cmStrCat("grant ", request.Test);
+      for (auto const& it : request.Needed) {
+        for (auto const& unit : it.second) {
+          this->ResourceAllocator.AllocateResource(
+            it.first, unit.Id, static_cast<unsigned int>(unit.SlotsNeeded));
+          message += cmStrCat(' ', unit.ProcessIndex, ',', it.first, ',',
+                              unit.Id, ',', unit.SlotsNeeded);
+        }
+      }
+      this->UsedSlots += request.Slots;
+      request.From->Grants[request.Test] =
+        Grant{ request.Slots, std::move(request.Needed) };
+      Write(request.From->Pipe, message + "\n");
+      this->Queue.pop_front();
+    }
+  }
+
+  void Free(Grant const& grant)
+  {
+    this->UsedSlots -= grant.Slots;
+    for (auto const& it : grant.Allocated) {
+      for (auto const& unit : it.second) {
+        this->ResourceAllocator.DeallocateResource(
+          it.first, unit.Id, static_cast<unsigned int>(unit.SlotsNeeded));
+      }
+    }
+  }
+
+  // Return everything held by a process that disconnected.
+  void Close(Connection* connection)
+  {
+    for (auto const& grant : connection->Grants) {
+      this->Free(grant.second);
+    }
+    this->Queue.erase(std::remove_if(this->Queue.begin(), this->Queue.end(),
+                                     [connection](Request const& r) {
+                                       return r.From == connection;
+                                     }),
+                      this->Queue.end());
+    this->Connections.remove_if(
+      [connection](std::unique_ptr<Connection> const& c) {
+        return c.get() == connection;
+      });
+    this->Schedule();
+    this->CheckDone();
+  }
+
+  void CheckDone()
+  {
+    if (this->LocalDone && this->Connections.empty()) {
+      // Closing the listener removes the socket file, after which the
+      // next process may take the lock and serve.
+      this->Listener.reset();
+      this->Lock.Release();
+    }
+  }
+
+  uv_loop_t& Loop;
+  std::size_t TotalSlots;
+  std::size_t UsedSlots = 0;
+  cmCTestResourceAllocator ResourceAllocator;
+  Resources Capacity;
+  cmFileLock Lock;
+  cm::uv_pipe_ptr Listener;
+  std::list<std::unique_ptr<Connection>> Connections;
+  std::deque<Request> Queue;
+  bool LocalDone = false;
+};
+
+cmCTestCoordinator::cmCTestCoordinator(uv_loop_t& loop, std::string path)
+  : Loop(loop)
+  , Path(std::move(path))
+{
+}
+
+cmCTestCoordinator::~cmCTestCoordinator() = default;
+
+bool cmCTestCoordinator::Start(std::size_t parallelLevel,
+                               cmCTestResourceAllocator const& resources,
+                               std::string& error)
+{
+  this->ParallelLevel = parallelLevel;
+  this->ResourceAllocator = resources;
+  return this->Elect(error);
+}
+
+bool cmCTestCoordinator::Elect(std::string& error)
+{
+  if (!this->Serving) {
+    cmFileLock lock;
+#ifdef _WIN32
+    // Named pipes go away with the process that created them, so the
+    // first process able to create one serves.
+    bool const mayServe = true;
+#else
+    // A socket file stays behind if the process serving is killed, and
+    // must be removed before another process can listen.  Only remove it
+    // while holding the lock, which the system releases in that case.
+    std::string const lockFile = this->Path + ".lock";
+    if (!cmSystemTools::Touch(lockFile, true)) {
+      error = cmStrCat("cannot create ", lockFile);
+      return false;
+    }
+    bool const mayServe = lock.Lock(lockFile, 0).IsOk();
+    if (mayServe) {
+      cmSystemTools::RemoveFile(this->Path);
+    }
+#endif
+    if (mayServe) {
+      auto server = cm::make_unique<Server>(
+        this->Loop, this->ParallelLevel, this->ResourceAllocator,
+        std::move(lock));
+      int status = server->Listen(this->Path);
+      if (status == 0) {
+        this->Serving = std::move(server);
+      } else if (status != UV_EADDRINUSE) {
+        error = cmStrCat("cannot listen on ", this->Path, ": ",
+                         uv_strerror(status));
+        return false;
+      }
+    }
+  }
+
+  int status = this->Pipe.init(this->Loop, 0, this);
+  if (status != 0) {
+    error = uv_strerror(status);
+    return false;
+  }
+  this->ConnectRequest.data = this;
+  uv_pipe_connect(&this->ConnectRequest, this->Pipe, this->Path.c_str(),
+                  &cmCTestCoordinator::OnConnectCB);
+  return true;
+}
+
+void cmCTestCoordinator::OnConnectCB(uv_connect_t* request, int status)
+{
+  auto* self = static_cast<cmCTestCoordinator*>(request->data);
+  if (self->Finished) {
+    return;
+  }
+  if (status != 0) {
+    self->Pipe.reset();
+    if (self->Serving || ++self->Attempts >= kMaxAttempts) {
+      self->Lose(cmStrCat("cannot connect to ", self->Path, ": ",
+                          uv_strerror(status)));
+      return;
+    }
+    // The process serving may just be starting or stopping, so try again
+    // and serve if it is gone.
+    if (self->RetryTimer.get() == nullptr) {
+      self->RetryTimer.init(self->Loop, self);
+    }
+    self->RetryTimer.start(&cmCTestCoordinator::OnRetryCB, 100, 0);
+    return;
+  }
+  status = uv_read_start(self->Pipe, &cmCTestCoordinator::OnAllocateCB,
+                         &cmCTestCoordinator::OnReadCB);
+  if (status != 0) {
+    self->Lose(uv_strerror(status));
+  }
+}
+
+void cmCTestCoordinator::OnRetryCB(uv_timer_t* timer)
+{
+  auto* self = static_cast<cmCTestCoordinator*>(timer->data);
+  std::string error;
+  if (!self->Elect(error)) {
+    self->Lose(error);
+  }
+}
+
+void cmCTestCoordinator::OnAllocateCB(uv_handle_t* handle,
+                                      size_t /*suggested_size*/,
+                                      uv_buf_t* buf)
+{
+  auto* self = static_cast<cmCTestCoordinator*>(handle->data);
+  self->Buf.resize(kBufferSize);
+  *buf = uv_buf_init(self->Buf.data(),
+                     static_cast<unsigned int>(self->Buf.size()));
+}
+
+void cmCTestCoordinator::OnReadCB(uv_stream_t* stream, ssize_t nread,
+                                  const uv_buf_t* buf)
+{
+  auto* self = static_cast<cmCTestCoordinator*>(stream->data);
+  if (nread == 0) {
+    return;
+  }
+  if (nread < 0) {
+    self->Lose(cmStrCat("the coordinator closed the connection: ",
+                        uv_strerror(static_cast<int>(nread))));
+    return;
+  }
+  std::vector<std::string> lines;
+  SplitLines(self->Input, buf->base, static_cast<std::size_t>(nread), lines);
+  for (std::string const& line : lines) {
+    // Stop if a callback disconnected.
+    if (self->Finished || !self->Pipe.get()) {
+      return;
+    }
+    if (!self->Receive(line)) {
+      self->Lose(cmStrCat("unexpected message from the coordinator: ", line));
+      return;
+    }
+  }
+}
+
+bool cmCTestCoordinator::Receive(std::string const& line)
+{
+  std::vector<std::string> words = cmSystemTools::SplitString(line, ' ');
+  if (words.empty()) {
+    return false;
+  }
+  if (words[0] == "resources" && !this->Connected) {
+    Resources resources;
+    for (std::size_t i = 1; i < words.size(); ++i) {
+      std::vector<std::string> fields =
+        cmSystemTools::SplitString(words[i], ',');
+      unsigned long total;
+      if (fields.size() != 3 || !ParseIndex(fields[2], total)) {
+        return false;
+      }
+      resources[fields[0]][fields[1]] = { static_cast<unsigned int>(total),
+                                          0 };
+    }
+    this->Connected = true;
+    this->ReadyCallback(resources);
+    return true;
+  }
+
+  unsigned long test;
+  if (words.size() < 2 || words[0] != "grant" || !this->Connected ||
+      !ParseIndex(words[1], test)) {
+    return false;
+  }
+  Allocations allocations;
+  for (std::size_t i = 2; i < words.size(); ++i) {
+    std::vector<std::string> fields =
+      cmSystemTools::SplitString(words[i], ',');
+    unsigned long group;
+    unsigned long slots;
+    if (fields.size() != 4 || !ParseIndex(fields[0], group) ||
+        !ParseIndex(fields[3], slots)) {
+      return false;
+    }
+    allocations[fields[1]].push_back(
+      { group, static_cast<int>(slots), fields[2] });
+  }
+  this->GrantCallback(static_cast<int>(test), allocations);
+  return true;
+}
+
+void cmCTestCoordinator::Send(std::string const& message)
+{
+  if (this->Connected && !this->Finished) {
+    Write(this->Pipe, message + "\n");
+  }
+}
+
+void cmCTestCoordinator::Acquire(int test, std::size_t slots,
+                                 Allocations const& allocations)
+{
+  std::string message = cmStrCat("acquire ", test, ' ', slots);
+  for (auto const& it : allocations) {
+    for (auto const& unit : it.second) {
+      message +=
+        cmStrCat(' ', unit.ProcessIndex, ',', it.first, ',', unit.SlotsNeeded);
+    }
+  }
+  this->Send(message);
+}
+
+void cmCTestCoordinator::Release(int test)
+{
+  this->Send(cmStrCat("release ", test));
+}
+
+void cmCTestCoordinator::Finish()
+{
+  this->Finished = true;
+  this->Connected = false;
+  this->Pipe.reset();
+  this->RetryTimer.reset();
+  if (this->Serving) {
+    this->Serving->SetLocalDone();
+  }
+}
+
+bool cmCTestCoordinator::IsServingOthers() const
+{
+  // The connection of this process is counted until the coordinator sees
+  // it close.
+  return this->Serving && this->Serving->GetConnectionCount() > 1;
+}
+
+void cmCTestCoordinator::Lose(std::string const& reason)
+{
+  this->Connected = false;
+  this->Finished = true;
+  this->Pipe.reset();
+  this->RetryTimer.reset();
+  if (this->Serving) {
+    this->Serving->SetLocalDone();
+  }
+  this->LostCallback(reason);
+}
@@ -0,0 +1,105 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file Copyright.txt or https://cmake.org/licensing for details.  */
+#pragma once
+
+#include "cmConfigure.h" // IWYU pragma: keep
+
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <cm3p/uv.h>
+
+#include "cmCTestBinPacker.h"
+#include "cmCTestResourceAllocator.h"
+#include "cmUVHandlePtr.h"
+
+/** \class cmCTestCoordinator
+ * \brief Share job slots and resources between ctest processes.
+ *
+ * Every ctest process given the same socket path connects to one
+ * coordinator and asks it for the job slots and resources of each test
+ * before starting it.  The first process to start serves as the
+ * coordinator for all of them, with its own parallel level and resources
+ * as the shared budget, and keeps serving until all processes connected
+ * are done.  Requests are granted in the order they arrive.
+ */
+class cmCTestCoordinator
+{
+public:
+  // Resource units of each type, as held by cmCTestResourceAllocator
+  using Resources =
+    std::map<std::string,
+             std::map<std::string, cmCTestResourceAllocator::Resource>>;
+  // Units needed or allocated for each type, as used by the bin packer
+  using Allocations =
+    std::map<std::string, std::vector<cmCTestBinPackerAllocation>>;
+
+  cmCTestCoordinator(uv_loop_t& loop, std::string path);
+  ~cmCTestCoordinator();
+
+  cmCTestCoordinator(cmCTestCoordinator const&) = delete;
+  cmCTestCoordinator& operator=(cmCTestCoordinator const&) = delete;
+
+  //! Called once connected, with the resources shared by all processes.
+  std::function<void(Resources const&)> ReadyCallback;
+  //! Called with the units allocated when a test may start.
+  std::function<void(int, Allocations const&)> GrantCallback;
+  //! Called with the reason if the coordinator cannot be reached.
+  std::function<void(std::string const&)> LostCallback;
+
+  /**
+   * Start connecting to the coordinator.  Serve as the coordinator, with
+   * the given parallel level and resources, if no other process does.
+   * Return false and set the error if neither is possible.
+   */
+  bool Start(std::size_t parallelLevel,
+             cmCTestResourceAllocator const& resources, std::string& error);
+
+  //! Ask for slots and resources to run the given test.
+  void Acquire(int test, std::size_t slots, Allocations const& allocations);
+
+  //! Return what was granted for the given test.
+  void Release(int test);
+
+  /**
+   * Disconnect.  A coordinator served by this process keeps serving the
+   * other processes until they disconnect too.
+   */
+  void Finish();
+
+  //! Whether this process serves other processes that are not done yet.
+  bool IsServingOthers() const;
+
+private:
+  class Server;
+
+  bool Elect(std::string& error);
+  void Send(std::string const& message);
+  bool Receive(std::string const& line);
+  void Lose(std::string const& reason);
+
+  static void OnConnectCB(uv_connect_t* request, int status);
+  static void OnRetryCB(uv_timer_t* timer);
+  static void OnAllocateCB(uv_handle_t* handle, size_t suggested_size,
+                           uv_buf_t* buf);
+  static void OnReadCB(uv_stream_t* stream, ssize_t nread,
+                       const uv_buf_t* buf);
+
+  uv_loop_t& Loop;
+  std::string Path;
+  std::size_t ParallelLevel = 1;
+  cmCTestResourceAllocator ResourceAllocator;
+  std::unique_ptr<Server> Serving;
+  cm::uv_pipe_ptr Pipe;
+  cm::uv_timer_ptr RetryTimer;
+  uv_connect_t ConnectRequest;
+  int Attempts = 0;
+  bool Connected = false;
+  bool Finished = false;
+  std::vector<char> Buf;
+  std::string Input;
+};
@@ -16,6 +16,7 @@ void cmCTestCoverageCommand::BindArguments()
 {
   this->cmCTestHandlerCommand::BindArguments();
   this->Bind("LABELS"_s, this->Labels);
+  this->Bind("PARALLEL_LEVEL"_s, this->ParallelLevel);
 }
 
 void cmCTestCoverageCommand::CheckArguments(
@@ -41,6 +42,10 @@ cmCTestGenericHandler* cmCTestCoverageCommand::InitializeHandler()
       std::set<std::string>(this->Labels.begin(), this->Labels.end()));
   }
 
+  if (!this->ParallelLevel.empty()) {
+    handler->SetOption("ParallelLevel", this->ParallelLevel);
+  }
+
   handler->SetQuiet(this->Quiet);
   return handler;
 }
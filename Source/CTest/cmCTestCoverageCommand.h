@@ -46,4 +46,5 @@ protected:
 
   bool LabelsMentioned;
   std::vector<std::string> Labels;
+  std::string ParallelLevel;
 };
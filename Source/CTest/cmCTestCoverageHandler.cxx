@@ -3,17 +3,24 @@
 #include "cmCTestCoverageHandler.h"
 
 #include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <cstdint>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
 #include <iomanip>
 #include <iterator>
+#include <mutex>
 #include <sstream>
+#include <thread>
 #include <utility>
 
+#include <cm/memory>
 #include <cmext/algorithm>
 
+#include <cm3p/uv.h>
+
 #include "cmsys/FStream.hxx"
 #include "cmsys/Glob.hxx"
 #include "cmsys/Process.h"
@@ -29,8 +36,11 @@
 #include "cmParseGTMCoverage.h"
 #include "cmParseJacocoCoverage.h"
 #include "cmParsePHPCoverage.h"
+#include "cmProcessOutput.h"
 #include "cmStringAlgorithms.h"
 #include "cmSystemTools.h"
+#include "cmUVProcessChain.h"
+#include "cmValue.h"
 #include "cmWorkingDirectory.h"
 #include "cmXMLWriter.h"
 
@@ -129,6 +139,15 @@ void cmCTestCoverageHandler::Initialize()
   this->LabelFilter.clear();
 }
 
+unsigned int cmCTestCoverageHandler::GetParallelLevel()
+{
+  int level = this->CTest->GetParallelLevel();
+  if (cmValue parallelLevel = this->GetOption("ParallelLevel")) {
+    level = std::atoi(parallelLevel->c_str());
+  }
+  return level > 1 ? static_cast<unsigned int>(level) : 1;
+}
+
 void cmCTestCoverageHandler::CleanCoverageLogFiles(std::ostream& log)
 {
   std::string logGlob =
@@ -322,6 +341,7 @@ int cmCTestCoverageHandler::ProcessHandler()
   cont.BinaryDir = binaryDir;
   cont.OFS = &ofs;
   cont.Quiet = this->Quiet;
+  cont.ParallelLevel = this->GetParallelLevel();
 
   // setup the regex exclude stuff
   this->CustomCoverageExcludeRegex.clear();
@@ -891,6 +911,356 @@ static std::string joinCommandLine(const std::vector<std::string>& args)
   return ret;
 }
 
+namespace {
+// The outcome of one run of a coverage tool.
+struct CoverageRun
+{
+  bool Started = false;
+  int64_t ExitCode = 0;
+  std::string Output;
+  std::string Errors;
+  // Line counts of the coverage files named in the output, by name.
+  std::map<std::string, cmCTestCoverageLineCounts> LineCounts;
+};
+
+int OpenRunLog(std::string const& file)
+{
+  uv_fs_t req;
+  int fd = uv_fs_open(nullptr, &req, file.c_str(),
+                      UV_FS_O_CREAT | UV_FS_O_TRUNC | UV_FS_O_WRONLY, 0644,
+                      nullptr);
+  uv_fs_req_cleanup(&req);
+  return fd;
+}
+
+std::string CloseRunLog(std::string const& file, int fd)
+{
+  if (fd < 0) {
+    return std::string();
+  }
+  uv_fs_t req;
+  uv_fs_close(nullptr, &req, fd, nullptr);
+  uv_fs_req_cleanup(&req);
+
+  std::ostringstream raw;
+  {
+    cmsys::ifstream fin(file.c_str(), std::ios::in | std::ios::binary);
+    raw << fin.rdbuf();
+  }
+  cmSystemTools::RemoveFile(file);
+
+  cmProcessOutput processOutput;
+  std::string text;
+  std::string rest;
+  processOutput.DecodeText(raw.str(), text);
+  processOutput.DecodeText(std::string(), rest);
+  return text + rest;
+}
+
+// Run a command in the given directory and wait for it.  The output goes
+// to files rather than pipes so that many of these may run at once
+// without a thread for each of their pipes.
+CoverageRun RunCoverageCommand(std::vector<std::string> const& command,
+                               std::string const& dir)
+{
+  CoverageRun run;
+  std::string const outputFile = cmStrCat(dir, "/CoverageOutput.log");
+  std::string const errorFile = cmStrCat(dir, "/CoverageErrors.log");
+  int const outputFd = OpenRunLog(outputFile);
+  int const errorFd = OpenRunLog(errorFile);
+  cmUVProcessChain::Status const* status = nullptr;
+  std::unique_ptr<cmUVProcessChain> chain;
+  cmUVProcessChainBuilder builder;
+  if (outputFd >= 0 && errorFd >= 0) {
+    builder.AddCommand(command)
+      .SetExternalStream(cmUVProcessChainBuilder::Stream_OUTPUT, outputFd)
+      .SetExternalStream(cmUVProcessChainBuilder::Stream_ERROR, errorFd)
+      .SetWorkingDirectory(dir);
+    chain = cm::make_unique<cmUVProcessChain>(builder.Start());
+    if (chain->Valid() && chain->Wait()) {
+      status = chain->GetStatus(0);
+    }
+  }
+  run.Output = CloseRunLog(outputFile, outputFd);
+  run.Errors = CloseRunLog(errorFile, errorFd);
+  if (!chain) {
+    run.Errors += cmStrCat("Cannot create output files in ", dir);
+  } else if (!status) {
+    run.Errors += "Error running command";
+  } else if (status->TermSignal != 0) {
+    run.Errors += cmStrCat("Process terminated by signal ",
+                           status->TermSignal);
+  } else {
+    run.Started = true;
+    run.ExitCode = status->ExitStatus;
+  }
+  return run;
+}
+
+// Call fn with each index below count on up to jobs threads.
+template <typename F>
+void ForEachIndex(std::size_t count, unsigned int jobs, F const& fn)
+{
+  std::atomic<std::size_t> next(0);
+  auto worker = [count, &next, &fn]() {
+    for (std::size_t i = next++; i < count; i = next++) {
+      fn(i);
+    }
+  };
+  std::vector<std::thread> threads;
+  jobs = std::min<unsigned int>(jobs, static_cast<unsigned int>(count));
+  for (unsigned int i = 1; i < jobs; ++i) {
+    threads.emplace_back(worker);
+  }
+  worker();
+  for (std::thread& t : threads) {
+    t.join();
+  }
+}
+
+// Read the line counts of a *.gcov file.  Lines without coverage
+// information are -1.
+bool ReadGCovFile(std::string const& file, cmCTestCoverageLineCounts& vec)
+{
+  cmsys::ifstream ifile(file.c_str());
+  if (!ifile) {
+    return false;
+  }
+  std::string nl;
+  while (cmSystemTools::GetLineFromStream(ifile, nl)) {
+    // Skip empty lines
+    if (nl.empty()) {
+      continue;
+    }
+
+    // Skip unused lines
+    if (nl.size() < 12) {
+      continue;
+    }
+
+    // Handle gcov 3.0 non-coverage lines
+    // non-coverage lines seem to always start with something not
+    // a space and don't have a ':' in the 9th position
+    // TODO: Verify that this is actually a robust metric
+    if (nl[0] != ' ' && nl[9] != ':') {
+      continue;
+    }
+
+    // Read the coverage count from the beginning of the gcov output
+    // line
+    std::string prefix = nl.substr(0, 12);
+    int cov = atoi(prefix.c_str());
+
+    // Read the line number starting at the 10th character of the gcov
+    // output line
+    std::string lineNumber = nl.substr(10, 5);
+
+    int lineIdx = atoi(lineNumber.c_str()) - 1;
+    if (lineIdx >= 0) {
+      while (vec.size() <= static_cast<size_t>(lineIdx)) {
+        vec.push_back(-1);
+      }
+
+      // Initially all entries are -1 (not used). If we get coverage
+      // information, increment it to 0 first.
+      if (vec[lineIdx] < 0) {
+        if (cov > 0 || prefix.find('#') != std::string::npos) {
+          vec[lineIdx] = 0;
+        }
+      }
+
+      vec[lineIdx] += cov;
+    }
+  }
+  return true;
+}
+
+struct LCovFile
+{
+  bool Opened = false;
+  bool HasSourceName = false;
+  std::string SourceName;
+  cmCTestCoverageLineCounts LineCounts;
+};
+
+// Read the source name and line counts of an Intel LCOV file.
+void ReadLCovFile(std::string const& file, LCovFile& data)
+{
+  cmsys::ifstream ifile(file.c_str());
+  data.Opened = static_cast<bool>(ifile);
+  std::string nl;
+  if (!cmSystemTools::GetLineFromStream(ifile, nl)) {
+    return;
+  }
+  data.HasSourceName = true;
+  if (nl.size() > 18) {
+    data.SourceName = nl.substr(18);
+  }
+
+  cmCTestCoverageLineCounts& vec = data.LineCounts;
+  while (cmSystemTools::GetLineFromStream(ifile, nl)) {
+    // Skip empty and unused lines
+    if (nl.size() <= 17) {
+      continue;
+    }
+
+    // Read the coverage count from the beginning of the lcov
+    // output line
+    std::string prefix = nl.substr(0, 17);
+    int cov = atoi(prefix.c_str());
+
+    // Read the line number starting at the 17th character of the
+    // lcov output line
+    std::string lineNumber = nl.substr(17, 7);
+
+    int lineIdx = atoi(lineNumber.c_str()) - 1;
+    if (lineIdx >= 0) {
+      while (vec.size() <= static_cast<size_t>(lineIdx)) {
+        vec.push_back(-1);
+      }
+
+      // Initially all entries are -1 (not used). If we get coverage
+      // information, increment it to 0 first.
+      if (vec[lineIdx] < 0) {
+        if (cov > 0 || prefix.find('#') != std::string::npos) {
+          vec[lineIdx] = 0;
+        }
+      }
+
+      vec[lineIdx] += cov;
+    }
+  }
+}
+}
+
+const std::uint16_t cmCTestCoverageLineCounts::NoCode;
+const std::uint16_t cmCTestCoverageLineCounts::Large;
+
+void cmCTestCoverageLineCounts::clear()
+{
+  this->Counts.clear();
+  this->LargeCounts.clear();
+}
+
+void cmCTestCoverageLineCounts::resize(size_type size, int count)
+{
+  size_type const oldSize = this->Counts.size();
+  this->Counts.resize(size, NoCode);
+  this->LargeCounts.erase(this->LargeCounts.lower_bound(size),
+                          this->LargeCounts.end());
+  if (count != -1) {
+    for (size_type i = oldSize; i < size; ++i) {
+      this->Set(i, count);
+    }
+  }
+}
+
+void cmCTestCoverageLineCounts::push_back(int count)
+{
+  this->Counts.push_back(NoCode);
+  this->Set(this->Counts.size() - 1, count);
+}
+
+void cmCTestCoverageLineCounts::Merge(cmCTestCoverageLineCounts const& other)
+{
+  if (this->size() < other.size()) {
+    this->resize(other.size());
+  }
+  for (size_type i = 0; i < other.size(); ++i) {
+    int const count = other[i];
+    if (count >= 0) {
+      this->Set(i, std::max(this->Get(i), 0) + count);
+    }
+  }
+}
+
+int cmCTestCoverageLineCounts::Get(size_type index) const
+{
+  std::uint16_t const count = this->Counts[index];
+  if (count == NoCode) {
+    return -1;
+  }
+  if (count == Large) {
+    return this->LargeCounts.find(index)->second;
+  }
+  return count;
+}
+
+void cmCTestCoverageLineCounts::Set(size_type index, int count)
+{
+  std::uint16_t& stored = this->Counts[index];
+  if (stored == Large) {
+    this->LargeCounts.erase(index);
+  }
+  if (count == -1) {
+    stored = NoCode;
+  } else if (count >= 0 && count < Large) {
+    stored = static_cast<std::uint16_t>(count);
+  } else {
+    stored = Large;
+    this->LargeCounts[index] = count;
+  }
+}
+
+void cmCTestCoverageHandlerContainer::Merge(
+  cmCTestCoverageHandlerContainer& other)
+{
+  this->Error += other.Error;
+  for (auto& file : other.TotalCoverage) {
+    auto i = this->TotalCoverage.find(file.first);
+    if (i == this->TotalCoverage.end()) {
+      this->TotalCoverage.emplace(file.first, std::move(file.second));
+    } else {
+      i->second.Merge(file.second);
+    }
+  }
+  other.TotalCoverage.clear();
+}
+
+bool cmCTestCoverageHandlerContainer::ParseFiles(
+  std::vector<std::string> const& files,
+  std::function<bool(cmCTestCoverageHandlerContainer&, std::string const&)>
+    const& parse)
+{
+  // Every job accumulates the files it parses in a container of its own.
+  // Counts of the same line add up, so the result does not depend on
+  // which job parsed which file.
+  unsigned int const jobs = std::max(
+    1u,
+    std::min(this->ParallelLevel, static_cast<unsigned int>(files.size())));
+  auto makeContainer = [this]() {
+    cmCTestCoverageHandlerContainer cont;
+    cont.Error = 0;
+    cont.SourceDir = this->SourceDir;
+    cont.BinaryDir = this->BinaryDir;
+    cont.OFS = this->OFS;
+    cont.Quiet = this->Quiet;
+    return cont;
+  };
+  std::vector<cmCTestCoverageHandlerContainer> results;
+  for (unsigned int job = 0; job < jobs; ++job) {
+    results.push_back(makeContainer());
+  }
+
+  std::atomic<std::size_t> next(0);
+  std::atomic<bool> ok(true);
+  ForEachIndex(jobs, jobs, [&](std::size_t job) {
+    cmCTestCoverageHandlerContainer& result = results[job];
+    for (std::size_t i = next++; i < files.size(); i = next++) {
+      cmCTestCoverageHandlerContainer cont = makeContainer();
+      if (!parse(cont, files[i])) {
+        ok = false;
+      }
+      result.Merge(cont);
+    }
+  });
+
+  for (cmCTestCoverageHandlerContainer& result : results) {
+    this->Merge(result);
+  }
+  return ok;
+}
+
 int cmCTestCoverageHandler::HandleBlanketJSCoverage(
   cmCTestCoverageHandlerContainer* cont)
 {
@@ -1016,37 +1386,96 @@ int cmCTestCoverageHandler::HandleGCovCoverage(
   basecovargs.insert(basecovargs.begin(), gcovCommand);
   basecovargs.emplace_back("-o");
 
+  // gcov writes the *.gcov files to its working directory, so each of the
+  // invocations running at the same time needs a directory of its own.
+  unsigned int const jobs = std::min<unsigned int>(
+    this->GetParallelLevel(), static_cast<unsigned int>(files.size()));
+  std::vector<std::string> runDirs;
+  if (jobs == 1) {
+    runDirs.push_back(tempDir);
+  } else {
+    for (unsigned int i = 0; i < jobs; ++i) {
+      runDirs.push_back(cmStrCat(tempDir, '/', i));
+      cmSystemTools::MakeDirectory(runDirs.back());
+    }
+  }
+
   // files is a list of *.da and *.gcda files with coverage data in them.
   // These are binary files that you give as input to gcov so that it will
   // give us text output we can analyze to summarize coverage.
   //
+  // gcov runs on up to one file per job at a time, each in a directory
+  // of its own.  The next file is started as soon as one is done and the
+  // *.gcov files it created are read.  The results are then merged in
+  // order.
+  //
+  std::vector<std::vector<std::string>> commands;
   for (std::string const& f : files) {
+    std::vector<std::string> covargs = basecovargs;
+    covargs.push_back(cmSystemTools::GetFilenamePath(f));
+    covargs.push_back(f);
+    commands.push_back(std::move(covargs));
+  }
+
+  std::vector<CoverageRun> runs(files.size());
+  std::mutex runDirsMutex;
+  std::vector<std::string> freeRunDirs = runDirs;
+  ForEachIndex(files.size(), jobs, [&](std::size_t i) {
+    std::string runDir;
+    {
+      std::lock_guard<std::mutex> lock(runDirsMutex);
+      runDir = std::move(freeRunDirs.back());
+      freeRunDirs.pop_back();
+    }
+    runs[i] = RunCoverageCommand(commands[i], runDir);
+
+    // Read the *.gcov files before the next gcov run in this directory
+    // overwrites them.
+    cmsys::RegularExpression gcovFileRe1(st1gcovOutputRex2);
+    cmsys::RegularExpression gcovFileRe2(st2gcovOutputRex3);
+    std::vector<std::string> lines;
+    cmsys::SystemTools::Split(runs[i].Output, lines);
+    for (std::string const& line : lines) {
+      std::string gcovFile;
+      if (gcovFileRe1.find(line)) {
+        gcovFile = gcovFileRe1.match(1);
+      } else if (gcovFileRe2.find(line)) {
+        gcovFile = gcovFileRe2.match(2);
+      } else {
+        continue;
+      }
+      cmCTestCoverageLineCounts counts;
+      if (ReadGCovFile(cmSystemTools::CollapseFullPath(gcovFile, runDir),
+                       counts)) {
+        runs[i].LineCounts[gcovFile] = std::move(counts);
+      }
+    }
+
+    std::lock_guard<std::mutex> lock(runDirsMutex);
+    freeRunDirs.push_back(std::move(runDir));
+  });
+
+  for (std::size_t i = 0; i < files.size(); ++i) {
+    std::string const& f = files[i];
+    CoverageRun const& run = runs[i];
     cmCTestOptionalLog(this->CTest, HANDLER_OUTPUT, "." << std::flush,
                        this->Quiet);
 
     // Call gcov to get coverage data for this *.gcda file:
     //
     std::string fileDir = cmSystemTools::GetFilenamePath(f);
-    std::vector<std::string> covargs = basecovargs;
-    covargs.push_back(fileDir);
-    covargs.push_back(f);
-    const std::string command = joinCommandLine(covargs);
+    const std::string command = joinCommandLine(commands[i]);
 
     cmCTestOptionalLog(this->CTest, HANDLER_VERBOSE_OUTPUT,
                        command << std::endl, this->Quiet);
 
-    std::string output;
-    std::string errors;
-    int retVal = 0;
+    std::string const& output = run.Output;
+    std::string const& errors = run.Errors;
     *cont->OFS << "* Run coverage for: " << fileDir << std::endl;
     *cont->OFS << "  Command: " << command << std::endl;
-    int res = this->CTest->RunCommand(covargs, &output, &errors, &retVal,
-                                      tempDir.c_str(),
-                                      cmDuration::zero() /*this->TimeOut*/);
-
     *cont->OFS << "  Output: " << output << std::endl;
     *cont->OFS << "  Errors: " << errors << std::endl;
-    if (!res) {
+    if (!run.Started) {
       cmCTestLog(this->CTest, ERROR_MESSAGE,
                  "Problem running coverage on file: " << f << std::endl);
       cmCTestLog(this->CTest, ERROR_MESSAGE,
@@ -1054,10 +1483,10 @@ int cmCTestCoverageHandler::HandleGCovCoverage(
       cont->Error++;
       continue;
     }
-    if (retVal != 0) {
+    if (run.ExitCode != 0) {
       cmCTestLog(this->CTest, ERROR_MESSAGE,
                  "Coverage command returned: "
-                   << retVal << " while processing: " << f << std::endl);
+                   << run.ExitCode << " while processing: " << f << std::endl);
       cmCTestLog(this->CTest, ERROR_MESSAGE,
                  "Command produced error: " << cont->Error << std::endl);
     }
@@ -1213,57 +1642,12 @@ int cmCTestCoverageHandler::HandleGCovCoverage(
                            "   in gcovFile: " << gcovFile << std::endl,
                            this->Quiet);
 
-        cmsys::ifstream ifile(gcovFile.c_str());
-        if (!ifile) {
+        auto const counts = run.LineCounts.find(gcovFile);
+        if (counts == run.LineCounts.end()) {
           cmCTestLog(this->CTest, ERROR_MESSAGE,
                      "Cannot open file: " << gcovFile << std::endl);
         } else {
-          std::string nl;
-          while (cmSystemTools::GetLineFromStream(ifile, nl)) {
-            // Skip empty lines
-            if (nl.empty()) {
-              continue;
-            }
-
-            // Skip unused lines
-            if (nl.size() < 12) {
-              continue;
-            }
-
-            // Handle gcov 3.0 non-coverage lines
-            // non-coverage lines seem to always start with something not
-            // a space and don't have a ':' in the 9th position
-            // TODO: Verify that this is actually a robust metric
-            if (nl[0] != ' ' && nl[9] != ':') {
-              continue;
-            }
-
-            // Read the coverage count from the beginning of the gcov output
-            // line
-            std::string prefix = nl.substr(0, 12);
-            int cov = atoi(prefix.c_str());
-
-            // Read the line number starting at the 10th character of the gcov
-            // output line
-            std::string lineNumber = nl.substr(10, 5);
-
-            int lineIdx = atoi(lineNumber.c_str()) - 1;
-            if (lineIdx >= 0) {
-              while (vec.size() <= static_cast<size_t>(lineIdx)) {
-                vec.push_back(-1);
-              }
-
-              // Initially all entries are -1 (not used). If we get coverage
-              // information, increment it to 0 first.
-              if (vec[lineIdx] < 0) {
-                if (cov > 0 || prefix.find('#') != std::string::npos) {
-                  vec[lineIdx] = 0;
-                }
-              }
-
-              vec[lineIdx] += cov;
-            }
-          }
+          vec.Merge(counts->second);
         }
 
         actualSourceFile.clear();
@@ -1452,6 +1836,26 @@ int cmCTestCoverageHandler::HandleLCovCoverage(
     std::vector<std::string> lines;
     cmsys::SystemTools::Split(output, lines);
 
+    // Look for LCOV files in binary directory
+    // Intel Compiler creates a CodeCoverage dir for each subfolder and
+    // each subfolder has LCOV files
+    // They do not change while the output is processed, so read them once
+    // on a pool of threads.
+    std::string daGlob = cmStrCat(this->CTest->GetBinaryDir(), "/*.LCOV");
+    std::vector<std::string> lcovFiles;
+    if (!lines.empty()) {
+      cmsys::Glob gl;
+      gl.RecurseOn();
+      gl.RecurseThroughSymlinksOff();
+      gl.FindFiles(daGlob);
+      lcovFiles = gl.GetFiles();
+    }
+    std::vector<LCovFile> lcovData(lcovFiles.size());
+    ForEachIndex(lcovFiles.size(), this->GetParallelLevel(),
+                 [&lcovFiles, &lcovData](std::size_t i) {
+                   ReadLCovFile(lcovFiles[i], lcovData[i]);
+                 });
+
     for (std::string const& line : lines) {
       std::string sourceFile;
       std::string lcovFile;
@@ -1459,46 +1863,28 @@ int cmCTestCoverageHandler::HandleLCovCoverage(
       if (line.empty()) {
         // Ignore empty line
       }
-      // Look for LCOV files in binary directory
-      // Intel Compiler creates a CodeCoverage dir for each subfolder and
-      // each subfolder has LCOV files
-      cmsys::Glob gl;
-      gl.RecurseOn();
-      gl.RecurseThroughSymlinksOff();
-      std::string dir;
-      std::vector<std::string> lcovFiles;
-      dir = this->CTest->GetBinaryDir();
-      std::string daGlob;
-      daGlob = cmStrCat(dir, "/*.LCOV");
       cmCTestOptionalLog(
         this->CTest, HANDLER_VERBOSE_OUTPUT,
         "   looking for LCOV files in: " << daGlob << std::endl, this->Quiet);
-      gl.FindFiles(daGlob);
-      // Keep a list of all LCOV files
-      cm::append(lcovFiles, gl.GetFiles());
 
-      for (std::string const& file : lcovFiles) {
-        lcovFile = file;
-        cmsys::ifstream srcead(lcovFile.c_str());
-        if (!srcead) {
+      for (std::size_t i = 0; i < lcovFiles.size(); ++i) {
+        lcovFile = lcovFiles[i];
+        LCovFile const& data = lcovData[i];
+        if (!data.Opened) {
           cmCTestLog(this->CTest, ERROR_MESSAGE,
                      "Cannot open file: " << lcovFile << std::endl);
         }
-        std::string srcname;
-
-        int success = cmSystemTools::GetLineFromStream(srcead, srcname);
-        if (!success) {
+        if (!data.HasSourceName) {
           cmCTestLog(this->CTest, ERROR_MESSAGE,
                      "Error while parsing lcov file '"
                        << lcovFile << "':"
                        << " No source file name found!" << std::endl);
           return 0;
         }
-        srcname = srcname.substr(18);
         // We can directly read found LCOV files to determine the source
         // files
-        sourceFile = srcname;
-        actualSourceFile = srcname;
+        sourceFile = data.SourceName;
+        actualSourceFile = data.SourceName;
 
         for (std::string const& t : lcovFiles) {
           cmCTestOptionalLog(this->CTest, HANDLER_VERBOSE_OUTPUT,
@@ -1519,57 +1905,10 @@ int cmCTestCoverageHandler::HandleLCovCoverage(
           cmCTestOptionalLog(this->CTest, HANDLER_VERBOSE_OUTPUT,
                              "   in lcovFile: " << lcovFile << std::endl,
                              this->Quiet);
-
-          cmsys::ifstream ifile(lcovFile.c_str());
-          if (!ifile) {
-            cmCTestLog(this->CTest, ERROR_MESSAGE,
-                       "Cannot open file: " << lcovFile << std::endl);
-          } else {
-            std::string nl;
-
-            // Skip the first line
-            cmSystemTools::GetLineFromStream(ifile, nl);
-            cmCTestOptionalLog(this->CTest, HANDLER_VERBOSE_OUTPUT,
-                               "File is ready, start reading." << std::endl,
-                               this->Quiet);
-            while (cmSystemTools::GetLineFromStream(ifile, nl)) {
-              // Skip empty lines
-              if (nl.empty()) {
-                continue;
-              }
-
-              // Skip unused lines
-              if (nl.size() < 12) {
-                continue;
-              }
-
-              // Read the coverage count from the beginning of the lcov
-              // output line
-              std::string prefix = nl.substr(0, 17);
-              int cov = atoi(prefix.c_str());
-
-              // Read the line number starting at the 17th character of the
-              // lcov output line
-              std::string lineNumber = nl.substr(17, 7);
-
-              int lineIdx = atoi(lineNumber.c_str()) - 1;
-              if (lineIdx >= 0) {
-                while (vec.size() <= static_cast<size_t>(lineIdx)) {
-                  vec.push_back(-1);
-                }
-
-                // Initially all entries are -1 (not used). If we get coverage
-                // information, increment it to 0 first.
-                if (vec[lineIdx] < 0) {
-                  if (cov > 0 || prefix.find('#') != std::string::npos) {
-                    vec[lineIdx] = 0;
-                  }
-                }
-
-                vec[lineIdx] += cov;
-              }
-            }
-          }
+          cmCTestOptionalLog(this->CTest, HANDLER_VERBOSE_OUTPUT,
+                             "File is ready, start reading." << std::endl,
+                             this->Quiet);
+          vec.Merge(data.LineCounts);
 
           actualSourceFile.clear();
         }
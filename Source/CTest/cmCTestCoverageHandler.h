@@ -4,6 +4,9 @@
 
 #include "cmConfigure.h" // IWYU pragma: keep
 
+#include <cstddef>
+#include <cstdint>
+#include <functional>
 #include <iosfwd>
 #include <map>
 #include <set>
@@ -18,17 +21,96 @@ class cmGeneratedFileStream;
 class cmMakefile;
 class cmXMLWriter;
 
+/** \class cmCTestCoverageLineCounts
+ * \brief Execution counts of the lines of one source file.
+ *
+ * A count of -1 marks a line without code.  Most counts are small, so
+ * they are stored in 16 bits each and the few others are kept aside.
+ * Indexing works as for a std::vector<int>.
+ */
+class cmCTestCoverageLineCounts
+{
+public:
+  using size_type = std::size_t;
+
+  class reference
+  {
+  public:
+    reference(cmCTestCoverageLineCounts& counts, size_type index)
+      : Counts(counts)
+      , Index(index)
+    {
+    }
+    operator int() const { return this->Counts.Get(this->Index); }
+    reference& operator=(reference const& other)
+    {
+      return *this = static_cast<int>(other);
+    }
+    reference& operator=(int count)
+    {
+      this->Counts.Set(this->Index, count);
+      return *this;
+    }
+    reference& operator+=(int count)
+    {
+      return *this = this->Counts.Get(this->Index) + count;
+    }
+    reference& operator++() { return *this += 1; }
+
+  private:
+    cmCTestCoverageLineCounts& Counts;
+    size_type Index;
+  };
+
+  size_type size() const { return this->Counts.size(); }
+  bool empty() const { return this->Counts.empty(); }
+  void clear();
+  void resize(size_type size, int count = -1);
+  void push_back(int count);
+
+  int operator[](size_type index) const { return this->Get(index); }
+  reference operator[](size_type index) { return { *this, index }; }
+
+  /** Add the counts of lines with code in other.  */
+  void Merge(cmCTestCoverageLineCounts const& other);
+
+private:
+  static const std::uint16_t NoCode = 0xFFFF;
+  static const std::uint16_t Large = 0xFFFE;
+
+  int Get(size_type index) const;
+  void Set(size_type index, int count);
+
+  std::vector<std::uint16_t> Counts;
+  // Counts that do not fit, by line index.
+  std::map<size_type, int> LargeCounts;
+};
+
 class cmCTestCoverageHandlerContainer
 {
 public:
   int Error;
   std::string SourceDir;
   std::string BinaryDir;
-  using SingleFileCoverageVector = std::vector<int>;
+  using SingleFileCoverageVector = cmCTestCoverageLineCounts;
   using TotalCoverageMap = std::map<std::string, SingleFileCoverageVector>;
   TotalCoverageMap TotalCoverage;
   std::ostream* OFS;
   bool Quiet;
+  unsigned int ParallelLevel = 1;
+
+  /** Add the coverage and errors collected in other.  */
+  void Merge(cmCTestCoverageHandlerContainer& other);
+
+  /**
+   * Call parse for each of the given files on up to ParallelLevel threads.
+   * Each call fills a container of its own, and the containers are merged
+   * into this one afterwards.  Return false if any call did.
+   */
+  bool ParseFiles(
+    std::vector<std::string> const& files,
+    std::function<bool(cmCTestCoverageHandlerContainer&, std::string const&)>
+      const& parse);
 };
 /** \class cmCTestCoverageHandler
  * \brief A class that handles coverage computation for ctest
@@ -66,6 +148,9 @@ private:
   void StartCoverageLogXML(cmXMLWriter& xml);
   void EndCoverageLogXML(cmXMLWriter& xml);
 
+  //! Number of coverage tool invocations and parsers to run at once
+  unsigned int GetParallelLevel();
+
   //! Handle coverage using GCC's GCov
   int HandleGCovCoverage(cmCTestCoverageHandlerContainer* cont);
   void FindGCovFiles(std::vector<std::string>& files);
@@ -0,0 +1,178 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file Copyright.txt or https://cmake.org/licensing for details.  */
+#include "cmCTestDependencyGraph.h"
+
+#include <algorithm>
+#include <limits>
+
+void cmCTestDependencyGraph::AddTest(int test)
+{
+  this->Tests.push_back(test);
+}
+
+void cmCTestDependencyGraph::AddDependency(int test, int dependency)
+{
+  this->Edges.emplace_back(test, dependency);
+}
+
+void cmCTestDependencyGraph::Build()
+{
+  std::sort(this->Tests.begin(), this->Tests.end());
+  this->Tests.erase(std::unique(this->Tests.begin(), this->Tests.end()),
+                    this->Tests.end());
+  this->Nodes.clear();
+  this->Nodes.reserve(this->Tests.size());
+  for (Node node = 0; node < this->Tests.size(); ++node) {
+    this->Nodes.emplace(this->Tests[node], node);
+  }
+
+  // Translate the dependencies between known tests to nodes.
+  std::vector<std::pair<Node, Node>> edges;
+  edges.reserve(this->Edges.size());
+  for (auto const& edge : this->Edges) {
+    Node from;
+    Node to;
+    if (this->FindNode(edge.first, from) && this->FindNode(edge.second, to)) {
+      edges.emplace_back(from, to);
+    }
+  }
+  this->Edges.clear();
+  std::sort(edges.begin(), edges.end());
+  edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+  // Store the edges sorted by source, then again sorted by target, each
+  // with the position where the edges of every node start.
+  auto store = [this](std::vector<std::pair<Node, Node>> const& sorted,
+                      std::vector<std::size_t>& start,
+                      std::vector<Node>& targets) {
+    start.assign(this->Tests.size() + 1, 0);
+    targets.clear();
+    targets.reserve(sorted.size());
+    for (auto const& edge : sorted) {
+      ++start[edge.first + 1];
+      targets.push_back(edge.second);
+    }
+    for (Node node = 0; node < this->Tests.size(); ++node) {
+      start[node + 1] += start[node];
+    }
+  };
+  store(edges, this->DependencyStart, this->Dependencies);
+  for (auto& edge : edges) {
+    std::swap(edge.first, edge.second);
+  }
+  std::sort(edges.begin(), edges.end());
+  store(edges, this->DependentStart, this->Dependents);
+}
+
+bool cmCTestDependencyGraph::FindNode(int test, Node& node) const
+{
+  auto it = this->Nodes.find(test);
+  if (it == this->Nodes.end()) {
+    return false;
+  }
+  node = it->second;
+  return true;
+}
+
+std::vector<cmCTestDependencyGraph::Node>
+cmCTestDependencyGraph::GetDependentsFirstOrder() const
+{
+  std::size_t const count = this->Tests.size();
+  std::vector<std::size_t> pending(count);
+  std::vector<Node> ready;
+  for (Node node = count; node > 0; --node) {
+    pending[node - 1] = this->GetDependents(node - 1).size();
+    if (pending[node - 1] == 0) {
+      ready.push_back(node - 1);
+    }
+  }
+
+  std::vector<Node> order;
+  order.reserve(count);
+  while (!ready.empty()) {
+    Node const node = ready.back();
+    ready.pop_back();
+    order.push_back(node);
+    for (Node dependency : this->GetDependencies(node)) {
+      if (--pending[dependency] == 0) {
+        ready.push_back(dependency);
+      }
+    }
+  }
+  return order;
+}
+
+bool cmCTestDependencyGraph::FindCycle(int& test) const
+{
+  // Find the strongly connected components with Tarjan's algorithm,
+  // using an explicit stack so that long chains of tests cannot overflow
+  // the call stack.  Any component of more than one node has a cycle.
+  std::size_t const count = this->Tests.size();
+  std::size_t const unvisited = std::numeric_limits<std::size_t>::max();
+  std::vector<std::size_t> order(count, unvisited);
+  std::vector<std::size_t> low(count);
+  std::vector<bool> onStack(count);
+  std::vector<Node> stack;
+  std::vector<std::pair<Node, std::size_t>> work;
+  std::size_t visited = 0;
+  bool found = false;
+  Node lowest = count;
+
+  auto visit = [&](Node node) {
+    order[node] = low[node] = visited++;
+    stack.push_back(node);
+    onStack[node] = true;
+    work.emplace_back(node, this->DependencyStart[node]);
+  };
+
+  for (Node root = 0; root < count; ++root) {
+    if (order[root] != unvisited) {
+      continue;
+    }
+    visit(root);
+    while (!work.empty()) {
+      Node const node = work.back().first;
+      std::size_t const next = work.back().second;
+      if (next < this->DependencyStart[node + 1]) {
+        ++work.back().second;
+        Node const dependency = this->Dependencies[next];
+        if (dependency == node) {
+          found = true;
+          lowest = std::min(lowest, node);
+        } else if (order[dependency] == unvisited) {
+          visit(dependency);
+        } else if (onStack[dependency]) {
+          low[node] = std::min(low[node], order[dependency]);
+        }
+        continue;
+      }
+
+      work.pop_back();
+      if (!work.empty()) {
+        Node const parent = work.back().first;
+        low[parent] = std::min(low[parent], low[node]);
+      }
+      if (low[node] == order[node]) {
+        Node member;
+        Node first = node;
+        std::size_t size = 0;
+        do {
+          member = stack.back();
+          stack.pop_back();
+          onStack[member] = false;
+          first = std::min(first, member);
+          ++size;
+        } while (member != node);
+        if (size > 1) {
+          found = true;
+          lowest = std::min(lowest, first);
+        }
+      }
+    }
+  }
+
+  if (found) {
+    test = this->Tests[lowest];
+  }
+  return found;
+}
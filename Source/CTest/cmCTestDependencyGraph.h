@@ -0,0 +1,82 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file Copyright.txt or https://cmake.org/licensing for details.  */
+#pragma once
+
+#include "cmConfigure.h" // IWYU pragma: keep
+
+#include <cstddef>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "cmRange.h"
+
+/** \class cmCTestDependencyGraph
+ * \brief Dependencies between tests, indexed for graph traversals.
+ *
+ * The tests added are numbered from 0 in increasing order of their test
+ * index.  The tests each one depends on, and the tests depending on each
+ * one, are stored in two flat arrays in that order, so that traversals
+ * visit every test and dependency once and in a deterministic order.
+ */
+class cmCTestDependencyGraph
+{
+public:
+  using Node = std::size_t;
+  using NodeRange = cmRange<std::vector<Node>::const_iterator>;
+
+  /** Add a test.  Call Build after adding all tests and dependencies.  */
+  void AddTest(int test);
+
+  /**
+   * Record that a test depends on another.  Dependencies on tests that
+   * are never added are ignored.
+   */
+  void AddDependency(int test, int dependency);
+
+  /** Index the tests and dependencies added so far.  */
+  void Build();
+
+  std::size_t GetNodeCount() const { return this->Tests.size(); }
+
+  int GetTest(Node node) const { return this->Tests[node]; }
+
+  /** Find the node of a test.  Return false if it was not added.  */
+  bool FindNode(int test, Node& node) const;
+
+  NodeRange GetDependencies(Node node) const
+  {
+    return cmMakeRange(
+      this->Dependencies.cbegin() + this->DependencyStart[node],
+      this->Dependencies.cbegin() + this->DependencyStart[node + 1]);
+  }
+
+  NodeRange GetDependents(Node node) const
+  {
+    return cmMakeRange(
+      this->Dependents.cbegin() + this->DependentStart[node],
+      this->Dependents.cbegin() + this->DependentStart[node + 1]);
+  }
+
+  /**
+   * Return the nodes ordered so that each comes before the nodes it
+   * depends on.  Nodes on a cycle, and the nodes they depend on, are
+   * left out.
+   */
+  std::vector<Node> GetDependentsFirstOrder() const;
+
+  /**
+   * Find the lowest test that is part of a dependency cycle.  Return false
+   * if there is no cycle.
+   */
+  bool FindCycle(int& test) const;
+
+private:
+  std::vector<int> Tests;
+  std::unordered_map<int, Node> Nodes;
+  std::vector<std::pair<int, int>> Edges;
+  std::vector<std::size_t> DependencyStart;
+  std::vector<Node> Dependencies;
+  std::vector<std::size_t> DependentStart;
+  std::vector<Node> Dependents;
+};
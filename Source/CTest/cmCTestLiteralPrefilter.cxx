@@ -0,0 +1,241 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file Copyright.txt or https://cmake.org/licensing for details.  */
+#include "cmCTestLiteralPrefilter.h"
+
+#include <algorithm>
+#include <deque>
+#include <utility>
+
+namespace {
+std::size_t const kAlphabet = 256;
+
+// Return the end of the group or bracket expression starting at pos.
+std::size_t SkipGroup(std::string const& regex, std::size_t pos)
+{
+  std::size_t const size = regex.size();
+  if (regex[pos] == '[') {
+    ++pos;
+    if (pos < size && regex[pos] == '^') {
+      ++pos;
+    }
+    // A ']' first in the list is literal.
+    if (pos < size && regex[pos] == ']') {
+      ++pos;
+    }
+    while (pos < size && regex[pos] != ']') {
+      ++pos;
+    }
+    return std::min(pos + 1, size);
+  }
+
+  int depth = 0;
+  while (pos < size) {
+    char const c = regex[pos];
+    if (c == '\\') {
+      pos += 2;
+      continue;
+    }
+    if (c == '[') {
+      pos = SkipGroup(regex, pos);
+      continue;
+    }
+    ++pos;
+    if (c == '(') {
+      ++depth;
+    } else if (c == ')' && --depth == 0) {
+      break;
+    }
+  }
+  return std::min(pos, size);
+}
+
+std::size_t GetShortest(std::vector<std::string> const& literals)
+{
+  std::size_t shortest = literals.empty() ? 0 : literals.front().size();
+  for (std::string const& literal : literals) {
+    shortest = std::min(shortest, literal.size());
+  }
+  return shortest;
+}
+
+// Return the literals one of which every match of the branch contains:
+// either its longest run of literal characters or the literals of one of
+// its groups, whichever has the longest shortest literal.
+std::vector<std::string> GetBranchLiterals(std::string const& branch)
+{
+  std::vector<std::string> best;
+  std::string run;
+  auto consider = [&best](std::vector<std::string> literals) {
+    if (GetShortest(literals) > GetShortest(best)) {
+      best = std::move(literals);
+    }
+  };
+  auto flush = [&run, &consider]() {
+    if (!run.empty()) {
+      consider(std::vector<std::string>{ run });
+      run.clear();
+    }
+  };
+
+  std::size_t const size = branch.size();
+  std::size_t pos = 0;
+  while (pos < size) {
+    char const c = branch[pos];
+    bool literal = false;
+    bool group = false;
+    char value = c;
+    std::size_t next = pos + 1;
+    switch (c) {
+      case '(':
+        next = SkipGroup(branch, pos);
+        group = branch[next - 1] == ')';
+        break;
+      case '[':
+        next = SkipGroup(branch, pos);
+        break;
+      case '.':
+      case '^':
+      case '$':
+        break;
+      case '\\':
+        if (next < size) {
+          value = branch[next];
+          ++next;
+        }
+        literal = true;
+        break;
+      default:
+        literal = true;
+        break;
+    }
+
+    char const quantifier = next < size ? branch[next] : '\0';
+    bool const optional = quantifier == '*' || quantifier == '?';
+    if (literal && !optional) {
+      run += value;
+    }
+    if (!literal || optional || quantifier == '+') {
+      // The atom ends the run unless it is one literal occurring once.
+      flush();
+    }
+    if (group && !optional) {
+      consider(cmCTestLiteralPrefilter::GetRequiredLiterals(
+        branch.substr(pos + 1, next - pos - 2)));
+    }
+    if (optional || quantifier == '+') {
+      ++next;
+    }
+    pos = next;
+  }
+  flush();
+  return best;
+}
+}
+
+std::vector<std::string> cmCTestLiteralPrefilter::GetRequiredLiterals(
+  std::string const& regex)
+{
+  // Split the top-level alternatives.
+  std::vector<std::string> branches;
+  std::size_t start = 0;
+  std::size_t pos = 0;
+  while (pos < regex.size()) {
+    char const c = regex[pos];
+    if (c == '\\') {
+      pos += 2;
+    } else if (c == '(' || c == '[') {
+      pos = SkipGroup(regex, pos);
+    } else if (c == '|') {
+      branches.push_back(regex.substr(start, pos - start));
+      start = ++pos;
+    } else {
+      ++pos;
+    }
+  }
+  branches.push_back(regex.substr(start));
+
+  std::vector<std::string> literals;
+  for (std::string const& branch : branches) {
+    std::vector<std::string> const branchLiterals = GetBranchLiterals(branch);
+    if (branchLiterals.empty()) {
+      return std::vector<std::string>();
+    }
+    literals.insert(literals.end(), branchLiterals.begin(),
+                    branchLiterals.end());
+  }
+  return literals;
+}
+
+std::size_t cmCTestLiteralPrefilter::Add(std::string const& regex)
+{
+  this->Literals.push_back(GetRequiredLiterals(regex));
+  this->AlwaysCandidates.push_back(this->Literals.back().empty());
+  return this->Literals.size() - 1;
+}
+
+void cmCTestLiteralPrefilter::Compile()
+{
+  // Build the trie of all literals.  Transitions not in the trie are -1.
+  this->Next.assign(kAlphabet, -1);
+  this->Matches.assign(1, std::vector<std::size_t>());
+  for (std::size_t id = 0; id < this->Literals.size(); ++id) {
+    for (std::string const& literal : this->Literals[id]) {
+      std::int32_t state = 0;
+      for (unsigned char c : literal) {
+        std::int32_t& next = this->Next[state * kAlphabet + c];
+        if (next < 0) {
+          next = static_cast<std::int32_t>(this->Matches.size());
+          this->Matches.emplace_back();
+          this->Next.resize(this->Next.size() + kAlphabet, -1);
+        }
+        // The table may have been reallocated.
+        state = this->Next[state * kAlphabet + c];
+      }
+      this->Matches[state].push_back(id);
+    }
+  }
+
+  // Complete the transitions breadth first so that a missing transition
+  // follows the one of the longest proper suffix in the trie.
+  std::vector<std::int32_t> fail(this->Matches.size(), 0);
+  std::deque<std::int32_t> queue;
+  for (std::size_t c = 0; c < kAlphabet; ++c) {
+    std::int32_t& next = this->Next[c];
+    if (next < 0) {
+      next = 0;
+    } else {
+      queue.push_back(next);
+    }
+  }
+  while (!queue.empty()) {
+    std::int32_t const state = queue.front();
+    queue.pop_front();
+    std::vector<std::size_t> const& inherited = this->Matches[fail[state]];
+    this->Matches[state].insert(this->Matches[state].end(), inherited.begin(),
+                                inherited.end());
+    for (std::size_t c = 0; c < kAlphabet; ++c) {
+      std::int32_t const fallback = this->Next[fail[state] * kAlphabet + c];
+      std::int32_t& next = this->Next[state * kAlphabet + c];
+      if (next < 0) {
+        next = fallback;
+      } else {
+        fail[next] = fallback;
+        queue.push_back(next);
+      }
+    }
+  }
+
+  this->Candidates = this->AlwaysCandidates;
+}
+
+void cmCTestLiteralPrefilter::Scan(std::string const& text)
+{
+  this->Candidates = this->AlwaysCandidates;
+  std::int32_t state = 0;
+  for (unsigned char c : text) {
+    state = this->Next[state * kAlphabet + c];
+    for (std::size_t id : this->Matches[state]) {
+      this->Candidates[id] = true;
+    }
+  }
+}
@@ -0,0 +1,51 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file Copyright.txt or https://cmake.org/licensing for details.  */
+#pragma once
+
+#include "cmConfigure.h" // IWYU pragma: keep
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/** \class cmCTestLiteralPrefilter
+ * \brief Find the regular expressions that may match a line in one pass.
+ *
+ * Each expression added is reduced to literal strings one of which any
+ * match must contain, taken from its literal runs and groups.  All
+ * literals are searched for at once with an Aho-Corasick automaton.  An
+ * expression is a candidate for a line if one of its literals occurs in
+ * it, or if no literal could be derived from it.  Only candidates need to
+ * be matched with the full regular expression.
+ */
+class cmCTestLiteralPrefilter
+{
+public:
+  /** Add an expression and return its id.  Call Compile afterwards.  */
+  std::size_t Add(std::string const& regex);
+
+  /** Build the automaton for the expressions added so far.  */
+  void Compile();
+
+  /** Find the candidate expressions for the given text.  */
+  void Scan(std::string const& text);
+
+  bool IsCandidate(std::size_t id) const { return this->Candidates[id]; }
+
+  /**
+   * Return the literals one of which a match of the given cmsys regular
+   * expression must contain, or nothing if there are none.
+   */
+  static std::vector<std::string> GetRequiredLiterals(
+    std::string const& regex);
+
+private:
+  std::vector<std::vector<std::string>> Literals;
+  std::vector<bool> AlwaysCandidates;
+  std::vector<bool> Candidates;
+  // Transition table of the automaton, 256 entries per state.
+  std::vector<std::int32_t> Next;
+  // Expressions whose literal ends at each state.
+  std::vector<std::vector<std::size_t>> Matches;
+};
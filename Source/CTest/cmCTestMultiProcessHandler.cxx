@@ -11,9 +11,7 @@
 #include <cstring>
 #include <iomanip>
 #include <iostream>
-#include <list>
 #include <sstream>
-#include <stack>
 #include <unordered_map>
 #include <utility>
 #include <vector>
@@ -31,11 +29,12 @@
 #include "cmAffinity.h"
 #include "cmCTest.h"
 #include "cmCTestBinPacker.h"
+#include "cmCTestCoordinator.h"
+#include "cmCTestResourceSpec.h"
 #include "cmCTestRunTest.h"
 #include "cmCTestTestHandler.h"
 #include "cmDuration.h"
 #include "cmListFileCache.h"
-#include "cmRange.h"
 #include "cmStringAlgorithms.h"
 #include "cmSystemTools.h"
 #include "cmUVSignalHackRAII.h" // IWYU pragma: keep
@@ -90,6 +89,14 @@ void cmCTestMultiProcessHandler::SetTests(TestMap& tests,
   for (auto const& t : this->Tests) {
     this->TestRunningMap[t.first] = false;
     this->TestFinishMap[t.first] = false;
+    this->Graph.AddTest(t.first);
+    for (int dependency : t.second) {
+      this->Graph.AddDependency(t.first, dependency);
+    }
+  }
+  this->Graph.Build();
+  for (auto const& p : this->Properties) {
+    this->TestsByName[p.second->Name] = p.first;
   }
   if (!this->CTest->GetShowOnly()) {
     this->ReadCostData();
@@ -121,6 +128,21 @@ void cmCTestMultiProcessHandler::SetTestLoad(unsigned long load)
   }
 }
 
+void cmCTestMultiProcessHandler::SetTestMemory(unsigned long memory)
+{
+  this->TestMemory = memory * 1024;
+
+  std::string fake_memory_value;
+  if (cmSystemTools::GetEnv("__CTEST_FAKE_MEMORY_AVAILABLE_FOR_TESTING",
+                            fake_memory_value)) {
+    if (!cmStrToULong(fake_memory_value, &this->FakeMemoryForTesting)) {
+      cmSystemTools::Error("Failed to parse fake memory value: " +
+                           fake_memory_value);
+    }
+    this->FakeMemoryForTesting *= 1024;
+  }
+}
+
 void cmCTestMultiProcessHandler::RunTests()
 {
   this->CheckResume();
@@ -132,11 +154,26 @@ void cmCTestMultiProcessHandler::RunTests()
 #endif
   this->TestHandler->SetMaxIndex(this->FindMaxIndex());
 
+  auto const startTime = std::chrono::steady_clock::now();
   uv_loop_init(&this->Loop);
+  this->StartCoordinator();
   this->StartNextTests();
+  this->CheckCoordinatorDone();
   uv_run(&this->Loop, UV_RUN_DEFAULT);
+  this->Coordinator.reset();
   uv_loop_close(&this->Loop);
 
+  if (this->PredictedMakespan > 0) {
+    cmDuration const actual = std::chrono::steady_clock::now() - startTime;
+    cmCTestOptionalLog(this->CTest, HANDLER_OUTPUT,
+                       std::endl
+                         << "Critical path schedule: predicted makespan "
+                         << std::fixed << std::setprecision(2)
+                         << this->PredictedMakespan << " sec, actual "
+                         << actual.count() << " sec" << std::endl,
+                       this->Quiet);
+  }
+
   if (!this->StopTimePassed && !this->CheckStopOnFailure()) {
     assert(this->Completed == this->Total);
     assert(this->Tests.empty());
@@ -170,6 +207,11 @@ bool cmCTestMultiProcessHandler::StartTestProcess(int test)
   // now remove the test itself
   this->EraseTest(test);
   this->RunningCount += this->GetProcessorsUsed(test);
+  if (this->TestMemory > 0) {
+    unsigned long const memory = this->GetMemoryUsed(test);
+    this->RunningTestMemory[test] = memory;
+    this->RunningMemory += memory;
+  }
 
   auto testRun = cm::make_unique<cmCTestRunTest>(*this);
 
@@ -282,18 +324,7 @@ bool cmCTestMultiProcessHandler::TryAllocateResources(
   std::map<std::string, std::vector<cmCTestBinPackerAllocation>>& allocations,
   std::map<std::string, ResourceAllocationError>* errors)
 {
-  allocations.clear();
-
-  std::size_t processIndex = 0;
-  for (auto const& process : this->Properties[index]->ResourceGroups) {
-    for (auto const& requirement : process) {
-      for (int i = 0; i < requirement.UnitsNeeded; ++i) {
-        allocations[requirement.ResourceType].push_back(
-          { processIndex, requirement.SlotsNeeded, "" });
-      }
-    }
-    ++processIndex;
-  }
+  this->GetResourcesNeeded(index, allocations);
 
   bool result = true;
   auto const& availableResources = this->ResourceAllocator.GetResources();
@@ -319,8 +350,34 @@ bool cmCTestMultiProcessHandler::TryAllocateResources(
   return result;
 }
 
+void cmCTestMultiProcessHandler::GetResourcesNeeded(
+  int index,
+  std::map<std::string, std::vector<cmCTestBinPackerAllocation>>& allocations)
+{
+  allocations.clear();
+
+  std::size_t processIndex = 0;
+  for (auto const& process : this->Properties[index]->ResourceGroups) {
+    for (auto const& requirement : process) {
+      for (int i = 0; i < requirement.UnitsNeeded; ++i) {
+        allocations[requirement.ResourceType].push_back(
+          { processIndex, requirement.SlotsNeeded, "" });
+      }
+    }
+    ++processIndex;
+  }
+}
+
 void cmCTestMultiProcessHandler::DeallocateResources(int index)
 {
+  if (this->CoordinatorGrants.erase(index)) {
+    if (this->CoordinatorStatus == CoordinatorState::Connected) {
+      this->Coordinator->Release(index);
+    }
+    this->AllocatedResources.erase(index);
+    return;
+  }
+
   if (!this->TestHandler->UseResourceSpec) {
     return;
   }
@@ -367,6 +424,154 @@ void cmCTestMultiProcessHandler::CheckResourcesAvailable()
   }
 }
 
+void cmCTestMultiProcessHandler::StartCoordinator()
+{
+  if (this->CoordinatorPath.empty()) {
+    return;
+  }
+
+  this->Coordinator =
+    cm::make_unique<cmCTestCoordinator>(this->Loop, this->CoordinatorPath);
+  this->Coordinator->ReadyCallback =
+    [this](cmCTestCoordinator::Resources const& resources) {
+      this->OnCoordinatorReady(resources);
+    };
+  this->Coordinator->GrantCallback =
+    [this](int index, cmCTestCoordinator::Allocations const& allocations) {
+      this->OnCoordinatorGrant(index, allocations);
+    };
+  this->Coordinator->LostCallback = [this](std::string const& reason) {
+    this->OnCoordinatorLost(reason);
+  };
+
+  std::string error;
+  if (!this->Coordinator->Start(this->ParallelLevel, this->ResourceAllocator,
+                                error)) {
+    cmCTestLog(this->CTest, WARNING,
+               "Cannot use the test coordinator: "
+                 << error << std::endl
+                 << "Scheduling tests for this process only." << std::endl);
+    this->Coordinator.reset();
+    return;
+  }
+  this->CoordinatorStatus = CoordinatorState::Connecting;
+}
+
+void cmCTestMultiProcessHandler::RequestFromCoordinator(int index)
+{
+  std::map<std::string, std::vector<cmCTestBinPackerAllocation>> allocations;
+  if (this->TestHandler->UseResourceSpec) {
+    this->GetResourcesNeeded(index, allocations);
+  }
+  this->CoordinatorRequest = index;
+  this->Coordinator->Acquire(index, this->GetProcessorsUsed(index),
+                             allocations);
+}
+
+void cmCTestMultiProcessHandler::OnCoordinatorReady(
+  cmCTestCoordinator::Resources const& resources)
+{
+  this->CoordinatorStatus = CoordinatorState::Connected;
+
+  // Tests are granted the resources of the process serving as the
+  // coordinator, so check them against those.
+  if (this->TestHandler->UseResourceSpec) {
+    cmCTestResourceSpec spec;
+    for (auto const& type : resources) {
+      auto& units = spec.LocalSocket.Resources[type.first];
+      for (auto const& unit : type.second) {
+        units.push_back({ unit.first, unit.second.Total });
+      }
+    }
+    this->ResourceAllocator.InitializeFromResourceSpec(spec);
+    this->ResourceAllocationErrors.clear();
+    this->CheckResourcesAvailable();
+  }
+
+  this->StartNextTests();
+  this->CheckCoordinatorDone();
+}
+
+void cmCTestMultiProcessHandler::OnCoordinatorGrant(
+  int index, cmCTestCoordinator::Allocations const& allocations)
+{
+  this->CoordinatorRequest = -1;
+  this->CoordinatorGrants.insert(index);
+  if (this->TestHandler->UseResourceSpec) {
+    auto& allocatedResources = this->AllocatedResources[index];
+    allocatedResources.resize(this->Properties[index]->ResourceGroups.size());
+    for (auto const& it : allocations) {
+      for (auto const& alloc : it.second) {
+        if (alloc.ProcessIndex < allocatedResources.size()) {
+          allocatedResources[alloc.ProcessIndex][it.first].push_back(
+            { alloc.Id, static_cast<unsigned int>(alloc.SlotsNeeded) });
+        }
+      }
+    }
+  }
+
+  // Give the grant back if testing stopped while waiting for it.
+  if (this->CheckStopTimePassed() ||
+      (this->CheckStopOnFailure() && !this->Failed->empty())) {
+    this->DeallocateResources(index);
+    this->CheckCoordinatorDone();
+    return;
+  }
+
+  if (!this->StartTestProcess(index) && !this->TestRunningMap[index] &&
+      !this->TestFinishMap[index]) {
+    // There are not enough processors to bind the test to.  Try again when
+    // another test finishes.
+    this->DeallocateResources(index);
+    return;
+  }
+  this->StartNextTests();
+  this->CheckCoordinatorDone();
+}
+
+void cmCTestMultiProcessHandler::OnCoordinatorLost(std::string const& reason)
+{
+  cmCTestLog(this->CTest, WARNING,
+             "Lost the test coordinator: "
+               << reason << std::endl
+               << "Scheduling the remaining tests for this process only."
+               << std::endl);
+  this->CoordinatorStatus = CoordinatorState::Closed;
+  this->CoordinatorRequest = -1;
+  this->StartNextTests();
+}
+
+void cmCTestMultiProcessHandler::CheckCoordinatorDone()
+{
+  if (this->CoordinatorStatus == CoordinatorState::None ||
+      this->CoordinatorStatus == CoordinatorState::Closed) {
+    return;
+  }
+  if (this->RunningCount > 0 || !this->CoordinatorGrants.empty() ||
+      this->CoordinatorRequest >= 0) {
+    return;
+  }
+  if (this->CoordinatorStatus == CoordinatorState::Connecting &&
+      !this->Tests.empty()) {
+    return;
+  }
+  if (this->TestLoadRetryTimer.get() != nullptr &&
+      uv_is_active(this->TestLoadRetryTimer)) {
+    return;
+  }
+
+  this->CoordinatorStatus = CoordinatorState::Closed;
+  bool const servingOthers = this->Coordinator->IsServingOthers();
+  this->Coordinator->Finish();
+  if (servingOthers) {
+    cmCTestOptionalLog(this->CTest, HANDLER_OUTPUT,
+                       "Waiting for the other ctest processes using the "
+                       "test coordinator to finish"
+                         << std::endl,
+                       this->Quiet);
+  }
+}
+
 bool cmCTestMultiProcessHandler::CheckStopOnFailure()
 {
   return this->CTest->GetStopOnFailure();
@@ -440,6 +645,25 @@ inline size_t cmCTestMultiProcessHandler::GetProcessorsUsed(int test)
   return processors;
 }
 
+unsigned long cmCTestMultiProcessHandler::GetMemoryUsed(int test)
+{
+  return this->Properties[test]->PeakMemory;
+}
+
+unsigned long cmCTestMultiProcessHandler::GetAvailableMemory()
+{
+  if (this->FakeMemoryForTesting > 0) {
+    return this->FakeMemoryForTesting;
+  }
+  cmsys::SystemInformation info;
+  long long const total = info.GetHostMemoryTotal();
+  long long const used = info.GetHostMemoryUsed();
+  if (total <= 0 || used < 0 || used >= total) {
+    return 0;
+  }
+  return static_cast<unsigned long>(total - used);
+}
+
 std::string cmCTestMultiProcessHandler::GetName(int test)
 {
   return this->Properties[test]->Name;
@@ -454,6 +678,16 @@ bool cmCTestMultiProcessHandler::StartTest(int test)
     }
   }
 
+  // With a coordinator, ask for the slots and resources of a test once it
+  // may run, and start it when they are granted.
+  if (this->CoordinatorStatus == CoordinatorState::Connected &&
+      this->ResourceAllocationErrors[test].empty()) {
+    if (this->Tests[test].empty()) {
+      this->RequestFromCoordinator(test);
+    }
+    return false;
+  }
+
   // Allocate resources
   if (this->ResourceAllocationErrors[test].empty() &&
       !this->AllocateResources(test)) {
@@ -492,6 +726,13 @@ void cmCTestMultiProcessHandler::StartNextTests()
     return;
   }
 
+  // Wait for the coordinator to be connected, and for it to grant the
+  // test requested before asking for another.
+  if (this->CoordinatorStatus == CoordinatorState::Connecting ||
+      this->CoordinatorRequest >= 0) {
+    return;
+  }
+
   size_t numToStart = 0;
 
   if (this->RunningCount < this->ParallelLevel) {
@@ -540,12 +781,25 @@ void cmCTestMultiProcessHandler::StartNextTests()
     }
   }
 
+  // Memory not used by any process on the machine right now.  The tests
+  // running may still grow to their peak, so it is only checked in
+  // addition to the memory limit.
+  unsigned long availableMemory = 0;
+  if (this->TestMemory > 0) {
+    availableMemory = this->GetAvailableMemory();
+  }
+  bool const haveAvailableMemory = availableMemory > 0;
+
   TestList copy = this->SortedTests;
   for (auto const& test : copy) {
     // Take a nap if we're currently performing a RUN_SERIAL test.
     if (this->SerialTestRunning) {
       break;
     }
+    // Only one test at a time waits for the coordinator.
+    if (this->CoordinatorRequest >= 0) {
+      break;
+    }
     // We can only start a RUN_SERIAL test if no other tests are also
     // running.
     if (this->Properties[test]->RunSerial && this->RunningCount > 0) {
@@ -571,8 +825,31 @@ void cmCTestMultiProcessHandler::StartNextTests()
       testWithMinProcessors = this->GetName(test);
     }
 
-    if (testLoadOk && processors <= numToStart && this->StartTest(test)) {
+    // Start a test only if the memory it used last time fits next to the
+    // tests running.  A test may always start alone, so that tests using
+    // more than the limit still run, one at a time.  Tests held back here
+    // are tried again when a test finishes.
+    bool testMemoryOk = true;
+    if (this->TestMemory > 0 && this->RunningCount > 0) {
+      unsigned long const memory = this->GetMemoryUsed(test);
+      if (this->RunningMemory + memory > this->TestMemory ||
+          (haveAvailableMemory && memory > availableMemory)) {
+        cmCTestLog(this->CTest, DEBUG,
+                   "Not enough memory to run "
+                     << this->GetName(test) << ", it used " << memory / 1024
+                     << " MiB, tests running use "
+                     << this->RunningMemory / 1024
+                     << " MiB & available memory is "
+                     << availableMemory / 1024 << " MiB" << std::endl);
+        testMemoryOk = false;
+      }
+    }
+
+    if (testLoadOk && testMemoryOk && processors <= numToStart &&
+        this->StartTest(test)) {
       numToStart -= processors;
+      unsigned long const memory = this->GetMemoryUsed(test);
+      availableMemory -= std::min(availableMemory, memory);
     } else if (numToStart == 0) {
       break;
     }
@@ -623,6 +900,7 @@ void cmCTestMultiProcessHandler::OnTestLoadRetryCB(uv_timer_t* timer)
 {
   auto* self = static_cast<cmCTestMultiProcessHandler*>(timer->data);
   self->StartNextTests();
+  self->CheckCoordinatorDone();
 }
 
 void cmCTestMultiProcessHandler::FinishTestProcess(
@@ -651,8 +929,16 @@ void cmCTestMultiProcessHandler::FinishTestProcess(
     this->Failed->push_back(properties->Name);
   }
 
-  for (auto& t : this->Tests) {
-    t.second.erase(test);
+  // Only the tests depending on this one can be waiting for it.
+  cmCTestDependencyGraph::Node node;
+  if (this->Graph.FindNode(test, node)) {
+    for (cmCTestDependencyGraph::Node dependent :
+         this->Graph.GetDependents(node)) {
+      auto it = this->Tests.find(this->Graph.GetTest(dependent));
+      if (it != this->Tests.end()) {
+        it->second.erase(test);
+      }
+    }
   }
 
   this->TestFinishMap[test] = true;
@@ -661,6 +947,11 @@ void cmCTestMultiProcessHandler::FinishTestProcess(
   this->DeallocateResources(test);
   this->UnlockResources(test);
   this->RunningCount -= this->GetProcessorsUsed(test);
+  auto memory = this->RunningTestMemory.find(test);
+  if (memory != this->RunningTestMemory.end()) {
+    this->RunningMemory -= memory->second;
+    this->RunningTestMemory.erase(memory);
+  }
 
   for (auto p : properties->Affinity) {
     this->ProcessorsAvailable.insert(p);
@@ -670,6 +961,7 @@ void cmCTestMultiProcessHandler::FinishTestProcess(
   runner.reset();
   if (started) {
     this->StartNextTests();
+    this->CheckCoordinatorDone();
   }
 }
 
@@ -682,6 +974,15 @@ void cmCTestMultiProcessHandler::UpdateCostData()
 
   PropertiesMap temp = this->Properties;
 
+  // Format: <name> <previous_runs> <avg_cost> <peak_memory> <resource_runs>
+  //         <avg_cpu_time> <avg_peak_memory> <avg_block_operations>
+  auto writeEntry = [&fout](cmCTestTestHandler::cmCTestTestProperties& p) {
+    fout << p.Name << " " << p.PreviousRuns << " " << p.Cost << " "
+         << p.PeakMemory << " " << p.ResourceRuns << " " << p.AverageCpuTime
+         << " " << p.AveragePeakMemory << " " << p.AverageBlockOperations
+         << "\n";
+  };
+
   if (cmSystemTools::FileExists(fname)) {
     cmsys::ifstream fin;
     fin.open(fname.c_str());
@@ -692,23 +993,17 @@ void cmCTestMultiProcessHandler::UpdateCostData()
         break;
       }
       std::vector<std::string> parts = cmSystemTools::SplitString(line, ' ');
-      // Format: <name> <previous_runs> <avg_cost>
       if (parts.size() < 3) {
         break;
       }
 
-      std::string name = parts[0];
-      int prev = atoi(parts[1].c_str());
-      float cost = static_cast<float>(atof(parts[2].c_str()));
-
-      int index = this->SearchByName(name);
+      int index = this->SearchByName(parts[0]);
       if (index == -1) {
         // This test is not in memory. We just rewrite the entry
-        fout << name << " " << prev << " " << cost << "\n";
+        fout << line << "\n";
       } else {
-        // Update with our new average cost
-        fout << name << " " << this->Properties[index]->PreviousRuns << " "
-             << this->Properties[index]->Cost << "\n";
+        // Update with our new averages
+        writeEntry(*this->Properties[index]);
         temp.erase(index);
       }
     }
@@ -718,8 +1013,7 @@ void cmCTestMultiProcessHandler::UpdateCostData()
 
   // Add all tests not previously listed in the file
   for (auto const& i : temp) {
-    fout << i.second->Name << " " << i.second->PreviousRuns << " "
-         << i.second->Cost << "\n";
+    writeEntry(*i.second);
   }
 
   // Write list of failed tests
@@ -762,6 +1056,16 @@ void cmCTestMultiProcessHandler::ReadCostData()
       }
 
       this->Properties[index]->PreviousRuns = prev;
+      cmCTestTestHandler::cmCTestTestProperties& p = *this->Properties[index];
+      if (parts.size() > 3) {
+        cmStrToULong(parts[3], &p.PeakMemory);
+      }
+      if (parts.size() > 7) {
+        p.ResourceRuns = atoi(parts[4].c_str());
+        p.AverageCpuTime = static_cast<float>(atof(parts[5].c_str()));
+        p.AveragePeakMemory = static_cast<float>(atof(parts[6].c_str()));
+        p.AverageBlockOperations = static_cast<float>(atof(parts[7].c_str()));
+      }
       // When not running in parallel mode, don't use cost data
       if (this->ParallelLevel > 1 && this->Properties[index] &&
           this->Properties[index]->Cost == 0) {
@@ -771,7 +1075,7 @@ void cmCTestMultiProcessHandler::ReadCostData()
     // Next part of the file is the failed tests
     while (std::getline(fin, line)) {
       if (!line.empty()) {
-        this->LastTestsFailed.push_back(line);
+        this->LastTestsFailed.insert(line);
       }
     }
     fin.close();
@@ -780,20 +1084,21 @@ void cmCTestMultiProcessHandler::ReadCostData()
 
 int cmCTestMultiProcessHandler::SearchByName(std::string const& name)
 {
-  int index = -1;
-
-  for (auto const& p : this->Properties) {
-    if (p.second->Name == name) {
-      index = p.first;
-    }
+  auto it = this->TestsByName.find(name);
+  if (it == this->TestsByName.end() || !this->Properties.count(it->second)) {
+    return -1;
   }
-  return index;
+  return it->second;
 }
 
 void cmCTestMultiProcessHandler::CreateTestCostList()
 {
   if (this->ParallelLevel > 1) {
-    this->CreateParallelTestCostList();
+    if (this->CTest->GetScheduleType() == "CriticalPath") {
+      this->CreateCriticalPathTestCostList();
+    } else {
+      this->CreateParallelTestCostList();
+    }
   } else {
     this->CreateSerialTestCostList();
   }
@@ -801,70 +1106,138 @@ void cmCTestMultiProcessHandler::CreateTestCostList()
 
 void cmCTestMultiProcessHandler::CreateParallelTestCostList()
 {
-  TestSet alreadySortedTests;
-
-  std::list<TestSet> priorityStack;
-  priorityStack.emplace_back();
-  TestSet& topLevel = priorityStack.back();
+  using Node = cmCTestDependencyGraph::Node;
+  std::size_t const count = this->Graph.GetNodeCount();
+  std::vector<bool> alreadySorted(count);
 
   // In parallel test runs add previously failed tests to the front
   // of the cost list and queue other tests for further sorting
-  for (auto const& t : this->Tests) {
-    if (cm::contains(this->LastTestsFailed, this->Properties[t.first]->Name)) {
+  std::vector<long> level(count, -1);
+  for (Node node = 0; node < count; ++node) {
+    int const test = this->Graph.GetTest(node);
+    if (cm::contains(this->LastTestsFailed, this->Properties[test]->Name)) {
       // If the test failed last time, it should be run first.
-      this->SortedTests.push_back(t.first);
-      alreadySortedTests.insert(t.first);
+      this->SortedTests.push_back(test);
+      alreadySorted[node] = true;
     } else {
-      topLevel.insert(t.first);
+      level[node] = 0;
     }
   }
 
-  // In parallel test runs repeatedly move dependencies of the tests on
-  // the current dependency level to the next level until no
-  // further dependencies exist.
-  while (!priorityStack.back().empty()) {
-    TestSet& previousSet = priorityStack.back();
-    priorityStack.emplace_back();
-    TestSet& currentSet = priorityStack.back();
-
-    for (auto const& i : previousSet) {
-      TestSet const& dependencies = this->Tests[i];
-      currentSet.insert(dependencies.begin(), dependencies.end());
+  // The dependency level of a test is the length of the longest chain of
+  // tests depending on it, starting from a test queued above.  Visit each
+  // test after all of its dependents so that its level is known.
+  long deepest = -1;
+  for (Node node : this->Graph.GetDependentsFirstOrder()) {
+    if (level[node] < 0) {
+      continue;
     }
-
-    for (auto const& i : currentSet) {
-      previousSet.erase(i);
+    deepest = std::max(deepest, level[node]);
+    for (Node dependency : this->Graph.GetDependencies(node)) {
+      level[dependency] = std::max(level[dependency], level[node] + 1);
     }
   }
 
-  // Remove the empty dependency level
-  priorityStack.pop_back();
-
-  // Reverse iterate over the different dependency levels (deepest first).
+  // Iterate over the different dependency levels (deepest first).
   // Sort tests within each level by COST and append them to the cost list.
-  for (TestSet const& currentSet : cmReverseRange(priorityStack)) {
-    TestList sortedCopy;
-    cm::append(sortedCopy, currentSet);
-    std::stable_sort(sortedCopy.begin(), sortedCopy.end(),
-                     TestComparator(this));
-
-    for (auto const& j : sortedCopy) {
-      if (!cm::contains(alreadySortedTests, j)) {
-        this->SortedTests.push_back(j);
-        alreadySortedTests.insert(j);
-      }
+  std::vector<TestList> levels(static_cast<std::size_t>(deepest + 1));
+  for (Node node = 0; node < count; ++node) {
+    if (level[node] >= 0 && !alreadySorted[node]) {
+      levels[static_cast<std::size_t>(level[node])].push_back(
+        this->Graph.GetTest(node));
+    }
+  }
+  for (auto it = levels.rbegin(); it != levels.rend(); ++it) {
+    std::stable_sort(it->begin(), it->end(), TestComparator(this));
+    cm::append(this->SortedTests, *it);
+  }
+}
+
+size_t cmCTestMultiProcessHandler::GetResourceDemand(int index)
+{
+  size_t demand = this->GetProcessorsUsed(index);
+  for (auto const& group : this->Properties[index]->ResourceGroups) {
+    for (auto const& requirement : group) {
+      demand += static_cast<size_t>(requirement.SlotsNeeded) *
+        static_cast<size_t>(requirement.UnitsNeeded);
     }
   }
+  return demand;
 }
 
-void cmCTestMultiProcessHandler::GetAllTestDependencies(int test,
-                                                        TestList& dependencies)
+void cmCTestMultiProcessHandler::CreateCriticalPathTestCostList()
 {
-  TestSet const& dependencySet = this->Tests[test];
-  for (int i : dependencySet) {
-    this->GetAllTestDependencies(i, dependencies);
-    dependencies.push_back(i);
+  using Node = cmCTestDependencyGraph::Node;
+  std::size_t const count = this->Graph.GetNodeCount();
+
+  // Tests without cost data are assumed to take as long as the average
+  // test with cost data.
+  double knownCost = 0;
+  size_t knownCount = 0;
+  for (auto const& t : this->Tests) {
+    if (this->Properties[t.first]->Cost > 0) {
+      knownCost += this->Properties[t.first]->Cost;
+      ++knownCount;
+    }
   }
+  double const defaultCost =
+    knownCount > 0 ? knownCost / static_cast<double>(knownCount) : 1.0;
+
+  std::vector<double> cost(count);
+  double totalWork = 0;
+  for (Node node = 0; node < count; ++node) {
+    int const test = this->Graph.GetTest(node);
+    cost[node] = this->Properties[test]->Cost > 0
+      ? this->Properties[test]->Cost
+      : defaultCost;
+    totalWork +=
+      cost[node] * static_cast<double>(this->GetProcessorsUsed(test));
+  }
+
+  // The downstream path of a test is its own cost plus the longest
+  // downstream path of the tests depending on it.  Visit each test after
+  // all of its dependents; CheckCycles guarantees that this reaches all.
+  std::vector<double> path(count);
+  double longestPath = 0;
+  for (Node node : this->Graph.GetDependentsFirstOrder()) {
+    double longestDependent = 0;
+    for (Node dependent : this->Graph.GetDependents(node)) {
+      longestDependent = std::max(longestDependent, path[dependent]);
+    }
+    path[node] = cost[node] + longestDependent;
+    longestPath = std::max(longestPath, path[node]);
+  }
+
+  // Start the longest chains first.  Among chains of equal length, start
+  // the tests needing the most processors and resources while they still
+  // fit, then the tests that failed last time.
+  std::vector<size_t> demand(count);
+  std::vector<bool> failed(count);
+  std::vector<Node> order(count);
+  for (Node node = 0; node < count; ++node) {
+    int const test = this->Graph.GetTest(node);
+    demand[node] = this->GetResourceDemand(test);
+    failed[node] =
+      cm::contains(this->LastTestsFailed, this->Properties[test]->Name);
+    order[node] = node;
+  }
+  std::stable_sort(order.begin(), order.end(), [&](Node a, Node b) {
+    if (path[a] != path[b]) {
+      return path[a] > path[b];
+    }
+    if (demand[a] != demand[b]) {
+      return demand[a] > demand[b];
+    }
+    return failed[a] && !failed[b];
+  });
+  for (Node node : order) {
+    this->SortedTests.push_back(this->Graph.GetTest(node));
+  }
+
+  // No schedule can finish before the longest chain does or before the
+  // total work is spread over all processors.
+  this->PredictedMakespan = std::max(
+    longestPath, totalWork / static_cast<double>(this->ParallelLevel));
 }
 
 void cmCTestMultiProcessHandler::CreateSerialTestCostList()
@@ -878,25 +1251,35 @@ void cmCTestMultiProcessHandler::CreateSerialTestCostList()
   std::stable_sort(presortedList.begin(), presortedList.end(),
                    TestComparator(this));
 
-  TestSet alreadySortedTests;
+  // Add each test after all of its dependencies, visiting them depth
+  // first in order of their test numbers.
+  using Node = cmCTestDependencyGraph::Node;
+  using NodeIterator = cmCTestDependencyGraph::NodeRange::const_iterator;
+  std::vector<bool> alreadySorted(this->Graph.GetNodeCount());
+  std::vector<std::pair<Node, NodeIterator>> stack;
+  auto visit = [&](Node node) {
+    stack.emplace_back(node, this->Graph.GetDependencies(node).begin());
+  };
 
   for (int test : presortedList) {
-    if (cm::contains(alreadySortedTests, test)) {
+    Node root;
+    if (!this->Graph.FindNode(test, root) || alreadySorted[root]) {
       continue;
     }
-
-    TestList dependencies;
-    this->GetAllTestDependencies(test, dependencies);
-
-    for (int testDependency : dependencies) {
-      if (!cm::contains(alreadySortedTests, testDependency)) {
-        alreadySortedTests.insert(testDependency);
-        this->SortedTests.push_back(testDependency);
+    visit(root);
+    while (!stack.empty()) {
+      Node const node = stack.back().first;
+      if (stack.back().second != this->Graph.GetDependencies(node).end()) {
+        Node const dependency = *stack.back().second++;
+        if (!alreadySorted[dependency]) {
+          visit(dependency);
+        }
+        continue;
       }
+      stack.pop_back();
+      alreadySorted[node] = true;
+      this->SortedTests.push_back(this->Graph.GetTest(node));
     }
-
-    alreadySortedTests.insert(test);
-    this->SortedTests.push_back(test);
   }
 }
 
@@ -1412,31 +1795,14 @@ bool cmCTestMultiProcessHandler::CheckCycles()
   cmCTestOptionalLog(this->CTest, HANDLER_VERBOSE_OUTPUT,
                      "Checking test dependency graph..." << std::endl,
                      this->Quiet);
-  for (auto const& it : this->Tests) {
-    // DFS from each element to itself
-    int root = it.first;
-    std::set<int> visited;
-    std::stack<int> s;
-    s.push(root);
-    while (!s.empty()) {
-      int test = s.top();
-      s.pop();
-      if (visited.insert(test).second) {
-        for (auto const& d : this->Tests[test]) {
-          if (d == root) {
-            // cycle exists
-            cmCTestLog(
-              this->CTest, ERROR_MESSAGE,
-              "Error: a cycle exists in the test dependency graph "
-              "for the test \""
-                << this->Properties[root]->Name
-                << "\".\nPlease fix the cycle and run ctest again.\n");
-            return false;
-          }
-          s.push(d);
-        }
-      }
-    }
+  int test;
+  if (this->Graph.FindCycle(test)) {
+    cmCTestLog(this->CTest, ERROR_MESSAGE,
+               "Error: a cycle exists in the test dependency graph "
+               "for the test \""
+                 << this->Properties[test]->Name
+                 << "\".\nPlease fix the cycle and run ctest again.\n");
+    return false;
   }
   cmCTestOptionalLog(this->CTest, HANDLER_VERBOSE_OUTPUT,
                      "Checking test dependency graph end" << std::endl,
@@ -9,16 +9,19 @@
 #include <memory>
 #include <set>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include <cm3p/uv.h>
 
 #include "cmCTest.h"
+#include "cmCTestDependencyGraph.h"
 #include "cmCTestResourceAllocator.h"
 #include "cmCTestTestHandler.h"
 #include "cmUVHandlePtr.h"
 
 struct cmCTestBinPackerAllocation;
+class cmCTestCoordinator;
 class cmCTestResourceSpec;
 class cmCTestRunTest;
 
@@ -59,6 +62,8 @@ public:
   // Set the max number of tests that can be run at the same time.
   void SetParallelLevel(size_t);
   void SetTestLoad(unsigned long load);
+  // Set the memory in MiB that the tests run at the same time may use.
+  void SetTestMemory(unsigned long memory);
   virtual void RunTests();
   void PrintOutputAsJson();
   void PrintTestList();
@@ -99,6 +104,13 @@ public:
 
   void CheckResourcesAvailable();
 
+  // Share job slots and resources with the ctest processes using the
+  // coordinator at the given socket path.
+  void SetCoordinator(std::string const& path)
+  {
+    this->CoordinatorPath = path;
+  }
+
 protected:
   // Start the next test or tests as many as are allowed by
   // ParallelLevel
@@ -115,11 +127,14 @@ protected:
 
   void CreateTestCostList();
 
-  void GetAllTestDependencies(int test, TestList& dependencies);
   void CreateSerialTestCostList();
 
   void CreateParallelTestCostList();
 
+  // Order tests by the longest chain of dependent tests they start
+  void CreateCriticalPathTestCostList();
+  size_t GetResourceDemand(int index);
+
   // Removes the checkpoint file
   void MarkFinished();
   void EraseTest(int index);
@@ -134,6 +149,9 @@ protected:
   bool CheckCycles();
   int FindMaxIndex();
   inline size_t GetProcessorsUsed(int index);
+  // Memory in KiB a test used in its last run, or 0 if unknown
+  unsigned long GetMemoryUsed(int index);
+  unsigned long GetAvailableMemory();
   std::string GetName(int index);
 
   bool CheckStopOnFailure();
@@ -151,6 +169,10 @@ protected:
   };
 
   bool AllocateResources(int index);
+  void GetResourcesNeeded(
+    int index,
+    std::map<std::string, std::vector<cmCTestBinPackerAllocation>>&
+      allocations);
   bool TryAllocateResources(
     int index,
     std::map<std::string, std::vector<cmCTestBinPackerAllocation>>&
@@ -159,8 +181,26 @@ protected:
   void DeallocateResources(int index);
   bool AllResourcesAvailable();
 
+  void StartCoordinator();
+  void RequestFromCoordinator(int index);
+  void OnCoordinatorReady(
+    std::map<std::string,
+             std::map<std::string, cmCTestResourceAllocator::Resource>> const&
+      resources);
+  void OnCoordinatorGrant(
+    int index,
+    std::map<std::string, std::vector<cmCTestBinPackerAllocation>> const&
+      allocations);
+  void OnCoordinatorLost(std::string const& reason);
+  // Disconnect from the coordinator once no more tests can start
+  void CheckCoordinatorDone();
+
   // map from test number to set of depend tests
   TestMap Tests;
+  // dependencies between the tests as given to SetTests
+  cmCTestDependencyGraph Graph;
+  // last test with each name
+  std::unordered_map<std::string, int> TestsByName;
   TestList SortedTests;
   // Total number of tests we'll be running
   size_t Total;
@@ -177,7 +217,7 @@ protected:
   std::map<int, std::string> TestOutput;
   std::vector<std::string>* Passed;
   std::vector<std::string>* Failed;
-  std::vector<std::string> LastTestsFailed;
+  std::set<std::string> LastTestsFailed;
   std::set<std::string> LockedResources;
   std::map<int,
            std::vector<std::map<std::string, std::vector<ResourceAllocation>>>>
@@ -189,6 +229,11 @@ protected:
   size_t ParallelLevel; // max number of process that can be run at once
   unsigned long TestLoad;
   unsigned long FakeLoadForTesting;
+  // Memory limit and memory used by the tests running, in KiB
+  unsigned long TestMemory = 0;
+  unsigned long FakeMemoryForTesting = 0;
+  unsigned long RunningMemory = 0;
+  std::map<int, unsigned long> RunningTestMemory;
   uv_loop_t Loop;
   cm::uv_timer_ptr TestLoadRetryTimer;
   cmCTestTestHandler* TestHandler;
@@ -198,4 +243,20 @@ protected:
   int RepeatCount = 1;
   bool Quiet;
   bool SerialTestRunning;
+  // Makespan in seconds predicted by the critical path schedule
+  double PredictedMakespan = 0;
+  std::string CoordinatorPath;
+  std::unique_ptr<cmCTestCoordinator> Coordinator;
+  enum class CoordinatorState
+  {
+    None,
+    Connecting,
+    Connected,
+    Closed,
+  };
+  CoordinatorState CoordinatorStatus = CoordinatorState::None;
+  // Test waiting to be granted its slots and resources, or -1
+  int CoordinatorRequest = -1;
+  // Tests holding slots and resources granted by the coordinator
+  std::set<int> CoordinatorGrants;
 };
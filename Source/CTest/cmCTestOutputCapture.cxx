@@ -0,0 +1,148 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file Copyright.txt or https://cmake.org/licensing for details.  */
+#include "cmCTestOutputCapture.h"
+
+#include <algorithm>
+
+#include <cm3p/zlib.h>
+
+#include "cmStringAlgorithms.h"
+#include "cmSystemTools.h"
+
+cmCTestOutputCapture::cmCTestOutputCapture(std::size_t limit)
+  : Limit(limit)
+{
+}
+
+cmCTestOutputCapture::~cmCTestOutputCapture()
+{
+  this->Finish();
+  if (this->Dropped) {
+    std::fclose(this->Dropped);
+  }
+}
+
+bool cmCTestOutputCapture::OpenSpool(std::string const& file)
+{
+  this->Finish();
+  cmSystemTools::MakeDirectory(cmSystemTools::GetFilenamePath(file));
+  gzFile spool = gzopen(file.c_str(), "wb");
+  if (!spool) {
+    return false;
+  }
+  this->Spool = spool;
+  return true;
+}
+
+void cmCTestOutputCapture::Append(std::string const& text)
+{
+  this->AppendToSpool(text);
+  this->Retain(text);
+}
+
+void cmCTestOutputCapture::AppendToSpool(std::string const& text)
+{
+  if (this->Spool && !text.empty()) {
+    gzwrite(static_cast<gzFile>(this->Spool), text.data(),
+            static_cast<unsigned int>(text.size()));
+  }
+}
+
+void cmCTestOutputCapture::Retain(std::string const& text)
+{
+  this->Total += text.size();
+  if (this->Limit == 0) {
+    this->Head += text;
+    return;
+  }
+
+  char const* data = text.data();
+  std::size_t size = text.size();
+  std::size_t n = std::min(size, this->Limit - this->Head.size());
+  this->Head.append(data, n);
+  data += n;
+  size -= n;
+
+  // Only the last Limit bytes of a large chunk can survive.
+  if (size >= this->Limit) {
+    this->Drop(this->Tail.data() + this->TailStart,
+               this->Tail.size() - this->TailStart);
+    this->Drop(this->Tail.data(), this->TailStart);
+    this->Drop(data, size - this->Limit);
+    this->Tail.assign(data + size - this->Limit, this->Limit);
+    this->TailStart = 0;
+    return;
+  }
+
+  while (size > 0) {
+    if (this->Tail.size() < this->Limit) {
+      n = std::min(size, this->Limit - this->Tail.size());
+      this->Tail.append(data, n);
+    } else {
+      n = std::min(size, this->Limit - this->TailStart);
+      this->Drop(this->Tail.data() + this->TailStart, n);
+      this->Tail.replace(this->TailStart, n, data, n);
+      this->TailStart = (this->TailStart + n) % this->Limit;
+    }
+    data += n;
+    size -= n;
+  }
+}
+
+void cmCTestOutputCapture::Finish()
+{
+  if (this->Spool) {
+    gzclose(static_cast<gzFile>(this->Spool));
+    this->Spool = nullptr;
+  }
+}
+
+void cmCTestOutputCapture::Drop(char const* data, std::size_t size)
+{
+  if (size == 0 || this->DroppedFailed) {
+    return;
+  }
+  if (!this->Dropped) {
+    this->Dropped = std::tmpfile();
+  }
+  if (!this->Dropped ||
+      std::fwrite(data, 1, size, this->Dropped) != size) {
+    this->DroppedFailed = true;
+  }
+}
+
+std::string cmCTestOutputCapture::GetWhole() const
+{
+  std::size_t const kept = this->Head.size() + this->Tail.size();
+  if (this->Total == kept) {
+    return this->GetRetained();
+  }
+  if (this->DroppedFailed || !this->Dropped ||
+      std::fflush(this->Dropped) != 0 ||
+      std::fseek(this->Dropped, 0, SEEK_SET) != 0) {
+    return this->GetRetained();
+  }
+  std::string output = this->Head;
+  output.resize(this->Total - this->Tail.size());
+  std::size_t const dropped = output.size() - this->Head.size();
+  if (std::fread(&output[this->Head.size()], 1, dropped, this->Dropped) !=
+      dropped) {
+    return this->GetRetained();
+  }
+  output.append(this->Tail, this->TailStart, std::string::npos);
+  output.append(this->Tail, 0, this->TailStart);
+  return output;
+}
+
+std::string cmCTestOutputCapture::GetRetained() const
+{
+  std::string output = this->Head;
+  std::size_t const kept = this->Head.size() + this->Tail.size();
+  if (this->Total > kept) {
+    output += cmStrCat("\n[", this->Total - kept,
+                       " bytes of the test output were not retained.]\n");
+  }
+  output.append(this->Tail, this->TailStart, std::string::npos);
+  output.append(this->Tail, 0, this->TailStart);
+  return output;
+}
@@ -0,0 +1,70 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file Copyright.txt or https://cmake.org/licensing for details.  */
+#pragma once
+
+#include "cmConfigure.h" // IWYU pragma: keep
+
+#include <cstddef>
+#include <cstdio>
+#include <string>
+
+/** \class cmCTestOutputCapture
+ * \brief Bounded capture of the output of a test.
+ *
+ * Keeps the first and the last Limit bytes of the output in memory.  The
+ * bytes dropped in between are moved to a temporary file so that the
+ * whole output can still be recovered when the test asks for it with
+ * CTEST_FULL_OUTPUT.  The whole output may also be written to a gzip
+ * compressed spool file as it arrives.
+ */
+class cmCTestOutputCapture
+{
+public:
+  /** A Limit of 0 keeps the whole output.  */
+  explicit cmCTestOutputCapture(std::size_t limit);
+  ~cmCTestOutputCapture();
+
+  cmCTestOutputCapture(cmCTestOutputCapture const&) = delete;
+  cmCTestOutputCapture& operator=(cmCTestOutputCapture const&) = delete;
+
+  /** Write the whole output to the given file.  Return false on error.  */
+  bool OpenSpool(std::string const& file);
+
+  /** Write text to the spool file and retain it.  */
+  void Append(std::string const& text);
+
+  /** Write text to the spool file only.  */
+  void AppendToSpool(std::string const& text);
+
+  /** Retain text without writing it to the spool file.  */
+  void Retain(std::string const& text);
+
+  /** Flush and close the spool file.  */
+  void Finish();
+
+  /** Return the retained output with a note in place of dropped bytes.  */
+  std::string GetRetained() const;
+
+  /**
+   * Return the whole retained output, reading back the dropped bytes.
+   * Fall back to GetRetained if they could not be kept.
+   */
+  std::string GetWhole() const;
+
+  std::size_t GetTotalSize() const { return this->Total; }
+
+private:
+  std::size_t Limit;
+  std::size_t Total = 0;
+  std::string Head;
+  // Ring buffer holding the last bytes, oldest at TailStart once full.
+  std::string Tail;
+  std::size_t TailStart = 0;
+  void* Spool = nullptr;
+  // Bytes dropped from the tail, in order, or null if none were dropped
+  // or they could not be written.
+  std::FILE* Dropped = nullptr;
+  bool DroppedFailed = false;
+
+  void Drop(char const* data, std::size_t size);
+};
@@ -17,8 +17,11 @@
 #include <cm/memory>
 #include <cm/optional>
 #include <cm/string_view>
+#include <cmext/algorithm>
 #include <cmext/string_view>
 
+#include <cm3p/uv.h>
+
 #include "cmsys/RegularExpression.hxx"
 
 #include "cmCTest.h"
@@ -77,13 +80,20 @@ void cmCTestRunTest::CheckOutput(std::string const& line)
     }
   }
 
-  this->ProcessOutput += line;
-  this->ProcessOutput += "\n";
+  if (this->OutputCapture) {
+    this->CheckOutputStreaming(line);
+  } else {
+    this->ProcessOutput += line;
+    this->ProcessOutput += "\n";
+  }
 
-  // Check for TIMEOUT_AFTER_MATCH property.
+  // Check for TIMEOUT_AFTER_MATCH property.  Streamed output is matched
+  // one line at a time.
+  std::string const& output =
+    this->OutputCapture ? line : this->ProcessOutput;
   if (!this->TestProperties->TimeoutRegularExpressions.empty()) {
     for (auto& reg : this->TestProperties->TimeoutRegularExpressions) {
-      if (reg.first.find(this->ProcessOutput)) {
+      if (reg.first.find(output)) {
         cmCTestLog(this->CTest, HANDLER_VERBOSE_OUTPUT,
                    this->GetIndex()
                      << ": "
@@ -102,8 +112,114 @@ void cmCTestRunTest::CheckOutput(std::string const& line)
   }
 }
 
+void cmCTestRunTest::StartOutputCapture()
+{
+  this->OutputCapture.reset();
+  this->MatchedExpressions.clear();
+  this->MeasurementOutput.clear();
+  this->MeasurementStart = 0;
+  this->InMeasurement = false;
+  this->FullOutputRequested = false;
+  // MemCheck parses the whole output.
+  if (!this->TestHandler->TestOutputStreaming || this->TestHandler->MemCheck) {
+    return;
+  }
+
+  // Keep enough of the head and tail to truncate the output as if it had
+  // been kept whole.
+  int const passed = this->TestHandler->CustomMaximumPassedTestOutputSize;
+  int const failed = this->TestHandler->CustomMaximumFailedTestOutputSize;
+  size_t const limit = passed > 0 && failed > 0
+    ? static_cast<size_t>(std::max(passed, failed))
+    : 0;
+  this->OutputCapture = cm::make_unique<cmCTestOutputCapture>(limit);
+
+  if (this->TestHandler->TestOutputSpool) {
+    std::string const spool =
+      cmStrCat(this->CTest->GetBinaryDir(), "/Testing/Temporary/TestOutput/",
+               this->TestProperties->Index, ".log.gz");
+    if (!this->OutputCapture->OpenSpool(spool)) {
+      cmCTestLog(this->CTest, WARNING,
+                 "Cannot write test output to " << spool << std::endl);
+    }
+  }
+}
+
+void cmCTestRunTest::CheckOutputStreaming(std::string const& line)
+{
+  auto matchLine = [this, &line](
+                     std::vector<std::pair<cmsys::RegularExpression,
+                                           std::string>>& regexes) {
+    for (auto& regex : regexes) {
+      if (!cm::contains(this->MatchedExpressions, &regex.first) &&
+          regex.first.find(line)) {
+        this->MatchedExpressions.insert(&regex.first);
+      }
+    }
+  };
+  matchLine(this->TestProperties->RequiredRegularExpressions);
+  matchLine(this->TestProperties->ErrorRegularExpressions);
+  matchLine(this->TestProperties->SkipRegularExpressions);
+
+  if (line.find("CTEST_FULL_OUTPUT") != std::string::npos) {
+    this->FullOutputRequested = true;
+  }
+
+  // Measurements may span lines; keep them aside for the end of the test.
+  std::string const text = line + "\n";
+  this->OutputCapture->AppendToSpool(text);
+  if (this->InMeasurement ||
+      line.find("<DartMeasurement") != std::string::npos ||
+      line.find("<CTestMeasurement") != std::string::npos) {
+    if (!this->InMeasurement) {
+      this->MeasurementStart = this->MeasurementOutput.size();
+    }
+    this->MeasurementOutput += text;
+    this->InMeasurement =
+      line.find("</DartMeasurement") == std::string::npos &&
+      line.find("</CTestMeasurement") == std::string::npos;
+    // A measurement that is never closed must not grow without bound.
+    static size_t const maxOpenMeasurement = 16 * 1024 * 1024;
+    if (this->InMeasurement &&
+        this->MeasurementOutput.size() - this->MeasurementStart >
+          maxOpenMeasurement) {
+      this->RetainOpenMeasurement();
+    }
+  } else {
+    this->OutputCapture->Retain(text);
+  }
+}
+
+void cmCTestRunTest::RetainOpenMeasurement()
+{
+  if (!this->InMeasurement) {
+    return;
+  }
+  this->OutputCapture->Retain(
+    this->MeasurementOutput.substr(this->MeasurementStart));
+  this->MeasurementOutput.erase(this->MeasurementStart);
+  this->InMeasurement = false;
+}
+
+bool cmCTestRunTest::OutputMatches(cmsys::RegularExpression& regex)
+{
+  if (this->OutputCapture) {
+    return cm::contains(this->MatchedExpressions, &regex);
+  }
+  return regex.find(this->ProcessOutput);
+}
+
 bool cmCTestRunTest::EndTest(size_t completed, size_t total, bool started)
 {
+  if (this->OutputCapture) {
+    this->RetainOpenMeasurement();
+    this->OutputCapture->Finish();
+    // Tests printing CTEST_FULL_OUTPUT are not truncated, so recover the
+    // bytes the capture dropped.
+    this->ProcessOutput = this->FullOutputRequested
+      ? this->OutputCapture->GetWhole()
+      : this->OutputCapture->GetRetained();
+  }
   this->WriteLogOutputTop(completed, total);
   std::string reason;
   bool passed = true;
@@ -121,7 +237,7 @@ bool cmCTestRunTest::EndTest(size_t completed, size_t total, bool started)
       this->FailedDependencies.empty()) {
     bool found = false;
     for (auto& pass : this->TestProperties->RequiredRegularExpressions) {
-      if (pass.first.find(this->ProcessOutput)) {
+      if (this->OutputMatches(pass.first)) {
         found = true;
         reason = cmStrCat("Required regular expression found. Regex=[",
                           pass.second, ']');
@@ -141,7 +257,7 @@ bool cmCTestRunTest::EndTest(size_t completed, size_t total, bool started)
   if (!this->TestProperties->ErrorRegularExpressions.empty() &&
       this->FailedDependencies.empty()) {
     for (auto& fail : this->TestProperties->ErrorRegularExpressions) {
-      if (fail.first.find(this->ProcessOutput)) {
+      if (this->OutputMatches(fail.first)) {
         reason = cmStrCat("Error regular expression found in output. Regex=[",
                           fail.second, ']');
         forceFail = true;
@@ -152,7 +268,7 @@ bool cmCTestRunTest::EndTest(size_t completed, size_t total, bool started)
   if (!this->TestProperties->SkipRegularExpressions.empty() &&
       this->FailedDependencies.empty()) {
     for (auto& skip : this->TestProperties->SkipRegularExpressions) {
-      if (skip.first.find(this->ProcessOutput)) {
+      if (this->OutputMatches(skip.first)) {
         reason = cmStrCat("Skip regular expression found in output. Regex=[",
                           skip.second, ']');
         forceSkip = true;
@@ -267,7 +383,11 @@ bool cmCTestRunTest::EndTest(size_t completed, size_t total, bool started)
     *this->TestHandler->LogFile << "Test time = " << buf << std::endl;
   }
 
-  this->ParseOutputForMeasurements();
+  if (this->OutputCapture) {
+    this->ParseOutputForMeasurements(this->MeasurementOutput);
+  } else {
+    this->ParseOutputForMeasurements(this->ProcessOutput);
+  }
 
   // if this is doing MemCheck then all the output needs to be put into
   // Output since that is what is parsed by cmCTestMemCheckHandler
@@ -345,6 +465,7 @@ bool cmCTestRunTest::EndTest(size_t completed, size_t total, bool started)
     this->TestResult.ExecutionTime = this->TestProcess->GetTotalTime();
     this->MemCheckPostProcess();
     this->ComputeWeightedCost();
+    this->RecordResourceUsage();
   }
   // If the test does not need to rerun push the current TestResult onto the
   // TestHandler vector
@@ -417,6 +538,48 @@ void cmCTestRunTest::ComputeWeightedCost()
   }
 }
 
+void cmCTestRunTest::RecordResourceUsage()
+{
+  uv_rusage_t const* rusage = this->TestProcess->GetResourceUsage();
+  if (!rusage) {
+    return;
+  }
+  auto toDuration = [](uv_timeval_t const& tv) {
+    return cmDuration(static_cast<double>(tv.tv_sec) +
+                      static_cast<double>(tv.tv_usec) / 1e6);
+  };
+  cmCTestTestHandler::cmCTestTestResourceUsage& usage =
+    this->TestResult.ResourceUsage;
+  usage.UserTime = toDuration(rusage->ru_utime);
+  usage.SystemTime = toDuration(rusage->ru_stime);
+  usage.PeakMemory = static_cast<unsigned long>(rusage->ru_maxrss);
+  usage.BlockInput = rusage->ru_inblock;
+  usage.BlockOutput = rusage->ru_oublock;
+  usage.VoluntaryContextSwitches = rusage->ru_nvcsw;
+  usage.InvoluntaryContextSwitches = rusage->ru_nivcsw;
+  this->TestResult.HasResourceUsage = true;
+
+  // Average over about the last ten runs so that the statistics follow
+  // changes of the test.
+  cmCTestTestHandler::cmCTestTestProperties& properties =
+    *this->TestProperties;
+  double const runs = std::min(properties.ResourceRuns, 9);
+  auto average = [runs](float& avg, double value) {
+    avg = static_cast<float>((avg * runs + value) / (runs + 1.0));
+  };
+  average(properties.AverageCpuTime,
+          (usage.UserTime + usage.SystemTime).count());
+  average(properties.AverageBlockOperations,
+          static_cast<double>(usage.BlockInput + usage.BlockOutput));
+  // Keep the peak memory of the previous runs if it is not known.
+  if (usage.PeakMemory != 0) {
+    average(properties.AveragePeakMemory,
+            static_cast<double>(usage.PeakMemory));
+    properties.PeakMemory = usage.PeakMemory;
+  }
+  properties.ResourceRuns++;
+}
+
 void cmCTestRunTest::MemCheckPostProcess()
 {
   if (!this->TestHandler->MemCheck) {
@@ -532,6 +695,7 @@ bool cmCTestRunTest::StartTest(size_t completed, size_t total)
   }
 
   this->ProcessOutput.clear();
+  this->StartOutputCapture();
 
   this->TestResult.Properties = this->TestProperties;
   this->TestResult.ExecutionTime = cmDuration::zero();
@@ -725,21 +889,19 @@ void cmCTestRunTest::ComputeArguments()
   }
 }
 
-void cmCTestRunTest::ParseOutputForMeasurements()
+void cmCTestRunTest::ParseOutputForMeasurements(std::string& output)
 {
-  if (!this->ProcessOutput.empty() &&
-      (this->ProcessOutput.find("<DartMeasurement") != std::string::npos ||
-       this->ProcessOutput.find("<CTestMeasurement") != std::string::npos)) {
-    if (this->TestHandler->AllTestMeasurementsRegex.find(
-          this->ProcessOutput)) {
+  if (!output.empty() &&
+      (output.find("<DartMeasurement") != std::string::npos ||
+       output.find("<CTestMeasurement") != std::string::npos)) {
+    if (this->TestHandler->AllTestMeasurementsRegex.find(output)) {
       this->TestResult.TestMeasurementsOutput =
         this->TestHandler->AllTestMeasurementsRegex.match(1);
       // keep searching and replacing until none are left
-      while (this->TestHandler->SingleTestMeasurementRegex.find(
-        this->ProcessOutput)) {
+      while (this->TestHandler->SingleTestMeasurementRegex.find(output)) {
         // replace the exact match for the string
         cmSystemTools::ReplaceString(
-          this->ProcessOutput,
+          output,
           this->TestHandler->SingleTestMeasurementRegex.match(1).c_str(), "");
       }
     }
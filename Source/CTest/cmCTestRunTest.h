@@ -13,6 +13,7 @@
 
 #include "cmCTest.h"
 #include "cmCTestMultiProcessHandler.h"
+#include "cmCTestOutputCapture.h"
 #include "cmCTestTestHandler.h"
 #include "cmDuration.h"
 #include "cmProcess.h"
@@ -80,6 +81,8 @@ public:
   void ComputeArguments();
 
   void ComputeWeightedCost();
+  // Record the resources used by the test and update their statistics
+  void RecordResourceUsage();
 
   void StartFailure(std::string const& output, std::string const& detail);
 
@@ -108,7 +111,10 @@ public:
 
 private:
   bool NeedsToRepeat();
-  void ParseOutputForMeasurements();
+  void ParseOutputForMeasurements(std::string& output);
+  void StartOutputCapture();
+  void CheckOutputStreaming(std::string const& line);
+  bool OutputMatches(cmsys::RegularExpression& regex);
   void ExeNotFound(std::string exe);
   bool ForkProcess(cmDuration testTimeOut, bool explicitTimeout,
                    std::vector<std::string>* environment,
@@ -117,6 +123,8 @@ private:
   void WriteLogOutputTop(size_t completed, size_t total);
   // Run post processing of the process output for MemCheck
   void MemCheckPostProcess();
+  // Retain a measurement that was not closed as ordinary output.
+  void RetainOpenMeasurement();
 
   void SetupResourcesEnvironment(std::vector<std::string>* log = nullptr);
 
@@ -130,6 +138,14 @@ private:
   cmCTest* CTest;
   std::unique_ptr<cmProcess> TestProcess;
   std::string ProcessOutput;
+  // Bounded output capture with --test-output-streaming
+  std::unique_ptr<cmCTestOutputCapture> OutputCapture;
+  std::set<cmsys::RegularExpression const*> MatchedExpressions;
+  std::string MeasurementOutput;
+  // Start of the measurement not closed yet, if InMeasurement.
+  size_t MeasurementStart = 0;
+  bool InMeasurement = false;
+  bool FullOutputRequested = false;
   // The test results
   cmCTestTestHandler::cmCTestTestResult TestResult;
   cmCTestMultiProcessHandler& MultiTestHandler;
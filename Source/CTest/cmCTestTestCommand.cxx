@@ -31,8 +31,10 @@ void cmCTestTestCommand::BindArguments()
   this->Bind("PARALLEL_LEVEL"_s, this->ParallelLevel);
   this->Bind("REPEAT"_s, this->Repeat);
   this->Bind("SCHEDULE_RANDOM"_s, this->ScheduleRandom);
+  this->Bind("SCHEDULE_CRITICAL_PATH"_s, this->ScheduleCriticalPath);
   this->Bind("STOP_TIME"_s, this->StopTime);
   this->Bind("TEST_LOAD"_s, this->TestLoad);
+  this->Bind("TEST_MEMORY"_s, this->TestMemory);
   this->Bind("RESOURCE_SPEC_FILE"_s, this->ResourceSpecFile);
   this->Bind("STOP_ON_FAILURE"_s, this->StopOnFailure);
   this->Bind("OUTPUT_JUNIT"_s, this->OutputJUnit);
@@ -103,6 +105,9 @@ cmCTestGenericHandler* cmCTestTestCommand::InitializeHandler()
   if (!this->ScheduleRandom.empty()) {
     handler->SetOption("ScheduleRandom", this->ScheduleRandom);
   }
+  if (!this->ScheduleCriticalPath.empty()) {
+    handler->SetOption("ScheduleCriticalPath", this->ScheduleCriticalPath);
+  }
   if (!this->ResourceSpecFile.empty()) {
     handler->SetOption("ResourceSpecFile", this->ResourceSpecFile);
   }
@@ -134,6 +139,17 @@ cmCTestGenericHandler* cmCTestTestCommand::InitializeHandler()
   }
   handler->SetTestLoad(testLoad);
 
+  if (!this->TestMemory.empty()) {
+    unsigned long testMemory;
+    if (cmStrToULong(this->TestMemory, &testMemory)) {
+      handler->SetOption("TestMemory", this->TestMemory);
+    } else {
+      cmCTestLog(this->CTest, WARNING,
+                 "Invalid value for 'TEST_MEMORY' : " << this->TestMemory
+                                                      << std::endl);
+    }
+  }
+
   if (cmValue labelsForSubprojects =
         this->Makefile->GetDefinition("CTEST_LABELS_FOR_SUBPROJECTS")) {
     this->CTest->SetCTestConfiguration("LabelsForSubprojects",
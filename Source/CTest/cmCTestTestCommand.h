@@ -57,8 +57,10 @@ protected:
   std::string ParallelLevel;
   std::string Repeat;
   std::string ScheduleRandom;
+  std::string ScheduleCriticalPath;
   std::string StopTime;
   std::string TestLoad;
+  std::string TestMemory;
   std::string ResourceSpecFile;
   std::string OutputJUnit;
   bool StopOnFailure = false;
@@ -15,6 +15,8 @@
 #include <iterator>
 #include <set>
 #include <sstream>
+#include <string>
+#include <unordered_map>
 #include <utility>
 
 #include <cm/memory>
@@ -32,6 +34,7 @@
 #include "cmCTest.h"
 #include "cmCTestMultiProcessHandler.h"
 #include "cmCTestResourceGroupsLexerHelper.h"
+#include "cmCTestTestListCache.h"
 #include "cmCTestTestMeasurementXMLParser.h"
 #include "cmDuration.h"
 #include "cmExecutionStatus.h"
@@ -44,6 +47,7 @@
 #include "cmSystemTools.h"
 #include "cmTimestamp.h"
 #include "cmValue.h"
+#include "cmVersion.h"
 #include "cmWorkingDirectory.h"
 #include "cmXMLWriter.h"
 #include "cmake.h"
@@ -53,8 +57,10 @@ namespace {
 class cmCTestCommand
 {
 public:
-  cmCTestCommand(cmCTestTestHandler* testHandler)
+  cmCTestCommand(cmCTestTestHandler* testHandler,
+                 cmCTestTestListCache* cache)
     : TestHandler(testHandler)
+    , Cache(cache)
   {
   }
 
@@ -79,6 +85,8 @@ public:
                            cmExecutionStatus& status) = 0;
 
   cmCTestTestHandler* TestHandler;
+  // Record of the calls for the test list cache, if enabled.
+  cmCTestTestListCache* Cache;
 };
 
 bool ReadSubdirectory(std::string fname, cmExecutionStatus& status)
@@ -175,6 +183,9 @@ bool cmCTestAddTestCommand::InitialPass(std::vector<std::string> const& args,
     status.SetError("called with incorrect number of arguments");
     return false;
   }
+  if (this->Cache) {
+    this->Cache->AddCall(cmCTestTestListCache::CallType::AddTest, args);
+  }
   return this->TestHandler->AddTest(args);
 }
 
@@ -194,6 +205,10 @@ public:
 bool cmCTestSetTestsPropertiesCommand::InitialPass(
   std::vector<std::string> const& args, cmExecutionStatus& /*unused*/)
 {
+  if (this->Cache) {
+    this->Cache->AddCall(cmCTestTestListCache::CallType::SetTestsProperties,
+                         args);
+  }
   return this->TestHandler->SetTestsProperties(args);
 }
 
@@ -213,6 +228,10 @@ public:
 bool cmCTestSetDirectoryPropertiesCommand::InitialPass(
   std::vector<std::string> const& args, cmExecutionStatus&)
 {
+  if (this->Cache) {
+    this->Cache->AddCall(
+      cmCTestTestListCache::CallType::SetDirectoryProperties, args);
+  }
   return this->TestHandler->SetDirectoryProperties(args);
 }
 
@@ -268,6 +287,27 @@ inline int GetNextRealNumber(std::string const& in, double& val,
   return 0;
 }
 
+// Call fn with the name, type and value of each measurement of the
+// resources used by a test.  The peak memory is left out when it is not
+// known.
+template <typename F>
+void ForEachResourceMeasurement(
+  cmCTestTestHandler::cmCTestTestResourceUsage const& usage, F const& fn)
+{
+  fn("User Time", "numeric/double", std::to_string(usage.UserTime.count()));
+  fn("System Time", "numeric/double",
+     std::to_string(usage.SystemTime.count()));
+  if (usage.PeakMemory != 0) {
+    fn("Peak Memory", "numeric/integer", std::to_string(usage.PeakMemory));
+  }
+  fn("Block Input", "numeric/integer", std::to_string(usage.BlockInput));
+  fn("Block Output", "numeric/integer", std::to_string(usage.BlockOutput));
+  fn("Voluntary Context Switches", "numeric/integer",
+     std::to_string(usage.VoluntaryContextSwitches));
+  fn("Involuntary Context Switches", "numeric/integer",
+     std::to_string(usage.InvoluntaryContextSwitches));
+}
+
 } // namespace
 
 cmCTestTestHandler::cmCTestTestHandler()
@@ -513,6 +553,9 @@ bool cmCTestTestHandler::ProcessOptions()
   if (cmIsOn(this->GetOption("ScheduleRandom"))) {
     this->CTest->SetScheduleType("Random");
   }
+  if (cmIsOn(this->GetOption("ScheduleCriticalPath"))) {
+    this->CTest->SetScheduleType("CriticalPath");
+  }
   if (cmValue repeat = this->GetOption("Repeat")) {
     cmsys::RegularExpression repeatRegex(
       "^(UNTIL_FAIL|UNTIL_PASS|AFTER_TIMEOUT):([0-9]+)$");
@@ -577,6 +620,28 @@ bool cmCTestTestHandler::ProcessOptions()
   }
   this->SetRerunFailed(cmIsOn(this->GetOption("RerunFailed")));
 
+  cmValue shardIndex = this->GetOption("ShardIndex");
+  cmValue shardCount = this->GetOption("ShardCount");
+  if (shardIndex || shardCount) {
+    unsigned long index = 0;
+    unsigned long count = 0;
+    if (!shardIndex || !shardCount || !cmStrToULong(*shardIndex, &index) ||
+        !cmStrToULong(*shardCount, &count) || count == 0 ||
+        index >= count) {
+      cmCTestLog(this->CTest, ERROR_MESSAGE,
+                 "Shard options invalid: --shard-index must be given with "
+                 "--shard-count and be less than it."
+                   << std::endl);
+      return false;
+    }
+    this->ShardIndex = static_cast<int>(index);
+    this->ShardCount = static_cast<int>(count);
+  }
+  val = this->GetOption("Coordinator");
+  if (val) {
+    this->Coordinator = *val;
+  }
+
   return true;
 }
 
@@ -928,6 +993,7 @@ bool cmCTestTestHandler::ComputeTestList()
     finalList.push_back(tp);
   }
 
+  this->SelectShard(finalList);
   this->UpdateForFixtures(finalList);
 
   // Save the total number of tests before exclusions
@@ -957,6 +1023,7 @@ void cmCTestTestHandler::ComputeTestListForRerunFailed()
     finalList.push_back(tp);
   }
 
+  this->SelectShard(finalList);
   this->UpdateForFixtures(finalList);
 
   // Save the total number of tests before exclusions
@@ -968,6 +1035,77 @@ void cmCTestTestHandler::ComputeTestListForRerunFailed()
   this->UpdateMaxTestNameWidth();
 }
 
+void cmCTestTestHandler::SelectShard(ListOfTests& tests) const
+{
+  if (this->ShardCount <= 1) {
+    return;
+  }
+
+  // Every shard must compute the same assignment, so only use data that
+  // is the same for all of them: the tests and their COST properties.
+  // The cost data file is not used because each shard rewrites it.
+  double total = 0;
+  std::size_t declared = 0;
+  for (cmCTestTestProperties const& test : tests) {
+    if (test.Cost > 0) {
+      total += test.Cost;
+      ++declared;
+    }
+  }
+  // Tests without a COST are assumed to take the average time.
+  float const average =
+    declared ? static_cast<float>(total / static_cast<double>(declared)) : 1;
+
+  struct Entry
+  {
+    float Cost;
+    std::size_t Position;
+  };
+  std::vector<Entry> entries;
+  entries.reserve(tests.size());
+  for (std::size_t i = 0; i < tests.size(); ++i) {
+    float const cost = tests[i].Cost > 0 ? tests[i].Cost : average;
+    entries.push_back(Entry{ cost, i });
+  }
+  std::sort(entries.begin(), entries.end(),
+            [&tests](Entry const& a, Entry const& b) {
+              if (a.Cost != b.Cost) {
+                return a.Cost > b.Cost;
+              }
+              std::string const& nameA = tests[a.Position].Name;
+              std::string const& nameB = tests[b.Position].Name;
+              if (nameA != nameB) {
+                return nameA < nameB;
+              }
+              return tests[a.Position].Index < tests[b.Position].Index;
+            });
+
+  // Give the most expensive remaining test to the shard with the least
+  // work so far, or with the fewest tests if the work is the same.
+  std::vector<std::pair<double, std::size_t>> loads(
+    static_cast<std::size_t>(this->ShardCount));
+  std::vector<bool> selected(tests.size());
+  for (Entry const& e : entries) {
+    auto shard = std::min_element(loads.begin(), loads.end());
+    shard->first += e.Cost;
+    ++shard->second;
+    selected[e.Position] = shard - loads.begin() == this->ShardIndex;
+  }
+
+  ListOfTests shardTests;
+  for (std::size_t i = 0; i < tests.size(); ++i) {
+    if (selected[i]) {
+      shardTests.push_back(std::move(tests[i]));
+    }
+  }
+  cmCTestOptionalLog(this->CTest, HANDLER_VERBOSE_OUTPUT,
+                     "Running " << shardTests.size() << " of " << tests.size()
+                                << " tests in shard " << this->ShardIndex
+                                << " of " << this->ShardCount << std::endl,
+                     this->Quiet);
+  tests = std::move(shardTests);
+}
+
 void cmCTestTestHandler::UpdateForFixtures(ListOfTests& tests) const
 {
   cmCTestOptionalLog(this->CTest, HANDLER_VERBOSE_OUTPUT,
@@ -1065,10 +1203,12 @@ void cmCTestTestHandler::UpdateForFixtures(ListOfTests& tests) const
       // cleanup tests depend on this test case later.
       std::pair<FixtureDepsIterator, FixtureDepsIterator> setupRange =
         fixtureSetups.equal_range(requiredFixtureName);
+      std::set<std::string> depends(tests[i].Depends.begin(),
+                                    tests[i].Depends.end());
       for (auto sIt = setupRange.first; sIt != setupRange.second; ++sIt) {
         const std::string& setupTestName = sIt->second->Name;
         tests[i].RequireSuccessDepends.insert(setupTestName);
-        if (!cm::contains(tests[i].Depends, setupTestName)) {
+        if (depends.insert(setupTestName).second) {
           tests[i].Depends.push_back(setupTestName);
         }
       }
@@ -1163,6 +1303,12 @@ void cmCTestTestHandler::UpdateForFixtures(ListOfTests& tests) const
   // but no other test has that fixture as a requirement.
   for (cmCTestTestProperties& p : tests) {
     const std::set<std::string>& cleanups = p.FixturesCleanup;
+    if (cleanups.empty()) {
+      continue;
+    }
+    // A cleanup test may depend on every test requiring its fixture, so
+    // look up the dependencies it already has in a set.
+    std::set<std::string> depends(p.Depends.begin(), p.Depends.end());
     for (std::string const& fixture : cleanups) {
       // This cleanup test could be part of the original test list that was
       // passed in. It is then possible that no other test requires the
@@ -1172,7 +1318,7 @@ void cmCTestTestHandler::UpdateForFixtures(ListOfTests& tests) const
         const std::vector<size_t>& indices = cIt->second;
         for (size_t index : indices) {
           const std::string& reqTestName = tests[index].Name;
-          if (!cm::contains(p.Depends, reqTestName)) {
+          if (depends.insert(reqTestName).second) {
             p.Depends.push_back(reqTestName);
           }
         }
@@ -1185,7 +1331,7 @@ void cmCTestTestHandler::UpdateForFixtures(ListOfTests& tests) const
         const std::vector<size_t>& indices = cIt->second;
         for (size_t index : indices) {
           const std::string& setupTestName = tests[index].Name;
-          if (!cm::contains(p.Depends, setupTestName)) {
+          if (depends.insert(setupTestName).second) {
             p.Depends.push_back(setupTestName);
           }
         }
@@ -1339,6 +1485,11 @@ bool cmCTestTestHandler::ProcessDirectory(std::vector<std::string>& passed,
   } else {
     parallel->SetTestLoad(this->CTest->GetTestLoad());
   }
+  unsigned long testMemory = this->CTest->GetTestMemory();
+  if (cmValue value = this->GetOption("TestMemory")) {
+    cmStrToULong(*value, &testMemory);
+  }
+  parallel->SetTestMemory(testMemory);
   if (!this->ResourceSpecFile.empty()) {
     this->UseResourceSpec = true;
     auto result = this->ResourceSpec.ReadFromJSONFile(this->ResourceSpecFile);
@@ -1352,6 +1503,9 @@ bool cmCTestTestHandler::ProcessDirectory(std::vector<std::string>& passed,
     }
     parallel->InitResourceAllocator(this->ResourceSpec);
   }
+  if (!this->Coordinator.empty()) {
+    parallel->SetCoordinator(this->Coordinator);
+  }
 
   *this->LogFile
     << "Start testing: " << this->CTest->CurrentTime() << std::endl
@@ -1366,6 +1520,13 @@ bool cmCTestTestHandler::ProcessDirectory(std::vector<std::string>& passed,
     srand(static_cast<unsigned>(time(nullptr)));
   }
 
+  // Look up the tests depended on by name.  Only the first test with
+  // each name can be depended on.
+  std::unordered_map<std::string, int> testsByName;
+  for (cmCTestTestProperties const& p : this->TestList) {
+    testsByName.emplace(p.Name, p.Index);
+  }
+
   for (cmCTestTestProperties& p : this->TestList) {
     cmCTestMultiProcessHandler::TestSet depends;
 
@@ -1378,14 +1539,10 @@ bool cmCTestTestHandler::ProcessDirectory(std::vector<std::string>& passed,
       p.Timeout = this->CTest->GetGlobalTimeout();
     }
 
-    if (!p.Depends.empty()) {
-      for (std::string const& i : p.Depends) {
-        for (cmCTestTestProperties const& it2 : this->TestList) {
-          if (it2.Name == i) {
-            depends.insert(it2.Index);
-            break; // break out of test loop as name can only match 1
-          }
-        }
+    for (std::string const& i : p.Depends) {
+      auto it2 = testsByName.find(i);
+      if (it2 != testsByName.end()) {
+        depends.insert(it2->second);
       }
     }
     tests[p.Index] = depends;
@@ -1460,6 +1617,18 @@ void cmCTestTestHandler::GenerateCTestXML(cmXMLWriter& xml)
       xml.Attribute("name", "Execution Time");
       xml.Element("Value", result.ExecutionTime.count());
       xml.EndElement(); // NamedMeasurement
+      if (result.HasResourceUsage) {
+        ForEachResourceMeasurement(
+          result.ResourceUsage,
+          [&xml](const char* name, const char* type,
+                 std::string const& value) {
+            xml.StartElement("NamedMeasurement");
+            xml.Attribute("type", type);
+            xml.Attribute("name", name);
+            xml.Element("Value", value);
+            xml.EndElement(); // NamedMeasurement
+          });
+      }
       if (!result.Reason.empty()) {
         const char* reasonType = "Pass Reason";
         if (result.Status != cmCTestTestHandler::COMPLETED) {
@@ -1777,6 +1946,32 @@ bool cmCTestTestHandler::GetListOfTests()
   }
   cmCTestOptionalLog(this->CTest, HANDLER_VERBOSE_OUTPUT,
                      "Constructing a list of tests" << std::endl, this->Quiet);
+  this->TestsByName.clear();
+
+  // The test files are evaluated with the configuration type, so a cached
+  // list is only valid for the same one.
+  std::string cacheFile;
+  std::string cacheKey;
+  std::unique_ptr<cmCTestTestListCache> cache;
+  if (this->CTest->GetTestListCache()) {
+    cacheFile = cmStrCat(this->CTest->GetBinaryDir(),
+                         "/Testing/Temporary/CTestTestList.bin");
+    cacheKey = cmStrCat(cmVersion::GetCMakeVersion(), '\n',
+                        cmSystemTools::GetCurrentWorkingDirectory(), '\n',
+                        this->CTest->GetConfigType());
+    cache = cm::make_unique<cmCTestTestListCache>();
+    if (cache->Load(cacheFile, cacheKey) && this->ReplayTestList(*cache)) {
+      cmCTestOptionalLog(this->CTest, HANDLER_VERBOSE_OUTPUT,
+                         "Read the list of tests from " << cacheFile
+                                                        << std::endl,
+                         this->Quiet);
+      return true;
+    }
+    this->TestList.clear();
+    this->TestsByName.clear();
+    cache = cm::make_unique<cmCTestTestListCache>();
+  }
+
   cmake cm(cmake::RoleScript, cmState::CTest);
   cm.SetHomeDirectory("");
   cm.SetHomeOutputDirectory("");
@@ -1786,7 +1981,8 @@ bool cmCTestTestHandler::GetListOfTests()
   mf.AddDefinition("CTEST_CONFIGURATION_TYPE", this->CTest->GetConfigType());
 
   // Add handler for ADD_TEST
-  cm.GetState()->AddBuiltinCommand("add_test", cmCTestAddTestCommand(this));
+  cm.GetState()->AddBuiltinCommand("add_test",
+                                   cmCTestAddTestCommand(this, cache.get()));
 
   // Add handler for SUBDIRS
   cm.GetState()->AddBuiltinCommand("subdirs", cmCTestSubdirCommand);
@@ -1796,13 +1992,15 @@ bool cmCTestTestHandler::GetListOfTests()
                                    cmCTestAddSubdirectoryCommand);
 
   // Add handler for SET_TESTS_PROPERTIES
-  cm.GetState()->AddBuiltinCommand("set_tests_properties",
-                                   cmCTestSetTestsPropertiesCommand(this));
+  cm.GetState()->AddBuiltinCommand(
+    "set_tests_properties",
+    cmCTestSetTestsPropertiesCommand(this, cache.get()));
 
   // Add handler for SET_DIRECTORY_PROPERTIES
   cm.GetState()->RemoveBuiltinCommand("set_directory_properties");
-  cm.GetState()->AddBuiltinCommand("set_directory_properties",
-                                   cmCTestSetDirectoryPropertiesCommand(this));
+  cm.GetState()->AddBuiltinCommand(
+    "set_directory_properties",
+    cmCTestSetDirectoryPropertiesCommand(this, cache.get()));
 
   const char* testFilename;
   if (cmSystemTools::FileExists("CTestTestfile.cmake")) {
@@ -1826,12 +2024,55 @@ bool cmCTestTestHandler::GetListOfTests()
   if (this->ResourceSpecFile.empty() && specFile) {
     this->ResourceSpecFile = *specFile;
   }
+  if (cache) {
+    cache->ResourceSpecFile = *specFile;
+    cache->SetInputs(mf.GetListFiles());
+    cmSystemTools::MakeDirectory(cmSystemTools::GetFilenamePath(cacheFile));
+    if (!cache->Save(cacheFile, cacheKey)) {
+      cmCTestLog(this->CTest, WARNING,
+                 "Could not write the test list cache " << cacheFile
+                                                        << std::endl);
+    }
+  }
   cmCTestOptionalLog(this->CTest, HANDLER_VERBOSE_OUTPUT,
                      "Done constructing a list of tests" << std::endl,
                      this->Quiet);
   return true;
 }
 
+bool cmCTestTestHandler::ReplayTestList(cmCTestTestListCache const& cache)
+{
+  cmWorkingDirectory workdir(cmSystemTools::GetCurrentWorkingDirectory());
+  std::string directory = workdir.GetOldDirectory();
+  for (cmCTestTestListCache::Call const& call : cache.GetCalls()) {
+    if (call.Directory != directory) {
+      if (!workdir.SetDirectory(call.Directory)) {
+        return false;
+      }
+      directory = call.Directory;
+    }
+    bool result = true;
+    switch (call.Type) {
+      case cmCTestTestListCache::CallType::AddTest:
+        result = this->AddTest(call.Args);
+        break;
+      case cmCTestTestListCache::CallType::SetTestsProperties:
+        result = this->SetTestsProperties(call.Args);
+        break;
+      case cmCTestTestListCache::CallType::SetDirectoryProperties:
+        result = this->SetDirectoryProperties(call.Args);
+        break;
+    }
+    if (!result) {
+      return false;
+    }
+  }
+  if (this->ResourceSpecFile.empty()) {
+    this->ResourceSpecFile = cache.ResourceSpecFile;
+  }
+  return true;
+}
+
 void cmCTestTestHandler::UseIncludeRegExp()
 {
   this->UseIncludeRegExpFlag = true;
@@ -2195,133 +2436,135 @@ bool cmCTestTestHandler::SetTestsProperties(
     }
     std::string const& val = *it;
     for (std::string const& t : tests) {
-      for (cmCTestTestProperties& rt : this->TestList) {
-        if (t == rt.Name) {
-          if (key == "_BACKTRACE_TRIPLES"_s) {
-            std::vector<std::string> triples;
-            // allow empty args in the triples
-            cmExpandList(val, triples, true);
-
-            // Ensure we have complete triples otherwise the data is corrupt.
-            if (triples.size() % 3 == 0) {
-              cmState state(cmState::Unknown);
-              rt.Backtrace = cmListFileBacktrace();
-
-              // the first entry represents the top of the trace so we need to
-              // reconstruct the backtrace in reverse
-              for (size_t i = triples.size(); i >= 3; i -= 3) {
-                cmListFileContext fc;
-                fc.FilePath = triples[i - 3];
-                long line = 0;
-                if (!cmStrToLong(triples[i - 2], &line)) {
-                  line = 0;
-                }
-                fc.Line = line;
-                fc.Name = triples[i - 1];
-                rt.Backtrace = rt.Backtrace.Push(fc);
+      auto const named = this->TestsByName.find(t);
+      if (named == this->TestsByName.end()) {
+        continue;
+      }
+      for (std::size_t index : named->second) {
+        cmCTestTestProperties& rt = this->TestList[index];
+        if (key == "_BACKTRACE_TRIPLES"_s) {
+          std::vector<std::string> triples;
+          // allow empty args in the triples
+          cmExpandList(val, triples, true);
+
+          // Ensure we have complete triples otherwise the data is corrupt.
+          if (triples.size() % 3 == 0) {
+            rt.Backtrace = cmListFileBacktrace();
+
+            // the first entry represents the top of the trace so we need to
+            // reconstruct the backtrace in reverse
+            for (size_t i = triples.size(); i >= 3; i -= 3) {
+              cmListFileContext fc;
+              fc.FilePath = triples[i - 3];
+              long line = 0;
+              if (!cmStrToLong(triples[i - 2], &line)) {
+                line = 0;
               }
+              fc.Line = line;
+              fc.Name = triples[i - 1];
+              rt.Backtrace = rt.Backtrace.Push(fc);
             }
-          } else if (key == "WILL_FAIL"_s) {
-            rt.WillFail = cmIsOn(val);
-          } else if (key == "DISABLED"_s) {
-            rt.Disabled = cmIsOn(val);
-          } else if (key == "ATTACHED_FILES"_s) {
-            cmExpandList(val, rt.AttachedFiles);
-          } else if (key == "ATTACHED_FILES_ON_FAIL"_s) {
-            cmExpandList(val, rt.AttachOnFail);
-          } else if (key == "RESOURCE_LOCK"_s) {
-            std::vector<std::string> lval = cmExpandedList(val);
-
-            rt.LockedResources.insert(lval.begin(), lval.end());
-          } else if (key == "FIXTURES_SETUP"_s) {
-            std::vector<std::string> lval = cmExpandedList(val);
-
-            rt.FixturesSetup.insert(lval.begin(), lval.end());
-          } else if (key == "FIXTURES_CLEANUP"_s) {
-            std::vector<std::string> lval = cmExpandedList(val);
-
-            rt.FixturesCleanup.insert(lval.begin(), lval.end());
-          } else if (key == "FIXTURES_REQUIRED"_s) {
-            std::vector<std::string> lval = cmExpandedList(val);
-
-            rt.FixturesRequired.insert(lval.begin(), lval.end());
-          } else if (key == "TIMEOUT"_s) {
-            rt.Timeout = cmDuration(atof(val.c_str()));
-            rt.ExplicitTimeout = true;
-          } else if (key == "COST"_s) {
-            rt.Cost = static_cast<float>(atof(val.c_str()));
-          } else if (key == "REQUIRED_FILES"_s) {
-            cmExpandList(val, rt.RequiredFiles);
-          } else if (key == "RUN_SERIAL"_s) {
-            rt.RunSerial = cmIsOn(val);
-          } else if (key == "FAIL_REGULAR_EXPRESSION"_s) {
-            std::vector<std::string> lval = cmExpandedList(val);
-            for (std::string const& cr : lval) {
-              rt.ErrorRegularExpressions.emplace_back(cr, cr);
-            }
-          } else if (key == "SKIP_REGULAR_EXPRESSION"_s) {
-            std::vector<std::string> lval = cmExpandedList(val);
-            for (std::string const& cr : lval) {
-              rt.SkipRegularExpressions.emplace_back(cr, cr);
-            }
-          } else if (key == "PROCESSORS"_s) {
-            rt.Processors = atoi(val.c_str());
-            if (rt.Processors < 1) {
-              rt.Processors = 1;
-            }
-          } else if (key == "PROCESSOR_AFFINITY"_s) {
-            rt.WantAffinity = cmIsOn(val);
-          } else if (key == "RESOURCE_GROUPS"_s) {
-            if (!ParseResourceGroupsProperty(val, rt.ResourceGroups)) {
-              return false;
-            }
-          } else if (key == "SKIP_RETURN_CODE"_s) {
-            rt.SkipReturnCode = atoi(val.c_str());
-            if (rt.SkipReturnCode < 0 || rt.SkipReturnCode > 255) {
-              rt.SkipReturnCode = -1;
-            }
-          } else if (key == "DEPENDS"_s) {
-            cmExpandList(val, rt.Depends);
-          } else if (key == "ENVIRONMENT"_s) {
-            cmExpandList(val, rt.Environment);
-          } else if (key == "ENVIRONMENT_MODIFICATION"_s) {
-            cmExpandList(val, rt.EnvironmentModification);
-          } else if (key == "LABELS"_s) {
-            std::vector<std::string> Labels = cmExpandedList(val);
-            rt.Labels.insert(rt.Labels.end(), Labels.begin(), Labels.end());
-            // sort the array
-            std::sort(rt.Labels.begin(), rt.Labels.end());
-            // remove duplicates
-            auto new_end = std::unique(rt.Labels.begin(), rt.Labels.end());
-            rt.Labels.erase(new_end, rt.Labels.end());
-          } else if (key == "MEASUREMENT"_s) {
-            size_t pos = val.find_first_of('=');
-            if (pos != std::string::npos) {
-              std::string mKey = val.substr(0, pos);
-              std::string mVal = val.substr(pos + 1);
-              rt.Measurements[mKey] = std::move(mVal);
-            } else {
-              rt.Measurements[val] = "1";
-            }
-          } else if (key == "PASS_REGULAR_EXPRESSION"_s) {
-            std::vector<std::string> lval = cmExpandedList(val);
+          }
+        } else if (key == "WILL_FAIL"_s) {
+          rt.WillFail = cmIsOn(val);
+        } else if (key == "DISABLED"_s) {
+          rt.Disabled = cmIsOn(val);
+        } else if (key == "ATTACHED_FILES"_s) {
+          cmExpandList(val, rt.AttachedFiles);
+        } else if (key == "ATTACHED_FILES_ON_FAIL"_s) {
+          cmExpandList(val, rt.AttachOnFail);
+        } else if (key == "RESOURCE_LOCK"_s) {
+          std::vector<std::string> lval = cmExpandedList(val);
+
+          rt.LockedResources.insert(lval.begin(), lval.end());
+        } else if (key == "FIXTURES_SETUP"_s) {
+          std::vector<std::string> lval = cmExpandedList(val);
+
+          rt.FixturesSetup.insert(lval.begin(), lval.end());
+        } else if (key == "FIXTURES_CLEANUP"_s) {
+          std::vector<std::string> lval = cmExpandedList(val);
+
+          rt.FixturesCleanup.insert(lval.begin(), lval.end());
+        } else if (key == "FIXTURES_REQUIRED"_s) {
+          std::vector<std::string> lval = cmExpandedList(val);
+
+          rt.FixturesRequired.insert(lval.begin(), lval.end());
+        } else if (key == "TIMEOUT"_s) {
+          rt.Timeout = cmDuration(atof(val.c_str()));
+          rt.ExplicitTimeout = true;
+        } else if (key == "COST"_s) {
+          rt.Cost = static_cast<float>(atof(val.c_str()));
+        } else if (key == "REQUIRED_FILES"_s) {
+          cmExpandList(val, rt.RequiredFiles);
+        } else if (key == "RUN_SERIAL"_s) {
+          rt.RunSerial = cmIsOn(val);
+        } else if (key == "FAIL_REGULAR_EXPRESSION"_s) {
+          std::vector<std::string> lval = cmExpandedList(val);
+          for (std::string const& cr : lval) {
+            rt.ErrorRegularExpressions.emplace_back(cr, cr);
+          }
+        } else if (key == "SKIP_REGULAR_EXPRESSION"_s) {
+          std::vector<std::string> lval = cmExpandedList(val);
+          for (std::string const& cr : lval) {
+            rt.SkipRegularExpressions.emplace_back(cr, cr);
+          }
+        } else if (key == "PROCESSORS"_s) {
+          rt.Processors = atoi(val.c_str());
+          if (rt.Processors < 1) {
+            rt.Processors = 1;
+          }
+        } else if (key == "PROCESSOR_AFFINITY"_s) {
+          rt.WantAffinity = cmIsOn(val);
+        } else if (key == "RESOURCE_GROUPS"_s) {
+          if (!ParseResourceGroupsProperty(val, rt.ResourceGroups)) {
+            return false;
+          }
+        } else if (key == "SKIP_RETURN_CODE"_s) {
+          rt.SkipReturnCode = atoi(val.c_str());
+          if (rt.SkipReturnCode < 0 || rt.SkipReturnCode > 255) {
+            rt.SkipReturnCode = -1;
+          }
+        } else if (key == "DEPENDS"_s) {
+          cmExpandList(val, rt.Depends);
+        } else if (key == "ENVIRONMENT"_s) {
+          cmExpandList(val, rt.Environment);
+        } else if (key == "ENVIRONMENT_MODIFICATION"_s) {
+          cmExpandList(val, rt.EnvironmentModification);
+        } else if (key == "LABELS"_s) {
+          std::vector<std::string> Labels = cmExpandedList(val);
+          rt.Labels.insert(rt.Labels.end(), Labels.begin(), Labels.end());
+          // sort the array
+          std::sort(rt.Labels.begin(), rt.Labels.end());
+          // remove duplicates
+          auto new_end = std::unique(rt.Labels.begin(), rt.Labels.end());
+          rt.Labels.erase(new_end, rt.Labels.end());
+        } else if (key == "MEASUREMENT"_s) {
+          size_t pos = val.find_first_of('=');
+          if (pos != std::string::npos) {
+            std::string mKey = val.substr(0, pos);
+            std::string mVal = val.substr(pos + 1);
+            rt.Measurements[mKey] = std::move(mVal);
+          } else {
+            rt.Measurements[val] = "1";
+          }
+        } else if (key == "PASS_REGULAR_EXPRESSION"_s) {
+          std::vector<std::string> lval = cmExpandedList(val);
+          for (std::string const& cr : lval) {
+            rt.RequiredRegularExpressions.emplace_back(cr, cr);
+          }
+        } else if (key == "WORKING_DIRECTORY"_s) {
+          rt.Directory = val;
+        } else if (key == "TIMEOUT_AFTER_MATCH"_s) {
+          std::vector<std::string> propArgs = cmExpandedList(val);
+          if (propArgs.size() != 2) {
+            cmCTestLog(this->CTest, WARNING,
+                       "TIMEOUT_AFTER_MATCH expects two arguments, found "
+                         << propArgs.size() << std::endl);
+          } else {
+            rt.AlternateTimeout = cmDuration(atof(propArgs[0].c_str()));
+            std::vector<std::string> lval = cmExpandedList(propArgs[1]);
             for (std::string const& cr : lval) {
-              rt.RequiredRegularExpressions.emplace_back(cr, cr);
-            }
-          } else if (key == "WORKING_DIRECTORY"_s) {
-            rt.Directory = val;
-          } else if (key == "TIMEOUT_AFTER_MATCH"_s) {
-            std::vector<std::string> propArgs = cmExpandedList(val);
-            if (propArgs.size() != 2) {
-              cmCTestLog(this->CTest, WARNING,
-                         "TIMEOUT_AFTER_MATCH expects two arguments, found "
-                           << propArgs.size() << std::endl);
-            } else {
-              rt.AlternateTimeout = cmDuration(atof(propArgs[0].c_str()));
-              std::vector<std::string> lval = cmExpandedList(propArgs[1]);
-              for (std::string const& cr : lval) {
-                rt.TimeoutRegularExpressions.emplace_back(cr, cr);
-              }
+              rt.TimeoutRegularExpressions.emplace_back(cr, cr);
             }
           }
         }
@@ -2437,13 +2680,19 @@ bool cmCTestTestHandler::AddTest(const std::vector<std::string>& args)
   test.WantAffinity = false;
   test.SkipReturnCode = -1;
   test.PreviousRuns = 0;
+  test.PeakMemory = 0;
+  test.ResourceRuns = 0;
+  test.AverageCpuTime = 0;
+  test.AveragePeakMemory = 0;
+  test.AverageBlockOperations = 0;
   if (this->UseIncludeRegExpFlag &&
       (!this->IncludeTestsRegularExpression.find(testname) ||
        (!this->UseExcludeRegExpFirst &&
         this->ExcludeTestsRegularExpression.find(testname)))) {
     test.IsInBasedOnREOptions = false;
   }
-  this->TestList.push_back(test);
+  this->TestsByName[testname].push_back(this->TestList.size());
+  this->TestList.push_back(std::move(test));
   return true;
 }
 
@@ -2568,6 +2817,20 @@ bool cmCTestTestHandler::WriteJUnitXML()
       xml.EndElement(); // </failure>
     }
 
+    if (result.HasResourceUsage) {
+      xml.StartElement("properties");
+      ForEachResourceMeasurement(
+        result.ResourceUsage,
+        [&xml](const char* name, const char* /*type*/,
+               std::string const& value) {
+          xml.StartElement("property");
+          xml.Attribute("name", name);
+          xml.Attribute("value", value);
+          xml.EndElement(); // </property>
+        });
+      xml.EndElement(); // </properties>
+    }
+
     // Note: compressed test output is unconditionally disabled when
     // --output-junit is specified.
     xml.Element("system-out", result.Output);
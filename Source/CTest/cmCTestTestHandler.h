@@ -24,6 +24,7 @@
 #include "cmListFileCache.h"
 #include "cmValue.h"
 
+class cmCTestTestListCache;
 class cmMakefile;
 class cmXMLWriter;
 
@@ -85,6 +86,12 @@ public:
   //! Set test output truncation mode. Return false if unknown mode.
   bool SetTestOutputTruncation(const std::string& mode);
 
+  //! Match and truncate test output as it arrives instead of at the end.
+  void SetTestOutputStreaming(bool b) { this->TestOutputStreaming = b; }
+
+  //! Write the whole output of each test to a compressed file.
+  void SetTestOutputSpool(bool b) { this->TestOutputSpool = b; }
+
   //! pass the -I argument down
   void SetTestsToRunInformation(cmValue);
 
@@ -144,6 +151,13 @@ public:
     bool Disabled;
     float Cost;
     int PreviousRuns;
+    // Peak resident memory of the last run in KiB, or 0 if unknown
+    unsigned long PeakMemory;
+    // Averages of the resources used by the recent runs
+    int ResourceRuns;
+    float AverageCpuTime;
+    float AveragePeakMemory;
+    float AverageBlockOperations;
     bool RunSerial;
     cmDuration Timeout;
     bool ExplicitTimeout;
@@ -168,6 +182,19 @@ public:
     cmListFileBacktrace Backtrace;
   };
 
+  // Resources used by a test process
+  struct cmCTestTestResourceUsage
+  {
+    cmDuration UserTime = cmDuration::zero();
+    cmDuration SystemTime = cmDuration::zero();
+    // Peak resident memory in KiB
+    unsigned long PeakMemory = 0;
+    std::uint64_t BlockInput = 0;
+    std::uint64_t BlockOutput = 0;
+    std::uint64_t VoluntaryContextSwitches = 0;
+    std::uint64_t InvoluntaryContextSwitches = 0;
+  };
+
   struct cmCTestTestResult
   {
     std::string Name;
@@ -186,6 +213,8 @@ public:
     std::string TestMeasurementsOutput;
     int TestCount;
     cmCTestTestProperties* Properties;
+    bool HasResourceUsage = false;
+    cmCTestTestResourceUsage ResourceUsage;
   };
 
   struct cmCTestTestResultLess
@@ -265,6 +294,8 @@ protected:
   int CustomMaximumPassedTestOutputSize;
   int CustomMaximumFailedTestOutputSize;
   cmCTestTypes::TruncationMode TestOutputTruncation;
+  bool TestOutputStreaming = false;
+  bool TestOutputSpool = false;
   int MaxIndex;
 
 public:
@@ -305,6 +336,11 @@ private:
    * Get the list of tests in directory and subdirectories.
    */
   bool GetListOfTests();
+
+  /**
+   * Make the calls recorded in the test list cache.
+   */
+  bool ReplayTestList(cmCTestTestListCache const& cache);
   // compute the lists of tests that will actually run
   // based on union regex and -I stuff
   bool ComputeTestList();
@@ -318,6 +354,10 @@ private:
   // tests to account for fixture setup/cleanup
   void UpdateForFixtures(ListOfTests& tests) const;
 
+  // keep only the tests assigned to the selected shard, balancing the
+  // shards by the costs recorded by previous runs
+  void SelectShard(ListOfTests& tests) const;
+
   void UpdateMaxTestNameWidth();
 
   bool GetValue(const char* tag, std::string& value, std::istream& fin);
@@ -364,6 +404,8 @@ private:
   std::string TestsToRunString;
   bool UseUnion;
   ListOfTests TestList;
+  // Positions in TestList of the tests with each name while reading it
+  std::map<std::string, std::vector<std::size_t>> TestsByName;
   size_t TotalNumberOfTests;
   cmsys::RegularExpression AllTestMeasurementsRegex;
   cmsys::RegularExpression SingleTestMeasurementRegex;
@@ -375,6 +417,9 @@ private:
   cmCTest::Repeat RepeatMode = cmCTest::Repeat::Never;
   int RepeatCount = 1;
   bool RerunFailed;
+  int ShardIndex = 0;
+  int ShardCount = 1;
+  std::string Coordinator;
 
   std::string JUnitXMLFileName;
 };
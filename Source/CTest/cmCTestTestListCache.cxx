@@ -0,0 +1,244 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file Copyright.txt or https://cmake.org/licensing for details.  */
+#include "cmCTestTestListCache.h"
+
+#include <cstdint>
+#include <set>
+#include <utility>
+
+#include "cmsys/FStream.hxx"
+
+#include "cmFileTime.h"
+#include "cmSystemTools.h"
+
+namespace {
+// Bump when the layout of the file changes.
+char const kMagic[] = "CTestTestList1";
+// Flag added to the call type when the directory is not repeated.
+std::uint64_t const kSameDirectory = 0x100;
+
+class Writer
+{
+public:
+  void Integer(std::uint64_t value)
+  {
+    for (int i = 0; i < 8; ++i) {
+      this->Data += static_cast<char>((value >> (8 * i)) & 0xff);
+    }
+  }
+
+  void String(std::string const& value)
+  {
+    this->Integer(value.size());
+    this->Data += value;
+  }
+
+  std::string Data;
+};
+
+class Reader
+{
+public:
+  Reader(std::string data, std::size_t pos)
+    : Data(std::move(data))
+    , Pos(pos)
+  {
+  }
+
+  bool Integer(std::uint64_t& value)
+  {
+    if (this->Data.size() - this->Pos < 8) {
+      return false;
+    }
+    value = 0;
+    for (int i = 0; i < 8; ++i) {
+      value |= static_cast<std::uint64_t>(
+                 static_cast<unsigned char>(this->Data[this->Pos + i]))
+        << (8 * i);
+    }
+    this->Pos += 8;
+    return true;
+  }
+
+  bool String(std::string& value)
+  {
+    std::uint64_t size;
+    if (!this->Integer(size) || this->Data.size() - this->Pos < size) {
+      return false;
+    }
+    value.assign(this->Data, this->Pos, static_cast<std::size_t>(size));
+    this->Pos += static_cast<std::size_t>(size);
+    return true;
+  }
+
+  bool AtEnd() const { return this->Pos == this->Data.size(); }
+
+private:
+  std::string Data;
+  std::size_t Pos;
+};
+}
+
+void cmCTestTestListCache::AddCall(CallType type,
+                                   std::vector<std::string> const& args)
+{
+  this->Calls.push_back(
+    Call{ type, cmSystemTools::GetCurrentWorkingDirectory(), args });
+}
+
+void cmCTestTestListCache::SetInputs(std::vector<std::string> const& files)
+{
+  // Files created next to the ones read, e.g. by a test discovery step,
+  // may change the result of if(EXISTS) checks, so watch the directories
+  // containing them too.
+  std::set<std::string> paths;
+  for (std::string const& file : files) {
+    std::string const path = cmSystemTools::CollapseFullPath(file);
+    paths.insert(path);
+    paths.insert(cmSystemTools::GetFilenamePath(path));
+  }
+  this->Inputs.clear();
+  for (std::string const& path : paths) {
+    cmFileTime time;
+    this->Inputs.push_back(
+      Input{ path, time.Load(path) ? time.GetTime() : -1 });
+  }
+}
+
+bool cmCTestTestListCache::Save(std::string const& file,
+                                std::string const& key) const
+{
+  Writer w;
+  w.Data = kMagic;
+  w.String(key);
+  w.Integer(this->Inputs.size());
+  for (Input const& input : this->Inputs) {
+    w.String(input.Path);
+    w.Integer(static_cast<std::uint64_t>(input.Time));
+  }
+  w.String(this->ResourceSpecFile);
+
+  // Most calls are made from the same directory as the previous one, so
+  // only write the directory when it changes.
+  w.Integer(this->Calls.size());
+  std::string const* directory = nullptr;
+  for (Call const& call : this->Calls) {
+    bool const sameDirectory = directory && *directory == call.Directory;
+    w.Integer(static_cast<std::uint64_t>(call.Type) |
+              (sameDirectory ? kSameDirectory : 0));
+    if (!sameDirectory) {
+      w.String(call.Directory);
+      directory = &call.Directory;
+    }
+    w.Integer(call.Args.size());
+    for (std::string const& arg : call.Args) {
+      w.String(arg);
+    }
+  }
+
+  // Write to a temporary file first so that concurrent runs never see a
+  // partial record.
+  std::string const tmp = file + ".tmp";
+  {
+    cmsys::ofstream fout(tmp.c_str(), std::ios::out | std::ios::binary);
+    if (!fout) {
+      return false;
+    }
+    fout.write(w.Data.data(), static_cast<std::streamsize>(w.Data.size()));
+    if (!fout) {
+      return false;
+    }
+  }
+  return cmSystemTools::RenameFile(tmp, file);
+}
+
+bool cmCTestTestListCache::Load(std::string const& file,
+                                std::string const& key)
+{
+  std::string data;
+  {
+    cmsys::ifstream fin(file.c_str(), std::ios::in | std::ios::binary);
+    if (!fin) {
+      return false;
+    }
+    data.resize(static_cast<std::size_t>(
+      cmSystemTools::FileLength(file)));
+    fin.read(&data[0], static_cast<std::streamsize>(data.size()));
+    if (!fin) {
+      return false;
+    }
+  }
+  std::size_t const magicSize = sizeof(kMagic) - 1;
+  if (data.compare(0, magicSize, kMagic) != 0) {
+    return false;
+  }
+  Reader r(std::move(data), magicSize);
+
+  std::string fileKey;
+  if (!r.String(fileKey) || fileKey != key) {
+    return false;
+  }
+
+  std::uint64_t count;
+  if (!r.Integer(count)) {
+    return false;
+  }
+  std::vector<Input> inputs;
+  for (std::uint64_t i = 0; i < count; ++i) {
+    Input input;
+    std::uint64_t time;
+    if (!r.String(input.Path) || !r.Integer(time)) {
+      return false;
+    }
+    input.Time = static_cast<long long>(time);
+    cmFileTime current;
+    if (!current.Load(input.Path) || current.GetTime() != input.Time) {
+      return false;
+    }
+    inputs.push_back(std::move(input));
+  }
+
+  std::string resourceSpecFile;
+  if (!r.String(resourceSpecFile) || !r.Integer(count)) {
+    return false;
+  }
+  std::vector<Call> calls;
+  for (std::uint64_t i = 0; i < count; ++i) {
+    Call call;
+    std::uint64_t type;
+    std::uint64_t argc;
+    if (!r.Integer(type)) {
+      return false;
+    }
+    if (type & kSameDirectory) {
+      if (calls.empty()) {
+        return false;
+      }
+      call.Directory = calls.back().Directory;
+      type &= ~kSameDirectory;
+    } else if (!r.String(call.Directory)) {
+      return false;
+    }
+    if (type > static_cast<std::uint64_t>(CallType::SetDirectoryProperties) ||
+        !r.Integer(argc)) {
+      return false;
+    }
+    call.Type = static_cast<CallType>(type);
+    for (std::uint64_t j = 0; j < argc; ++j) {
+      std::string arg;
+      if (!r.String(arg)) {
+        return false;
+      }
+      call.Args.push_back(std::move(arg));
+    }
+    calls.push_back(std::move(call));
+  }
+  if (!r.AtEnd()) {
+    return false;
+  }
+
+  this->Inputs = std::move(inputs);
+  this->ResourceSpecFile = std::move(resourceSpecFile);
+  this->Calls = std::move(calls);
+  return true;
+}
@@ -0,0 +1,68 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file Copyright.txt or https://cmake.org/licensing for details.  */
+#pragma once
+
+#include "cmConfigure.h" // IWYU pragma: keep
+
+#include <string>
+#include <vector>
+
+/** \class cmCTestTestListCache
+ * \brief Record of the test list calls made by the CTestTestfile tree.
+ *
+ * Holds the add_test, set_tests_properties and set_directory_properties
+ * calls made while reading CTestTestfile.cmake files, with the directory
+ * each was made from, so they can be replayed without running the files
+ * again.  The record is saved to a binary file together with the
+ * modification times of the files read and the directories containing
+ * them, and is only loaded back while none of these have changed.
+ */
+class cmCTestTestListCache
+{
+public:
+  enum class CallType
+  {
+    AddTest,
+    SetTestsProperties,
+    SetDirectoryProperties,
+  };
+
+  struct Call
+  {
+    CallType Type;
+    std::string Directory;
+    std::vector<std::string> Args;
+  };
+
+  /** Record a call made from the current working directory.  */
+  void AddCall(CallType type, std::vector<std::string> const& args);
+
+  /** Record the files read to make the calls.  */
+  void SetInputs(std::vector<std::string> const& files);
+
+  std::vector<Call> const& GetCalls() const { return this->Calls; }
+
+  std::string ResourceSpecFile;
+
+  /**
+   * Write the record to the given file, keyed by the given string.
+   * Return false on error.
+   */
+  bool Save(std::string const& file, std::string const& key) const;
+
+  /**
+   * Read a record from the given file.  Return false if it cannot be read,
+   * was saved with another key, or any of its inputs changed since.
+   */
+  bool Load(std::string const& file, std::string const& key);
+
+private:
+  struct Input
+  {
+    std::string Path;
+    long long Time;
+  };
+
+  std::vector<Call> Calls;
+  std::vector<Input> Inputs;
+};
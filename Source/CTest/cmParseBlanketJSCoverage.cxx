@@ -117,23 +117,16 @@ bool cmParseBlanketJSCoverage::LoadCoverageData(
   cmCTestOptionalLog(this->CTest, HANDLER_VERBOSE_OUTPUT,
                      "Found " << files.size() << " Files" << std::endl,
                      this->Coverage.Quiet);
-  for (std::string const& file : files) {
-    cmCTestOptionalLog(this->CTest, HANDLER_VERBOSE_OUTPUT,
-                       "Reading JSON File " << file << std::endl,
-                       this->Coverage.Quiet);
-
-    if (!this->ReadJSONFile(file)) {
-      return false;
-    }
-  }
-  return true;
-}
-
-bool cmParseBlanketJSCoverage::ReadJSONFile(std::string const& file)
-{
-  cmParseBlanketJSCoverage::JSONParser parser(this->Coverage);
-  cmCTestOptionalLog(this->CTest, HANDLER_VERBOSE_OUTPUT,
-                     "Parsing " << file << std::endl, this->Coverage.Quiet);
-  parser.ParseFile(file);
-  return true;
+  return this->Coverage.ParseFiles(
+    files,
+    [this](cmCTestCoverageHandlerContainer& cont, std::string const& file) {
+      cmCTestOptionalLog(this->CTest, HANDLER_VERBOSE_OUTPUT,
+                         "Reading JSON File " << file << std::endl,
+                         cont.Quiet);
+      cmParseBlanketJSCoverage::JSONParser parser(cont);
+      cmCTestOptionalLog(this->CTest, HANDLER_VERBOSE_OUTPUT,
+                         "Parsing " << file << std::endl, cont.Quiet);
+      parser.ParseFile(file);
+      return true;
+    });
 }
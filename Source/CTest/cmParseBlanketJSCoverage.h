@@ -29,8 +29,6 @@ public:
   cmParseBlanketJSCoverage(cmCTestCoverageHandlerContainer& cont,
                            cmCTest* ctest);
   bool LoadCoverageData(std::vector<std::string> const& files);
-  //  Read the JSON output
-  bool ReadJSONFile(std::string const& file);
 
 protected:
   class JSONParser;
@@ -1,5 +1,6 @@
 #include "cmParseCacheCoverage.h"
 
+#include <cstddef>
 #include <cstdio>
 #include <cstdlib>
 #include <map>
@@ -53,8 +54,8 @@ void cmParseCacheCoverage::RemoveUnCoveredFiles()
   while (ci != this->Coverage.TotalCoverage.end()) {
     cmCTestCoverageHandlerContainer::SingleFileCoverageVector& v = ci->second;
     bool nothing = true;
-    for (int i : v) {
-      if (i > 0) {
+    for (std::size_t i = 0; i < v.size(); ++i) {
+      if (v[i] > 0) {
         nothing = false;
         break;
       }
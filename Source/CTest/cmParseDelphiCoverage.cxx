@@ -206,27 +206,20 @@ cmParseDelphiCoverage::cmParseDelphiCoverage(
 bool cmParseDelphiCoverage::LoadCoverageData(
   std::vector<std::string> const& files)
 {
-  size_t i;
-  std::string path;
-  size_t numf = files.size();
-  for (i = 0; i < numf; i++) {
-    path = files[i];
-
+  std::vector<std::string> htmlFiles;
+  for (std::string const& path : files) {
     cmCTestOptionalLog(this->CTest, HANDLER_VERBOSE_OUTPUT,
                        "Reading HTML File " << path << std::endl,
                        this->Coverage.Quiet);
     if (cmSystemTools::GetFilenameLastExtension(path) == ".html") {
-      if (!this->ReadDelphiHTML(path.c_str())) {
-        return false;
-      }
+      htmlFiles.push_back(path);
     }
   }
-  return true;
-}
-
-bool cmParseDelphiCoverage::ReadDelphiHTML(const char* file)
-{
-  cmParseDelphiCoverage::HTMLParser parser(this->CTest, this->Coverage);
-  parser.ParseFile(file);
-  return true;
+  return this->Coverage.ParseFiles(
+    htmlFiles,
+    [this](cmCTestCoverageHandlerContainer& cont, std::string const& path) {
+      cmParseDelphiCoverage::HTMLParser parser(this->CTest, cont);
+      parser.ParseFile(path.c_str());
+      return true;
+    });
 }
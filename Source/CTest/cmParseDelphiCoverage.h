@@ -24,7 +24,6 @@ class cmParseDelphiCoverage
 public:
   cmParseDelphiCoverage(cmCTestCoverageHandlerContainer& cont, cmCTest* ctest);
   bool LoadCoverageData(std::vector<std::string> const& files);
-  bool ReadDelphiHTML(const char* file);
   // Read a single HTML file from output
   bool ReadHTMLFile(const char* f);
 
@@ -151,28 +151,20 @@ bool cmParseJacocoCoverage::LoadCoverageData(
   std::vector<std::string> const& files)
 {
   // load all the jacoco.xml files in the source directory
-  cmsys::Directory dir;
-  size_t i;
-  std::string path;
-  size_t numf = files.size();
-  for (i = 0; i < numf; i++) {
-    path = files[i];
-
+  std::vector<std::string> xmlFiles;
+  for (std::string const& path : files) {
     cmCTestOptionalLog(this->CTest, HANDLER_VERBOSE_OUTPUT,
                        "Reading XML File " << path << std::endl,
                        this->Coverage.Quiet);
     if (cmSystemTools::GetFilenameLastExtension(path) == ".xml") {
-      if (!this->ReadJacocoXML(path.c_str())) {
-        return false;
-      }
+      xmlFiles.push_back(path);
     }
   }
-  return true;
-}
-
-bool cmParseJacocoCoverage::ReadJacocoXML(const char* file)
-{
-  cmParseJacocoCoverage::XMLParser parser(this->CTest, this->Coverage);
-  parser.ParseFile(file);
-  return true;
+  return this->Coverage.ParseFiles(
+    xmlFiles,
+    [this](cmCTestCoverageHandlerContainer& cont, std::string const& path) {
+      cmParseJacocoCoverage::XMLParser parser(this->CTest, cont);
+      parser.ParseFile(path.c_str());
+      return true;
+    });
 }
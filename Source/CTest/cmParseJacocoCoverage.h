@@ -34,8 +34,6 @@ private:
   // implement virtual from parent
   // remove files with no coverage
   void RemoveUnCoveredFiles();
-  // Read a single mcov file
-  bool ReadJacocoXML(const char* f);
   // split a string based on ,
   bool SplitString(std::vector<std::string>& args, std::string const& line);
   bool FindJavaFile(std::string const& routine, std::string& filepath);
@@ -2,6 +2,7 @@
 
 #include <cstdlib>
 #include <cstring>
+#include <vector>
 
 #include <cm/memory>
 
@@ -209,14 +210,17 @@ bool cmParsePHPCoverage::ReadPHPCoverageDirectory(const char* d)
   size_t numf;
   unsigned int i;
   numf = dir.GetNumberOfFiles();
+  std::vector<std::string> paths;
   for (i = 0; i < numf; i++) {
     std::string file = dir.GetFile(i);
     if (file != "." && file != ".." && !cmSystemTools::FileIsDirectory(file)) {
-      std::string path = cmStrCat(d, '/', file);
-      if (!this->ReadPHPData(path.c_str())) {
-        return false;
-      }
+      paths.push_back(cmStrCat(d, '/', file));
     }
   }
-  return true;
+  return this->Coverage.ParseFiles(
+    paths,
+    [this](cmCTestCoverageHandlerContainer& cont, std::string const& path) {
+      cmParsePHPCoverage parser(cont, this->CTest);
+      return parser.ReadPHPData(path.c_str());
+    });
 }
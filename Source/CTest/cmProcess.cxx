@@ -18,10 +18,94 @@
 #include "cmStringAlgorithms.h"
 #if defined(_WIN32)
 #  include <cm3p/kwiml/int.h>
+
+#  include <windows.h>
+
+#  include <psapi.h>
+#else
+#  include <cerrno>
+#  include <sstream>
+
+#  include <fcntl.h>
+#  include <unistd.h>
 #endif
 
 #define CM_PROCESS_BUF_SIZE 65536
 
+namespace {
+#if !defined(_WIN32)
+// Descriptor on which "cmake -E cmake_resource_usage" reports.
+int const ResourceUsageFd = 3;
+
+// Parse the report of "cmake -E cmake_resource_usage".  It is missing if
+// the process was killed.
+bool ReadResourceUsage(int fd, uv_rusage_t& usage, int& execError)
+{
+  std::string report;
+  char buf[256];
+  ssize_t n;
+  while ((n = read(fd, buf, sizeof(buf))) > 0 ||
+         (n < 0 && errno == EINTR)) {
+    if (n > 0) {
+      report.append(buf, static_cast<std::size_t>(n));
+    }
+  }
+  std::istringstream in(report);
+  std::string kind;
+  in >> kind;
+  if (kind == "error") {
+    return static_cast<bool>(in >> execError);
+  }
+  long utimeSec;
+  long utimeUsec;
+  long stimeSec;
+  long stimeUsec;
+  usage = uv_rusage_t();
+  if (kind != "usage" ||
+      !(in >> utimeSec >> utimeUsec >> stimeSec >> stimeUsec >>
+        usage.ru_maxrss >> usage.ru_minflt >> usage.ru_majflt >>
+        usage.ru_inblock >> usage.ru_oublock >> usage.ru_nvcsw >>
+        usage.ru_nivcsw)) {
+    return false;
+  }
+  usage.ru_utime.tv_sec = utimeSec;
+  usage.ru_utime.tv_usec = utimeUsec;
+  usage.ru_stime.tv_sec = stimeSec;
+  usage.ru_stime.tv_usec = stimeUsec;
+  return true;
+}
+#elif !defined(CMAKE_USE_SYSTEM_LIBUV)
+bool GetProcessUsage(HANDLE process, uv_rusage_t& usage)
+{
+  FILETIME createTime;
+  FILETIME exitTime;
+  FILETIME kernelTime;
+  FILETIME userTime;
+  PROCESS_MEMORY_COUNTERS memCounters;
+  if (!GetProcessTimes(process, &createTime, &exitTime, &kernelTime,
+                       &userTime) ||
+      !GetProcessMemoryInfo(process, &memCounters, sizeof(memCounters))) {
+    return false;
+  }
+  // The times are given in units of 100 nanoseconds.
+  auto toTimeval = [](FILETIME const& ft, uv_timeval_t& tv) {
+    ULARGE_INTEGER t;
+    t.LowPart = ft.dwLowDateTime;
+    t.HighPart = ft.dwHighDateTime;
+    tv.tv_sec = static_cast<long>(t.QuadPart / 10000000);
+    tv.tv_usec = static_cast<long>(t.QuadPart % 10000000 / 10);
+  };
+  usage = uv_rusage_t();
+  toTimeval(userTime, usage.ru_utime);
+  toTimeval(kernelTime, usage.ru_stime);
+  usage.ru_maxrss = memCounters.PeakWorkingSetSize / 1024;
+  usage.ru_majflt = memCounters.PageFaultCount;
+  return true;
+}
+#endif
+}
+
+
 cmProcess::cmProcess(std::unique_ptr<cmCTestRunTest> runner)
   : Runner(std::move(runner))
   , Conv(cmProcessOutput::UTF8, CM_PROCESS_BUF_SIZE)
@@ -33,7 +117,14 @@ cmProcess::cmProcess(std::unique_ptr<cmCTestRunTest> runner)
   this->StartTime = std::chrono::steady_clock::time_point();
 }
 
-cmProcess::~cmProcess() = default;
+cmProcess::~cmProcess()
+{
+#if !defined(_WIN32)
+  if (this->UsageFd >= 0) {
+    close(this->UsageFd);
+  }
+#endif
+}
 
 void cmProcess::SetCommand(std::string const& command)
 {
@@ -58,6 +149,14 @@ bool cmProcess::StartProcess(uv_loop_t& loop, std::vector<size_t>* affinity)
   }
   this->StartTime = std::chrono::steady_clock::now();
   this->ProcessArgs.clear();
+#if !defined(_WIN32)
+  // The event loop reaps the process without the resources it used, so
+  // run it through cmake, which waits for it and reports them.
+  std::string const& cmakeCommand = cmSystemTools::GetCMakeCommand();
+  this->ProcessArgs.push_back(cmakeCommand.c_str());
+  this->ProcessArgs.push_back("-E");
+  this->ProcessArgs.push_back("cmake_resource_usage");
+#endif
   // put the command as arg0
   this->ProcessArgs.push_back(this->Command.c_str());
   // now put the command arguments in
@@ -93,7 +192,7 @@ bool cmProcess::StartProcess(uv_loop_t& loop, std::vector<size_t>* affinity)
   uv_pipe_open(pipe_reader, fds[0]);
   uv_pipe_open(pipe_writer, fds[1]);
 
-  uv_stdio_container_t stdio[3];
+  uv_stdio_container_t stdio[4];
   stdio[0].flags = UV_INHERIT_FD;
   stdio[0].data.fd = 0;
   stdio[1].flags = UV_INHERIT_STREAM;
@@ -101,9 +200,25 @@ bool cmProcess::StartProcess(uv_loop_t& loop, std::vector<size_t>* affinity)
   stdio[2] = stdio[1];
 
   uv_process_options_t options = uv_process_options_t();
-  options.file = this->Command.data();
+  options.file = this->ProcessArgs[0];
   options.args = const_cast<char**>(this->ProcessArgs.data());
   options.stdio_count = 3; // in, out and err
+#if !defined(_WIN32)
+  int usageFds[2] = { -1, -1 };
+  status = cmGetPipes(usageFds);
+  if (status != 0) {
+    cmCTestLog(this->Runner->GetCTest(), ERROR_MESSAGE,
+               "Error initializing pipe: " << uv_strerror(status)
+                                           << std::endl);
+    return false;
+  }
+  // The report is read after the process exited, so never wait for it.
+  fcntl(usageFds[0], F_SETFL, fcntl(usageFds[0], F_GETFL) | O_NONBLOCK);
+  this->UsageFd = usageFds[0];
+  stdio[ResourceUsageFd].flags = UV_INHERIT_FD;
+  stdio[ResourceUsageFd].data.fd = usageFds[1];
+  options.stdio_count = ResourceUsageFd + 1;
+#endif
   options.exit_cb = &cmProcess::OnExitCB;
   options.stdio = stdio;
 #if !defined(CMAKE_USE_SYSTEM_LIBUV)
@@ -134,6 +249,9 @@ bool cmProcess::StartProcess(uv_loop_t& loop, std::vector<size_t>* affinity)
   }
 
   status = this->Process.spawn(loop, options, this);
+#if !defined(_WIN32)
+  close(usageFds[1]);
+#endif
   if (status != 0) {
     cmCTestLog(this->Runner->GetCTest(), ERROR_MESSAGE,
                "Process not started\n " << this->Command << "\n["
@@ -322,6 +440,29 @@ void cmProcess::OnExit(int64_t exit_status, int term_signal)
   this->ExitValue = exit_status;
   this->Signal = term_signal;
 
+#if !defined(_WIN32)
+  int execError = 0;
+  if (this->UsageFd >= 0) {
+    this->HaveResourceUsage =
+      ReadResourceUsage(this->UsageFd, this->ResourceUsage, execError) &&
+      execError == 0;
+    close(this->UsageFd);
+    this->UsageFd = -1;
+  }
+  if (execError != 0) {
+    // Report the command as not started, as when spawning it fails.
+    int const error = uv_translate_sys_error(execError);
+    cmCTestLog(this->Runner->GetCTest(), ERROR_MESSAGE,
+               "Process not started\n " << this->Command << "\n["
+                                        << uv_strerror(error) << "]\n");
+    this->ProcessState = cmProcess::State::Error;
+  }
+#elif !defined(CMAKE_USE_SYSTEM_LIBUV)
+  uv_process_t const* process = this->Process;
+  this->HaveResourceUsage =
+    GetProcessUsage(process->process_handle, this->ResourceUsage);
+#endif
+
   this->ProcessHandleClosed = true;
   if (this->ReadHandleClosed) {
     uv_timer_stop(this->Timer);
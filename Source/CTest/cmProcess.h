@@ -56,6 +56,12 @@ public:
   void SetId(int id) { this->Id = id; }
   int64_t GetExitValue() const { return this->ExitValue; }
   cmDuration GetTotalTime() { return this->TotalTime; }
+  // Resources used by the exited process, or nullptr if unknown.  The
+  // peak resident set size is given in KiB on all platforms.
+  uv_rusage_t const* GetResourceUsage() const
+  {
+    return this->HaveResourceUsage ? &this->ResourceUsage : nullptr;
+  }
 
   enum class Exception
   {
@@ -126,4 +132,8 @@ private:
   std::vector<const char*> ProcessArgs;
   int Id;
   int64_t ExitValue;
+  uv_rusage_t ResourceUsage;
+  bool HaveResourceUsage = false;
+  // Read end of the pipe on which the resources used are reported.
+  int UsageFd = -1;
 };
@@ -2,19 +2,28 @@
    file Copyright.txt or https://cmake.org/licensing for details.  */
 #include "cmArchiveWrite.h"
 
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
 #include <cstdlib>
 #include <cstring>
 #include <ctime>
+#include <deque>
 #include <iostream>
 #include <limits>
+#include <mutex>
 #include <sstream>
 #include <string>
 #include <thread>
+#include <utility>
+#include <vector>
 
 #include <cm/algorithm>
+#include <cm/memory>
 
 #include <cm3p/archive.h>
 #include <cm3p/archive_entry.h>
+#include <cm3p/zlib.h>
 
 #include "cmsys/Directory.hxx"
 #include "cmsys/Encoding.hxx"
@@ -71,6 +80,390 @@ public:
   operator struct archive_entry*() { return this->Object; }
 };
 
+// Compress a gzip stream on multiple threads.  The input is cut into
+// blocks compressed independently, each primed with the end of the block
+// before it like pigz does, and the compressed blocks are written out in
+// order as one deflate stream.
+class cmArchiveWrite::GZipStream
+{
+public:
+  GZipStream(std::ostream& os, int level, unsigned int threads,
+             std::uint32_t mtime);
+  ~GZipStream();
+  GZipStream(const GZipStream&) = delete;
+  GZipStream& operator=(const GZipStream&) = delete;
+
+  bool Write(const char* data, size_t size);
+  bool Finish();
+
+private:
+  struct Block
+  {
+    std::string Input;
+    std::string Dictionary;
+    std::string Output;
+    uLong Crc = 0;
+    bool Last = false;
+    bool Done = false;
+    bool Failed = false;
+  };
+
+  static size_t const BlockSize = 128 * 1024;
+  static size_t const DictionarySize = 32 * 1024;
+
+  void Submit(bool last);
+  bool WriteOldest();
+  void Work();
+  static bool Compress(z_stream& strm, Block& block);
+
+  std::ostream& Stream;
+  int Level;
+  size_t MaxPending;
+  std::string Input;
+  std::string Dictionary;
+  uLong Crc;
+  std::uint32_t Size = 0;
+  bool Okay = true;
+  bool Finished = false;
+
+  std::mutex Mutex;
+  std::condition_variable Queued;
+  std::condition_variable Compressed;
+  std::deque<std::unique_ptr<Block>> Pending;
+  std::deque<Block*> Queue;
+  bool Stop = false;
+  std::vector<std::thread> Threads;
+};
+
+cmArchiveWrite::GZipStream::GZipStream(std::ostream& os, int level,
+                                       unsigned int threads,
+                                       std::uint32_t mtime)
+  : Stream(os)
+  , Level(level)
+  , MaxPending(2 * threads)
+  , Crc(crc32(0L, Z_NULL, 0))
+{
+  int xfl = 0;
+  if (level == 9) {
+    xfl = 2;
+  } else if (level == 1) {
+    xfl = 4;
+  }
+  // Member header with no file name and the Unix OS code.
+  char const header[10] = {
+    '\x1f',
+    '\x8b',
+    8,
+    0,
+    static_cast<char>(mtime & 0xff),
+    static_cast<char>((mtime >> 8) & 0xff),
+    static_cast<char>((mtime >> 16) & 0xff),
+    static_cast<char>((mtime >> 24) & 0xff),
+    static_cast<char>(xfl),
+    3,
+  };
+  this->Okay = static_cast<bool>(this->Stream.write(header, sizeof(header)));
+
+  this->Input.reserve(BlockSize);
+  this->Threads.reserve(threads);
+  for (unsigned int i = 0; i < threads; ++i) {
+    this->Threads.emplace_back(&GZipStream::Work, this);
+  }
+}
+
+cmArchiveWrite::GZipStream::~GZipStream()
+{
+  {
+    std::lock_guard<std::mutex> lock(this->Mutex);
+    this->Stop = true;
+  }
+  this->Queued.notify_all();
+  for (std::thread& thread : this->Threads) {
+    thread.join();
+  }
+}
+
+bool cmArchiveWrite::GZipStream::Write(const char* data, size_t size)
+{
+  while (size > 0 && this->Okay) {
+    size_t const n = std::min(size, BlockSize - this->Input.size());
+    this->Input.append(data, n);
+    data += n;
+    size -= n;
+    if (this->Input.size() == BlockSize) {
+      this->Submit(false);
+    }
+  }
+  return this->Okay;
+}
+
+bool cmArchiveWrite::GZipStream::Finish()
+{
+  if (this->Finished) {
+    return this->Okay;
+  }
+  this->Finished = true;
+  if (this->Okay) {
+    this->Submit(true);
+  }
+  while (!this->Pending.empty() && this->WriteOldest()) {
+  }
+  if (this->Okay) {
+    char trailer[8];
+    for (int i = 0; i < 4; ++i) {
+      trailer[i] = static_cast<char>((this->Crc >> (8 * i)) & 0xff);
+      trailer[4 + i] = static_cast<char>((this->Size >> (8 * i)) & 0xff);
+    }
+    this->Okay =
+      static_cast<bool>(this->Stream.write(trailer, sizeof(trailer)));
+  }
+  return this->Okay;
+}
+
+void cmArchiveWrite::GZipStream::Submit(bool last)
+{
+  auto block = cm::make_unique<Block>();
+  block->Input = std::move(this->Input);
+  block->Dictionary = this->Dictionary;
+  block->Last = last;
+  if (block->Input.size() >= DictionarySize) {
+    this->Dictionary =
+      block->Input.substr(block->Input.size() - DictionarySize);
+  } else {
+    this->Dictionary += block->Input;
+    if (this->Dictionary.size() > DictionarySize) {
+      this->Dictionary.erase(0, this->Dictionary.size() - DictionarySize);
+    }
+  }
+  this->Input.clear();
+  this->Input.reserve(BlockSize);
+
+  while (this->Pending.size() >= this->MaxPending && this->WriteOldest()) {
+  }
+  {
+    std::lock_guard<std::mutex> lock(this->Mutex);
+    this->Queue.push_back(block.get());
+    this->Pending.push_back(std::move(block));
+  }
+  this->Queued.notify_one();
+}
+
+bool cmArchiveWrite::GZipStream::WriteOldest()
+{
+  std::unique_ptr<Block> block;
+  {
+    std::unique_lock<std::mutex> lock(this->Mutex);
+    this->Compressed.wait(lock,
+                          [this] { return this->Pending.front()->Done; });
+    block = std::move(this->Pending.front());
+    this->Pending.pop_front();
+  }
+  if (block->Failed) {
+    this->Okay = false;
+  }
+  if (this->Okay) {
+    this->Crc = crc32_combine(this->Crc, block->Crc,
+                              static_cast<z_off_t>(block->Input.size()));
+    this->Size += static_cast<std::uint32_t>(block->Input.size());
+    this->Okay = static_cast<bool>(this->Stream.write(
+      block->Output.data(),
+      static_cast<std::streamsize>(block->Output.size())));
+  }
+  return this->Okay;
+}
+
+void cmArchiveWrite::GZipStream::Work()
+{
+  z_stream strm;
+  memset(&strm, 0, sizeof(strm));
+  bool const initialized = deflateInit2(&strm, this->Level, Z_DEFLATED, -15,
+                                        8, Z_DEFAULT_STRATEGY) == Z_OK;
+  std::unique_lock<std::mutex> lock(this->Mutex);
+  for (;;) {
+    this->Queued.wait(lock,
+                      [this] { return this->Stop || !this->Queue.empty(); });
+    if (this->Queue.empty()) {
+      break;
+    }
+    Block* block = this->Queue.front();
+    this->Queue.pop_front();
+    lock.unlock();
+    block->Failed = !initialized || !Compress(strm, *block);
+    lock.lock();
+    block->Done = true;
+    this->Compressed.notify_all();
+  }
+  lock.unlock();
+  if (initialized) {
+    deflateEnd(&strm);
+  }
+}
+
+bool cmArchiveWrite::GZipStream::Compress(z_stream& strm, Block& block)
+{
+  if (deflateReset(&strm) != Z_OK) {
+    return false;
+  }
+  if (!block.Dictionary.empty() &&
+      deflateSetDictionary(
+        &strm, reinterpret_cast<Bytef const*>(block.Dictionary.data()),
+        static_cast<uInt>(block.Dictionary.size())) != Z_OK) {
+    return false;
+  }
+  uInt const size = static_cast<uInt>(block.Input.size());
+  block.Crc = crc32(crc32(0L, Z_NULL, 0),
+                    reinterpret_cast<Bytef const*>(block.Input.data()), size);
+
+  // Blocks other than the last end on a byte boundary with an empty
+  // stored block so that the next block's output can follow them.
+  int const flush = block.Last ? Z_FINISH : Z_SYNC_FLUSH;
+  strm.next_in = reinterpret_cast<Bytef*>(&block.Input[0]);
+  strm.avail_in = size;
+  block.Output.resize(deflateBound(&strm, size) + 16);
+  size_t have = 0;
+  for (;;) {
+    strm.next_out = reinterpret_cast<Bytef*>(&block.Output[have]);
+    strm.avail_out = static_cast<uInt>(block.Output.size() - have);
+    int const r = deflate(&strm, flush);
+    have = block.Output.size() - strm.avail_out;
+    if (r == Z_STREAM_ERROR) {
+      return false;
+    }
+    if (block.Last ? r == Z_STREAM_END
+                   : (strm.avail_in == 0 && strm.avail_out != 0)) {
+      break;
+    }
+    block.Output.resize(2 * block.Output.size());
+  }
+  block.Output.resize(have);
+  return true;
+}
+
+// Read files on other threads ahead of them being added.  Small regular
+// files are read whole, a bounded number of them ahead of the writer, and
+// the others are left to be read when they are added.
+class cmArchiveWrite::ReadAhead
+{
+public:
+  ReadAhead(std::vector<std::string> paths, unsigned int threads);
+  ~ReadAhead();
+  ReadAhead(const ReadAhead&) = delete;
+  ReadAhead& operator=(const ReadAhead&) = delete;
+
+  // If the path is the next one expected, wait for it and return whether
+  // its content was read.
+  bool Take(std::string const& path, std::string& content);
+
+private:
+  struct File
+  {
+    std::string Content;
+    bool Done = false;
+    bool Read = false;
+  };
+
+  static size_t const MaxFileSize = 1024 * 1024;
+  static size_t const MaxFilesAhead = 64;
+
+  void Work();
+  static bool ReadFile(std::string const& path, std::string& content);
+
+  std::vector<std::string> Paths;
+  std::vector<File> Files;
+  size_t Next = 0;
+  size_t Taken = 0;
+  bool Stop = false;
+
+  std::mutex Mutex;
+  std::condition_variable Changed;
+  std::vector<std::thread> Threads;
+};
+
+cmArchiveWrite::ReadAhead::ReadAhead(std::vector<std::string> paths,
+                                     unsigned int threads)
+  : Paths(std::move(paths))
+  , Files(this->Paths.size())
+{
+  threads = std::min<unsigned int>(
+    threads, static_cast<unsigned int>(this->Paths.size()));
+  this->Threads.reserve(threads);
+  for (unsigned int i = 0; i < threads; ++i) {
+    this->Threads.emplace_back(&ReadAhead::Work, this);
+  }
+}
+
+cmArchiveWrite::ReadAhead::~ReadAhead()
+{
+  {
+    std::lock_guard<std::mutex> lock(this->Mutex);
+    this->Stop = true;
+  }
+  this->Changed.notify_all();
+  for (std::thread& thread : this->Threads) {
+    thread.join();
+  }
+}
+
+bool cmArchiveWrite::ReadAhead::Take(std::string const& path,
+                                     std::string& content)
+{
+  std::unique_lock<std::mutex> lock(this->Mutex);
+  if (this->Taken >= this->Paths.size() || this->Paths[this->Taken] != path) {
+    return false;
+  }
+  File& file = this->Files[this->Taken];
+  this->Changed.wait(lock, [&file] { return file.Done; });
+  content = std::move(file.Content);
+  file.Content.clear();
+  ++this->Taken;
+  this->Changed.notify_all();
+  return file.Read;
+}
+
+void cmArchiveWrite::ReadAhead::Work()
+{
+  std::unique_lock<std::mutex> lock(this->Mutex);
+  for (;;) {
+    this->Changed.wait(lock, [this] {
+      return this->Stop || this->Next >= this->Paths.size() ||
+        this->Next < this->Taken + MaxFilesAhead;
+    });
+    if (this->Stop || this->Next >= this->Paths.size()) {
+      break;
+    }
+    size_t const i = this->Next++;
+    lock.unlock();
+    std::string content;
+    bool const read = ReadFile(this->Paths[i], content);
+    lock.lock();
+    this->Files[i].Content = std::move(content);
+    this->Files[i].Read = read;
+    this->Files[i].Done = true;
+    this->Changed.notify_all();
+  }
+}
+
+bool cmArchiveWrite::ReadAhead::ReadFile(std::string const& path,
+                                         std::string& content)
+{
+  // The content of symlinks is not archived.
+  if (cmSystemTools::FileIsSymlink(path)) {
+    return false;
+  }
+  cmsys::ifstream fin(path.c_str(), std::ios::in | std::ios::binary);
+  if (!fin) {
+    return false;
+  }
+  char buffer[16384];
+  while (fin.read(buffer, sizeof(buffer)) || fin.gcount() > 0) {
+    content.append(buffer, static_cast<size_t>(fin.gcount()));
+    if (content.size() > MaxFileSize) {
+      return false;
+    }
+  }
+  return true;
+}
+
 struct cmArchiveWrite::Callback
 {
   // archive_write_callback
@@ -78,6 +471,12 @@ struct cmArchiveWrite::Callback
                             const void* b, size_t n)
   {
     cmArchiveWrite* self = static_cast<cmArchiveWrite*>(cd);
+    if (self->GZip) {
+      if (self->GZip->Write(static_cast<const char*>(b), n)) {
+        return static_cast<__LA_SSIZE_T>(n);
+      }
+      return static_cast<__LA_SSIZE_T>(-1);
+    }
     if (self->Stream.write(static_cast<const char*>(b),
                            static_cast<std::streamsize>(n))) {
       return static_cast<__LA_SSIZE_T>(n);
@@ -105,6 +504,7 @@ cmArchiveWrite::cmArchiveWrite(std::ostream& os, Compress c,
       cm::clamp<int>(std::thread::hardware_concurrency(), 1, upperLimit);
   }
 
+  this->Threads = numThreads;
   std::string sNumThreads = std::to_string(numThreads);
 
   switch (c) {
@@ -123,13 +523,34 @@ cmArchiveWrite::cmArchiveWrite(std::ostream& os, Compress c,
       }
       break;
     case CompressGZip: {
+      std::string source_date_epoch;
+      cmSystemTools::GetEnv("SOURCE_DATE_EPOCH", source_date_epoch);
+      if (numThreads > 1) {
+        // Compress in parallel ourselves on the uncompressed archive.
+        if (compressionLevel < 0 || compressionLevel > 9) {
+          this->Error = cmStrCat("gzip compression level out of range: ",
+                                 compressionLevel);
+          return;
+        }
+        if (archive_write_add_filter_none(this->Archive) != ARCHIVE_OK) {
+          this->Error = cmStrCat("archive_write_add_filter_none: ",
+                                 cm_archive_error_string(this->Archive));
+          return;
+        }
+        // Like libarchive, omit the timestamp when the date is fixed.
+        std::uint32_t const mtime = source_date_epoch.empty()
+          ? static_cast<std::uint32_t>(time(nullptr))
+          : 0;
+        this->GZip = cm::make_unique<GZipStream>(
+          os, compressionLevel != 0 ? compressionLevel : Z_DEFAULT_COMPRESSION,
+          static_cast<unsigned int>(numThreads), mtime);
+        break;
+      }
       if (archive_write_add_filter_gzip(this->Archive) != ARCHIVE_OK) {
         this->Error = cmStrCat("archive_write_add_filter_gzip: ",
                                cm_archive_error_string(this->Archive));
         return;
       }
-      std::string source_date_epoch;
-      cmSystemTools::GetEnv("SOURCE_DATE_EPOCH", source_date_epoch);
       if (!source_date_epoch.empty()) {
         // We're not able to specify an arbitrary timestamp for gzip.
         // The next best thing is to omit the timestamp entirely.
@@ -207,7 +628,9 @@ cmArchiveWrite::cmArchiveWrite(std::ostream& os, Compress c,
       case CompressCompress:
         break;
       case CompressGZip:
-        archiveFilterName = "gzip";
+        if (!this->GZip) {
+          archiveFilterName = "gzip";
+        }
         break;
       case CompressBZip2:
         archiveFilterName = "bzip2";
@@ -274,32 +697,72 @@ bool cmArchiveWrite::Open()
 
 cmArchiveWrite::~cmArchiveWrite()
 {
+  bool const okay = this->Okay();
+  if (!this->Close() && okay) {
+    cmSystemTools::Error(this->Error);
+  }
   archive_read_free(this->Disk);
   archive_write_free(this->Archive);
 }
 
+bool cmArchiveWrite::Close()
+{
+  if (this->Closed) {
+    return this->Okay();
+  }
+  this->Closed = true;
+  if (archive_write_close(this->Archive) != ARCHIVE_OK && this->Okay()) {
+    this->Error = cmStrCat("archive_write_close: ",
+                           cm_archive_error_string(this->Archive));
+  }
+  if (this->GZip && !this->GZip->Finish() && this->Okay()) {
+    this->Error = cmStrCat("Problem writing compressed archive: ",
+                           cmSystemTools::GetLastSystemError());
+  }
+  return this->Okay();
+}
+
 bool cmArchiveWrite::Add(std::string path, size_t skip, const char* prefix,
                          bool recursive)
 {
   if (!path.empty() && path.back() == '/') {
     path.erase(path.size() - 1);
   }
-  this->AddPath(path.c_str(), skip, prefix, recursive);
+  std::vector<std::string> paths;
+  this->CollectPaths(path, recursive, paths);
+
+  std::unique_ptr<ReadAhead> readAhead;
+  if (this->Threads > 1 && paths.size() > 1) {
+    readAhead = cm::make_unique<ReadAhead>(
+      paths, static_cast<unsigned int>(this->Threads));
+  }
+  for (std::string const& p : paths) {
+    if (!this->AddFile(p.c_str(), skip, prefix,
+                       readAhead ? readAhead.get() : this->Prefetched.get())) {
+      break;
+    }
+  }
   return this->Okay();
 }
 
-bool cmArchiveWrite::AddPath(const char* path, size_t skip, const char* prefix,
-                             bool recursive)
+void cmArchiveWrite::PrefetchFiles(std::vector<std::string> paths)
 {
-  if (strcmp(path, ".") != 0 ||
-      (this->Format != "zip" && this->Format != "7zip")) {
-    if (!this->AddFile(path, skip, prefix)) {
-      return false;
-    }
+  this->Prefetched.reset();
+  if (this->Threads > 1 && !paths.empty()) {
+    this->Prefetched = cm::make_unique<ReadAhead>(
+      std::move(paths), static_cast<unsigned int>(this->Threads));
+  }
+}
+
+void cmArchiveWrite::CollectPaths(std::string const& path, bool recursive,
+                                  std::vector<std::string>& paths)
+{
+  if (path != "." || (this->Format != "zip" && this->Format != "7zip")) {
+    paths.push_back(path);
   }
   if ((!cmSystemTools::FileIsDirectory(path) || !recursive) ||
       cmSystemTools::FileIsSymlink(path)) {
-    return true;
+    return;
   }
   cmsys::Directory d;
   if (d.Load(path)) {
@@ -314,18 +777,18 @@ bool cmArchiveWrite::AddPath(const char* path, size_t skip, const char* prefix,
       if (strcmp(file, ".") != 0 && strcmp(file, "..") != 0) {
         next.erase(end);
         next += file;
-        if (!this->AddPath(next.c_str(), skip, prefix)) {
-          return false;
-        }
+        this->CollectPaths(next, true, paths);
       }
     }
   }
-  return true;
 }
 
-bool cmArchiveWrite::AddFile(const char* file, size_t skip, const char* prefix)
+bool cmArchiveWrite::AddFile(const char* file, size_t skip, const char* prefix,
+                             ReadAhead* readAhead)
 {
   this->Error = "";
+  std::string content;
+  bool const prefetched = readAhead && readAhead->Take(file, content);
   // Skip the file if we have no name for it.  This may happen on a
   // top-level directory, which does not need to be included anyway.
   if (skip >= strlen(file)) {
@@ -419,6 +882,15 @@ bool cmArchiveWrite::AddFile(const char* file, size_t skip, const char* prefix)
   if (!archive_entry_symlink(e)) {
     // Content.
     if (size_t size = static_cast<size_t>(archive_entry_size(e))) {
+      if (prefetched && content.size() == size) {
+        if (archive_write_data(this->Archive, content.data(), size) !=
+            static_cast<__LA_SSIZE_T>(size)) {
+          this->Error = cmStrCat("archive_write_data: ",
+                                 cm_archive_error_string(this->Archive));
+          return false;
+        }
+        return true;
+      }
       return this->AddData(file, size);
     }
   }
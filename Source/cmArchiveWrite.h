@@ -6,7 +6,9 @@
 
 #include <cstddef>
 #include <iosfwd>
+#include <memory>
 #include <string>
+#include <vector>
 
 #if defined(CMAKE_BOOTSTRAP)
 #  error "cmArchiveWrite not allowed during bootstrap build!"
@@ -36,6 +38,10 @@ private:
 /** \class cmArchiveWrite
  * \brief Wrapper around libarchive for writing.
  *
+ * When more than one thread is requested, files are read ahead of the
+ * archive on other threads, and gzip compression is done on blocks of
+ * the archive in parallel like pigz does.  Other compression filters use
+ * the threads libarchive gives them.
  */
 class cmArchiveWrite
 {
@@ -64,6 +70,13 @@ public:
 
   bool Open();
 
+  /**
+   * Finish writing the archive and report whether that succeeded.  The
+   * destructor finishes an archive that was not closed and reports any
+   * error then.
+   */
+  bool Close();
+
   /**
    * Add a path (file or directory) to the archive.  Directories are
    * added recursively.  The "path" must be readable on disk, either
@@ -75,6 +88,14 @@ public:
   bool Add(std::string path, size_t skip = 0, const char* prefix = nullptr,
            bool recursive = true);
 
+  /**
+   * Start reading the given paths on other threads, if more than one
+   * thread was requested, so that their content is ready when they are
+   * added.  The paths must then be added in the same order, each with
+   * a non-recursive call to Add.
+   */
+  void PrefetchFiles(std::vector<std::string> paths);
+
   /** Returns true if there has been no error.  */
   explicit operator bool() const { return this->Okay(); }
 
@@ -142,20 +163,27 @@ public:
   }
 
 private:
+  class Entry;
+  class GZipStream;
+  class ReadAhead;
+
   bool Okay() const { return this->Error.empty(); }
-  bool AddPath(const char* path, size_t skip, const char* prefix,
-               bool recursive = true);
-  bool AddFile(const char* file, size_t skip, const char* prefix);
+  void CollectPaths(std::string const& path, bool recursive,
+                    std::vector<std::string>& paths);
+  bool AddFile(const char* file, size_t skip, const char* prefix,
+               ReadAhead* readAhead);
   bool AddData(const char* file, size_t size);
 
   struct Callback;
   friend struct Callback;
 
-  class Entry;
-
   std::ostream& Stream;
   struct archive* Archive;
   struct archive* Disk;
+  int Threads = 1;
+  std::unique_ptr<GZipStream> GZip;
+  bool Closed = false;
+  std::unique_ptr<ReadAhead> Prefetched;
   bool Verbose = false;
   std::string Format;
   std::string Error;
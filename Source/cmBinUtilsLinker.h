@@ -4,6 +4,7 @@
 #pragma once
 
 #include <string>
+#include <vector>
 
 #include "cmStateTypes.h"
 
@@ -20,6 +21,9 @@ public:
   virtual bool ScanDependencies(std::string const& file,
                                 cmStateEnums::TargetType type) = 0;
 
+  /** Hint that the given files are about to be scanned.  */
+  virtual void PrefetchFiles(std::vector<std::string> const& /*files*/) {}
+
 protected:
   cmRuntimeDependencyArchive* Archive;
 
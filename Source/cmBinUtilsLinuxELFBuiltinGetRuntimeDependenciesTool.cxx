@@ -0,0 +1,118 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file Copyright.txt or https://cmake.org/licensing for details.  */
+
+#include "cmBinUtilsLinuxELFBuiltinGetRuntimeDependenciesTool.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+
+#include <cmext/algorithm>
+
+#if !defined(CMAKE_BOOTSTRAP)
+#  include <atomic>
+#  include <thread>
+#endif
+
+#include "cmELF.h"
+#include "cmRuntimeDependencyArchive.h"
+#include "cmStringAlgorithms.h"
+#include "cmSystemTools.h"
+
+cmBinUtilsLinuxELFBuiltinGetRuntimeDependenciesTool::
+  cmBinUtilsLinuxELFBuiltinGetRuntimeDependenciesTool(
+    cmRuntimeDependencyArchive* archive)
+  : cmBinUtilsLinuxELFGetRuntimeDependenciesTool(archive)
+{
+}
+
+bool cmBinUtilsLinuxELFBuiltinGetRuntimeDependenciesTool::GetFileInfo(
+  std::string const& file, std::vector<std::string>& needed,
+  std::vector<std::string>& rpaths, std::vector<std::string>& runpaths)
+{
+  FileInfo info;
+  auto it = this->Prefetched.find(file);
+  if (it != this->Prefetched.end()) {
+    info = std::move(it->second);
+    this->Prefetched.erase(it);
+  } else {
+    ReadFileInfo(file, info);
+  }
+
+  if (!info.Error.empty()) {
+    this->SetError(info.Error);
+    return false;
+  }
+  cm::append(needed, info.Needed);
+  cm::append(rpaths, info.RPaths);
+  cm::append(runpaths, info.RunPaths);
+  return true;
+}
+
+void cmBinUtilsLinuxELFBuiltinGetRuntimeDependenciesTool::PrefetchFileInfo(
+  std::vector<std::string> const& files)
+{
+#if !defined(CMAKE_BOOTSTRAP)
+  std::vector<std::string> pending;
+  for (std::string const& file : files) {
+    if (this->Prefetched.find(file) == this->Prefetched.end() &&
+        std::find(pending.begin(), pending.end(), file) == pending.end()) {
+      pending.push_back(file);
+    }
+  }
+  if (pending.size() < 2) {
+    // Nothing to gain over reading the file when it is requested.
+    return;
+  }
+
+  // Each file is parsed independently, so the threads share nothing but
+  // the index of the next file to parse.
+  std::vector<FileInfo> infos(pending.size());
+  std::atomic<std::size_t> next(0);
+  auto work = [&pending, &infos, &next]() {
+    for (std::size_t i = next++; i < pending.size(); i = next++) {
+      ReadFileInfo(pending[i], infos[i]);
+    }
+  };
+  std::size_t const threadCount = std::min<std::size_t>(
+    std::max(std::thread::hardware_concurrency(), 1u), pending.size());
+  std::vector<std::thread> threads;
+  threads.reserve(threadCount - 1);
+  for (std::size_t i = 1; i < threadCount; ++i) {
+    threads.emplace_back(work);
+  }
+  work();
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+
+  for (std::size_t i = 0; i < pending.size(); ++i) {
+    this->Prefetched.emplace(std::move(pending[i]), std::move(infos[i]));
+  }
+#else
+  static_cast<void>(files);
+#endif
+}
+
+void cmBinUtilsLinuxELFBuiltinGetRuntimeDependenciesTool::ReadFileInfo(
+  std::string const& file, FileInfo& info)
+{
+  cmELF elf(file.c_str());
+  if (!elf) {
+    info.Error = cmStrCat("Failed to read ELF file:\n  ", file, "\n",
+                          elf.GetErrorMessage());
+    return;
+  }
+
+  info.Needed = elf.GetNeeded();
+  if (cmELF::StringEntry const* se = elf.GetRPath()) {
+    info.RPaths = cmSystemTools::SplitString(se->Value, ':');
+  }
+  if (cmELF::StringEntry const* se = elf.GetRunPath()) {
+    info.RunPaths = cmSystemTools::SplitString(se->Value, ':');
+  }
+  if (!elf) {
+    info.Error = cmStrCat("Failed to read ELF file:\n  ", file, "\n",
+                          elf.GetErrorMessage());
+  }
+}
@@ -0,0 +1,45 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file Copyright.txt or https://cmake.org/licensing for details.  */
+
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "cmBinUtilsLinuxELFGetRuntimeDependenciesTool.h"
+
+class cmRuntimeDependencyArchive;
+
+/** \class cmBinUtilsLinuxELFBuiltinGetRuntimeDependenciesTool
+ * \brief Read the dynamic section of ELF files with cmELF.
+ *
+ * No external process is run.  Files named in a prefetch are parsed on
+ * multiple threads and kept until their information is requested.
+ */
+class cmBinUtilsLinuxELFBuiltinGetRuntimeDependenciesTool
+  : public cmBinUtilsLinuxELFGetRuntimeDependenciesTool
+{
+public:
+  cmBinUtilsLinuxELFBuiltinGetRuntimeDependenciesTool(
+    cmRuntimeDependencyArchive* archive);
+
+  bool GetFileInfo(std::string const& file, std::vector<std::string>& needed,
+                   std::vector<std::string>& rpaths,
+                   std::vector<std::string>& runpaths) override;
+
+  void PrefetchFileInfo(std::vector<std::string> const& files) override;
+
+private:
+  struct FileInfo
+  {
+    std::string Error;
+    std::vector<std::string> Needed;
+    std::vector<std::string> RPaths;
+    std::vector<std::string> RunPaths;
+  };
+
+  static void ReadFileInfo(std::string const& file, FileInfo& info);
+
+  std::map<std::string, FileInfo> Prefetched;
+};
@@ -20,6 +20,12 @@ public:
                            std::vector<std::string>& rpaths,
                            std::vector<std::string>& runpaths) = 0;
 
+  /** Hint that the information of the given files will be requested
+      soon, so that a tool able to read them concurrently can do so.  */
+  virtual void PrefetchFileInfo(std::vector<std::string> const& /*files*/)
+  {
+  }
+
 protected:
   cmRuntimeDependencyArchive* Archive;
 
@@ -3,13 +3,16 @@
 
 #include "cmBinUtilsLinuxELFLinker.h"
 
+#include <cstddef>
 #include <sstream>
+#include <utility>
 
 #include <cm/memory>
 #include <cm/string_view>
 
 #include <cmsys/RegularExpression.hxx>
 
+#include "cmBinUtilsLinuxELFBuiltinGetRuntimeDependenciesTool.h"
 #include "cmBinUtilsLinuxELFObjdumpGetRuntimeDependenciesTool.h"
 #include "cmELF.h"
 #include "cmLDConfigLDConfigTool.h"
@@ -58,6 +61,10 @@ bool cmBinUtilsLinuxELFLinker::Prepare()
     this->Tool =
       cm::make_unique<cmBinUtilsLinuxELFObjdumpGetRuntimeDependenciesTool>(
         this->Archive);
+  } else if (tool == "builtin") {
+    this->Tool =
+      cm::make_unique<cmBinUtilsLinuxELFBuiltinGetRuntimeDependenciesTool>(
+        this->Archive);
   } else {
     std::ostringstream e;
     e << "Invalid value for CMAKE_GET_RUNTIME_DEPENDENCIES_TOOL: " << tool;
@@ -100,6 +107,8 @@ bool cmBinUtilsLinuxELFLinker::ScanDependencies(
       }
     } else {
       this->Machine = elf.GetMachine();
+      // Candidates were checked against no architecture so far.
+      this->Resolutions.clear();
     }
   }
 
@@ -109,64 +118,125 @@ bool cmBinUtilsLinuxELFLinker::ScanDependencies(
 bool cmBinUtilsLinuxELFLinker::ScanDependencies(
   std::string const& file, std::vector<std::string> const& parentRpaths)
 {
-  std::string origin = cmSystemTools::GetFilenamePath(file);
-  std::vector<std::string> needed;
-  std::vector<std::string> rpaths;
-  std::vector<std::string> runpaths;
-  if (!this->Tool->GetFileInfo(file, needed, rpaths, runpaths)) {
+  FileInfo const* info = this->GetFileInfo(file);
+  if (!info) {
     return false;
   }
-  for (auto& runpath : runpaths) {
-    runpath = ReplaceOrigin(runpath, origin);
-  }
-  for (auto& rpath : rpaths) {
-    rpath = ReplaceOrigin(rpath, origin);
-  }
 
   std::vector<std::string> searchPaths;
-  if (!runpaths.empty()) {
-    searchPaths = runpaths;
+  if (!info->RunPaths.empty()) {
+    searchPaths = info->RunPaths;
   } else {
-    searchPaths = rpaths;
+    searchPaths = info->RPaths;
     searchPaths.insert(searchPaths.end(), parentRpaths.begin(),
                        parentRpaths.end());
   }
 
-  std::vector<std::string> ldConfigPaths;
-  if (!this->LDConfigTool->GetLDConfigPaths(ldConfigPaths)) {
+  if (!this->GetLDConfigPaths()) {
     return false;
   }
-  searchPaths.insert(searchPaths.end(), ldConfigPaths.begin(),
-                     ldConfigPaths.end());
+  searchPaths.insert(searchPaths.end(), this->LDConfigPaths.begin(),
+                     this->LDConfigPaths.end());
 
-  for (auto const& dep : needed) {
-    if (!this->Archive->IsPreExcluded(dep)) {
-      std::string path;
-      bool resolved = false;
-      if (dep.find('/') != std::string::npos) {
+  // Resolve all dependencies first so that the files they resolve to can
+  // be read together before descending into each of them in turn.
+  std::vector<Resolution const*> resolutions(info->Needed.size());
+  std::vector<std::string> prefetch;
+  for (std::size_t i = 0; i < info->Needed.size(); ++i) {
+    std::string const& dep = info->Needed[i];
+    if (this->Archive->IsPreExcluded(dep) ||
+        dep.find('/') != std::string::npos) {
+      continue;
+    }
+    resolutions[i] = &this->ResolveDependency(dep, searchPaths);
+    std::string const& path = resolutions[i]->Path;
+    if (resolutions[i]->Resolved &&
+        this->FileInfos.find(path) == this->FileInfos.end() &&
+        !this->Archive->IsPostExcluded(path)) {
+      prefetch.push_back(path);
+    }
+  }
+  this->Tool->PrefetchFileInfo(prefetch);
+
+  for (std::size_t i = 0; i < info->Needed.size(); ++i) {
+    std::string const& dep = info->Needed[i];
+    Resolution const* resolution = resolutions[i];
+    if (!resolution) {
+      if (dep.find('/') != std::string::npos &&
+          !this->Archive->IsPreExcluded(dep)) {
         this->SetError("Paths to dependencies are not supported");
         return false;
       }
-      if (!this->ResolveDependency(dep, searchPaths, path, resolved)) {
-        return false;
-      }
-      if (resolved) {
-        if (!this->Archive->IsPostExcluded(path)) {
-          bool unique;
-          this->Archive->AddResolvedPath(dep, path, unique);
-          if (unique && !this->ScanDependencies(path, rpaths)) {
-            return false;
-          }
+      continue;
+    }
+    if (!resolution->SearchDirectory.empty()) {
+      std::ostringstream warning;
+      warning << "Dependency " << dep << " found in search directory:\n  "
+              << resolution->SearchDirectory
+              << "\nSee file(GET_RUNTIME_DEPENDENCIES) documentation for "
+              << "more information.";
+      this->Archive->GetMakefile()->IssueMessage(MessageType::WARNING,
+                                                 warning.str());
+    }
+    if (resolution->Resolved) {
+      if (!this->Archive->IsPostExcluded(resolution->Path)) {
+        bool unique;
+        this->Archive->AddResolvedPath(dep, resolution->Path, unique);
+        if (unique &&
+            !this->ScanDependencies(resolution->Path, info->RPaths)) {
+          return false;
         }
-      } else {
-        this->Archive->AddUnresolvedPath(dep);
       }
+    } else {
+      this->Archive->AddUnresolvedPath(dep);
     }
   }
 
   return true;
 }
 
+void cmBinUtilsLinuxELFLinker::PrefetchFiles(
+  std::vector<std::string> const& files)
+{
+  this->Tool->PrefetchFileInfo(files);
+}
+
+cmBinUtilsLinuxELFLinker::FileInfo const*
+cmBinUtilsLinuxELFLinker::GetFileInfo(std::string const& file)
+{
+  // A library may be reached by more than one name, or also be given
+  // explicitly, so keep what was read from each file.
+  auto it = this->FileInfos.find(file);
+  if (it != this->FileInfos.end()) {
+    return &it->second;
+  }
+
+  FileInfo info;
+  if (!this->Tool->GetFileInfo(file, info.Needed, info.RPaths,
+                               info.RunPaths)) {
+    return nullptr;
+  }
+  std::string origin = cmSystemTools::GetFilenamePath(file);
+  for (auto& runpath : info.RunPaths) {
+    runpath = ReplaceOrigin(runpath, origin);
+  }
+  for (auto& rpath : info.RPaths) {
+    rpath = ReplaceOrigin(rpath, origin);
+  }
+  return &this->FileInfos.emplace(file, std::move(info)).first->second;
+}
+
+bool cmBinUtilsLinuxELFLinker::GetLDConfigPaths()
+{
+  if (!this->HaveLDConfigPaths) {
+    if (!this->LDConfigTool->GetLDConfigPaths(this->LDConfigPaths)) {
+      return false;
+    }
+    this->HaveLDConfigPaths = true;
+  }
+  return true;
+}
+
 namespace {
 bool FileHasArchitecture(const char* filename, std::uint16_t machine)
 {
@@ -178,35 +248,38 @@ bool FileHasArchitecture(const char* filename, std::uint16_t machine)
 }
 }
 
-bool cmBinUtilsLinuxELFLinker::ResolveDependency(
-  std::string const& name, std::vector<std::string> const& searchPaths,
-  std::string& path, bool& resolved)
+cmBinUtilsLinuxELFLinker::Resolution const&
+cmBinUtilsLinuxELFLinker::ResolveDependency(
+  std::string const& name, std::vector<std::string> const& searchPaths)
 {
+  // Many files share their search paths, so resolve each name once.
+  auto key = std::make_pair(name, searchPaths);
+  auto it = this->Resolutions.find(key);
+  if (it != this->Resolutions.end()) {
+    return it->second;
+  }
+  Resolution& resolution = this->Resolutions[std::move(key)];
+
   for (auto const& searchPath : searchPaths) {
-    path = cmStrCat(searchPath, '/', name);
+    std::string path = cmStrCat(searchPath, '/', name);
     if (cmSystemTools::PathExists(path) &&
         FileHasArchitecture(path.c_str(), this->Machine)) {
-      resolved = true;
-      return true;
+      resolution.Path = std::move(path);
+      resolution.Resolved = true;
+      return resolution;
     }
   }
 
   for (auto const& searchPath : this->Archive->GetSearchDirectories()) {
-    path = cmStrCat(searchPath, '/', name);
+    std::string path = cmStrCat(searchPath, '/', name);
     if (cmSystemTools::PathExists(path) &&
         FileHasArchitecture(path.c_str(), this->Machine)) {
-      std::ostringstream warning;
-      warning << "Dependency " << name << " found in search directory:\n  "
-              << searchPath
-              << "\nSee file(GET_RUNTIME_DEPENDENCIES) documentation for "
-              << "more information.";
-      this->Archive->GetMakefile()->IssueMessage(MessageType::WARNING,
-                                                 warning.str());
-      resolved = true;
-      return true;
+      resolution.Path = std::move(path);
+      resolution.Resolved = true;
+      resolution.SearchDirectory = searchPath;
+      return resolution;
     }
   }
 
-  resolved = false;
-  return true;
+  return resolution;
 }
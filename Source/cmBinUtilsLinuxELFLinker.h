@@ -6,8 +6,10 @@
 #include "cmConfigure.h" // IWYU pragma: keep
 
 #include <cstdint>
+#include <map>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "cmBinUtilsLinker.h"
@@ -27,19 +29,41 @@ public:
   bool ScanDependencies(std::string const& file,
                         cmStateEnums::TargetType type) override;
 
+  void PrefetchFiles(std::vector<std::string> const& files) override;
+
 private:
+  struct FileInfo
+  {
+    std::vector<std::string> Needed;
+    std::vector<std::string> RPaths;
+    std::vector<std::string> RunPaths;
+  };
+
+  struct Resolution
+  {
+    std::string Path;
+    bool Resolved = false;
+    // The search directory the dependency was found in, if it was not
+    // found in the search paths.
+    std::string SearchDirectory;
+  };
+
   std::unique_ptr<cmBinUtilsLinuxELFGetRuntimeDependenciesTool> Tool;
   std::unique_ptr<cmLDConfigTool> LDConfigTool;
   bool HaveLDConfigPaths = false;
   std::vector<std::string> LDConfigPaths;
   std::uint16_t Machine = 0;
+  std::map<std::string, FileInfo> FileInfos;
+  std::map<std::pair<std::string, std::vector<std::string>>, Resolution>
+    Resolutions;
 
   bool ScanDependencies(std::string const& file,
                         std::vector<std::string> const& parentRpaths);
 
-  bool ResolveDependency(std::string const& name,
-                         std::vector<std::string> const& searchPaths,
-                         std::string& path, bool& resolved);
+  FileInfo const* GetFileInfo(std::string const& file);
+
+  Resolution const& ResolveDependency(
+    std::string const& name, std::vector<std::string> const& searchPaths);
 
   bool GetLDConfigPaths();
 };
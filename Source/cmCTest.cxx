@@ -11,6 +11,7 @@
 #include <ctime>
 #include <iostream>
 #include <map>
+#include <mutex>
 #include <sstream>
 #include <string>
 #include <utility>
@@ -96,6 +97,7 @@ struct cmCTest::Private
   std::chrono::system_clock::time_point StopTime;
   bool StopOnFailure = false;
   bool TestProgressOutput = false;
+  bool TestListCache = false;
   bool Verbose = false;
   bool ExtraVerbose = false;
   bool ProduceXML = false;
@@ -176,6 +178,7 @@ struct cmCTest::Private
   bool ParallelLevelSetInCli = false;
 
   unsigned long TestLoad = 0;
+  unsigned long TestMemory = 0;
 
   int CompatibilityMode;
 
@@ -211,6 +214,9 @@ struct cmCTest::Private
   std::unique_ptr<cmGeneratedFileStream> OutputLogFile;
   int OutputLogFileLastTag = -1;
 
+  // Serialize messages logged from helper threads.
+  std::mutex LogMutex;
+
   bool OutputTestOutputOnTestFailure = false;
   bool OutputColorCode = cmCTest::ColoredOutputSupportedByConsole();
 
@@ -342,6 +348,10 @@ cmCTest::cmCTest()
   if (cmSystemTools::GetEnv("CTEST_PROGRESS_OUTPUT", envValue)) {
     this->Impl->TestProgressOutput = !cmIsOff(envValue);
   }
+  envValue.clear();
+  if (cmSystemTools::GetEnv("CTEST_TEST_LIST_CACHE", envValue)) {
+    this->Impl->TestListCache = !cmIsOff(envValue);
+  }
 
   this->Impl->Parts[PartStart].SetName("Start");
   this->Impl->Parts[PartUpdate].SetName("Update");
@@ -392,6 +402,16 @@ void cmCTest::SetTestLoad(unsigned long load)
   this->Impl->TestLoad = load;
 }
 
+unsigned long cmCTest::GetTestMemory() const
+{
+  return this->Impl->TestMemory;
+}
+
+void cmCTest::SetTestMemory(unsigned long memory)
+{
+  this->Impl->TestMemory = memory;
+}
+
 bool cmCTest::ShouldCompressTestOutput()
 {
   return this->Impl->CompressTestOutput;
@@ -1955,6 +1975,19 @@ bool cmCTest::HandleCommandLineArguments(size_t& i,
     }
   }
 
+  else if (this->CheckArgument(arg, "--test-memory"_s) &&
+           i < args.size() - 1) {
+    i++;
+    unsigned long memory;
+    if (cmStrToULong(args[i], &memory)) {
+      this->SetTestMemory(memory);
+    } else {
+      cmCTestLog(this, WARNING,
+                 "Invalid value for 'Test Memory' : " << args[i]
+                                                      << std::endl);
+    }
+  }
+
   else if (this->CheckArgument(arg, "--no-compress-output"_s)) {
     this->Impl->CompressTestOutput = false;
   }
@@ -2008,6 +2041,8 @@ bool cmCTest::HandleCommandLineArguments(size_t& i,
     this->Impl->Quiet = true;
   } else if (this->CheckArgument(arg, "--progress"_s)) {
     this->Impl->TestProgressOutput = true;
+  } else if (this->CheckArgument(arg, "--test-list-cache"_s)) {
+    this->Impl->TestListCache = true;
   } else if (this->CheckArgument(arg, "-V"_s, "--verbose")) {
     this->Impl->Verbose = true;
   } else if (this->CheckArgument(arg, "-VV"_s, "--extra-verbose")) {
@@ -2046,6 +2081,11 @@ bool cmCTest::HandleCommandLineArguments(size_t& i,
       errormsg = "Invalid value for '--test-output-truncation': " + args[i];
       return false;
     }
+  } else if (this->CheckArgument(arg, "--test-output-streaming"_s)) {
+    this->Impl->TestHandler.SetTestOutputStreaming(true);
+  } else if (this->CheckArgument(arg, "--test-output-spool"_s)) {
+    this->Impl->TestHandler.SetTestOutputStreaming(true);
+    this->Impl->TestHandler.SetTestOutputSpool(true);
   } else if (this->CheckArgument(arg, "-N"_s, "--show-only")) {
     this->Impl->ShowOnly = true;
   } else if (cmHasLiteralPrefix(arg, "--show-only=")) {
@@ -2213,6 +2253,29 @@ bool cmCTest::HandleCommandLineArguments(size_t& i,
                                                     args[i].c_str());
   }
 
+  else if (this->CheckArgument(arg, "--shard-index"_s) &&
+           i < args.size() - 1) {
+    i++;
+    this->GetTestHandler()->SetPersistentOption("ShardIndex",
+                                                args[i].c_str());
+    this->GetMemCheckHandler()->SetPersistentOption("ShardIndex",
+                                                    args[i].c_str());
+  } else if (this->CheckArgument(arg, "--shard-count"_s) &&
+             i < args.size() - 1) {
+    i++;
+    this->GetTestHandler()->SetPersistentOption("ShardCount",
+                                                args[i].c_str());
+    this->GetMemCheckHandler()->SetPersistentOption("ShardCount",
+                                                    args[i].c_str());
+  } else if (this->CheckArgument(arg, "--coordinator"_s) &&
+             i < args.size() - 1) {
+    i++;
+    this->GetTestHandler()->SetPersistentOption("Coordinator",
+                                                args[i].c_str());
+    this->GetMemCheckHandler()->SetPersistentOption("Coordinator",
+                                                    args[i].c_str());
+  }
+
   else if (this->CheckArgument(arg, "--rerun-failed"_s)) {
     this->GetTestHandler()->SetPersistentOption("RerunFailed", "true");
     this->GetMemCheckHandler()->SetPersistentOption("RerunFailed", "true");
@@ -2754,6 +2817,11 @@ int cmCTest::Run(std::vector<std::string>& args, std::string* output)
       this->Impl->ScheduleType = "Random";
     }
 
+    // --schedule-critical-path
+    if (this->CheckArgument(arg, "--schedule-critical-path"_s)) {
+      this->Impl->ScheduleType = "CriticalPath";
+    }
+
     // pass the argument to all the handlers as well, but it may no longer be
     // set to what it was originally so I'm not sure this is working as
     // intended
@@ -3314,6 +3382,11 @@ bool cmCTest::GetTestProgressOutput() const
   return this->Impl->TestProgressOutput && !GetExtraVerbose();
 }
 
+bool cmCTest::GetTestListCache() const
+{
+  return this->Impl->TestListCache;
+}
+
 bool cmCTest::GetVerbose() const
 {
   return this->Impl->Verbose;
@@ -3571,6 +3644,7 @@ void cmCTest::Log(int logType, const char* file, int line, const char* msg,
       (this->Impl->Debug || this->Impl->ExtraVerbose)) {
     return;
   }
+  std::lock_guard<std::mutex> lock(this->Impl->LogMutex);
   if (this->Impl->OutputLogFile) {
     bool display = true;
     if (logType == cmCTest::DEBUG && !this->Impl->Debug) {
@@ -122,6 +122,10 @@ public:
   unsigned long GetTestLoad() const;
   void SetTestLoad(unsigned long);
 
+  /** memory in MiB the tests run at the same time may use */
+  unsigned long GetTestMemory() const;
+  void SetTestMemory(unsigned long);
+
   /**
    * Check if CTest file exists
    */
@@ -418,6 +422,9 @@ public:
 
   bool GetTestProgressOutput() const;
 
+  /** Whether to cache the list of tests read from the test files.  */
+  bool GetTestListCache() const;
+
   bool GetVerbose() const;
   bool GetExtraVerbose() const;
 
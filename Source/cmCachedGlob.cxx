@@ -0,0 +1,248 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file Copyright.txt or https://cmake.org/licensing for details.  */
+#include "cmCachedGlob.h"
+
+#include <algorithm>
+
+#include "cmsys/SystemTools.hxx"
+
+#include "cmStringAlgorithms.h"
+#include "cmSystemTools.h"
+
+#if defined(_WIN32) || defined(__APPLE__)
+// On Windows and Apple, no difference between lower and upper case
+#  define CM_GLOB_CASE_INDEPENDENT
+#endif
+
+#if defined(_WIN32) || defined(__CYGWIN__)
+// Handle network paths
+#  define CM_GLOB_SUPPORT_NETWORK_PATHS
+#endif
+
+// The search mirrors cmsys::Glob, including its messages and the paths
+// of the files found, so that file(GLOB) gives the same results.
+
+void cmCachedGlob::FindFiles(std::string const& inexpr,
+                             cmsys::Glob::GlobMessages* messages)
+{
+  this->Expressions.clear();
+  this->Files.clear();
+  this->ReadDirectories.clear();
+
+  // Listings are trusted for the rest of this search only.
+  cmDirectoryListingCache::Revalidate();
+
+  std::string expr = inexpr;
+  if (!cmSystemTools::FileIsFullPath(expr)) {
+    expr = cmStrCat(cmSystemTools::GetCurrentWorkingDirectory(), '/', inexpr);
+  }
+  std::string const fexpr = expr;
+
+  std::string::size_type skip = 0;
+  std::string::size_type lastSlash = 0;
+  for (std::string::size_type cc = 0; cc < expr.size(); cc++) {
+    if (cc > 0 && expr[cc] == '/' && expr[cc - 1] != '\\') {
+      lastSlash = cc;
+    }
+    if (cc > 0 && (expr[cc] == '[' || expr[cc] == '?' || expr[cc] == '*') &&
+        expr[cc - 1] != '\\') {
+      break;
+    }
+  }
+  if (lastSlash > 0) {
+    skip = lastSlash;
+  }
+  if (skip == 0) {
+#if defined(CM_GLOB_SUPPORT_NETWORK_PATHS)
+    // Handle network paths
+    if (expr[0] == '/' && expr[1] == '/') {
+      int cnt = 0;
+      std::string::size_type cc;
+      for (cc = 2; cc < expr.size(); cc++) {
+        if (expr[cc] == '/') {
+          cnt++;
+          if (cnt == 2) {
+            break;
+          }
+        }
+      }
+      skip = cc + 1;
+    } else
+#endif
+      // Handle drive letters on Windows
+      if (expr[1] == ':' && expr[0] != '/') {
+      skip = 2;
+    }
+  }
+
+  if (skip > 0) {
+    expr.erase(0, skip);
+  }
+
+  std::string cexpr;
+  for (char ch : expr) {
+    if (ch == '/') {
+      if (!cexpr.empty()) {
+        this->Expressions.emplace_back(cmsys::Glob::PatternToRegex(cexpr));
+      }
+      cexpr.clear();
+    } else {
+      cexpr += ch;
+    }
+  }
+  if (!cexpr.empty()) {
+    this->Expressions.emplace_back(cmsys::Glob::PatternToRegex(cexpr));
+  }
+
+  if (skip > 0) {
+    this->ProcessDirectory(0, fexpr.substr(0, skip) + "/", messages);
+  } else {
+    this->ProcessDirectory(0, "/", messages);
+  }
+}
+
+void cmCachedGlob::ProcessDirectory(std::size_t start, std::string const& dir,
+                                    cmsys::Glob::GlobMessages* messages)
+{
+  bool const last = (start == this->Expressions.size() - 1);
+  if (last && this->Recurse) {
+    // Read the whole tree on multiple threads before searching it.
+    cmDirectoryListingCache::PrefetchTrees({ dir });
+    this->RecurseDirectory(start, dir, messages);
+    return;
+  }
+
+  if (start >= this->Expressions.size()) {
+    return;
+  }
+
+  std::vector<cmDirectoryListingCache::Entry> entries;
+  std::string error;
+  if (!this->ListDirectory(dir, entries, error)) {
+    return;
+  }
+  for (cmDirectoryListingCache::Entry const& entry : entries) {
+    std::string const realname =
+      start == 0 ? cmStrCat(dir, entry.Name) : cmStrCat(dir, '/', entry.Name);
+    if ((!last && !entry.IsDirectory) ||
+        (!this->ListDirs && last && entry.IsDirectory)) {
+      continue;
+    }
+
+#if defined(CM_GLOB_CASE_INDEPENDENT)
+    // On case-insensitive file systems convert to lower case for matching.
+    std::string const fname = cmSystemTools::LowerCase(entry.Name);
+#else
+    std::string const& fname = entry.Name;
+#endif
+    if (this->Expressions[start].find(fname)) {
+      if (last) {
+        this->AddFile(realname);
+      } else {
+        this->ProcessDirectory(start + 1, realname, messages);
+      }
+    }
+  }
+}
+
+bool cmCachedGlob::RecurseDirectory(std::size_t start, std::string const& dir,
+                                    cmsys::Glob::GlobMessages* messages)
+{
+  std::vector<cmDirectoryListingCache::Entry> entries;
+  std::string error;
+  if (!this->ListDirectory(dir, entries, error)) {
+    if (messages && !error.empty()) {
+      messages->emplace_back(cmsys::Glob::warning,
+                             cmStrCat("Error listing directory '", dir,
+                                      "'! Reason: '", error, '\''));
+    }
+    return true;
+  }
+  for (cmDirectoryListingCache::Entry const& entry : entries) {
+    std::string const realname =
+      start == 0 ? cmStrCat(dir, entry.Name) : cmStrCat(dir, '/', entry.Name);
+#if defined(CM_GLOB_CASE_INDEPENDENT)
+    std::string const fname = cmSystemTools::LowerCase(entry.Name);
+#else
+    std::string const& fname = entry.Name;
+#endif
+
+    if (!entry.IsDirectory ||
+        (entry.IsSymlink && !this->RecurseThroughSymlinks)) {
+      if (!this->Expressions.empty() &&
+          this->Expressions.back().find(fname)) {
+        this->AddFile(realname);
+      }
+      continue;
+    }
+
+    if (!entry.IsSymlink) {
+      if (this->RecurseListDirs) {
+        this->AddFile(realname);
+      }
+      if (!this->RecurseDirectory(start + 1, realname, messages)) {
+        return false;
+      }
+      continue;
+    }
+
+    ++this->FollowedSymlinkCount;
+    std::string realPathErrorMessage;
+    std::string const canonicalPath =
+      cmsys::SystemTools::GetRealPath(dir, &realPathErrorMessage);
+    if (!realPathErrorMessage.empty()) {
+      if (messages) {
+        messages->emplace_back(
+          cmsys::Glob::error,
+          cmStrCat("Canonical path generation from path '", dir,
+                   "' failed! Reason: '", realPathErrorMessage, '\''));
+      }
+      return false;
+    }
+
+    auto const visited = std::find(this->VisitedSymlinks.begin(),
+                                   this->VisitedSymlinks.end(), canonicalPath);
+    if (visited == this->VisitedSymlinks.end()) {
+      if (this->RecurseListDirs) {
+        // symlinks are treated as directories
+        this->AddFile(realname);
+      }
+      this->VisitedSymlinks.push_back(canonicalPath);
+      bool const ok = this->RecurseDirectory(start + 1, realname, messages);
+      this->VisitedSymlinks.pop_back();
+      if (!ok) {
+        return false;
+      }
+    } else if (messages) {
+      // Already visited this symlink; prevent cyclic recursion.
+      std::string message;
+      for (auto it = visited; it != this->VisitedSymlinks.end(); ++it) {
+        message += *it + "\n";
+      }
+      message += cmStrCat(canonicalPath, '/', fname);
+      messages->emplace_back(cmsys::Glob::cyclicRecursion, message);
+    }
+  }
+  return true;
+}
+
+bool cmCachedGlob::ListDirectory(
+  std::string const& dir, std::vector<cmDirectoryListingCache::Entry>& entries,
+  std::string& error)
+{
+  cmDirectoryListingCache::Stamp stamp;
+  bool const listed =
+    cmDirectoryListingCache::GetEntries(dir, entries, stamp, error);
+  this->ReadDirectories.emplace(dir, stamp);
+  return listed;
+}
+
+void cmCachedGlob::AddFile(std::string const& file)
+{
+  if (!this->Relative.empty()) {
+    this->Files.push_back(
+      cmsys::SystemTools::RelativePath(this->Relative, file));
+  } else {
+    this->Files.push_back(file);
+  }
+}
@@ -0,0 +1,91 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file Copyright.txt or https://cmake.org/licensing for details.  */
+#pragma once
+
+#include "cmConfigure.h" // IWYU pragma: keep
+
+#include <cstddef>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "cmsys/Glob.hxx"
+#include "cmsys/RegularExpression.hxx"
+
+#include "cmDirectoryListingCache.h"
+
+/** \class cmCachedGlob
+ * \brief Find files matching a globbing expression like cmsys::Glob.
+ *
+ * Directories are read through cmDirectoryListingCache so that globs
+ * searching the same directories during one configure step share their
+ * listings, and trees searched recursively are read on multiple threads
+ * before they are searched.  The directories read by each search are
+ * recorded with their modification times so that a later check can tell
+ * whether the result may have changed without searching again.
+ */
+class cmCachedGlob
+{
+public:
+  using Directories = std::map<std::string, cmDirectoryListingCache::Stamp>;
+
+  //! Find all files that match the expression.
+  void FindFiles(std::string const& expr,
+                 cmsys::Glob::GlobMessages* messages = nullptr);
+
+  //! Return the list of files that matched.
+  std::vector<std::string>& GetFiles() { return this->Files; }
+
+  //! Return the directories read to find the files.
+  Directories const& GetDirectories() const { return this->ReadDirectories; }
+
+  void SetRecurse(bool recurse) { this->Recurse = recurse; }
+  bool GetRecurse() const { return this->Recurse; }
+
+  void SetRecurseThroughSymlinks(bool recurse)
+  {
+    this->RecurseThroughSymlinks = recurse;
+  }
+  bool GetRecurseThroughSymlinks() const
+  {
+    return this->RecurseThroughSymlinks;
+  }
+
+  //! Get the number of symlinks followed through recursion
+  unsigned int GetFollowedSymlinkCount() const
+  {
+    return this->FollowedSymlinkCount;
+  }
+
+  //! Give the files found relative to the given directory.
+  void SetRelative(std::string dir) { this->Relative = std::move(dir); }
+  std::string const& GetRelative() const { return this->Relative; }
+
+  void SetListDirs(bool list) { this->ListDirs = list; }
+  bool GetListDirs() const { return this->ListDirs; }
+  void SetRecurseListDirs(bool list) { this->RecurseListDirs = list; }
+  bool GetRecurseListDirs() const { return this->RecurseListDirs; }
+
+private:
+  void ProcessDirectory(std::size_t start, std::string const& dir,
+                        cmsys::Glob::GlobMessages* messages);
+  bool RecurseDirectory(std::size_t start, std::string const& dir,
+                        cmsys::Glob::GlobMessages* messages);
+  bool ListDirectory(std::string const& dir,
+                     std::vector<cmDirectoryListingCache::Entry>& entries,
+                     std::string& error);
+  void AddFile(std::string const& file);
+
+  std::vector<cmsys::RegularExpression> Expressions;
+  std::vector<std::string> Files;
+  Directories ReadDirectories;
+  std::vector<std::string> VisitedSymlinks;
+  std::string Relative;
+  unsigned int FollowedSymlinkCount = 0;
+  bool Recurse = false;
+  // True by default for compatibility with cmsys::Glob.
+  bool RecurseThroughSymlinks = true;
+  bool ListDirs = true;
+  bool RecurseListDirs = false;
+};
@@ -0,0 +1,198 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file Copyright.txt or https://cmake.org/licensing for details.  */
+#include "cmConfigureInputs.h"
+
+#include <algorithm>
+#include <memory>
+#include <sstream>
+#include <utility>
+
+#include "cmsys/FStream.hxx"
+
+#include "cmCryptoHash.h"
+#include "cmGlobalGenerator.h"
+#include "cmLocalGenerator.h"
+#include "cmMakefile.h"
+#include "cmStringAlgorithms.h"
+#include "cmSystemTools.h"
+#include "cmVersion.h"
+
+namespace {
+std::string HashInput(std::string const& path)
+{
+  cmCryptoHash hasher(cmCryptoHash::AlgoSHA256);
+  return hasher.HashFile(path);
+}
+
+std::string Header()
+{
+  return cmStrCat("cmake-configure-inputs 1 ", cmVersion::GetCMakeVersion());
+}
+}
+
+void cmConfigureInputs::Collect(cmGlobalGenerator const* gg)
+{
+  this->Inputs.clear();
+  this->Directories.clear();
+  for (auto const& lg : gg->GetLocalGenerators()) {
+    cmMakefile const* mf = lg->GetMakefile();
+    std::vector<std::string>& files =
+      this->Directories[mf->GetCurrentSourceDirectory()];
+    for (std::string const& f : mf->GetListFiles()) {
+      this->AddInput(f, true);
+      files.push_back(f);
+    }
+    std::sort(files.begin(), files.end());
+    files.erase(std::unique(files.begin(), files.end()), files.end());
+  }
+}
+
+void cmConfigureInputs::AddInput(std::string const& path, bool compareContent)
+{
+  auto it = this->Inputs.find(path);
+  if (it != this->Inputs.end()) {
+    if (!compareContent) {
+      it->second.Hash.clear();
+    }
+    return;
+  }
+  Input& input = this->Inputs[path];
+  cmFileTime ftm;
+  if (ftm.Load(path)) {
+    input.Size = cmSystemTools::FileLength(path);
+    input.Time = ftm.GetTime();
+  }
+  if (compareContent) {
+    input.Hash = HashInput(path);
+  }
+}
+
+bool cmConfigureInputs::Load(std::string const& file)
+{
+  this->Inputs.clear();
+  this->Directories.clear();
+  this->Modified = false;
+
+  cmsys::ifstream fin(file.c_str());
+  std::string line;
+  if (!fin || !cmSystemTools::GetLineFromStream(fin, line) ||
+      line != Header()) {
+    return false;
+  }
+
+  std::vector<std::string>* files = nullptr;
+  while (cmSystemTools::GetLineFromStream(fin, line)) {
+    if (line.size() < 2 || line[1] != ' ') {
+      return false;
+    }
+    std::string const rest = line.substr(2);
+    switch (line[0]) {
+      case 'f': {
+        // f <size> <time> <hash or -> <path>
+        std::istringstream fields(rest);
+        Input input;
+        std::string hash;
+        if (!(fields >> input.Size >> input.Time >> hash) ||
+            fields.get() != ' ') {
+          return false;
+        }
+        std::string path;
+        std::getline(fields, path);
+        if (hash != "-") {
+          input.Hash = std::move(hash);
+        }
+        this->Inputs[path] = std::move(input);
+      } break;
+      case 'd':
+        files = &this->Directories[rest];
+        break;
+      case 'i':
+        if (!files || !this->Inputs.count(rest)) {
+          return false;
+        }
+        files->push_back(rest);
+        break;
+      default:
+        return false;
+    }
+  }
+  return true;
+}
+
+bool cmConfigureInputs::Save(std::string const& file) const
+{
+  // Write to a temporary file and rename so that a concurrent check
+  // never reads a partial record.
+  std::string const tmpFile = cmStrCat(file, ".tmp");
+  {
+    cmsys::ofstream fout(tmpFile.c_str(), std::ios::out | std::ios::trunc);
+    if (!fout) {
+      return false;
+    }
+    fout << Header() << '\n';
+    for (auto const& i : this->Inputs) {
+      fout << "f " << i.second.Size << ' ' << i.second.Time << ' '
+           << (i.second.Hash.empty() ? "-" : i.second.Hash) << ' '
+           << i.first << '\n';
+    }
+    for (auto const& d : this->Directories) {
+      fout << "d " << d.first << '\n';
+      for (std::string const& f : d.second) {
+        fout << "i " << f << '\n';
+      }
+    }
+    if (!fout) {
+      return false;
+    }
+  }
+  return cmSystemTools::RenameFile(tmpFile, file);
+}
+
+bool cmConfigureInputs::Check(std::vector<std::string> const& depends,
+                              std::vector<std::string>& dirtyDirectories,
+                              std::string& reason)
+{
+  for (std::string const& d : depends) {
+    if (!this->Inputs.count(d)) {
+      reason = cmStrCat("dependency not recorded: ", d);
+      return false;
+    }
+  }
+
+  std::vector<std::string> changed;
+  for (auto& i : this->Inputs) {
+    Input& input = i.second;
+    cmFileTime ftm;
+    if (!ftm.Load(i.first)) {
+      changed.push_back(i.first);
+      continue;
+    }
+    if (ftm.GetTime() == input.Time) {
+      continue;
+    }
+    if (!input.Hash.empty() &&
+        cmSystemTools::FileLength(i.first) == input.Size &&
+        HashInput(i.first) == input.Hash) {
+      // Touched but not changed.
+      input.Time = ftm.GetTime();
+      this->Modified = true;
+      continue;
+    }
+    changed.push_back(i.first);
+  }
+  if (changed.empty()) {
+    return true;
+  }
+
+  reason = cmStrCat("input changed: ", changed.front());
+  std::sort(changed.begin(), changed.end());
+  for (auto const& d : this->Directories) {
+    for (std::string const& f : d.second) {
+      if (std::binary_search(changed.begin(), changed.end(), f)) {
+        dirtyDirectories.push_back(d.first);
+        break;
+      }
+    }
+  }
+  return false;
+}
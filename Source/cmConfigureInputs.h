@@ -0,0 +1,72 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file Copyright.txt or https://cmake.org/licensing for details.  */
+#pragma once
+
+#include "cmConfigure.h" // IWYU pragma: keep
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "cmFileTime.h"
+
+class cmGlobalGenerator;
+
+/** \class cmConfigureInputs
+ * \brief Record the inputs of each directory's configure step.
+ *
+ * After generation cmConfigureInputs stores, for every directory, the
+ * list files and other configure dependencies it read together with
+ * their size, modification time and content hash.  When the build
+ * system later finds a dependency newer than its outputs the record
+ * tells which directories actually changed.  If no recorded input
+ * changed its content the re-run can be skipped.
+ */
+class cmConfigureInputs
+{
+public:
+  /** Collect the inputs of all directories of the given generator.  */
+  void Collect(cmGlobalGenerator const* gg);
+
+  /** Add an input that does not belong to a directory.  Inputs whose
+      content is not compared are checked by modification time only,
+      e.g. stamp files that are touched to request a re-run.  */
+  void AddInput(std::string const& path, bool compareContent);
+
+  /** Load a record written by Save.  Returns false if the file is
+      missing or was written by another version.  */
+  bool Load(std::string const& file);
+
+  /** Write the record to the given file.  */
+  bool Save(std::string const& file) const;
+
+  /**
+   * @brief Check whether the content of every recorded input is unchanged.
+   *
+   * Files whose modification time changed but whose content did not are
+   * updated in the record so that later checks need not hash them again.
+   * @param depends The dependencies the build system checks.  Any that
+   *                is not in the record makes the check fail.
+   * @param dirtyDirectories Receives the directories with changed inputs.
+   * @param reason Receives a description of the first difference found.
+   * @return true if nothing changed.
+   */
+  bool Check(std::vector<std::string> const& depends,
+             std::vector<std::string>& dirtyDirectories, std::string& reason);
+
+  /** Whether Check updated the record.  */
+  bool IsModified() const { return this->Modified; }
+
+private:
+  struct Input
+  {
+    unsigned long long Size = 0;
+    cmFileTime::TimeType Time = 0;
+    /** Content hash, or empty to compare the modification time only.  */
+    std::string Hash;
+  };
+
+  std::map<std::string, Input> Inputs;
+  std::map<std::string, std::vector<std::string>> Directories;
+  bool Modified = false;
+};
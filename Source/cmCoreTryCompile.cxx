@@ -12,8 +12,11 @@
 #include <cmext/string_view>
 
 #include "cmsys/Directory.hxx"
+#include "cmsys/FStream.hxx"
 
+#include "cmCryptoHash.h"
 #include "cmExportTryCompileFileGenerator.h"
+#include "cmFileTime.h"
 #include "cmGlobalGenerator.h"
 #include "cmMakefile.h"
 #include "cmMessageType.h"
@@ -233,6 +236,192 @@ std::set<std::string> const ghs_platform_vars{
   "GHS_OS_ROOT",         "GHS_OS_DIR",         "GHS_BSP_NAME",
   "GHS_OS_DIR_OPTION"
 };
+
+/* Per-language variables that identify the toolchain of a try_compile
+   project in the result cache.  */
+std::vector<std::string> const kTryCompileCacheLanguageVariables{
+  "_COMPILER",         "_COMPILER_ID",      "_COMPILER_VERSION",
+  "_COMPILER_TARGET",  "_COMPILER_ARG1",    "_COMPILER_LAUNCHER",
+  "_SIMULATE_ID",      "_SIMULATE_VERSION", "_COMPILER_EXTERNAL_TOOLCHAIN"
+};
+
+/* Other variables and environment variables that affect the result of
+   a try_compile project.  */
+std::vector<std::string> const kTryCompileCacheVariables{
+  "CMAKE_SYSTEM_NAME",
+  "CMAKE_SYSTEM_VERSION",
+  "CMAKE_SYSTEM_PROCESSOR",
+  "CMAKE_TOOLCHAIN_FILE",
+  "CMAKE_LINKER",
+  "CMAKE_AR",
+  "CMAKE_RANLIB",
+  "CMAKE_MT",
+  "CMAKE_MAKE_PROGRAM",
+  "CMAKE_GENERATOR_INSTANCE",
+  "CMAKE_GENERATOR_PLATFORM",
+  "CMAKE_GENERATOR_TOOLSET",
+  "CMAKE_TRY_COMPILE_CONFIGURATION",
+};
+std::vector<std::string> const kTryCompileCacheEnvironment{
+  "CPATH",
+  "C_INCLUDE_PATH",
+  "CPLUS_INCLUDE_PATH",
+  "OBJC_INCLUDE_PATH",
+  "LIBRARY_PATH",
+  "INCLUDE",
+  "LIB",
+  "LIBPATH",
+  "SDKROOT",
+  "MACOSX_DEPLOYMENT_TARGET",
+};
+
+char const kTryCompileCacheHeader[] = "cmake-try-compile-result 1";
+
+/* Replace the parts of a try_compile project that differ between calls
+   and build trees so that equal projects have equal cache keys.  */
+std::string NormalizeTryCompileText(std::string text,
+                                    std::string const& binDir,
+                                    std::string const& targetName)
+{
+  cmSystemTools::ReplaceString(text, binDir, "<BINARY_DIR>");
+  cmSystemTools::ReplaceString(text, targetName, "<TARGET_NAME>");
+  return text;
+}
+
+/* Compute the result cache key of a source file signature try_compile
+   from the generated project, its sources, its cache arguments and the
+   identity of the toolchain.  */
+std::string ComputeTryCompileCacheKey(
+  cmMakefile const* mf, std::string const& binDir,
+  std::string const& targetName, std::set<std::string> const& langs,
+  std::vector<std::string> const& sources,
+  std::vector<std::string> const& cmakeFlags)
+{
+  cmCryptoHash hasher(cmCryptoHash::AlgoSHA256);
+  std::string content = cmStrCat(kTryCompileCacheHeader, '\n', "cmake ",
+                                 cmVersion::GetCMakeVersion(), '\n',
+                                 "generator ",
+                                 mf->GetGlobalGenerator()->GetName(), '\n');
+  auto addFile = [&content](std::string const& label,
+                            std::string const& path) {
+    cmFileTime ftm;
+    std::string stamp = "-";
+    if (ftm.Load(path)) {
+      stamp = cmStrCat(cmSystemTools::FileLength(path), ' ', ftm.GetTime());
+    }
+    content += cmStrCat(label, ' ', path, ' ', stamp, '\n');
+  };
+  auto addVariable = [&content, mf](std::string const& var) {
+    if (cmValue value = mf->GetDefinition(var)) {
+      content += cmStrCat("var ", var, '=', *value, '\n');
+    }
+  };
+
+  // The generated project and the sources it builds.
+  {
+    cmsys::ifstream fin(cmStrCat(binDir, "/CMakeLists.txt").c_str());
+    std::ostringstream project;
+    project << fin.rdbuf();
+    content += cmStrCat("project ",
+                        hasher.HashString(NormalizeTryCompileText(
+                          project.str(), binDir, targetName)),
+                        '\n');
+  }
+  for (std::string const& src : sources) {
+    content +=
+      cmStrCat("source ", NormalizeTryCompileText(src, binDir, targetName),
+               ' ', hasher.HashFile(src), '\n');
+  }
+  for (std::string const& flag : cmakeFlags) {
+    content += cmStrCat("flag ",
+                        NormalizeTryCompileText(flag, binDir, targetName),
+                        '\n');
+  }
+
+  // The toolchain.  Compilers and toolchain files are identified by
+  // size and modification time to notice in-place upgrades.
+  for (std::string const& lang : langs) {
+    for (std::string const& suffix : kTryCompileCacheLanguageVariables) {
+      addVariable(cmStrCat("CMAKE_", lang, suffix));
+    }
+    addFile("compiler",
+            mf->GetSafeDefinition(cmStrCat("CMAKE_", lang, "_COMPILER")));
+  }
+  for (std::string const& var : kTryCompileCacheVariables) {
+    addVariable(var);
+  }
+  if (cmValue toolchain = mf->GetDefinition("CMAKE_TOOLCHAIN_FILE")) {
+    addFile("toolchain", *toolchain);
+  }
+  for (std::string const& var : kTryCompileCacheEnvironment) {
+    std::string value;
+    if (cmSystemTools::GetEnv(var, value)) {
+      content += cmStrCat("env ", var, '=', value, '\n');
+    }
+  }
+
+  return hasher.HashString(content);
+}
+
+std::string GetTryCompileCacheFile(std::string const& cacheDir,
+                                   std::string const& key)
+{
+  return cmStrCat(cacheDir, '/', key.substr(0, 2), '/', key);
+}
+
+/* Load a result stored by StoreTryCompileResult.  */
+bool LoadTryCompileResult(std::string const& file, std::string const& binDir,
+                          std::string const& targetName, int& result,
+                          std::string& output)
+{
+  cmsys::ifstream fin(file.c_str(), std::ios::in | std::ios::binary);
+  std::string line;
+  if (!fin || !cmSystemTools::GetLineFromStream(fin, line) ||
+      line != kTryCompileCacheHeader ||
+      !cmSystemTools::GetLineFromStream(fin, line)) {
+    return false;
+  }
+  long value = 0;
+  if (!cmStrToLong(line, &value)) {
+    return false;
+  }
+  std::ostringstream content;
+  content << fin.rdbuf();
+  output = content.str();
+  cmSystemTools::ReplaceString(output, "<BINARY_DIR>", binDir);
+  cmSystemTools::ReplaceString(output, "<TARGET_NAME>", targetName);
+  result = static_cast<int>(value);
+  return true;
+}
+
+/* Store the result of a try_compile.  The file is written under a
+   temporary name and renamed so that concurrent configures sharing the
+   cache never read a partial result.  */
+void StoreTryCompileResult(std::string const& file, std::string const& binDir,
+                           std::string const& targetName, int result,
+                           std::string const& output)
+{
+  cmSystemTools::MakeDirectory(cmSystemTools::GetFilenamePath(file));
+  std::string const tmpFile =
+    cmStrCat(file, ".tmp", cmSystemTools::RandomSeed());
+  {
+    cmsys::ofstream fout(tmpFile.c_str(), std::ios::out | std::ios::binary);
+    if (!fout) {
+      return;
+    }
+    fout << kTryCompileCacheHeader << '\n'
+         << result << '\n'
+         << NormalizeTryCompileText(output, binDir, targetName);
+    if (!fout) {
+      fout.close();
+      cmSystemTools::RemoveFile(tmpFile);
+      return;
+    }
+  }
+  if (!cmSystemTools::RenameFile(tmpFile, file)) {
+    cmSystemTools::RemoveFile(tmpFile);
+  }
+}
 }
 
 int cmCoreTryCompile::TryCompileCode(std::vector<std::string> const& argv,
@@ -289,6 +478,7 @@ int cmCoreTryCompile::TryCompileCode(std::vector<std::string> const& argv,
   bool didCopyFileError = false;
   bool useSources = argv[2] == "SOURCES";
   std::vector<std::string> sources;
+  std::set<std::string> testLangs;
 
   enum Doing
   {
@@ -491,7 +681,6 @@ int cmCoreTryCompile::TryCompileCode(std::vector<std::string> const& argv,
 
     // Detect languages to enable.
     cmGlobalGenerator* gg = this->Makefile->GetGlobalGenerator();
-    std::set<std::string> testLangs;
     for (std::string const& si : sources) {
       std::string ext = cmSystemTools::GetFilenameLastExtension(si);
       std::string lang = gg->GetLanguageFromExtension(ext.c_str());
@@ -983,14 +1172,40 @@ int cmCoreTryCompile::TryCompileCode(std::vector<std::string> const& argv,
     }
   }
 
+  // Look up the result in the cache shared between build trees.  Only
+  // results are stored, so skip calls that need the built binary.
+  std::string cacheFile;
+  cmValue cacheDir =
+    this->Makefile->GetDefinition("CMAKE_TRY_COMPILE_CACHE_DIR");
+  if (cmNonempty(cacheDir) && this->SrcFileSignature && !isTryRun &&
+      copyFile.empty() && cmakeInternal.empty() && targets.empty() &&
+      !this->Makefile->GetCMakeInstance()->GetDebugTryCompile()) {
+    cacheFile = GetTryCompileCacheFile(
+      *cacheDir,
+      ComputeTryCompileCacheKey(this->Makefile, this->BinaryDirectory,
+                                targetName, testLangs, sources, cmakeFlags));
+  }
+
   bool erroroc = cmSystemTools::GetErrorOccurredFlag();
   cmSystemTools::ResetErrorOccurredFlag();
   std::string output;
-  // actually do the try compile now that everything is setup
-  int res = this->Makefile->TryCompile(
-    sourceDirectory, this->BinaryDirectory, projectName, targetName,
-    this->SrcFileSignature, cmake::NO_BUILD_PARALLEL_LEVEL, &cmakeFlags,
-    output);
+  int res = 0;
+  bool cached = false;
+  if (!cacheFile.empty()) {
+    cached = LoadTryCompileResult(cacheFile, this->BinaryDirectory,
+                                  targetName, res, output);
+  }
+  if (!cached) {
+    // actually do the try compile now that everything is setup
+    res = this->Makefile->TryCompile(
+      sourceDirectory, this->BinaryDirectory, projectName, targetName,
+      this->SrcFileSignature, cmake::NO_BUILD_PARALLEL_LEVEL, &cmakeFlags,
+      output);
+    if (!cacheFile.empty() && !cmSystemTools::GetErrorOccurredFlag()) {
+      StoreTryCompileResult(cacheFile, this->BinaryDirectory, targetName, res,
+                            output);
+    }
+  }
   if (erroroc) {
     cmSystemTools::SetErrorOccurred();
   }
@@ -1004,7 +1219,7 @@ int cmCoreTryCompile::TryCompileCode(std::vector<std::string> const& argv,
     this->Makefile->AddDefinition(outputVariable, output);
   }
 
-  if (this->SrcFileSignature) {
+  if (this->SrcFileSignature && !cached) {
     std::string copyFileErrorMessage;
     this->FindOutputFile(targetName, targetType);
 
@@ -2,6 +2,15 @@
    file Copyright.txt or https://cmake.org/licensing for details.  */
 #include "cmCryptoHash.h"
 
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+#if !defined(CMAKE_BOOTSTRAP)
+#  include <atomic>
+#  include <thread>
+#endif
+
 #include <cm/memory>
 
 #include <cm3p/kwiml/int.h>
@@ -9,6 +18,8 @@
 
 #include "cmsys/FStream.hxx"
 
+#include "cmCryptoHashAccel.h"
+
 static unsigned int const cmCryptoHashAlgoToId[] = {
   /* clang-format needs this comment to break after the opening brace */
   RHASH_MD5,      //
@@ -34,15 +45,118 @@ static rhash cmCryptoHash_rhash_init(unsigned int id)
   return rhash_init(id);
 }
 
+/** Merkle-Damgard padding and buffering around a block function.  */
+struct cmCryptoHash::BlockHash
+{
+  using BlocksFunction = void (*)(std::uint32_t*, unsigned char const*,
+                                  std::size_t);
+
+  BlocksFunction Blocks;
+  std::uint32_t const* InitialState;
+  std::size_t StateWords;
+  std::size_t DigestSize;
+
+  std::uint32_t State[8];
+  unsigned char Buffer[64];
+  std::size_t Buffered;
+  std::uint64_t Length;
+
+  void Initialize()
+  {
+    std::copy(this->InitialState, this->InitialState + this->StateWords,
+              this->State);
+    this->Buffered = 0;
+    this->Length = 0;
+  }
+
+  void Append(unsigned char const* data, std::size_t size)
+  {
+    this->Length += size;
+    if (this->Buffered > 0) {
+      std::size_t const n = std::min(size, 64 - this->Buffered);
+      std::memcpy(this->Buffer + this->Buffered, data, n);
+      this->Buffered += n;
+      data += n;
+      size -= n;
+      if (this->Buffered < 64) {
+        return;
+      }
+      this->Blocks(this->State, this->Buffer, 1);
+      this->Buffered = 0;
+    }
+    if (size >= 64) {
+      this->Blocks(this->State, data, size / 64);
+      data += size - size % 64;
+      size %= 64;
+    }
+    std::memcpy(this->Buffer, data, size);
+    this->Buffered = size;
+  }
+
+  std::vector<unsigned char> Finalize()
+  {
+    // Pad with a one bit, zeros, and the message length in bits.
+    std::uint64_t const bits = this->Length * 8;
+    unsigned char padding[72] = { 0x80 };
+    std::size_t const padSize =
+      (this->Buffered < 56 ? 56 : 120) - this->Buffered;
+    for (int i = 0; i < 8; ++i) {
+      padding[padSize + i] =
+        static_cast<unsigned char>(bits >> (56 - 8 * i));
+    }
+    this->Append(padding, padSize + 8);
+
+    std::vector<unsigned char> digest(this->DigestSize);
+    for (std::size_t i = 0; i < this->DigestSize; ++i) {
+      digest[i] =
+        static_cast<unsigned char>(this->State[i / 4] >> (24 - 8 * (i % 4)));
+    }
+    return digest;
+  }
+};
+
+static std::uint32_t const cmCryptoHashSHA1Initial[5] = {
+  0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476, 0xc3d2e1f0
+};
+static std::uint32_t const cmCryptoHashSHA224Initial[8] = {
+  0xc1059ed8, 0x367cd507, 0x3070dd17, 0xf70e5939,
+  0xffc00b31, 0x68581511, 0x64f98fa7, 0xbefa4fa4
+};
+static std::uint32_t const cmCryptoHashSHA256Initial[8] = {
+  0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+  0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+};
+
 cmCryptoHash::cmCryptoHash(Algo algo)
   : Id(cmCryptoHashAlgoToId[algo])
-  , CTX(cmCryptoHash_rhash_init(this->Id))
 {
+  if (cmCryptoHashAccel::IsAvailable() &&
+      (algo == AlgoSHA1 || algo == AlgoSHA224 || algo == AlgoSHA256)) {
+    this->Blocks = cm::make_unique<BlockHash>();
+    if (algo == AlgoSHA1) {
+      this->Blocks->Blocks = &cmCryptoHashAccel::SHA1Blocks;
+      this->Blocks->InitialState = cmCryptoHashSHA1Initial;
+      this->Blocks->StateWords = 5;
+      this->Blocks->DigestSize = 20;
+    } else {
+      this->Blocks->Blocks = &cmCryptoHashAccel::SHA256Blocks;
+      this->Blocks->InitialState = algo == AlgoSHA224
+        ? cmCryptoHashSHA224Initial
+        : cmCryptoHashSHA256Initial;
+      this->Blocks->StateWords = 8;
+      this->Blocks->DigestSize = algo == AlgoSHA224 ? 28 : 32;
+    }
+    this->Blocks->Initialize();
+  } else {
+    this->CTX = cmCryptoHash_rhash_init(this->Id);
+  }
 }
 
 cmCryptoHash::~cmCryptoHash()
 {
-  rhash_free(this->CTX);
+  if (this->CTX) {
+    rhash_free(this->CTX);
+  }
 }
 
 std::unique_ptr<cmCryptoHash> cmCryptoHash::New(cm::string_view algo)
@@ -126,8 +240,8 @@ std::vector<unsigned char> cmCryptoHash::ByteHashFile(const std::string& file)
   if (fin) {
     this->Initialize();
     {
-      // Should be efficient enough on most system:
-      KWIML_INT_uint64_t buffer[512];
+      // Large enough to hand many blocks at once to the hash.
+      KWIML_INT_uint64_t buffer[8192];
       char* buffer_c = reinterpret_cast<char*>(buffer);
       unsigned char const* buffer_uc =
         reinterpret_cast<unsigned char const*>(buffer);
@@ -164,23 +278,73 @@ std::string cmCryptoHash::HashFile(const std::string& file)
   return ByteHashToString(this->ByteHashFile(file));
 }
 
+std::vector<std::string> cmCryptoHash::HashFiles(
+  Algo algo, std::vector<std::string> const& files)
+{
+  std::vector<std::string> hashes(files.size());
+#if !defined(CMAKE_BOOTSTRAP)
+  std::size_t const threadCount = std::min<std::size_t>(
+    std::max(std::thread::hardware_concurrency(), 1u), files.size());
+  if (threadCount > 1) {
+    // Create every hash object here so that librhash is initialized
+    // before any thread uses it.
+    std::vector<std::unique_ptr<cmCryptoHash>> hashers;
+    for (std::size_t i = 0; i < threadCount; ++i) {
+      hashers.emplace_back(cm::make_unique<cmCryptoHash>(algo));
+    }
+    std::atomic<std::size_t> next(0);
+    auto work = [&files, &hashes, &next](cmCryptoHash* hasher) {
+      for (std::size_t i = next++; i < files.size(); i = next++) {
+        hashes[i] = hasher->HashFile(files[i]);
+      }
+    };
+    std::vector<std::thread> threads;
+    threads.reserve(threadCount - 1);
+    for (std::size_t i = 1; i < threadCount; ++i) {
+      threads.emplace_back(work, hashers[i].get());
+    }
+    work(hashers[0].get());
+    for (std::thread& thread : threads) {
+      thread.join();
+    }
+    return hashes;
+  }
+#endif
+  cmCryptoHash hasher(algo);
+  for (std::size_t i = 0; i < files.size(); ++i) {
+    hashes[i] = hasher.HashFile(files[i]);
+  }
+  return hashes;
+}
+
 void cmCryptoHash::Initialize()
 {
+  if (this->Blocks) {
+    this->Blocks->Initialize();
+    return;
+  }
   rhash_reset(this->CTX);
 }
 
 void cmCryptoHash::Append(void const* buf, size_t sz)
 {
+  if (this->Blocks) {
+    this->Blocks->Append(static_cast<unsigned char const*>(buf), sz);
+    return;
+  }
   rhash_update(this->CTX, buf, sz);
 }
 
 void cmCryptoHash::Append(cm::string_view input)
 {
-  rhash_update(this->CTX, input.data(), input.size());
+  this->Append(input.data(), input.size());
 }
 
 std::vector<unsigned char> cmCryptoHash::Finalize()
 {
+  if (this->Blocks) {
+    return this->Blocks->Finalize();
+  }
   std::vector<unsigned char> hash(rhash_get_digest_size(this->Id), 0);
   rhash_final(this->CTX, hash.data());
   return hash;
@@ -74,6 +74,14 @@ public:
   ///         An empty string otherwise.
   std::string HashFile(const std::string& file);
 
+  /// @brief Calculates the hash strings of the contents of many files
+  ///        concurrently
+  /// @see HashFile()
+  /// @return One hash string per file, in the same order.  The string is
+  ///         empty if the file could not be read.
+  static std::vector<std::string> HashFiles(
+    Algo algo, std::vector<std::string> const& files);
+
   void Initialize();
   void Append(void const*, size_t);
   void Append(cm::string_view input);
@@ -81,6 +89,10 @@ public:
   std::string FinalizeHex();
 
 private:
+  struct BlockHash;
+
   unsigned int Id;
-  struct rhash_context* CTX;
+  struct rhash_context* CTX = nullptr;
+  // Used in place of CTX when the CPU can compute the hash itself.
+  std::unique_ptr<BlockHash> Blocks;
 };
@@ -0,0 +1,237 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file Copyright.txt or https://cmake.org/licensing for details.  */
+#include "cmCryptoHashAccel.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) &&                            \
+  ((defined(__GNUC__) && __GNUC__ >= 5) || defined(__clang__)) &&             \
+  !defined(__INTEL_COMPILER)
+#  include <cpuid.h>
+#  include <immintrin.h>
+#  define CM_CRYPTO_HASH_ACCEL_X86
+#  define CM_CRYPTO_HASH_ACCEL_TARGET                                         \
+    __attribute__((target("sha,sse4.1,ssse3")))
+#elif (defined(_M_X64) || defined(_M_IX86)) && defined(_MSC_VER) &&          \
+  _MSC_VER >= 1900 && !defined(__clang__)
+#  include <immintrin.h>
+#  include <intrin.h>
+#  define CM_CRYPTO_HASH_ACCEL_X86
+#  define CM_CRYPTO_HASH_ACCEL_TARGET
+#endif
+
+#if defined(CM_CRYPTO_HASH_ACCEL_X86)
+
+namespace {
+
+bool HaveSHAExtensions()
+{
+  // SSSE3 and SSE4.1 are in leaf 1 ECX, SHA is in leaf 7 EBX.
+  unsigned int const ssse3 = 1u << 9;
+  unsigned int const sse41 = 1u << 19;
+  unsigned int const sha = 1u << 29;
+#  if defined(_MSC_VER) && !defined(__clang__)
+  int regs[4];
+  __cpuid(regs, 0);
+  if (regs[0] < 7) {
+    return false;
+  }
+  __cpuid(regs, 1);
+  unsigned int const ecx1 = static_cast<unsigned int>(regs[2]);
+  __cpuidex(regs, 7, 0);
+  unsigned int const ebx7 = static_cast<unsigned int>(regs[1]);
+#  else
+  unsigned int eax;
+  unsigned int ebx;
+  unsigned int ecx;
+  unsigned int edx;
+  if (__get_cpuid_max(0, nullptr) < 7 ||
+      !__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+    return false;
+  }
+  unsigned int const ecx1 = ecx;
+  __cpuid_count(7, 0, eax, ebx, ecx, edx);
+  unsigned int const ebx7 = ebx;
+#  endif
+  return (ecx1 & ssse3) && (ecx1 & sse41) && (ebx7 & sha);
+}
+
+// The round constants of SHA-256, four per group of rounds.
+alignas(16) std::uint32_t const K256[64] = {
+  0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1,
+  0x923f82a4, 0xab1c5ed5, 0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
+  0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174, 0xe49b69c1, 0xefbe4786,
+  0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+  0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147,
+  0x06ca6351, 0x14292967, 0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13,
+  0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85, 0xa2bfe8a1, 0xa81a664b,
+  0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+  0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a,
+  0x5b9cca4f, 0x682e6ff3, 0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+  0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+CM_CRYPTO_HASH_ACCEL_TARGET
+__m128i SHA1Rounds(__m128i abcd, __m128i e, int group)
+{
+  // The round function is an immediate operand.
+  switch (group / 5) {
+    case 0:
+      return _mm_sha1rnds4_epu32(abcd, e, 0);
+    case 1:
+      return _mm_sha1rnds4_epu32(abcd, e, 1);
+    case 2:
+      return _mm_sha1rnds4_epu32(abcd, e, 2);
+    default:
+      return _mm_sha1rnds4_epu32(abcd, e, 3);
+  }
+}
+
+CM_CRYPTO_HASH_ACCEL_TARGET
+void SHA1BlocksX86(std::uint32_t state[5], unsigned char const* data,
+                   std::size_t blocks)
+{
+  __m128i const mask =
+    _mm_set_epi64x(0x0001020304050607LL, 0x08090a0b0c0d0e0fLL);
+  __m128i abcd =
+    _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<__m128i*>(state)),
+                      0x1B);
+  __m128i e0 = _mm_set_epi32(static_cast<int>(state[4]), 0, 0, 0);
+
+  for (; blocks > 0; --blocks, data += 64) {
+    __m128i const abcdSave = abcd;
+    __m128i const e0Save = e0;
+    __m128i e1 = _mm_setzero_si128();
+    __m128i w[4];
+
+    // Each group of four rounds consumes one quarter of the message
+    // schedule in w, and the schedule for later groups is computed
+    // alongside.
+    for (int g = 0; g < 20; ++g) {
+      __m128i& cur = w[g % 4];
+      if (g < 4) {
+        cur = _mm_shuffle_epi8(
+          _mm_loadu_si128(reinterpret_cast<__m128i const*>(data + 16 * g)),
+          mask);
+      }
+      __m128i& e = (g % 2) ? e1 : e0;
+      if (g == 0) {
+        e = _mm_add_epi32(e, cur);
+      } else {
+        e = _mm_sha1nexte_epu32(e, cur);
+      }
+      ((g % 2) ? e0 : e1) = abcd;
+      if (g >= 3 && g <= 18) {
+        w[(g + 1) % 4] = _mm_sha1msg2_epu32(w[(g + 1) % 4], cur);
+      }
+      abcd = SHA1Rounds(abcd, e, g);
+      if (g >= 1 && g <= 16) {
+        w[(g + 3) % 4] = _mm_sha1msg1_epu32(w[(g + 3) % 4], cur);
+      }
+      if (g >= 2 && g <= 17) {
+        w[(g + 2) % 4] = _mm_xor_si128(w[(g + 2) % 4], cur);
+      }
+    }
+
+    e0 = _mm_sha1nexte_epu32(e0, e0Save);
+    abcd = _mm_add_epi32(abcd, abcdSave);
+  }
+
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(state),
+                   _mm_shuffle_epi32(abcd, 0x1B));
+  state[4] = static_cast<std::uint32_t>(_mm_extract_epi32(e0, 3));
+}
+
+CM_CRYPTO_HASH_ACCEL_TARGET
+void SHA256BlocksX86(std::uint32_t state[8], unsigned char const* data,
+                     std::size_t blocks)
+{
+  __m128i const mask =
+    _mm_set_epi64x(0x0c0d0e0f08090a0bLL, 0x0405060700010203LL);
+
+  // The instructions keep the state as ABEF and CDGH.
+  __m128i tmp = _mm_shuffle_epi32(
+    _mm_loadu_si128(reinterpret_cast<__m128i*>(&state[0])), 0xB1);
+  __m128i state1 = _mm_shuffle_epi32(
+    _mm_loadu_si128(reinterpret_cast<__m128i*>(&state[4])), 0x1B);
+  __m128i state0 = _mm_alignr_epi8(tmp, state1, 8);
+  state1 = _mm_blend_epi16(state1, tmp, 0xF0);
+
+  for (; blocks > 0; --blocks, data += 64) {
+    __m128i const abefSave = state0;
+    __m128i const cdghSave = state1;
+    __m128i w[4];
+
+    for (int g = 0; g < 16; ++g) {
+      __m128i& cur = w[g % 4];
+      if (g < 4) {
+        cur = _mm_shuffle_epi8(
+          _mm_loadu_si128(reinterpret_cast<__m128i const*>(data + 16 * g)),
+          mask);
+      }
+      __m128i msg = _mm_add_epi32(
+        cur, _mm_load_si128(reinterpret_cast<__m128i const*>(K256 + 4 * g)));
+      state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+      if (g >= 3 && g <= 14) {
+        __m128i& next = w[(g + 1) % 4];
+        next = _mm_add_epi32(next, _mm_alignr_epi8(cur, w[(g + 3) % 4], 4));
+        next = _mm_sha256msg2_epu32(next, cur);
+      }
+      msg = _mm_shuffle_epi32(msg, 0x0E);
+      state0 = _mm_sha256rnds2_epu32(state0, state1, msg);
+      if (g >= 1 && g <= 12) {
+        w[(g + 3) % 4] = _mm_sha256msg1_epu32(w[(g + 3) % 4], cur);
+      }
+    }
+
+    state0 = _mm_add_epi32(state0, abefSave);
+    state1 = _mm_add_epi32(state1, cdghSave);
+  }
+
+  tmp = _mm_shuffle_epi32(state0, 0x1B);
+  state1 = _mm_shuffle_epi32(state1, 0xB1);
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(&state[0]),
+                   _mm_blend_epi16(tmp, state1, 0xF0));
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(&state[4]),
+                   _mm_alignr_epi8(state1, tmp, 8));
+}
+}
+
+bool cmCryptoHashAccel::IsAvailable()
+{
+  static bool const available = HaveSHAExtensions();
+  return available;
+}
+
+void cmCryptoHashAccel::SHA1Blocks(std::uint32_t state[5],
+                                   unsigned char const* data,
+                                   std::size_t blocks)
+{
+  SHA1BlocksX86(state, data, blocks);
+}
+
+void cmCryptoHashAccel::SHA256Blocks(std::uint32_t state[8],
+                                     unsigned char const* data,
+                                     std::size_t blocks)
+{
+  SHA256BlocksX86(state, data, blocks);
+}
+
+#else
+
+bool cmCryptoHashAccel::IsAvailable()
+{
+  return false;
+}
+
+void cmCryptoHashAccel::SHA1Blocks(std::uint32_t /*state*/[5],
+                                   unsigned char const* /*data*/,
+                                   std::size_t /*blocks*/)
+{
+}
+
+void cmCryptoHashAccel::SHA256Blocks(std::uint32_t /*state*/[8],
+                                     unsigned char const* /*data*/,
+                                     std::size_t /*blocks*/)
+{
+}
+
+#endif
@@ -0,0 +1,29 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file Copyright.txt or https://cmake.org/licensing for details.  */
+#pragma once
+
+#include "cmConfigure.h" // IWYU pragma: keep
+
+#include <cstddef>
+#include <cstdint>
+
+/** \class cmCryptoHashAccel
+ * \brief SHA-1 and SHA-256 block functions using CPU instructions.
+ *
+ * cmCryptoHash uses these in place of librhash when the processor
+ * running CMake has the x86 SHA extensions.  The functions process whole
+ * 64-byte blocks; padding is left to the caller.
+ */
+class cmCryptoHashAccel
+{
+public:
+  /** Return true if the block functions can be used on this machine.  */
+  static bool IsAvailable();
+
+  static void SHA1Blocks(std::uint32_t state[5], unsigned char const* data,
+                         std::size_t blocks);
+
+  /** Process blocks for SHA-256, or SHA-224 with its own initial state. */
+  static void SHA256Blocks(std::uint32_t state[8], unsigned char const* data,
+                           std::size_t blocks);
+};
@@ -3,7 +3,9 @@
 #include "cmDefinitions.h"
 
 #include <cassert>
-#include <functional>
+#include <cstdint>
+#include <deque>
+#include <unordered_map>
 #include <unordered_set>
 #include <utility>
 
@@ -11,47 +13,174 @@
 
 cmDefinitions::Def cmDefinitions::NoDef;
 
-cmDefinitions::Def const& cmDefinitions::GetInternal(const std::string& key,
-                                                     StackIter begin,
+struct cmDefinitions::AtomTable
+{
+  // Atoms are never freed, so a deque gives them stable addresses
+  // without a separate allocation per name.
+  std::deque<Atom> Atoms;
+  std::unordered_map<cm::string_view, Atom*> Index;
+};
+
+cmDefinitions::AtomTable& cmDefinitions::GetAtomTable()
+{
+  static AtomTable table;
+  return table;
+}
+
+namespace {
+inline std::size_t HashAtom(void const* atom)
+{
+  // Atoms are at least pointer-aligned, so drop the low bits and mix
+  // the rest with a multiplicative hash.
+  auto v = static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(atom));
+  v = (v >> 3) * 0x9E3779B97F4A7C15ull;
+  return static_cast<std::size_t>(v ^ (v >> 32));
+}
+}
+
+cmDefinitions::Key cmDefinitions::Intern(const std::string& name)
+{
+  AtomTable& table = cmDefinitions::GetAtomTable();
+  auto it = table.Index.find(name);
+  if (it != table.Index.end()) {
+    return it->second;
+  }
+  table.Atoms.emplace_back(name);
+  Atom* atom = &table.Atoms.back();
+  table.Index.emplace(atom->Name, atom);
+  return atom;
+}
+
+cmDefinitions::Key cmDefinitions::Lookup(const std::string& name)
+{
+  AtomTable& table = cmDefinitions::GetAtomTable();
+  auto it = table.Index.find(name);
+  return it != table.Index.end() ? it->second : nullptr;
+}
+
+template <typename T>
+T* cmDefinitions::AtomMap<T>::Find(Key key)
+{
+  if (this->Slots.empty()) {
+    return nullptr;
+  }
+  std::size_t const mask = this->Slots.size() - 1;
+  for (std::size_t i = HashAtom(key) & mask;; i = (i + 1) & mask) {
+    Slot& slot = this->Slots[i];
+    if (slot.First == key) {
+      return &slot.Second;
+    }
+    if (!slot.First) {
+      return nullptr;
+    }
+  }
+}
+
+template <typename T>
+T& cmDefinitions::AtomMap<T>::operator[](Key key)
+{
+  // Keep the load factor at or below one half.
+  if ((this->Count + 1) * 2 > this->Slots.size()) {
+    this->Grow();
+  }
+  std::size_t const mask = this->Slots.size() - 1;
+  for (std::size_t i = HashAtom(key) & mask;; i = (i + 1) & mask) {
+    Slot& slot = this->Slots[i];
+    if (slot.First == key) {
+      return slot.Second;
+    }
+    if (!slot.First) {
+      slot.First = key;
+      ++this->Count;
+      return slot.Second;
+    }
+  }
+}
+
+template <typename T>
+void cmDefinitions::AtomMap<T>::Grow()
+{
+  std::vector<Slot> old;
+  old.swap(this->Slots);
+  this->Slots.resize(old.empty() ? 8 : old.size() * 2);
+  std::size_t const mask = this->Slots.size() - 1;
+  for (Slot& o : old) {
+    if (!o.First) {
+      continue;
+    }
+    std::size_t i = HashAtom(o.First) & mask;
+    while (this->Slots[i].First) {
+      i = (i + 1) & mask;
+    }
+    this->Slots[i].First = o.First;
+    this->Slots[i].Second = std::move(o.Second);
+  }
+}
+
+cmDefinitions::Def const& cmDefinitions::GetInternal(Key key, StackIter begin,
                                                      StackIter end, bool raise)
 {
   assert(begin != end);
-  {
-    auto it = begin->Map.find(cm::String::borrow(key));
-    if (it != begin->Map.end()) {
-      return it->second;
-    }
+  if (Def* def = begin->Map.Find(key)) {
+    return *def;
   }
   StackIter it = begin;
   ++it;
   if (it == end) {
     return cmDefinitions::NoDef;
   }
-  Def const& def = cmDefinitions::GetInternal(key, it, end, raise);
-  if (!raise) {
-    return def;
+  if (raise) {
+    Def const& def = cmDefinitions::GetInternal(key, it, end, raise);
+    return begin->Map[key] = def;
+  }
+
+  // Answer repeated lookups of the same name from the lookup cache
+  // as long as nobody has set or unset the name since.
+  if (CachedDef* cached = begin->Cache.Find(key)) {
+    if (cached->Version == key->Version) {
+      return cached->Value;
+    }
   }
-  return begin->Map.emplace(key, def).first->second;
+  Def const* found = &cmDefinitions::NoDef;
+  for (; it != end; ++it) {
+    if (Def* def = it->Map.Find(key)) {
+      found = def;
+      break;
+    }
+  }
+  CachedDef& cached = begin->Cache[key];
+  cached.Value = *found;
+  cached.Version = key->Version;
+  return cached.Value;
 }
 
 cmValue cmDefinitions::Get(const std::string& key, StackIter begin,
                            StackIter end)
 {
-  Def const& def = cmDefinitions::GetInternal(key, begin, end, false);
+  // A name that was never interned was never set in any scope.
+  Key const atom = cmDefinitions::Lookup(key);
+  if (!atom) {
+    return nullptr;
+  }
+  Def const& def = cmDefinitions::GetInternal(atom, begin, end, false);
   return def.Value ? cmValue(def.Value.str_if_stable()) : nullptr;
 }
 
 void cmDefinitions::Raise(const std::string& key, StackIter begin,
                           StackIter end)
 {
-  cmDefinitions::GetInternal(key, begin, end, true);
+  cmDefinitions::GetInternal(cmDefinitions::Intern(key), begin, end, true);
 }
 
 bool cmDefinitions::HasKey(const std::string& key, StackIter begin,
                            StackIter end)
 {
+  Key const atom = cmDefinitions::Lookup(key);
+  if (!atom) {
+    return false;
+  }
   for (StackIter it = begin; it != end; ++it) {
-    if (it->Map.find(cm::String::borrow(key)) != it->Map.end()) {
+    if (it->Map.Find(atom)) {
       return true;
     }
   }
@@ -61,20 +190,19 @@ bool cmDefinitions::HasKey(const std::string& key, StackIter begin,
 cmDefinitions cmDefinitions::MakeClosure(StackIter begin, StackIter end)
 {
   cmDefinitions closure;
-  std::unordered_set<cm::string_view> undefined;
+  std::unordered_set<Key> undefined;
   for (StackIter it = begin; it != end; ++it) {
     // Consider local definitions.
-    for (auto const& mi : it->Map) {
+    it->Map.ForEach([&closure, &undefined](Key key, Def const& def) {
       // Use this key if it is not already set or unset.
-      if (closure.Map.find(mi.first) == closure.Map.end() &&
-          undefined.find(mi.first.view()) == undefined.end()) {
-        if (mi.second.Value) {
-          closure.Map.insert(mi);
+      if (!closure.Map.Find(key) && undefined.find(key) == undefined.end()) {
+        if (def.Value) {
+          closure.Map[key] = def;
         } else {
-          undefined.emplace(mi.first.view());
+          undefined.emplace(key);
         }
       }
-    }
+    });
   }
   return closure;
 }
@@ -83,16 +211,16 @@ std::vector<std::string> cmDefinitions::ClosureKeys(StackIter begin,
                                                     StackIter end)
 {
   std::vector<std::string> defined;
-  std::unordered_set<cm::string_view> bound;
+  std::unordered_set<Key> bound;
 
   for (StackIter it = begin; it != end; ++it) {
-    defined.reserve(defined.size() + it->Map.size());
-    for (auto const& mi : it->Map) {
+    defined.reserve(defined.size() + it->Map.Size());
+    it->Map.ForEach([&defined, &bound](Key key, Def const& def) {
       // Use this key if it is not already set or unset.
-      if (bound.emplace(mi.first.view()).second && mi.second.Value) {
-        defined.push_back(*mi.first.str_if_stable());
+      if (bound.emplace(key).second && def.Value) {
+        defined.push_back(key->Name);
       }
-    }
+    });
   }
 
   return defined;
@@ -100,10 +228,14 @@ std::vector<std::string> cmDefinitions::ClosureKeys(StackIter begin,
 
 void cmDefinitions::Set(const std::string& key, cm::string_view value)
 {
-  this->Map[key] = Def(value);
+  Key const atom = cmDefinitions::Intern(key);
+  this->Map[atom] = Def(value);
+  ++atom->Version;
 }
 
 void cmDefinitions::Unset(const std::string& key)
 {
-  this->Map[key] = Def();
+  Key const atom = cmDefinitions::Intern(key);
+  this->Map[atom] = Def();
+  ++atom->Version;
 }
@@ -4,9 +4,9 @@
 
 #include "cmConfigure.h" // IWYU pragma: keep
 
-#include <functional>
+#include <cstddef>
 #include <string>
-#include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include <cm/string_view>
@@ -21,6 +21,11 @@
  * This stores the state of variable definitions (set or unset) for
  * one scope.  Sets are always local.  Gets search parent scopes
  * transitively and save results locally.
+ *
+ * Variable names are interned so that each is hashed only once per
+ * lookup no matter how deep the scope chain is.  Values found in parent
+ * scopes are remembered in a per-scope lookup cache that is invalidated
+ * whenever the name is set or unset anywhere.
  */
 class cmDefinitions
 {
@@ -48,6 +53,25 @@ public:
   void Unset(const std::string& key);
 
 private:
+  /** Interned variable name.  Names are hashed once when interned and
+      are afterwards compared and hashed by address.  The version is
+      bumped whenever the name is set or unset in any scope.  */
+  struct Atom
+  {
+    Atom(std::string name)
+      : Name(std::move(name))
+    {
+    }
+    std::string Name;
+    unsigned int Version = 0;
+  };
+  using Key = Atom*;
+
+  struct AtomTable;
+  static AtomTable& GetAtomTable();
+  static Key Intern(const std::string& name);
+  static Key Lookup(const std::string& name);
+
   /** String with existence boolean.  */
   struct Def
   {
@@ -61,8 +85,49 @@ private:
   };
   static Def NoDef;
 
-  std::unordered_map<cm::String, Def> Map;
+  /** Value found in an enclosing scope, tagged with the atom version.  */
+  struct CachedDef
+  {
+    Def Value;
+    unsigned int Version = 0;
+  };
+
+  /** Open-addressing hash table keyed on interned atoms.  Entries are
+      never erased, so all of a scope's entries live in one allocation.  */
+  template <typename T>
+  class AtomMap
+  {
+  public:
+    T* Find(Key key);
+    T& operator[](Key key);
+
+    template <typename F>
+    void ForEach(F const& f) const
+    {
+      for (Slot const& slot : this->Slots) {
+        if (slot.First) {
+          f(slot.First, slot.Second);
+        }
+      }
+    }
+
+    std::size_t Size() const { return this->Count; }
+
+  private:
+    struct Slot
+    {
+      Key First = nullptr;
+      T Second;
+    };
+    std::vector<Slot> Slots;
+    std::size_t Count = 0;
+
+    void Grow();
+  };
+
+  AtomMap<Def> Map;
+  AtomMap<CachedDef> Cache;
 
-  static Def const& GetInternal(const std::string& key, StackIter begin,
-                                StackIter end, bool raise);
+  static Def const& GetInternal(Key key, StackIter begin, StackIter end,
+                                bool raise);
 };
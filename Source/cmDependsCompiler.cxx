@@ -26,11 +26,22 @@
 #include "cmStringAlgorithms.h"
 #include "cmSystemTools.h"
 
+#if !defined(CMAKE_BOOTSTRAP)
+#  include "cmDependsCompilerLog.h"
+#endif
+
 bool cmDependsCompiler::CheckDependencies(
   const std::string& internalDepFile, const std::vector<std::string>& depFiles,
   cmDepends::DependencyMap& dependencies,
   const std::function<bool(const std::string&)>& isValidPath)
 {
+#if !defined(CMAKE_BOOTSTRAP)
+  if (!this->LogFile.empty()) {
+    return this->CheckLoggedDependencies(internalDepFile, depFiles,
+                                         dependencies, isValidPath);
+  }
+#endif
+
   bool status = true;
   bool forceReadDeps = true;
 
@@ -96,95 +107,172 @@ bool cmDependsCompiler::CheckDependencies(
                                        internalDepFile, "\".\n"));
       }
 
-      std::vector<std::string> depends;
-      if (format == "custom"_s) {
-        auto deps = cmReadGccDepfile(
-          depFile.c_str(), this->LocalGenerator->GetCurrentBinaryDirectory());
-        if (!deps) {
-          continue;
-        }
+      RuleList rules;
+      if (this->ReadDependencies(source, target, format, depFile,
+                                 isValidPath, rules)) {
+        MergeDependencies(format, std::move(rules), dependencies);
+      }
+    }
+  }
 
-        for (auto& entry : *deps) {
-          depends = std::move(entry.paths);
-          if (isValidPath) {
-            cm::erase_if(depends, isValidPath);
-          }
-          // copy depends for each target, except first one, which can be
-          // moved
-          for (auto index = entry.rules.size() - 1; index > 0; --index) {
-            auto& rule_deps = dependencies[entry.rules[index]];
-            rule_deps.insert(rule_deps.end(), depends.cbegin(),
-                             depends.cend());
-          }
-          auto& rule_deps = dependencies[entry.rules.front()];
-          std::move(depends.cbegin(), depends.cend(),
-                    std::back_inserter(rule_deps));
-        }
-      } else {
-        if (format == "msvc"_s) {
-          cmsys::ifstream fin(depFile.c_str());
-          if (!fin) {
-            continue;
-          }
+  return status;
+}
 
-          std::string line;
-          if (!isValidPath) {
-            // insert source as first dependency
-            depends.push_back(source);
-          }
-          while (cmSystemTools::GetLineFromStream(fin, line)) {
-            depends.emplace_back(std::move(line));
-          }
-        } else if (format == "gcc"_s) {
-          auto deps = cmReadGccDepfile(
-            depFile.c_str(), this->LocalGenerator->GetCurrentBinaryDirectory(),
-            GccDepfilePrependPaths::Deps);
-          if (!deps) {
-            continue;
-          }
+#if !defined(CMAKE_BOOTSTRAP)
+bool cmDependsCompiler::CheckLoggedDependencies(
+  const std::string& internalDepFile, const std::vector<std::string>& depFiles,
+  cmDepends::DependencyMap& dependencies,
+  const std::function<bool(const std::string&)>& isValidPath)
+{
+  // The internal file only tells whether the make depends file was
+  // written since the dependencies were last cleared.
+  bool status = cmSystemTools::FileExists(internalDepFile);
+  bool const filtered = static_cast<bool>(isValidPath);
 
-          // dependencies generated by the compiler contains only one target
-          depends = std::move(deps->front().paths);
-          if (depends.empty()) {
-            // unexpectedly empty, ignore it and continue
-            continue;
-          }
+  cmDependsCompilerLog log(this->LogFile);
+  log.Load();
 
-          // depending of the effective format of the dependencies file
-          // generated by the compiler, the target can be wrongly identified
-          // as a dependency so remove it from the list
-          if (depends.front() == target) {
-            depends.erase(depends.begin());
-          }
+  cmFileTime depFileTime;
+  for (auto dep = depFiles.begin(); dep != depFiles.end(); dep++) {
+    const auto& source = *dep++;
+    const auto& target = *dep++;
+    const auto& format = *dep++;
+    const auto& depFile = *dep;
 
-          // ensure source file is the first dependency
-          if (depends.front() != source) {
-            cm::erase(depends, source);
-            if (!isValidPath) {
-              depends.insert(depends.begin(), source);
-            }
-          } else if (isValidPath) {
-            // remove first dependency because it must not be filtered out
-            depends.erase(depends.begin());
-          }
-        } else {
-          // unknown format, ignore it
-          continue;
-        }
+    if (!depFileTime.Load(depFile)) {
+      continue;
+    }
 
-        if (isValidPath) {
-          cm::erase_if(depends, isValidPath);
-          // insert source as first dependency
-          depends.insert(depends.begin(), source);
-        }
+    RuleList rules;
+    if (!log.Lookup(depFile, depFileTime.GetTime(), filtered, rules)) {
+      status = false;
+      if (this->Verbose) {
+        cmSystemTools::Stdout(cmStrCat("Dependencies file \"", depFile,
+                                       "\" is not recorded in \"",
+                                       this->LogFile, "\".\n"));
+      }
 
-        dependencies[target] = std::move(depends);
+      if (!this->ReadDependencies(source, target, format, depFile,
+                                  isValidPath, rules)) {
+        continue;
       }
+      log.Record(depFile, depFileTime.GetTime(), filtered, rules);
     }
+    MergeDependencies(format, std::move(rules), dependencies);
   }
 
+  // Failing to record the dependencies only means that they are read
+  // again next time.
+  log.Save();
+
   return status;
 }
+#endif
+
+bool cmDependsCompiler::ReadDependencies(
+  const std::string& source, const std::string& target,
+  const std::string& format, const std::string& depFile,
+  const std::function<bool(const std::string&)>& isValidPath, RuleList& rules)
+{
+  std::vector<std::string> depends;
+  if (format == "custom"_s) {
+    auto deps = cmReadGccDepfile(
+      depFile.c_str(), this->LocalGenerator->GetCurrentBinaryDirectory());
+    if (!deps) {
+      return false;
+    }
+
+    for (auto& entry : *deps) {
+      depends = std::move(entry.paths);
+      if (isValidPath) {
+        cm::erase_if(depends, isValidPath);
+      }
+      // copy depends for each target, except first one, which can be
+      // moved
+      for (auto index = entry.rules.size() - 1; index > 0; --index) {
+        rules.emplace_back(std::move(entry.rules[index]), depends);
+      }
+      rules.emplace_back(std::move(entry.rules.front()), std::move(depends));
+    }
+    return true;
+  }
+
+  if (format == "msvc"_s) {
+    cmsys::ifstream fin(depFile.c_str());
+    if (!fin) {
+      return false;
+    }
+
+    std::string line;
+    if (!isValidPath) {
+      // insert source as first dependency
+      depends.push_back(source);
+    }
+    while (cmSystemTools::GetLineFromStream(fin, line)) {
+      depends.emplace_back(std::move(line));
+    }
+  } else if (format == "gcc"_s) {
+    auto deps = cmReadGccDepfile(
+      depFile.c_str(), this->LocalGenerator->GetCurrentBinaryDirectory(),
+      GccDepfilePrependPaths::Deps);
+    if (!deps) {
+      return false;
+    }
+
+    // dependencies generated by the compiler contains only one target
+    depends = std::move(deps->front().paths);
+    if (depends.empty()) {
+      // unexpectedly empty, ignore it and continue
+      return false;
+    }
+
+    // depending of the effective format of the dependencies file
+    // generated by the compiler, the target can be wrongly identified
+    // as a dependency so remove it from the list
+    if (depends.front() == target) {
+      depends.erase(depends.begin());
+    }
+
+    // ensure source file is the first dependency
+    if (depends.front() != source) {
+      cm::erase(depends, source);
+      if (!isValidPath) {
+        depends.insert(depends.begin(), source);
+      }
+    } else if (isValidPath) {
+      // remove first dependency because it must not be filtered out
+      depends.erase(depends.begin());
+    }
+  } else {
+    // unknown format, ignore it
+    return false;
+  }
+
+  if (isValidPath) {
+    cm::erase_if(depends, isValidPath);
+    // insert source as first dependency
+    depends.insert(depends.begin(), source);
+  }
+
+  rules.emplace_back(target, std::move(depends));
+  return true;
+}
+
+void cmDependsCompiler::MergeDependencies(
+  const std::string& format, RuleList rules,
+  cmDepends::DependencyMap& dependencies)
+{
+  for (auto& rule : rules) {
+    if (format == "custom"_s) {
+      // a custom command may list the same output in several rules
+      auto& rule_deps = dependencies[rule.first];
+      std::move(rule.second.begin(), rule.second.end(),
+                std::back_inserter(rule_deps));
+    } else {
+      dependencies[rule.first] = std::move(rule.second);
+    }
+  }
+}
 
 void cmDependsCompiler::WriteDependencies(
   const cmDepends::DependencyMap& dependencies, std::ostream& makeDepends,
@@ -238,6 +326,11 @@ void cmDependsCompiler::WriteDependencies(
   }
 
   // internal dependencies file
+  if (!this->LogFile.empty()) {
+    internalDepends << "# Dependencies are recorded in \"" << this->LogFile
+                    << "\"." << std::endl;
+    return;
+  }
   for (const auto& node : dependencies) {
     internalDepends << node.first << std::endl;
     for (const auto& dep : node.second) {
@@ -7,6 +7,7 @@
 #include <functional>
 #include <iosfwd>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "cmDepends.h"
@@ -37,6 +38,10 @@ public:
     this->LocalGenerator = lg;
   }
 
+  /** Record the dependencies in the given log of the build tree instead
+      of the internal dependencies file of the target.  */
+  void SetLogFile(std::string const& logFile) { this->LogFile = logFile; }
+
   /** Read dependencies for the target file. Return true if
       dependencies didn't changed and false if not.
       Up-to-date Dependencies will be stored in deps. */
@@ -55,6 +60,27 @@ public:
   void ClearDependencies(const std::vector<std::string>& depFiles);
 
 private:
+  using RuleList =
+    std::vector<std::pair<std::string, std::vector<std::string>>>;
+
+#if !defined(CMAKE_BOOTSTRAP)
+  bool CheckLoggedDependencies(
+    const std::string& internalDepFile,
+    const std::vector<std::string>& depFiles,
+    cmDepends::DependencyMap& dependencies,
+    const std::function<bool(const std::string&)>& isValidPath);
+#endif
+
+  bool ReadDependencies(
+    const std::string& source, const std::string& target,
+    const std::string& format, const std::string& depFile,
+    const std::function<bool(const std::string&)>& isValidPath,
+    RuleList& rules);
+
+  static void MergeDependencies(const std::string& format, RuleList rules,
+                                cmDepends::DependencyMap& dependencies);
+
   bool Verbose = false;
   cmLocalUnixMakefileGenerator3* LocalGenerator = nullptr;
+  std::string LogFile;
 };
@@ -0,0 +1,333 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file Copyright.txt or https://cmake.org/licensing for details.  */
+#include "cmDependsCompilerLog.h"
+
+#include <cstring>
+#include <ios>
+#include <iterator>
+
+#include "cmsys/FStream.hxx"
+
+#include "cmStringAlgorithms.h"
+#include "cmSystemTools.h"
+
+namespace {
+// The log starts with a signature and a version number.  Each record
+// then starts with a 32 bit header holding its size in bytes.  The high
+// bit of the header tells dependency records from path records.
+//
+// A path record holds the path padded with NUL characters to a multiple
+// of four bytes and the one's complement of its index to detect a log
+// that was not written completely.
+//
+// A dependency record holds the index of the depfile path, flags, the
+// modification time of the depfile and for each rule the index of its
+// path, the number of dependencies and their path indices.
+char const kSignature[] = "# cmake compiler depends log\n";
+std::uint32_t const kVersion = 1;
+std::uint32_t const kDepsRecord = 0x80000000u;
+std::uint32_t const kFilteredFlag = 1;
+
+// Rewrite the log once it holds at least this many records and this
+// ratio of them is superseded.
+std::size_t const kMinCompactionRecords = 1000;
+std::size_t const kCompactionRatio = 3;
+
+void AppendU32(std::string& out, std::uint32_t value)
+{
+  char bytes[sizeof(value)];
+  std::memcpy(bytes, &value, sizeof(value));
+  out.append(bytes, sizeof(value));
+}
+
+std::uint32_t ReadU32(char const* data)
+{
+  std::uint32_t value;
+  std::memcpy(&value, data, sizeof(value));
+  return value;
+}
+
+void AppendPathRecord(std::string& out, std::string const& path,
+                      std::uint32_t id)
+{
+  std::size_t const padded = (path.size() + 3) & ~std::size_t(3);
+  AppendU32(out, static_cast<std::uint32_t>(padded + 4));
+  out += path;
+  out.append(padded - path.size(), '\0');
+  AppendU32(out, ~id);
+}
+
+void AppendDepsRecord(std::string& out, std::uint32_t depFileId,
+                      cmFileTime::TimeType time, bool filtered,
+                      std::vector<std::uint32_t> const& data)
+{
+  auto const time64 = static_cast<std::uint64_t>(time);
+  AppendU32(out,
+            kDepsRecord | static_cast<std::uint32_t>((4 + data.size()) * 4));
+  AppendU32(out, depFileId);
+  AppendU32(out, filtered ? kFilteredFlag : 0);
+  AppendU32(out, static_cast<std::uint32_t>(time64));
+  AppendU32(out, static_cast<std::uint32_t>(time64 >> 32));
+  for (std::uint32_t value : data) {
+    AppendU32(out, value);
+  }
+}
+
+std::string Header()
+{
+  std::string header = kSignature;
+  AppendU32(header, kVersion);
+  return header;
+}
+
+bool ReadFile(std::string const& file, std::string& content)
+{
+  cmsys::ifstream fin(file.c_str(), std::ios::in | std::ios::binary);
+  if (!fin) {
+    return false;
+  }
+  content.assign(std::istreambuf_iterator<char>(fin),
+                 std::istreambuf_iterator<char>());
+  return true;
+}
+}
+
+cmDependsCompilerLog::cmDependsCompilerLog(std::string file)
+  : File(std::move(file))
+{
+}
+
+void cmDependsCompilerLog::Load()
+{
+  // The records before an incomplete one are still used, and the log is
+  // rewritten when it is saved.
+  std::string content;
+  this->Valid = ReadFile(this->File, content) && this->Parse(content);
+}
+
+bool cmDependsCompilerLog::Parse(std::string const& content)
+{
+  this->Paths.clear();
+  this->PathIds.clear();
+  this->Entries.clear();
+  this->RecordCount = 0;
+
+  std::string const header = Header();
+  if (content.compare(0, header.size(), header) != 0) {
+    return false;
+  }
+
+  std::vector<std::uint32_t> words;
+  std::size_t pos = header.size();
+  while (pos < content.size()) {
+    if (content.size() - pos < 4) {
+      return false;
+    }
+    std::uint32_t const head = ReadU32(content.data() + pos);
+    std::size_t const size = head & ~kDepsRecord;
+    pos += 4;
+    if (size % 4 != 0 || size < 4 || size > content.size() - pos) {
+      return false;
+    }
+    char const* data = content.data() + pos;
+    pos += size;
+
+    if ((head & kDepsRecord) == 0) {
+      auto const id = static_cast<std::uint32_t>(this->Paths.size());
+      if (ReadU32(data + size - 4) != ~id) {
+        return false;
+      }
+      std::size_t length = size - 4;
+      while (length > 0 && data[length - 1] == '\0') {
+        --length;
+      }
+      this->Paths.emplace_back(data, length);
+      this->PathIds.emplace(this->Paths.back(), id);
+      continue;
+    }
+
+    if (size < 16) {
+      return false;
+    }
+    words.resize(size / 4);
+    std::memcpy(words.data(), data, size);
+    std::size_t const pathCount = this->Paths.size();
+    if (words[0] >= pathCount) {
+      return false;
+    }
+    for (std::size_t i = 4; i < words.size();) {
+      if (words.size() - i < 2 || words[i] >= pathCount ||
+          words[i + 1] > words.size() - i - 2) {
+        return false;
+      }
+      std::size_t const end = i + 2 + words[i + 1];
+      for (i += 2; i < end; ++i) {
+        if (words[i] >= pathCount) {
+          return false;
+        }
+      }
+    }
+
+    Entry& entry = this->Entries[words[0]];
+    entry.Filtered = (words[1] & kFilteredFlag) != 0;
+    entry.Time = static_cast<cmFileTime::TimeType>(
+      (static_cast<std::uint64_t>(words[3]) << 32) | words[2]);
+    entry.Data.assign(words.begin() + 4, words.end());
+    ++this->RecordCount;
+  }
+  return true;
+}
+
+bool cmDependsCompilerLog::Lookup(std::string const& depFile,
+                                  cmFileTime::TimeType time, bool filtered,
+                                  RuleList& rules) const
+{
+  auto id = this->PathIds.find(depFile);
+  if (id == this->PathIds.end()) {
+    return false;
+  }
+  auto entry = this->Entries.find(id->second);
+  if (entry == this->Entries.end() || entry->second.Time != time ||
+      entry->second.Filtered != filtered) {
+    return false;
+  }
+
+  rules.clear();
+  std::vector<std::uint32_t> const& data = entry->second.Data;
+  for (std::size_t i = 0; i < data.size();) {
+    rules.emplace_back(this->Paths[data[i]], std::vector<std::string>());
+    std::vector<std::string>& deps = rules.back().second;
+    std::size_t const end = i + 2 + data[i + 1];
+    deps.reserve(data[i + 1]);
+    for (i += 2; i < end; ++i) {
+      deps.push_back(this->Paths[data[i]]);
+    }
+  }
+  return true;
+}
+
+void cmDependsCompilerLog::Record(std::string const& depFile,
+                                  cmFileTime::TimeType time, bool filtered,
+                                  RuleList rules)
+{
+  this->PendingRecords.push_back(
+    Pending{ depFile, time, filtered, std::move(rules) });
+}
+
+std::uint32_t cmDependsCompilerLog::GetPathId(std::string const& path)
+{
+  auto it = this->PathIds.find(path);
+  if (it != this->PathIds.end()) {
+    return it->second;
+  }
+  auto const id = static_cast<std::uint32_t>(this->Paths.size());
+  this->Paths.push_back(path);
+  this->PathIds.emplace(path, id);
+  return id;
+}
+
+bool cmDependsCompilerLog::Save()
+{
+  if (this->PendingRecords.empty()) {
+    return true;
+  }
+
+  std::size_t const firstNewPath = this->Paths.size();
+  std::string records;
+  for (Pending& pending : this->PendingRecords) {
+    Entry entry;
+    entry.Time = pending.Time;
+    entry.Filtered = pending.Filtered;
+    for (auto const& rule : pending.Rules) {
+      entry.Data.push_back(this->GetPathId(rule.first));
+      entry.Data.push_back(static_cast<std::uint32_t>(rule.second.size()));
+      for (std::string const& dep : rule.second) {
+        entry.Data.push_back(this->GetPathId(dep));
+      }
+    }
+    std::uint32_t const depFileId = this->GetPathId(pending.DepFile);
+    AppendDepsRecord(records, depFileId, entry.Time, entry.Filtered,
+                     entry.Data);
+    this->Entries[depFileId] = std::move(entry);
+    ++this->RecordCount;
+  }
+  this->PendingRecords.clear();
+
+  if (!this->Valid ||
+      (this->RecordCount >= kMinCompactionRecords &&
+       this->RecordCount >= kCompactionRatio * this->Entries.size())) {
+    return this->Compact();
+  }
+
+  std::string paths;
+  for (std::size_t i = firstNewPath; i < this->Paths.size(); ++i) {
+    AppendPathRecord(paths, this->Paths[i], static_cast<std::uint32_t>(i));
+  }
+  cmsys::ofstream fout(this->File.c_str(),
+                       std::ios::out | std::ios::binary | std::ios::app);
+  if (!fout) {
+    return false;
+  }
+  fout.write(paths.data(), static_cast<std::streamsize>(paths.size()));
+  fout.write(records.data(), static_cast<std::streamsize>(records.size()));
+  fout.close();
+  return !fout.fail();
+}
+
+bool cmDependsCompilerLog::Compact()
+{
+  // Keep the latest record of each depfile that still exists and only
+  // the paths these records use.
+  std::uint32_t const noId = ~std::uint32_t(0);
+  std::vector<std::uint32_t> newIds(this->Paths.size(), noId);
+  std::uint32_t nextId = 0;
+  std::string content = Header();
+  auto mapId = [&](std::uint32_t id) -> std::uint32_t {
+    if (newIds[id] == noId) {
+      newIds[id] = nextId;
+      AppendPathRecord(content, this->Paths[id], nextId);
+      ++nextId;
+    }
+    return newIds[id];
+  };
+
+  std::vector<std::uint32_t> data;
+  for (auto const& entry : this->Entries) {
+    if (!cmSystemTools::FileExists(this->Paths[entry.first])) {
+      continue;
+    }
+    std::uint32_t const depFileId = mapId(entry.first);
+    std::vector<std::uint32_t> const& oldData = entry.second.Data;
+    data.clear();
+    for (std::size_t i = 0; i < oldData.size();) {
+      data.push_back(mapId(oldData[i]));
+      data.push_back(oldData[i + 1]);
+      std::size_t const end = i + 2 + oldData[i + 1];
+      for (i += 2; i < end; ++i) {
+        data.push_back(mapId(oldData[i]));
+      }
+    }
+    AppendDepsRecord(content, depFileId, entry.second.Time,
+                     entry.second.Filtered, data);
+  }
+
+  // Replace the log atomically so that an interrupted build leaves the
+  // previous one.
+  std::string const tmpFile = cmStrCat(this->File, ".tmp");
+  {
+    cmsys::ofstream fout(tmpFile.c_str(),
+                         std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!fout) {
+      return false;
+    }
+    fout.write(content.data(), static_cast<std::streamsize>(content.size()));
+    if (!fout) {
+      return false;
+    }
+  }
+  if (!cmSystemTools::RenameFile(tmpFile, this->File)) {
+    return false;
+  }
+  this->Valid = this->Parse(content);
+  return true;
+}
@@ -0,0 +1,88 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file Copyright.txt or https://cmake.org/licensing for details.  */
+#pragma once
+
+#include "cmConfigure.h" // IWYU pragma: keep
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "cmFileTime.h"
+
+/** \class cmDependsCompilerLog
+ * \brief Binary log of the dependencies read from compiler depfiles.
+ *
+ * When CMAKE_DEPENDS_USE_LOG is enabled the Makefile generators record
+ * the dependencies parsed from each compiler generated depfile of a
+ * target in a binary log in the target directory instead of its
+ * compiler_depend.internal text file.  A record is keyed by the depfile
+ * and its modification time, so only depfiles written since they were
+ * last recorded are parsed again.
+ *
+ * Each check of the dependencies of a target loads the log of that target
+ * once and saves it once.  Paths are stored once and referenced by their
+ * index.  New records are appended to the log, which is rewritten
+ * without superseded records once these dominate it.
+ */
+class cmDependsCompilerLog
+{
+public:
+  /** Dependencies of each rule read from one depfile.  */
+  using RuleList =
+    std::vector<std::pair<std::string, std::vector<std::string>>>;
+
+  explicit cmDependsCompilerLog(std::string file);
+
+  /** Read the log.  A missing or unreadable log is treated as empty.  */
+  void Load();
+
+  /**
+   * @brief Get the rules recorded for a depfile.
+   * @return false if the depfile is not recorded or its record was made
+   *         for another modification time or filtering.
+   */
+  bool Lookup(std::string const& depFile, cmFileTime::TimeType time,
+              bool filtered, RuleList& rules) const;
+
+  /** Record the rules read from a depfile.  They are written by Save.  */
+  void Record(std::string const& depFile, cmFileTime::TimeType time,
+              bool filtered, RuleList rules);
+
+  /** Append the new records to the log, compacting it if needed.  */
+  bool Save();
+
+private:
+  struct Entry
+  {
+    cmFileTime::TimeType Time = 0;
+    bool Filtered = false;
+    // For each rule its path index, the number of dependencies and
+    // their path indices.
+    std::vector<std::uint32_t> Data;
+  };
+
+  struct Pending
+  {
+    std::string DepFile;
+    cmFileTime::TimeType Time;
+    bool Filtered;
+    RuleList Rules;
+  };
+
+  bool Parse(std::string const& content);
+  std::uint32_t GetPathId(std::string const& path);
+  bool Compact();
+
+  std::string File;
+  std::vector<std::string> Paths;
+  std::unordered_map<std::string, std::uint32_t> PathIds;
+  std::unordered_map<std::uint32_t, Entry> Entries;
+  // Number of dependency records in the log, including superseded ones.
+  std::size_t RecordCount = 0;
+  // Whether the log was read completely, so records can be appended.
+  bool Valid = false;
+  std::vector<Pending> PendingRecords;
+};
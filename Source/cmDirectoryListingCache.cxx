@@ -0,0 +1,538 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file Copyright.txt or https://cmake.org/licensing for details.  */
+#include "cmDirectoryListingCache.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <unordered_map>
+#include <utility>
+
+#include "cmsys/Directory.hxx"
+
+#include "cmFileTime.h"
+#include "cmStringAlgorithms.h"
+#include "cmSystemTools.h"
+
+#if !defined(_WIN32) || defined(__CYGWIN__)
+#  include <cerrno>
+#  include <cstring>
+
+#  include <dirent.h>
+#endif
+
+#if !defined(CMAKE_BOOTSTRAP)
+#  include <atomic>
+#  include <condition_variable>
+#  include <functional>
+#  include <mutex>
+#  include <thread>
+#  include <unordered_set>
+#endif
+
+namespace {
+enum class Kind : unsigned char
+{
+  // Not known without checking the entry itself.
+  Unknown,
+  // Neither a directory nor a symbolic link.
+  File,
+  Directory,
+  // A symbolic link whose target was not checked.
+  Link,
+  LinkToFile,
+  LinkToDirectory,
+};
+
+struct Listing
+{
+  enum class StateType
+  {
+    // The directory does not exist.
+    Missing,
+    // The directory exists but could not be read.
+    Unknown,
+    // The directory was read.
+    Listed,
+  };
+  StateType State = StateType::Missing;
+  // The listing was taken too close to the directory modification time
+  // to detect later changes by comparing it.
+  bool Racy = false;
+  cmFileTime::TimeType Time = 0;
+  unsigned long Epoch = 0;
+  // Sorted entry names.
+  std::vector<std::string> Names;
+  // Kinds of the entries in the order of their names.  Checking the kind
+  // of an entry may need a stat, so this is done on first use only.
+  std::vector<Kind> Kinds;
+  // Why the directory could not be read.
+  std::string Error;
+  // Sorted lower case entry names.  Any platform may mount a file system
+  // that ignores case, so a name matching one of these may exist.
+  std::vector<std::string> LowerNames;
+};
+
+struct Cache
+{
+  std::unordered_map<std::string, Listing> Listings;
+  unsigned long Epoch = 1;
+};
+
+Cache& GetCache()
+{
+  static Cache cache;
+  return cache;
+}
+
+std::string NormalizeDirectory(std::string dir)
+{
+  // Drop trailing slashes but keep the root of "/" and "c:/".
+  while (dir.size() > 1 && dir.back() == '/' && dir[dir.size() - 2] != ':') {
+    dir.pop_back();
+  }
+  return dir;
+}
+
+// Get the current time in the unit and epoch of cmFileTime.
+cmFileTime::TimeType Now()
+{
+  auto const sinceEpoch = std::chrono::system_clock::now().time_since_epoch();
+  cmFileTime::TimeType now =
+    std::chrono::duration_cast<std::chrono::seconds>(sinceEpoch).count();
+#if defined(_WIN32) && !defined(__CYGWIN__)
+  // FILETIME counts from 1601-01-01.
+  now += 11644473600LL;
+#endif
+  return now * cmFileTime::UtPerS;
+}
+
+std::string JoinPath(std::string const& dir, std::string const& name)
+{
+  return dir.back() == '/' ? cmStrCat(dir, name) : cmStrCat(dir, '/', name);
+}
+
+// Find out whether an entry is a directory or a symbolic link.
+Kind GetKind(std::string const& path)
+{
+  if (cmSystemTools::FileIsSymlink(path)) {
+    return Kind::Link;
+  }
+  return cmSystemTools::FileIsDirectory(path) ? Kind::Directory : Kind::File;
+}
+
+// Find out whether a symbolic link points to a directory.
+Kind GetLinkKind(std::string const& path)
+{
+  return cmSystemTools::FileIsDirectory(path) ? Kind::LinkToDirectory
+                                              : Kind::LinkToFile;
+}
+
+// Read the entries of a directory with the kinds known without a stat.
+bool ReadEntries(std::string const& dir,
+                 std::vector<std::pair<std::string, Kind>>& entries,
+                 std::string& error)
+{
+#if defined(_WIN32) && !defined(__CYGWIN__)
+  cmsys::Directory d;
+  if (!d.Load(dir, &error)) {
+    return false;
+  }
+  entries.reserve(d.GetNumberOfFiles());
+  for (std::size_t i = 0; i < d.GetNumberOfFiles(); ++i) {
+    std::string const& name = d.GetFileName(i);
+    if (name == "." || name == "..") {
+      continue;
+    }
+    // The attributes read with the listing tell the kind of each entry.
+    Kind kind;
+    if (d.FileIsSymlink(i)) {
+      kind = d.FileIsDirectory(i) ? Kind::LinkToDirectory : Kind::LinkToFile;
+    } else {
+      kind = d.FileIsDirectory(i) ? Kind::Directory : Kind::File;
+    }
+    entries.emplace_back(name, kind);
+  }
+  return true;
+#else
+  DIR* d = opendir(dir.c_str());
+  if (!d) {
+    error = std::strerror(errno);
+    return false;
+  }
+  while (dirent* e = readdir(d)) {
+    std::string name = e->d_name;
+    if (name == "." || name == "..") {
+      continue;
+    }
+    Kind kind = Kind::Unknown;
+#  if defined(DT_DIR) && defined(DT_LNK) && defined(DT_UNKNOWN)
+    // Most file systems tell the kind of each entry in the listing.
+    switch (e->d_type) {
+      case DT_UNKNOWN:
+        break;
+      case DT_DIR:
+        kind = Kind::Directory;
+        break;
+      case DT_LNK:
+        kind = Kind::Link;
+        break;
+      default:
+        kind = Kind::File;
+        break;
+    }
+#  endif
+    entries.emplace_back(std::move(name), kind);
+  }
+  closedir(d);
+  return true;
+#endif
+}
+
+// Read a listing without touching the cache so that it may run on any
+// thread.
+Listing ReadListing(std::string const& dir)
+{
+  Listing listing;
+  cmFileTime ftm;
+  if (!ftm.Load(dir)) {
+    return listing;
+  }
+  listing.Time = ftm.GetTime();
+  listing.Racy = listing.Time + 2 * cmFileTime::UtPerS > Now();
+
+  std::vector<std::pair<std::string, Kind>> entries;
+  if (!ReadEntries(dir, entries, listing.Error)) {
+    // Nothing exists below a path that is not a directory.
+    listing.State = cmSystemTools::FileIsDirectory(dir)
+      ? Listing::StateType::Unknown
+      : Listing::StateType::Missing;
+    return listing;
+  }
+  listing.State = Listing::StateType::Listed;
+  std::sort(entries.begin(), entries.end());
+  listing.Names.reserve(entries.size());
+  listing.Kinds.reserve(entries.size());
+  for (auto& entry : entries) {
+    listing.Names.push_back(std::move(entry.first));
+    listing.Kinds.push_back(entry.second);
+  }
+  listing.LowerNames.reserve(listing.Names.size());
+  for (std::string const& name : listing.Names) {
+    listing.LowerNames.push_back(cmSystemTools::LowerCase(name));
+  }
+  std::sort(listing.LowerNames.begin(), listing.LowerNames.end());
+  return listing;
+}
+
+// Whether a listing read in an earlier epoch still describes the
+// directory.
+bool IsCurrent(std::string const& dir, Listing const& listing)
+{
+  if (listing.Racy) {
+    return false;
+  }
+  cmFileTime ftm;
+  if (!ftm.Load(dir)) {
+    return listing.State == Listing::StateType::Missing;
+  }
+  return listing.State != Listing::StateType::Missing &&
+    ftm.GetTime() == listing.Time;
+}
+
+Listing& Lookup(std::string const& dir)
+{
+  Cache& cache = GetCache();
+  auto it = cache.Listings.find(dir);
+  if (it == cache.Listings.end()) {
+    it = cache.Listings.emplace(dir, ReadListing(dir)).first;
+  } else if (it->second.Epoch != cache.Epoch &&
+             !IsCurrent(dir, it->second)) {
+    it->second = ReadListing(dir);
+  }
+  it->second.Epoch = cache.Epoch;
+  return it->second;
+}
+}
+
+bool cmDirectoryListingCache::MayExist(std::string const& path)
+{
+  std::string const file = NormalizeDirectory(path);
+  if (!cmSystemTools::FileIsFullPath(file)) {
+    return true;
+  }
+  std::string const dir = cmSystemTools::GetFilenamePath(file);
+  std::string const name = cmSystemTools::GetFilenameName(file);
+  if (dir.empty() || name.empty() || name == "." || name == "..") {
+    return true;
+  }
+#if defined(_WIN32)
+  // Short names and names with trailing dots or spaces resolve to
+  // entries that are listed under another name.
+  if (name.find('~') != std::string::npos || name.back() == '.' ||
+      name.back() == ' ') {
+    return true;
+  }
+#endif
+
+  Listing const& listing = Lookup(NormalizeDirectory(dir));
+  switch (listing.State) {
+    case Listing::StateType::Missing:
+      return false;
+    case Listing::StateType::Unknown:
+      return true;
+    case Listing::StateType::Listed:
+      break;
+  }
+  if (listing.Racy) {
+    return true;
+  }
+  if (std::binary_search(listing.Names.begin(), listing.Names.end(), name)) {
+    return true;
+  }
+  // Whether the file system ignores case, or folds or normalizes names
+  // beyond ASCII, is not known here.  Leave such names to a real check.
+  auto const isNonAscii = [](char c) {
+    return static_cast<unsigned char>(c) >= 0x80;
+  };
+  if (std::any_of(name.begin(), name.end(), isNonAscii)) {
+    return true;
+  }
+  return std::binary_search(listing.LowerNames.begin(),
+                            listing.LowerNames.end(),
+                            cmSystemTools::LowerCase(name));
+}
+
+bool cmDirectoryListingCache::GetEntries(std::string const& dir,
+                                         std::vector<std::string>& entries)
+{
+  std::string const key = NormalizeDirectory(dir);
+  if (!cmSystemTools::FileIsFullPath(key)) {
+    Listing listing = ReadListing(key);
+    entries = std::move(listing.Names);
+    return listing.State == Listing::StateType::Listed;
+  }
+  Listing const& listing = Lookup(key);
+  entries = listing.Names;
+  return listing.State == Listing::StateType::Listed;
+}
+
+bool cmDirectoryListingCache::GetEntries(std::string const& dir,
+                                         std::vector<Entry>& entries,
+                                         Stamp& stamp, std::string& error)
+{
+  entries.clear();
+  std::string const key = NormalizeDirectory(dir);
+  Listing uncached;
+  Listing* listing = &uncached;
+  if (cmSystemTools::FileIsFullPath(key)) {
+    listing = &Lookup(key);
+  } else {
+    uncached = ReadListing(key);
+  }
+
+  stamp = Stamp();
+  error.clear();
+  switch (listing->State) {
+    case Listing::StateType::Missing:
+      return false;
+    case Listing::StateType::Unknown:
+      // Whether the directory becomes readable is not seen in its time.
+      stamp.Time = listing->Time;
+      stamp.Racy = true;
+      error = listing->Error;
+      return false;
+    case Listing::StateType::Listed:
+      break;
+  }
+  stamp.Time = listing->Time;
+  stamp.Racy = listing->Racy;
+
+  entries.reserve(listing->Names.size());
+  for (std::size_t i = 0; i < listing->Names.size(); ++i) {
+    Kind& kind = listing->Kinds[i];
+    if (kind == Kind::Unknown || kind == Kind::Link) {
+      std::string const path = JoinPath(key, listing->Names[i]);
+      if (kind == Kind::Unknown) {
+        kind = GetKind(path);
+      }
+      if (kind == Kind::Link) {
+        kind = GetLinkKind(path);
+      }
+    }
+    Entry entry;
+    entry.Name = listing->Names[i];
+    entry.IsDirectory =
+      kind == Kind::Directory || kind == Kind::LinkToDirectory;
+    entry.IsSymlink =
+      kind == Kind::LinkToFile || kind == Kind::LinkToDirectory;
+    entries.push_back(std::move(entry));
+  }
+  return true;
+}
+
+bool cmDirectoryListingCache::IsUnchanged(std::string const& dir,
+                                          Stamp const& stamp)
+{
+  if (stamp.Racy) {
+    return false;
+  }
+  std::string const key = NormalizeDirectory(dir);
+  if (stamp.Time < 0) {
+    return !cmSystemTools::FileIsDirectory(key);
+  }
+  cmFileTime ftm;
+  return ftm.Load(key) && ftm.GetTime() == stamp.Time;
+}
+
+void cmDirectoryListingCache::Revalidate()
+{
+  ++GetCache().Epoch;
+}
+
+void cmDirectoryListingCache::Prefetch(std::vector<std::string> const& dirs)
+{
+#if !defined(CMAKE_BOOTSTRAP)
+  Cache& cache = GetCache();
+  std::vector<std::string> work;
+  for (std::string const& dir : dirs) {
+    std::string key = NormalizeDirectory(dir);
+    if (cmSystemTools::FileIsFullPath(key) && !cache.Listings.count(key)) {
+      work.push_back(std::move(key));
+    }
+  }
+  std::sort(work.begin(), work.end());
+  work.erase(std::unique(work.begin(), work.end()), work.end());
+  unsigned int const jobs = std::min<unsigned int>(
+    std::thread::hardware_concurrency(),
+    static_cast<unsigned int>(work.size()));
+  if (jobs < 2) {
+    return;
+  }
+
+  // Read the listings on a pool of threads and publish them afterwards
+  // so that the cache itself is only used from this thread.
+  std::vector<Listing> listings(work.size());
+  std::atomic<std::size_t> next(0);
+  auto worker = [&work, &listings, &next]() {
+    for (std::size_t i = next++; i < work.size(); i = next++) {
+      listings[i] = ReadListing(work[i]);
+    }
+  };
+  std::vector<std::thread> threads;
+  for (unsigned int i = 1; i < jobs; ++i) {
+    threads.emplace_back(worker);
+  }
+  worker();
+  for (std::thread& t : threads) {
+    t.join();
+  }
+
+  for (std::size_t i = 0; i < work.size(); ++i) {
+    listings[i].Epoch = cache.Epoch;
+    cache.Listings.emplace(std::move(work[i]), std::move(listings[i]));
+  }
+#else
+  static_cast<void>(dirs);
+#endif
+}
+
+void cmDirectoryListingCache::PrefetchTrees(
+  std::vector<std::string> const& roots)
+{
+#if !defined(CMAKE_BOOTSTRAP)
+  unsigned int const jobs = std::thread::hardware_concurrency();
+  if (jobs < 2) {
+    return;
+  }
+  Cache& cache = GetCache();
+  std::vector<std::string> queue;
+  std::unordered_set<std::string> queued;
+  for (std::string const& root : roots) {
+    std::string key = NormalizeDirectory(root);
+    if (cmSystemTools::FileIsFullPath(key) && queued.insert(key).second) {
+      queue.push_back(std::move(key));
+    }
+  }
+
+  // Read the listings on a pool of threads and publish them afterwards
+  // so that the cache itself is only changed from this thread.  Listings
+  // already cached are checked on the threads too.
+  std::vector<std::pair<std::string, Listing>> read;
+  std::vector<std::string> current;
+  std::mutex mutex;
+  std::condition_variable changed;
+  std::size_t busy = 0;
+  std::vector<std::thread> threads;
+  std::function<void(bool)> worker = [&](bool spawn) {
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;) {
+      changed.wait(lock, [&]() { return !queue.empty() || busy == 0; });
+      if (queue.empty()) {
+        return;
+      }
+      std::string dir = std::move(queue.back());
+      queue.pop_back();
+      ++busy;
+      lock.unlock();
+
+      Listing listing;
+      Listing const* known = nullptr;
+      auto it = cache.Listings.find(dir);
+      if (it != cache.Listings.end() &&
+          (it->second.Epoch == cache.Epoch || IsCurrent(dir, it->second))) {
+        known = &it->second;
+      } else {
+        listing = ReadListing(dir);
+        known = &listing;
+      }
+      std::vector<std::string> subdirs;
+      for (std::size_t i = 0; i < known->Names.size(); ++i) {
+        std::string path = JoinPath(dir, known->Names[i]);
+        Kind kind = known->Kinds[i];
+        if (kind == Kind::Unknown) {
+          kind = GetKind(path);
+          if (known == &listing) {
+            listing.Kinds[i] = kind;
+          }
+        }
+        if (kind == Kind::Directory) {
+          subdirs.push_back(std::move(path));
+        }
+      }
+
+      lock.lock();
+      --busy;
+      if (known == &listing) {
+        read.emplace_back(dir, std::move(listing));
+      } else {
+        current.push_back(std::move(dir));
+      }
+      for (std::string& subdir : subdirs) {
+        if (queued.insert(subdir).second) {
+          queue.push_back(std::move(subdir));
+        }
+      }
+      // Start more threads only while there is work for them.
+      if (spawn && queue.size() > 1 && threads.size() + 1 < jobs) {
+        threads.emplace_back([&worker]() { worker(false); });
+      }
+      changed.notify_all();
+    }
+  };
+  worker(true);
+  for (std::thread& t : threads) {
+    t.join();
+  }
+
+  for (auto& r : read) {
+    r.second.Epoch = cache.Epoch;
+    cache.Listings[r.first] = std::move(r.second);
+  }
+  for (std::string const& dir : current) {
+    cache.Listings[dir].Epoch = cache.Epoch;
+  }
+#else
+  static_cast<void>(roots);
+#endif
+}
@@ -0,0 +1,84 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file Copyright.txt or https://cmake.org/licensing for details.  */
+#pragma once
+
+#include "cmConfigure.h" // IWYU pragma: keep
+
+#include <string>
+#include <vector>
+
+/** \class cmDirectoryListingCache
+ * \brief Process-wide cache of directory listings.
+ *
+ * The find commands probe the same directories for many candidate file
+ * names, and file(GLOB) walks the same trees for many expressions.  Each
+ * directory is read once and later lookups are answered from memory.
+ * A listing is checked against the modification time of its directory
+ * again after Revalidate is called, so files created by the project
+ * between two find commands are seen.  Listings of directories
+ * modified within the last two seconds are never trusted because a
+ * change within the file system time resolution would go unnoticed.
+ */
+class cmDirectoryListingCache
+{
+public:
+  /** An entry of a directory.  */
+  struct Entry
+  {
+    std::string Name;
+    // Whether the entry is a directory or a symbolic link to one.
+    bool IsDirectory = false;
+    bool IsSymlink = false;
+  };
+
+  /** State of a directory when its listing was read.  */
+  struct Stamp
+  {
+    // Modification time, or -1 if the directory did not exist.
+    long long Time = -1;
+    // Whether a change may go unnoticed by comparing the time.
+    bool Racy = false;
+  };
+
+  /**
+   * @brief Check whether a file might exist.
+   * @return false only if the cached listing of the parent directory
+   *         proves that the file does not exist.  Callers must still
+   *         check the file itself when true is returned.  The file
+   *         system may ignore case, so a name matching an entry only
+   *         when ignoring case, or with non-ASCII characters, may exist.
+   */
+  static bool MayExist(std::string const& path);
+
+  /**
+   * @brief Get the names of the entries of a directory, without "." and "..".
+   * @return false if the directory cannot be read.
+   */
+  static bool GetEntries(std::string const& dir,
+                         std::vector<std::string>& entries);
+
+  /**
+   * @brief Get the entries of a directory with their kinds, sorted by
+   *        name, and the state of the directory they were read from.
+   * @return false if the path is not a directory or cannot be read.  The
+   *         reason is given in error if the directory exists.
+   */
+  static bool GetEntries(std::string const& dir, std::vector<Entry>& entries,
+                         Stamp& stamp, std::string& error);
+
+  /** Check whether a directory is still in the given state.  */
+  static bool IsUnchanged(std::string const& dir, Stamp const& stamp);
+
+  /** Check the modification time of each cached directory again on its
+      next use.  */
+  static void Revalidate();
+
+  /** Read the listings of the given directories that are not cached
+      yet using one thread per processor.  */
+  static void Prefetch(std::vector<std::string> const& dirs);
+
+  /** Read the listings of all directories below the given ones that are
+      not cached or current, using up to one thread per processor.
+      Symbolic links to directories are not followed.  */
+  static void PrefetchTrees(std::vector<std::string> const& roots);
+};
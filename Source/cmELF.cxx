@@ -109,6 +109,8 @@ public:
   virtual std::vector<char> EncodeDynamicEntries(
     const cmELF::DynamicEntryList&) = 0;
   virtual StringEntry const* GetDynamicSectionString(unsigned int tag) = 0;
+  virtual std::vector<std::string> GetDynamicSectionStrings(
+    unsigned int tag) = 0;
   virtual bool IsMips() const = 0;
   virtual void PrintInfo(std::ostream& os) const = 0;
 
@@ -130,6 +132,12 @@ public:
     return this->GetDynamicSectionString(DT_RUNPATH);
   }
 
+  // Lookup all NEEDED entries in the DYNAMIC section.
+  std::vector<std::string> GetNeeded()
+  {
+    return this->GetDynamicSectionStrings(DT_NEEDED);
+  }
+
   // Return the recorded ELF type.
   cmELF::FileType GetFileType() const { return this->ELFType; }
 
@@ -225,6 +233,11 @@ public:
   // Lookup a string from the dynamic section with the given tag.
   StringEntry const* GetDynamicSectionString(unsigned int tag) override;
 
+  // Lookup the strings of all entries in the dynamic section with the
+  // given tag, in the order they appear.
+  std::vector<std::string> GetDynamicSectionStrings(
+    unsigned int tag) override;
+
   bool IsMips() const override { return this->ELFHeader.e_machine == EM_MIPS; }
 
   // Print information about the ELF file.
@@ -633,6 +646,54 @@ cmELF::StringEntry const* cmELFInternalImpl<Types>::GetDynamicSectionString(
   return nullptr;
 }
 
+template <class Types>
+std::vector<std::string> cmELFInternalImpl<Types>::GetDynamicSectionStrings(
+  unsigned int tag)
+{
+  std::vector<std::string> strings;
+
+  // Try reading the dynamic section.
+  if (!this->LoadDynamicSection()) {
+    return strings;
+  }
+
+  // Get the string table referenced by the DYNAMIC section.
+  ELF_Shdr const& sec = this->SectionHeaders[this->DynamicSectionIndex];
+  if (sec.sh_link >= this->SectionHeaders.size()) {
+    this->SetErrorMessage("Section DYNAMIC has invalid string table index.");
+    return strings;
+  }
+  ELF_Shdr const& strtab = this->SectionHeaders[sec.sh_link];
+
+  for (ELF_Dyn const& dyn : this->DynamicSectionEntries) {
+    if (static_cast<tagtype>(dyn.d_tag) != static_cast<tagtype>(tag)) {
+      continue;
+    }
+    if (dyn.d_un.d_val >= strtab.sh_size) {
+      this->SetErrorMessage("Section DYNAMIC references string beyond "
+                            "the end of its string section.");
+      return std::vector<std::string>();
+    }
+
+    // Read the string up to its terminator or the end of the table.
+    unsigned long const first = static_cast<unsigned long>(dyn.d_un.d_val);
+    unsigned long const end = static_cast<unsigned long>(strtab.sh_size);
+    this->Stream->seekg(strtab.sh_offset + first);
+    std::string value;
+    char c;
+    for (unsigned long pos = first;
+         pos != end && this->Stream->get(c) && c != 0; ++pos) {
+      value += c;
+    }
+    if (!(*this->Stream)) {
+      this->SetErrorMessage("Dynamic section specifies unreadable string.");
+      return std::vector<std::string>();
+    }
+    strings.push_back(std::move(value));
+  }
+  return strings;
+}
+
 //============================================================================
 // External class implementation.
 
@@ -794,6 +855,16 @@ cmELF::StringEntry const* cmELF::GetRunPath()
   return nullptr;
 }
 
+std::vector<std::string> cmELF::GetNeeded()
+{
+  if (this->Valid() &&
+      (this->Internal->GetFileType() == cmELF::FileTypeExecutable ||
+       this->Internal->GetFileType() == cmELF::FileTypeSharedLibrary)) {
+    return this->Internal->GetNeeded();
+  }
+  return std::vector<std::string>();
+}
+
 bool cmELF::IsMIPS() const
 {
   if (this->Valid()) {
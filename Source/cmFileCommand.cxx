@@ -31,6 +31,7 @@
 #include "cmAlgorithms.h"
 #include "cmArgumentParser.h"
 #include "cmCMakePath.h"
+#include "cmCachedGlob.h"
 #include "cmCryptoHash.h"
 #include "cmELF.h"
 #include "cmExecutionStatus.h"
@@ -621,7 +622,7 @@ bool HandleGlobImpl(std::vector<std::string> const& args, bool recurse,
 
   std::string variable = *i;
   i++;
-  cmsys::Glob g;
+  cmCachedGlob g;
   g.SetRecurse(recurse);
 
   bool explicitFollowSymlinks = false;
@@ -632,12 +633,12 @@ bool HandleGlobImpl(std::vector<std::string> const& args, bool recurse,
       case cmPolicies::REQUIRED_IF_USED:
       case cmPolicies::REQUIRED_ALWAYS:
       case cmPolicies::NEW:
-        g.RecurseThroughSymlinksOff();
+        g.SetRecurseThroughSymlinks(false);
         break;
       case cmPolicies::WARN:
         CM_FALLTHROUGH;
       case cmPolicies::OLD:
-        g.RecurseThroughSymlinksOn();
+        g.SetRecurseThroughSymlinks(true);
         break;
     }
   }
@@ -671,7 +672,7 @@ bool HandleGlobImpl(std::vector<std::string> const& args, bool recurse,
       ++i; // skip FOLLOW_SYMLINKS
       if (recurse) {
         explicitFollowSymlinks = true;
-        g.RecurseThroughSymlinksOn();
+        g.SetRecurseThroughSymlinks(true);
         if (i == args.end()) {
           status.SetError(
             "GLOB_RECURSE requires a glob expression after FOLLOW_SYMLINKS.");
@@ -684,7 +685,7 @@ bool HandleGlobImpl(std::vector<std::string> const& args, bool recurse,
         status.SetError("GLOB requires a directory after the RELATIVE tag.");
         return false;
       }
-      g.SetRelative(i->c_str());
+      g.SetRelative(*i);
       ++i;
       if (i == args.end()) {
         status.SetError(
@@ -767,8 +768,8 @@ bool HandleGlobImpl(std::vector<std::string> const& args, bool recurse,
                          foundFiles.end());
         cm->AddGlobCacheEntry(
           recurse, (recurse ? g.GetRecurseListDirs() : g.GetListDirs()),
-          (recurse ? g.GetRecurseThroughSymlinks() : false),
-          (g.GetRelative() ? g.GetRelative() : ""), expr, foundFiles, variable,
+          (recurse ? g.GetRecurseThroughSymlinks() : false), g.GetRelative(),
+          expr, foundFiles, g.GetDirectories(), variable,
           status.GetMakefile().GetBacktrace());
       } else {
         warnConfigureLate = true;
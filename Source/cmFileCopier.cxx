@@ -18,6 +18,13 @@
 #  include "cmsys/FStream.hxx"
 #endif
 
+#if !defined(CMAKE_BOOTSTRAP)
+#  include <atomic>
+#  include <thread>
+#endif
+
+#include <algorithm>
+#include <cstddef>
 #include <cstring>
 #include <sstream>
 
@@ -577,8 +584,10 @@ bool cmFileCopier::InstallFile(const std::string& fromFile,
   // Determine whether we will copy the file.
   bool copy = true;
   if (!this->Always) {
-    // If both files exist with the same time do not copy.
-    if (!this->FileTimes.DifferS(fromFile, toFile)) {
+    // If both files exist with the same time and size do not copy.
+    if (!this->FileTimes.DifferS(fromFile, toFile) &&
+        cmSystemTools::FileLength(fromFile) ==
+          cmSystemTools::FileLength(toFile)) {
       copy = false;
     }
   }
@@ -586,47 +595,157 @@ bool cmFileCopier::InstallFile(const std::string& fromFile,
   // Inform the user about this file installation.
   this->ReportCopy(toFile, TypeFile, copy);
 
+  // Compute the permissions of the destination file.
+  mode_t permissions =
+    (match_properties.Permissions ? match_properties.Permissions
+                                  : this->FilePermissions);
+  if (!permissions) {
+    // No permissions were explicitly provided but the user requested
+    // that the source file permissions be used.
+    cmSystemTools::GetPermissions(fromFile, permissions);
+  }
+
   // Copy the file.
-  if (copy && !cmSystemTools::CopyAFile(fromFile, toFile, true)) {
-    std::ostringstream e;
-    e << this->Name << " cannot copy file \"" << fromFile << "\" to \""
-      << toFile << "\": " << cmSystemTools::GetLastSystemError() << ".";
-    this->Status.SetError(e.str());
+  if (copy) {
+    if (this->Deferring) {
+      this->DeferredCopies.push_back({ fromFile, toFile, permissions });
+      return true;
+    }
+    std::string error;
+    if (!this->CopyOneFile(fromFile, toFile, error)) {
+      this->Status.SetError(error);
+      return false;
+    }
+  }
+
+  // Set permissions of the destination file.
+  return this->SetPermissions(toFile, permissions);
+}
+
+bool cmFileCopier::CopyOneFile(const std::string& fromFile,
+                               const std::string& toFile,
+                               std::string& error) const
+{
+  // Copy through cmSystemTools so the content may be copied within the
+  // kernel.  It does not create the destination directory.
+  std::string err;
+  bool copied = false;
+  cmsys::Status status =
+    cmSystemTools::MakeDirectory(cmSystemTools::GetFilenamePath(toFile));
+  if (!status) {
+    err = status.GetString();
+  } else {
+    copied = cmSystemTools::CopySingleFile(fromFile, toFile,
+                                           cmSystemTools::CopyWhen::Always,
+                                           &err) ==
+      cmSystemTools::CopyResult::Success;
+  }
+  if (!copied) {
+    error = cmStrCat(this->Name, " cannot copy file \"", fromFile, "\" to \"",
+                     toFile, "\": ", err, '.');
     return false;
   }
 
   // Set the file modification time of the destination file.
-  if (copy && !this->Always) {
+  if (!this->Always) {
     // Add write permission so we can set the file time.
-    // Permissions are set unconditionally below anyway.
+    // Permissions are set unconditionally afterwards anyway.
     mode_t perm = 0;
     if (cmSystemTools::GetPermissions(toFile, perm)) {
       cmSystemTools::SetPermissions(toFile, perm | mode_owner_write);
     }
     if (!cmFileTimes::Copy(fromFile, toFile)) {
-      std::ostringstream e;
-      e << this->Name << " cannot set modification time on \"" << toFile
-        << "\": " << cmSystemTools::GetLastSystemError() << ".";
-      this->Status.SetError(e.str());
+      error = cmStrCat(this->Name, " cannot set modification time on \"",
+                       toFile, "\": ", cmSystemTools::GetLastSystemError(),
+                       '.');
       return false;
     }
   }
+  return true;
+}
 
-  // Set permissions of the destination file.
-  mode_t permissions =
-    (match_properties.Permissions ? match_properties.Permissions
-                                  : this->FilePermissions);
-  if (!permissions) {
-    // No permissions were explicitly provided but the user requested
-    // that the source file permissions be used.
-    cmSystemTools::GetPermissions(fromFile, permissions);
+bool cmFileCopier::CopyDeferredFiles()
+{
+  std::vector<DeferredCopy> copies;
+  copies.swap(this->DeferredCopies);
+  std::vector<std::pair<std::string, mode_t>> directories;
+  directories.swap(this->DeferredDirPermissions);
+
+  std::vector<std::string> errors(copies.size());
+#if !defined(CMAKE_BOOTSTRAP)
+  std::atomic<std::size_t> next(0);
+  auto worker = [this, &copies, &errors, &next]() {
+    for (std::size_t i = next++; i < copies.size(); i = next++) {
+      this->CopyOneFile(copies[i].FromFile, copies[i].ToFile, errors[i]);
+    }
+  };
+  // Copying is bound by the disks, which more threads do not speed up.
+  std::size_t const threads = std::min<std::size_t>(
+    std::min(std::thread::hardware_concurrency(), 8u), copies.size());
+  std::vector<std::thread> pool;
+  for (std::size_t i = 1; i < threads; ++i) {
+    pool.emplace_back(worker);
+  }
+  worker();
+  for (std::thread& thread : pool) {
+    thread.join();
   }
-  return this->SetPermissions(toFile, permissions);
+#else
+  for (std::size_t i = 0; i < copies.size(); ++i) {
+    this->CopyOneFile(copies[i].FromFile, copies[i].ToFile, errors[i]);
+  }
+#endif
+
+  // Report the first failure in installation order.
+  for (std::size_t i = 0; i < copies.size(); ++i) {
+    if (!errors[i].empty()) {
+      this->Status.SetError(errors[i]);
+      return false;
+    }
+    if (!this->SetPermissions(copies[i].ToFile, copies[i].Permissions)) {
+      return false;
+    }
+  }
+  for (auto const& directory : directories) {
+    if (!this->SetPermissions(directory.first, directory.second)) {
+      return false;
+    }
+  }
+  return true;
 }
 
 bool cmFileCopier::InstallDirectory(const std::string& source,
                                     const std::string& destination,
                                     MatchProperties match_properties)
+{
+#if !defined(CMAKE_BOOTSTRAP)
+  bool const parallel = std::thread::hardware_concurrency() > 1;
+#else
+  bool const parallel = false;
+#endif
+  if (this->Deferring || !parallel) {
+    return this->InstallDirectoryTree(source, destination, match_properties);
+  }
+
+  this->Deferring = true;
+  bool const traversed =
+    this->InstallDirectoryTree(source, destination, match_properties);
+  this->Deferring = false;
+  if (!traversed) {
+    // The files collected so far have been reported as installed, so
+    // copy them as a serial installation would have before the error.
+    std::string const error = this->Status.GetError();
+    if (this->CopyDeferredFiles()) {
+      this->Status.SetError(error);
+    }
+    return false;
+  }
+  return this->CopyDeferredFiles();
+}
+
+bool cmFileCopier::InstallDirectoryTree(const std::string& source,
+                                        const std::string& destination,
+                                        MatchProperties match_properties)
 {
   // Inform the user about this directory installation.
   this->ReportCopy(destination, TypeDir,
@@ -698,5 +817,9 @@ bool cmFileCopier::InstallDirectory(const std::string& source,
   }
 
   // Set the requested permissions of the destination directory.
+  if (this->Deferring) {
+    this->DeferredDirPermissions.emplace_back(destination, permissions_after);
+    return true;
+  }
   return this->SetPermissions(destination, permissions_after);
 }
@@ -5,6 +5,7 @@
 #include "cmConfigure.h" // IWYU pragma: keep
 
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "cmsys/RegularExpression.hxx"
@@ -73,6 +74,25 @@ protected:
   bool InstallDirectory(const std::string& source,
                         const std::string& destination,
                         MatchProperties match_properties);
+  bool InstallDirectoryTree(const std::string& source,
+                            const std::string& destination,
+                            MatchProperties match_properties);
+  bool CopyOneFile(const std::string& fromFile, const std::string& toFile,
+                   std::string& error) const;
+
+  // Files to copy while installing a directory tree are collected and
+  // copied on multiple threads once the whole tree has been traversed.
+  // The final permissions of the directories are set after that.
+  struct DeferredCopy
+  {
+    std::string FromFile;
+    std::string ToFile;
+    mode_t Permissions;
+  };
+  bool CopyDeferredFiles();
+  bool Deferring = false;
+  std::vector<DeferredCopy> DeferredCopies;
+  std::vector<std::pair<std::string, mode_t>> DeferredDirPermissions;
   virtual bool Install(const std::string& fromFile, const std::string& toFile);
   virtual std::string const& ToName(std::string const& fromName);
 
@@ -8,6 +8,7 @@
 
 #include <cmext/algorithm>
 
+#include "cmDirectoryListingCache.h"
 #include "cmExecutionStatus.h"
 #include "cmMakefile.h"
 #include "cmMessageType.h"
@@ -58,6 +59,9 @@ cmFindCommon::cmFindCommon(cmExecutionStatus& status)
 
   this->InitializeSearchPathGroups();
 
+  // Directories may have changed since the last find command.
+  cmDirectoryListingCache::Revalidate();
+
   this->DebugMode = false;
 
   // Windows Registry views
@@ -434,4 +438,9 @@ void cmFindCommon::ComputeFinalPaths(IgnorePaths ignorePaths)
   // Add a trailing slash to all paths to aid the search process.
   std::for_each(this->SearchPaths.begin(), this->SearchPaths.end(),
                 &AddTrailingSlash);
+
+  // Read the candidate directories in parallel if requested.
+  if (this->Makefile->IsOn("CMAKE_FIND_PREFETCH_DIRECTORIES")) {
+    cmDirectoryListingCache::Prefetch(this->SearchPaths);
+  }
 }
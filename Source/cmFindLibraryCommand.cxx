@@ -10,6 +10,7 @@
 
 #include "cmsys/RegularExpression.hxx"
 
+#include "cmDirectoryListingCache.h"
 #include "cmGlobalGenerator.h"
 #include "cmMakefile.h"
 #include "cmState.h"
@@ -419,7 +420,8 @@ bool cmFindLibraryHelper::CheckDirectoryForName(std::string const& path,
   if (name.TryRaw) {
     this->TestPath = cmStrCat(path, name.Raw);
 
-    const bool exists = cmSystemTools::FileExists(this->TestPath, true);
+    const bool exists = cmDirectoryListingCache::MayExist(this->TestPath) &&
+      cmSystemTools::FileExists(this->TestPath, true);
     if (!exists) {
       this->DebugLibraryFailed(name.Raw, path);
     } else {
@@ -24,6 +24,7 @@
 
 #include "cmAlgorithms.h"
 #include "cmDependencyProvider.h"
+#include "cmDirectoryListingCache.h"
 #include "cmListFileCache.h"
 #include "cmMakefile.h"
 #include "cmMessageType.h"
@@ -1359,7 +1360,12 @@ bool cmFindPackageCommand::ReadListFile(const std::string& f,
   ITScope scope = this->GlobalScope ? ITScope::Global : ITScope::Local;
   cmMakefile::SetGlobalTargetImportScope globScope(this->Makefile, scope);
 
-  if (this->Makefile->ReadDependentFile(f, noPolicyScope)) {
+  bool const result = this->Makefile->ReadDependentFile(f, noPolicyScope);
+
+  // The file may have changed the directories that are searched next.
+  cmDirectoryListingCache::Revalidate();
+
+  if (result) {
     return true;
   }
   std::string e = cmStrCat("Error reading CMake code from \"", f, "\".");
@@ -1976,7 +1982,8 @@ bool cmFindPackageCommand::FindConfigFile(std::string const& dir,
     if (this->DebugMode) {
       this->DebugBuffer = cmStrCat(this->DebugBuffer, "  ", file, "\n");
     }
-    if (cmSystemTools::FileExists(file, true) && this->CheckVersion(file)) {
+    if (cmDirectoryListingCache::MayExist(file) &&
+        cmSystemTools::FileExists(file, true) && this->CheckVersion(file)) {
       // Allow resolving symlinks when the config file is found through a link
       if (this->UseRealPath) {
         file = cmSystemTools::GetRealPath(file);
@@ -1999,14 +2006,16 @@ bool cmFindPackageCommand::CheckVersion(std::string const& config_file)
 
   // Look for foo-config-version.cmake
   std::string version_file = cmStrCat(version_file_base, "-version.cmake");
-  if (!haveResult && cmSystemTools::FileExists(version_file, true)) {
+  if (!haveResult && cmDirectoryListingCache::MayExist(version_file) &&
+      cmSystemTools::FileExists(version_file, true)) {
     result = this->CheckVersionFile(version_file, version);
     haveResult = true;
   }
 
   // Look for fooConfigVersion.cmake
   version_file = cmStrCat(version_file_base, "Version.cmake");
-  if (!haveResult && cmSystemTools::FileExists(version_file, true)) {
+  if (!haveResult && cmDirectoryListingCache::MayExist(version_file) &&
+      cmSystemTools::FileExists(version_file, true)) {
     result = this->CheckVersionFile(version_file, version);
     haveResult = true;
   }
@@ -2328,16 +2337,13 @@ private:
   {
     // Construct a list of matches.
     std::vector<std::string> matches;
-    cmsys::Directory d;
-    d.Load(parent);
-    for (unsigned long i = 0; i < d.GetNumberOfFiles(); ++i) {
-      const char* fname = d.GetFile(i);
-      if (strcmp(fname, ".") == 0 || strcmp(fname, "..") == 0) {
-        continue;
-      }
+    std::vector<std::string> entries;
+    cmDirectoryListingCache::GetEntries(parent, entries);
+    for (std::string const& fname : entries) {
       for (std::string const& n : this->Names) {
-        if (cmsysString_strncasecmp(fname, n.c_str(), n.length()) == 0) {
-          matches.emplace_back(fname);
+        if (cmsysString_strncasecmp(fname.c_str(), n.c_str(), n.length()) ==
+            0) {
+          matches.push_back(fname);
         }
       }
     }
@@ -2386,17 +2392,13 @@ private:
   {
     // Construct a list of matches.
     std::vector<std::string> matches;
-    cmsys::Directory d;
-    d.Load(parent);
-    for (unsigned long i = 0; i < d.GetNumberOfFiles(); ++i) {
-      const char* fname = d.GetFile(i);
-      if (strcmp(fname, ".") == 0 || strcmp(fname, "..") == 0) {
-        continue;
-      }
+    std::vector<std::string> entries;
+    cmDirectoryListingCache::GetEntries(parent, entries);
+    for (std::string const& fname : entries) {
       for (std::string name : this->Names) {
         name += this->Extension;
-        if (cmsysString_strcasecmp(fname, name.c_str()) == 0) {
-          matches.emplace_back(fname);
+        if (cmsysString_strcasecmp(fname.c_str(), name.c_str()) == 0) {
+          matches.push_back(fname);
         }
       }
     }
@@ -2434,15 +2436,10 @@ private:
   bool Search(std::string const& parent, cmFileList& lister) override
   {
     // Look for matching files.
-    std::vector<std::string> matches;
-    cmsys::Directory d;
-    d.Load(parent);
-    for (unsigned long i = 0; i < d.GetNumberOfFiles(); ++i) {
-      const char* fname = d.GetFile(i);
-      if (strcmp(fname, ".") == 0 || strcmp(fname, "..") == 0) {
-        continue;
-      }
-      if (cmsysString_strcasecmp(fname, this->String.c_str()) == 0) {
+    std::vector<std::string> entries;
+    cmDirectoryListingCache::GetEntries(parent, entries);
+    for (std::string const& fname : entries) {
+      if (cmsysString_strcasecmp(fname.c_str(), this->String.c_str()) == 0) {
         if (this->Consider(parent + fname, lister)) {
           return true;
         }
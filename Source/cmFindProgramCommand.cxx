@@ -6,6 +6,7 @@
 #include <string>
 #include <utility>
 
+#include "cmDirectoryListingCache.h"
 #include "cmMakefile.h"
 #include "cmMessageType.h"
 #include "cmPolicies.h"
@@ -108,7 +109,8 @@ struct cmFindProgramHelper
   }
   bool FileIsValid(std::string const& file) const
   {
-    if (!this->FileIsExecutableCMP0109(file)) {
+    if (!cmDirectoryListingCache::MayExist(file) ||
+        !this->FileIsExecutableCMP0109(file)) {
       return false;
     }
 #ifdef _WIN32
@@ -3,6 +3,8 @@
 #include "cmGccDepfileLexerHelper.h"
 
 #include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <memory>
 #include <string>
 #include <vector>
@@ -17,6 +19,78 @@
 #  include "cmsys/Encoding.h"
 #endif
 
+namespace {
+// Read a whole file into memory.  The buffer is sized from the length of
+// the file so that one read usually suffices, but reading continues to
+// the end in case the file is being rewritten.
+bool ReadWholeFile(const char* filePath, std::string& content)
+{
+#ifdef _WIN32
+  wchar_t* wpath = cmsysEncoding_DupToWide(filePath);
+  FILE* file = _wfopen(wpath, L"rb");
+  free(wpath);
+#else
+  FILE* file = fopen(filePath, "rb");
+#endif
+  if (!file) {
+    return false;
+  }
+  std::size_t length = 0;
+  if (fseek(file, 0, SEEK_END) == 0) {
+    long const end = ftell(file);
+    if (end > 0) {
+      length = static_cast<std::size_t>(end);
+    }
+  }
+  rewind(file);
+
+  // One spare byte lets the first read reach the end of the file.
+  content.resize(length + 1);
+  std::size_t used = 0;
+  for (;;) {
+    if (used == content.size()) {
+      content.resize(content.size() + 4096);
+    }
+    std::size_t const n =
+      fread(&content[used], 1, content.size() - used, file);
+    if (n == 0) {
+      break;
+    }
+    used += n;
+  }
+  bool const ok = !ferror(file);
+  fclose(file);
+  content.resize(used);
+  return ok;
+}
+
+// The characters matched by the lexer's plain text rule.
+class PlainCharacters
+{
+public:
+  PlainCharacters()
+  {
+    for (unsigned char const c :
+         std::string("+,/_.~()}{%=@[]!-0123456789"
+                     "abcdefghijklmnopqrstuvwxyz"
+                     "ABCDEFGHIJKLMNOPQRSTUVWXYZ")) {
+      this->Table[c] = true;
+    }
+    for (unsigned int c = 0x80; c <= 0xFF; ++c) {
+      this->Table[c] = true;
+    }
+  }
+  bool operator()(char c) const
+  {
+    return this->Table[static_cast<unsigned char>(c)];
+  }
+
+private:
+  bool Table[256] = {};
+};
+PlainCharacters const IsPlain;
+}
+
 bool cmGccDepfileLexerHelper::readFile(const char* filePath)
 {
 #ifdef _WIN32
@@ -41,6 +115,152 @@ bool cmGccDepfileLexerHelper::readFile(const char* filePath)
   return this->HelperState != State::Failed;
 }
 
+bool cmGccDepfileLexerHelper::readFileBuffered(const char* filePath)
+{
+  std::string content;
+  if (!ReadWholeFile(filePath, content)) {
+    return false;
+  }
+  return this->parseBuffer(content.data(), content.size());
+}
+
+bool cmGccDepfileLexerHelper::parseBuffer(const char* data, std::size_t size)
+{
+  const char* p = data;
+  const char* const end = data + size;
+  // Length of the newline at q, or 0.
+  auto newlineAt = [end](const char* q) -> std::size_t {
+    if (q < end && *q == '\n') {
+      return 1;
+    }
+    if (end - q >= 2 && q[0] == '\r' && q[1] == '\n') {
+      return 2;
+    }
+    return 0;
+  };
+  auto isSpace = [](char c) { return c == ' ' || c == '\t'; };
+
+  // Each branch below corresponds to the rule of the lexer that matches
+  // the longest text at p.
+  this->newEntry();
+  while (p < end) {
+    if (IsPlain(*p)) {
+      // Got a span of plain text.
+      const char* q = p + 1;
+      while (q < end && IsPlain(*q)) {
+        ++q;
+      }
+      this->addToCurrentPath(p, static_cast<std::size_t>(q - p));
+      p = q;
+      continue;
+    }
+    std::size_t n;
+    switch (*p) {
+      case ' ':
+      case '\t': {
+        // Rules and dependencies are separated by blocks of whitespace.
+        // A line continuation after them ends the file name too.
+        const char* q = p + 1;
+        while (q < end && isSpace(*q)) {
+          ++q;
+        }
+        if (q < end && *q == '\\' && (n = newlineAt(q + 1)) != 0) {
+          q += 1 + n;
+        }
+        this->newRuleOrDependency();
+        p = q;
+      } break;
+      case '\\': {
+        const char* q = p;
+        while (q < end && *q == '\\') {
+          ++q;
+        }
+        std::size_t const count = static_cast<std::size_t>(q - p);
+        if (q < end && *q == ' ') {
+          if (count % 2 == 1) {
+            // 2N+1 backslashes plus space -> N backslashes plus space.
+            std::string s(count / 2, '\\');
+            s.push_back(' ');
+            this->addToCurrentPath(s.data(), s.size());
+          } else {
+            // 2N backslashes plus space -> 2N backslashes, end of filename.
+            this->addToCurrentPath(p, count);
+            this->newDependency();
+          }
+          p = q + 1;
+          break;
+        }
+        // All but the last backslash are unmatched characters.
+        this->addToCurrentPath(p, count - 1);
+        if (q < end && *q == '#') {
+          // Unescape the hash.
+          this->addToCurrentPath("#", 1);
+          p = q + 1;
+        } else if ((n = newlineAt(q)) != 0) {
+          // A line continuation ends the current file name.
+          this->newRuleOrDependency();
+          p = q + n;
+        } else {
+          this->addToCurrentPath("\\", 1);
+          p = q;
+        }
+      } break;
+      case ':':
+        if ((n = newlineAt(p + 1)) != 0) {
+          // A colon ends the rules
+          this->newDependency();
+          // A newline after colon terminates current rule.
+          this->newEntry();
+          p += 1 + n;
+        } else if (p + 1 < end && isSpace(p[1])) {
+          // A colon followed by space ends the rules and starts a new
+          // dependency.
+          p += 2;
+          while (p < end && isSpace(*p)) {
+            ++p;
+          }
+          this->newDependency();
+        } else if (p + 1 < end && p[1] == '\\' &&
+                   (n = newlineAt(p + 2)) != 0) {
+          // As does a colon followed by a line continuation.
+          this->newDependency();
+          p += 2 + n;
+        } else {
+          this->addToCurrentPath(p, 1);
+          ++p;
+        }
+        break;
+      case '\n':
+      case '\r':
+        if ((n = newlineAt(p)) != 0) {
+          // A newline ends the current file name and the current rule.
+          this->newEntry();
+          p += n;
+        } else {
+          this->addToCurrentPath(p, 1);
+          ++p;
+        }
+        break;
+      case '$':
+        // Unescape the dollar sign.
+        this->addToCurrentPath(p, 1);
+        p += (p + 1 < end && p[1] == '$') ? 2 : 1;
+        break;
+      case '\0':
+        // The lexer passes NUL to addToCurrentPath as an empty string.
+        ++p;
+        break;
+      default:
+        // Got an otherwise unmatched character.
+        this->addToCurrentPath(p, 1);
+        ++p;
+        break;
+    }
+  }
+  this->sanitizeContent();
+  return this->HelperState != State::Failed;
+}
+
 void cmGccDepfileLexerHelper::newEntry()
 {
   if (this->HelperState == State::Rule && !this->Content.empty()) {
@@ -85,6 +305,11 @@ void cmGccDepfileLexerHelper::newRuleOrDependency()
 }
 
 void cmGccDepfileLexerHelper::addToCurrentPath(const char* s)
+{
+  this->addToCurrentPath(s, std::strlen(s));
+}
+
+void cmGccDepfileLexerHelper::addToCurrentPath(const char* s, std::size_t n)
 {
   if (this->Content.empty()) {
     return;
@@ -107,7 +332,7 @@ void cmGccDepfileLexerHelper::addToCurrentPath(const char* s)
     case State::Failed:
       return;
   }
-  dst->append(s);
+  dst->append(s, n);
 }
 
 void cmGccDepfileLexerHelper::sanitizeContent()
@@ -2,6 +2,7 @@
    file Copyright.txt or https://cmake.org/licensing for details.  */
 #pragma once
 
+#include <cstddef>
 #include <utility>
 
 #include <cmGccDepfileReaderTypes.h>
@@ -12,6 +13,15 @@ public:
   cmGccDepfileLexerHelper() = default;
 
   bool readFile(const char* filePath);
+
+  // Read the whole file into memory and scan it with parseBuffer instead
+  // of the lexer.
+  bool readFileBuffered(const char* filePath);
+
+  // Scan a depfile in memory.  This follows the rules of the lexer but
+  // appends runs of plain characters directly from the buffer.
+  bool parseBuffer(const char* data, std::size_t size);
+
   cmGccDepfileContent extractContent() && { return std::move(this->Content); }
 
   // Functions called by the lexer
@@ -20,6 +30,7 @@ public:
   void newDependency();
   void newRuleOrDependency();
   void addToCurrentPath(const char* s);
+  void addToCurrentPath(const char* s, std::size_t n);
 
 private:
   void sanitizeContent();
@@ -17,7 +17,7 @@ cm::optional<cmGccDepfileContent> cmReadGccDepfile(
   GccDepfilePrependPaths prependPaths)
 {
   cmGccDepfileLexerHelper helper;
-  if (!helper.readFile(filePath)) {
+  if (!helper.readFileBuffered(filePath)) {
     return cm::nullopt;
   }
   auto deps = cm::make_optional(std::move(helper).extractContent());
@@ -3,6 +3,7 @@
 #include "cmGeneratedFileStream.h"
 
 #include <cstdio>
+#include <utility>
 
 #include "cmStringAlgorithms.h"
 #include "cmSystemTools.h"
@@ -116,11 +117,46 @@ cmGeneratedFileStreamBase::cmGeneratedFileStreamBase(std::string const& name)
   this->Open(name);
 }
 
+cmGeneratedFileStreamBase::DeferredReplacements*
+  cmGeneratedFileStreamBase::Deferred = nullptr;
+
 cmGeneratedFileStreamBase::~cmGeneratedFileStreamBase()
 {
+  if (Deferred && !this->Name.empty() && this->Okay) {
+    Replacement r = this->MakeReplacement();
+    auto it = Deferred->find(r.Name);
+    if (it == Deferred->end()) {
+      Deferred->emplace(r.Name, std::move(r));
+      return;
+    }
+    // The same file was generated twice.  The later content wins.
+    if (it->second.TempName != r.TempName) {
+      cmSystemTools::RemoveFile(it->second.TempName);
+    }
+    it->second = std::move(r);
+    return;
+  }
   this->Close();
 }
 
+void cmGeneratedFileStreamBase::SetDeferredReplacements(
+  DeferredReplacements* deferred)
+{
+  Deferred = deferred;
+}
+
+cmGeneratedFileStreamBase::Replacement
+cmGeneratedFileStreamBase::MakeReplacement() const
+{
+  Replacement r;
+  r.Name = this->Name;
+  r.TempName = this->TempName;
+  r.CopyIfDifferent = this->CopyIfDifferent;
+  r.Compress = this->Compress;
+  r.CompressExtraExtension = this->CompressExtraExtension;
+  return r;
+}
+
 void cmGeneratedFileStreamBase::Open(std::string const& name)
 {
   // Save the original name of the file.
@@ -150,6 +186,36 @@ void cmGeneratedFileStreamBase::Open(std::string const& name)
 }
 
 bool cmGeneratedFileStreamBase::Close()
+{
+  // A file closed explicitly supersedes any earlier deferred content.
+  if (Deferred && !this->Name.empty()) {
+    auto it = Deferred->find(this->Name);
+    if (it != Deferred->end()) {
+      if (it->second.TempName != this->TempName) {
+        cmSystemTools::RemoveFile(it->second.TempName);
+      }
+      Deferred->erase(it);
+    }
+  }
+
+  bool replaced = false;
+
+  // Only consider replacing the destination file if no error
+  // occurred.
+  if (!this->Name.empty() && this->Okay) {
+    replaced = this->MakeReplacement().Apply();
+  } else if (!this->TempName.empty()) {
+    // Always delete the temporary file. We never want it to stay around.
+    cmSystemTools::RemoveFile(this->TempName);
+  }
+
+  // The destructor must not replace the destination a second time.
+  this->Name.clear();
+
+  return replaced;
+}
+
+bool cmGeneratedFileStreamBase::Replacement::Apply() const
 {
   bool replaced = false;
 
@@ -158,21 +224,18 @@ bool cmGeneratedFileStreamBase::Close()
     resname += ".gz";
   }
 
-  // Only consider replacing the destination file if no error
-  // occurred.
-  if (!this->Name.empty() && this->Okay &&
-      (!this->CopyIfDifferent ||
-       cmSystemTools::FilesDiffer(this->TempName, resname))) {
+  if (!this->CopyIfDifferent ||
+      cmSystemTools::FilesDiffer(this->TempName, resname)) {
     // The destination is to be replaced.  Rename the temporary to the
     // destination atomically.
     if (this->Compress) {
       std::string gzname = cmStrCat(this->TempName, ".temp.gz");
-      if (this->CompressFile(this->TempName, gzname)) {
-        this->RenameFile(gzname, resname);
+      if (cmGeneratedFileStreamBase::CompressFile(this->TempName, gzname)) {
+        cmGeneratedFileStreamBase::RenameFile(gzname, resname);
       }
       cmSystemTools::RemoveFile(gzname);
     } else {
-      this->RenameFile(this->TempName, resname);
+      cmGeneratedFileStreamBase::RenameFile(this->TempName, resname);
     }
 
     replaced = true;
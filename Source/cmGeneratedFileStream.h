@@ -5,6 +5,7 @@
 #include "cmConfigure.h" // IWYU pragma: keep
 
 #include <string>
+#include <unordered_map>
 
 #include "cmsys/FStream.hxx"
 
@@ -15,6 +16,32 @@
 // therefore be used to manage the temporary file.
 class cmGeneratedFileStreamBase
 {
+public:
+  // Replacement of a destination file by a finished temporary file.
+  struct Replacement
+  {
+    std::string Name;
+    std::string TempName;
+    bool CopyIfDifferent = false;
+    bool Compress = false;
+    bool CompressExtraExtension = true;
+
+    // Replace the destination if needed and always remove the temporary
+    // file.  Returns whether the destination was replaced.  This may be
+    // called concurrently for distinct destinations.
+    bool Apply() const;
+  };
+
+  // Replacements keyed by destination file name.
+  using DeferredReplacements = std::unordered_map<std::string, Replacement>;
+
+  // While a map is set, streams destroyed without an explicit Close()
+  // record their replacement in it instead of performing it.  The caller
+  // owns the map and must pass nullptr and apply the recorded
+  // replacements on every path out of the scope that set it, or the
+  // temporary files are left behind.
+  static void SetDeferredReplacements(DeferredReplacements* deferred);
+
 protected:
   // This constructor does not prepare the temporary file.  The open
   // method must be used.
@@ -34,10 +61,12 @@ protected:
   bool Close();
 
   // Internal file replacement implementation.
-  int RenameFile(std::string const& oldname, std::string const& newname);
+  static int RenameFile(std::string const& oldname,
+                        std::string const& newname);
 
   // Internal file compression implementation.
-  int CompressFile(std::string const& oldname, std::string const& newname);
+  static int CompressFile(std::string const& oldname,
+                          std::string const& newname);
 
   // The name of the final destination file for the output.
   std::string Name;
@@ -59,6 +88,11 @@ protected:
 
   // Whether the destination file is compressed
   bool CompressExtraExtension = true;
+
+private:
+  Replacement MakeReplacement() const;
+
+  static DeferredReplacements* Deferred;
 };
 
 /** \class cmGeneratedFileStream
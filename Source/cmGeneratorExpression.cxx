@@ -4,7 +4,9 @@
 
 #include <cassert>
 #include <memory>
+#include <tuple>
 #include <utility>
+#include <vector>
 
 #include "cmsys/RegularExpression.hxx"
 
@@ -13,9 +15,19 @@
 #include "cmGeneratorExpressionEvaluator.h"
 #include "cmGeneratorExpressionLexer.h"
 #include "cmGeneratorExpressionParser.h"
+#include "cmGeneratorTarget.h"
+#include "cmGlobalGenerator.h"
+#include "cmLocalGenerator.h"
 #include "cmStringAlgorithms.h"
 #include "cmSystemTools.h"
 
+#if !defined(CMAKE_BOOTSTRAP)
+#  include <cm/optional>
+
+#  include "cmMakefileProfilingData.h"
+#  include "cmake.h"
+#endif
+
 cmGeneratorExpression::cmGeneratorExpression(cmListFileBacktrace backtrace)
   : Backtrace(std::move(backtrace))
 {
@@ -57,7 +69,114 @@ const std::string& cmCompiledGeneratorExpression::Evaluate(
     currentTarget ? currentTarget : headTarget, this->EvaluateForBuildsystem,
     this->Backtrace, language);
 
-  return this->EvaluateWithContext(context, dagChecker);
+#if !defined(CMAKE_BOOTSTRAP)
+  // Profile only outermost evaluations; nested ones are part of them.
+  cm::optional<cmMakefileProfilingData::RAII> profilingRAII;
+  if (this->NeedsEvaluation && lg && !dagChecker &&
+      lg->GetCMakeInstance()->IsProfilingEnabled()) {
+    std::size_t const maxLength = 80;
+    profilingRAII.emplace(lg->GetCMakeInstance()->GetProfilingOutput(),
+                          "genex",
+                          this->Input.size() > maxLength
+                            ? cmStrCat(this->Input.substr(0, maxLength), "...")
+                            : this->Input);
+  }
+#endif
+
+  cmGeneratorExpressionMemo* memo = nullptr;
+  if (this->NeedsEvaluation && lg) {
+    memo = &lg->GetGlobalGenerator()->GetGeneratorExpressionMemo();
+    if (!memo->IsEnabled()) {
+      memo = nullptr;
+    }
+  }
+  if (!memo) {
+    return this->EvaluateWithContext(context, dagChecker);
+  }
+
+  // The local generator is implied by the head target when it is the
+  // head target's own, which is the case for target property entries.
+  cmGeneratorExpressionMemo::Key key;
+  key.Input = this->Input;
+  if (!context.HeadTarget || context.HeadTarget->GetLocalGenerator() != lg) {
+    key.LocalGenerator = lg;
+  }
+  key.Config = config;
+  key.HeadTarget = context.HeadTarget;
+  key.CurrentTarget = context.CurrentTarget;
+  key.Language = language;
+  key.Quiet = this->Quiet;
+  key.EvaluateForBuildsystem = this->EvaluateForBuildsystem;
+  if (dagChecker) {
+    cmGeneratorExpressionDAGChecker const* top = dagChecker->Top();
+    key.CheckerTarget = dagChecker->GetTarget();
+    key.CheckerProperty = dagChecker->GetProperty();
+    key.TopTarget = top->GetTarget();
+    key.TopProperty = top->GetProperty();
+    key.TransitivePropertiesOnly = dagChecker->GetTransitivePropertiesOnly();
+  }
+
+  auto it = memo->Results.find(key);
+  if (it != memo->Results.end()) {
+    cmGeneratorExpressionMemo::Result const& result = it->second;
+    if (dagChecker && !dagChecker->VisitsAreRepeatable(result.Visits)) {
+      // The enclosing evaluation has already visited a target property
+      // this one visits, so the result may differ.
+      ++memo->Stats.Uncacheable;
+      return this->EvaluateWithContext(context, dagChecker);
+    }
+    ++memo->Stats.Hits;
+    if (dagChecker) {
+      dagChecker->ReplayVisits(result.Visits);
+    }
+    this->Output = result.Output;
+    this->SeenTargetProperties.insert(result.SeenTargetProperties.cbegin(),
+                                      result.SeenTargetProperties.cend());
+    this->MaxLanguageStandard = result.MaxLanguageStandard;
+    this->HadContextSensitiveCondition = result.HadContextSensitiveCondition;
+    this->HadHeadSensitiveCondition = result.HadHeadSensitiveCondition;
+    this->HadLinkLanguageSensitiveCondition =
+      result.HadLinkLanguageSensitiveCondition;
+    this->SourceSensitiveTargets = result.SourceSensitiveTargets;
+    this->DependTargets = result.DependTargets;
+    this->AllTargetsSeen = result.AllTargetsSeen;
+    return this->Output;
+  }
+
+  ++memo->Stats.Misses;
+  std::vector<cmGeneratorExpressionDAGChecker::Visit> visits;
+  std::vector<cmGeneratorExpressionDAGChecker::Visit>* outerVisits = nullptr;
+  if (dagChecker) {
+    outerVisits = dagChecker->SetVisitRecord(&visits);
+  }
+  this->EvaluateWithContext(context, dagChecker);
+  if (dagChecker) {
+    dagChecker->SetVisitRecord(outerVisits);
+    if (outerVisits) {
+      outerVisits->insert(outerVisits->end(), visits.begin(), visits.end());
+    }
+  }
+
+  // Evaluate again after an error so that it is diagnosed every time.
+  // Results that depend on what the enclosing evaluation has visited are
+  // not a function of the key.
+  if (!context.HadError &&
+      (!dagChecker || dagChecker->VisitsAreLocal(visits))) {
+    cmGeneratorExpressionMemo::Result& result =
+      memo->Results[std::move(key)];
+    result.Output = this->Output;
+    result.SeenTargetProperties = context.SeenTargetProperties;
+    result.MaxLanguageStandard = this->MaxLanguageStandard;
+    result.HadContextSensitiveCondition = this->HadContextSensitiveCondition;
+    result.HadHeadSensitiveCondition = this->HadHeadSensitiveCondition;
+    result.HadLinkLanguageSensitiveCondition =
+      this->HadLinkLanguageSensitiveCondition;
+    result.SourceSensitiveTargets = this->SourceSensitiveTargets;
+    result.DependTargets = this->DependTargets;
+    result.AllTargetsSeen = this->AllTargetsSeen;
+    result.Visits = std::move(visits);
+  }
+  return this->Output;
 }
 
 const std::string& cmCompiledGeneratorExpression::EvaluateWithContext(
@@ -96,6 +215,28 @@ const std::string& cmCompiledGeneratorExpression::EvaluateWithContext(
   return this->Output;
 }
 
+bool cmGeneratorExpressionMemo::Key::operator<(Key const& other) const
+{
+  return std::tie(this->Input, this->LocalGenerator, this->Config,
+                  this->HeadTarget, this->CurrentTarget, this->Language,
+                  this->Quiet, this->EvaluateForBuildsystem,
+                  this->CheckerTarget, this->CheckerProperty, this->TopTarget,
+                  this->TopProperty, this->TransitivePropertiesOnly) <
+    std::tie(other.Input, other.LocalGenerator, other.Config,
+             other.HeadTarget, other.CurrentTarget, other.Language,
+             other.Quiet, other.EvaluateForBuildsystem, other.CheckerTarget,
+             other.CheckerProperty, other.TopTarget, other.TopProperty,
+             other.TransitivePropertiesOnly);
+}
+
+void cmGeneratorExpressionMemo::SetEnabled(bool enabled)
+{
+  this->Enabled = enabled;
+  if (!enabled) {
+    this->Results.clear();
+  }
+}
+
 cmCompiledGeneratorExpression::cmCompiledGeneratorExpression(
   cmListFileBacktrace backtrace, std::string input)
   : Backtrace(std::move(backtrace))
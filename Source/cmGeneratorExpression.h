@@ -11,13 +11,14 @@
 #include <utility>
 #include <vector>
 
+#include "cmGeneratorExpressionDAGChecker.h"
 #include "cmListFileCache.h"
 
 class cmCompiledGeneratorExpression;
+class cmGeneratorExpressionMemo;
 class cmGeneratorTarget;
 class cmLocalGenerator;
 struct cmGeneratorExpressionContext;
-struct cmGeneratorExpressionDAGChecker;
 struct cmGeneratorExpressionEvaluator;
 
 /** \class cmGeneratorExpression
@@ -177,6 +178,78 @@ private:
   mutable std::set<cmGeneratorTarget const*> SourceSensitiveTargets;
 };
 
+/** \class cmGeneratorExpressionMemo
+ * \brief Remember the results of generator expression evaluations.
+ *
+ * While the memo is enabled, evaluations are answered from previous
+ * evaluations of the same expression text with the same configuration,
+ * head target, current target and language.  The local generator is part
+ * of the key only when it is not the head target's own.  Evaluations
+ * under a cmGeneratorExpressionDAGChecker are also keyed on the checker's
+ * target and property and those of the outermost checker.  Their result
+ * is remembered with the target properties they visited, and is reused
+ * only when no enclosing evaluation has visited any of those, so that
+ * the checker would reach the same results.  The owner must enable the
+ * memo only while no target is modified.
+ */
+class cmGeneratorExpressionMemo
+{
+public:
+  struct Statistics
+  {
+    unsigned long Hits = 0;
+    unsigned long Misses = 0;
+    /** Remembered results not reused because of the enclosing checks.  */
+    unsigned long Uncacheable = 0;
+  };
+
+  void SetEnabled(bool enabled);
+  bool IsEnabled() const { return this->Enabled; }
+
+  Statistics const& GetStatistics() const { return this->Stats; }
+
+private:
+  friend class cmCompiledGeneratorExpression;
+
+  struct Key
+  {
+    std::string Input;
+    cmLocalGenerator const* LocalGenerator = nullptr;
+    std::string Config;
+    cmGeneratorTarget const* HeadTarget = nullptr;
+    cmGeneratorTarget const* CurrentTarget = nullptr;
+    std::string Language;
+    bool Quiet = false;
+    bool EvaluateForBuildsystem = false;
+    cmGeneratorTarget const* CheckerTarget = nullptr;
+    std::string CheckerProperty;
+    cmGeneratorTarget const* TopTarget = nullptr;
+    std::string TopProperty;
+    bool TransitivePropertiesOnly = false;
+
+    bool operator<(Key const& other) const;
+  };
+
+  struct Result
+  {
+    std::string Output;
+    std::set<cmGeneratorTarget*> DependTargets;
+    std::set<cmGeneratorTarget const*> AllTargetsSeen;
+    std::set<std::string> SeenTargetProperties;
+    std::map<cmGeneratorTarget const*, std::map<std::string, std::string>>
+      MaxLanguageStandard;
+    bool HadContextSensitiveCondition = false;
+    bool HadHeadSensitiveCondition = false;
+    bool HadLinkLanguageSensitiveCondition = false;
+    std::set<cmGeneratorTarget const*> SourceSensitiveTargets;
+    std::vector<cmGeneratorExpressionDAGChecker::Visit> Visits;
+  };
+
+  bool Enabled = false;
+  std::map<Key, Result> Results;
+  Statistics Stats;
+};
+
 class cmGeneratorExpressionInterpreter
 {
 public:
@@ -2,6 +2,7 @@
    file Copyright.txt or https://cmake.org/licensing for details.  */
 #include "cmGeneratorExpressionDAGChecker.h"
 
+#include <algorithm>
 #include <cstring>
 #include <sstream>
 #include <utility>
@@ -50,22 +51,111 @@ void cmGeneratorExpressionDAGChecker::Initialize()
   const auto* top = this->Top();
   this->CheckResult = this->CheckGraph();
 
-#define TEST_TRANSITIVE_PROPERTY_METHOD(METHOD) top->METHOD() ||
-
-  if (this->CheckResult == DAG &&
-      (CM_FOR_EACH_TRANSITIVE_PROPERTY_METHOD(
-        TEST_TRANSITIVE_PROPERTY_METHOD) false)) // NOLINT(*)
-#undef TEST_TRANSITIVE_PROPERTY_METHOD
-  {
+  if (this->CheckResult == DAG && top->EvaluatingTransitiveProperty()) {
     auto it = top->Seen.find(this->Target);
     if (it != top->Seen.end()) {
       const std::set<std::string>& propSet = it->second;
       if (propSet.find(this->Property) != propSet.end()) {
         this->CheckResult = ALREADY_SEEN;
-        return;
       }
     }
-    top->Seen[this->Target].insert(this->Property);
+    if (this->CheckResult == DAG) {
+      top->Seen[this->Target].insert(this->Property);
+    }
+  }
+
+  if (this->Parent) {
+    this->Parent->RecordVisit(
+      Visit{ this->Target, this->Property, this->CheckResult });
+  }
+}
+
+bool cmGeneratorExpressionDAGChecker::EvaluatingTransitiveProperty() const
+{
+#define TEST_TRANSITIVE_PROPERTY_METHOD(METHOD) this->METHOD() ||
+
+  return CM_FOR_EACH_TRANSITIVE_PROPERTY_METHOD(
+    TEST_TRANSITIVE_PROPERTY_METHOD) false; // NOLINT(*)
+
+#undef TEST_TRANSITIVE_PROPERTY_METHOD
+}
+
+bool cmGeneratorExpressionDAGChecker::IsOnPath(
+  cmGeneratorTarget const* target, std::string const& property) const
+{
+  for (const auto* checker = this; checker; checker = checker->Parent) {
+    if (checker->Target == target && checker->Property == property) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void cmGeneratorExpressionDAGChecker::RecordVisit(Visit const& visit) const
+{
+  for (const auto* checker = this; checker; checker = checker->Parent) {
+    if (checker->VisitRecord) {
+      checker->VisitRecord->push_back(visit);
+    }
+  }
+}
+
+std::vector<cmGeneratorExpressionDAGChecker::Visit>*
+cmGeneratorExpressionDAGChecker::SetVisitRecord(
+  std::vector<Visit>* record) const
+{
+  std::vector<Visit>* previous = this->VisitRecord;
+  this->VisitRecord = record;
+  return previous;
+}
+
+bool cmGeneratorExpressionDAGChecker::VisitsAreLocal(
+  std::vector<Visit> const& visits) const
+{
+  for (auto it = visits.begin(); it != visits.end(); ++it) {
+    if (this->IsOnPath(it->Target, it->Property)) {
+      return false;
+    }
+    if (it->CheckResult == ALREADY_SEEN &&
+        std::none_of(visits.begin(), it, [it](Visit const& earlier) {
+          return earlier.CheckResult == DAG &&
+            earlier.Target == it->Target && earlier.Property == it->Property;
+        })) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool cmGeneratorExpressionDAGChecker::VisitsAreRepeatable(
+  std::vector<Visit> const& visits) const
+{
+  const auto* top = this->Top();
+  bool const transitive = top->EvaluatingTransitiveProperty();
+  for (Visit const& visit : visits) {
+    if (this->IsOnPath(visit.Target, visit.Property)) {
+      return false;
+    }
+    if (transitive) {
+      auto it = top->Seen.find(visit.Target);
+      if (it != top->Seen.end() && it->second.count(visit.Property)) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+void cmGeneratorExpressionDAGChecker::ReplayVisits(
+  std::vector<Visit> const& visits) const
+{
+  const auto* top = this->Top();
+  bool const transitive = top->EvaluatingTransitiveProperty();
+  for (Visit const& visit : visits) {
+    if (transitive && visit.CheckResult == DAG) {
+      top->Seen[visit.Target].insert(visit.Property);
+    }
+    this->RecordVisit(visit);
   }
 }
 
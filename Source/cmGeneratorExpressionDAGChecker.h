@@ -7,6 +7,7 @@
 #include <map>
 #include <set>
 #include <string>
+#include <vector>
 
 #include "cmListFileCache.h"
 
@@ -85,14 +86,56 @@ struct cmGeneratorExpressionDAGChecker
   cmGeneratorExpressionDAGChecker const* Top() const;
   cmGeneratorTarget const* TopTarget() const;
 
+  cmGeneratorTarget const* GetTarget() const { return this->Target; }
+  std::string const& GetProperty() const { return this->Property; }
+
+  /** A check of a target property made by a checker created below.  */
+  struct Visit
+  {
+    cmGeneratorTarget const* Target;
+    std::string Property;
+    Result CheckResult;
+  };
+
+  /**
+   * Record the checks made by the checkers created below this one in the
+   * given list.  Returns the list recorded in before, which the caller
+   * must restore.
+   */
+  std::vector<Visit>* SetVisitRecord(std::vector<Visit>* record) const;
+
+  /**
+   * Whether the recorded checks depend only on each other.  That is, none
+   * of them refers to this checker or one above it, and none was found
+   * already seen before the first of them was made.
+   */
+  bool VisitsAreLocal(std::vector<Visit> const& visits) const;
+
+  /**
+   * Whether making the recorded checks below this checker now would give
+   * the results that were recorded.
+   */
+  bool VisitsAreRepeatable(std::vector<Visit> const& visits) const;
+
+  /**
+   * Account for recorded checks as if they were made again below this
+   * checker, without evaluating anything.
+   */
+  void ReplayVisits(std::vector<Visit> const& visits) const;
+
 private:
   Result CheckGraph() const;
   void Initialize();
+  bool EvaluatingTransitiveProperty() const;
+  bool IsOnPath(cmGeneratorTarget const* target,
+                std::string const& property) const;
+  void RecordVisit(Visit const& visit) const;
 
   const cmGeneratorExpressionDAGChecker* const Parent;
   cmGeneratorTarget const* Target;
   const std::string Property;
   mutable std::map<cmGeneratorTarget const*, std::set<std::string>> Seen;
+  mutable std::vector<Visit>* VisitRecord = nullptr;
   const GeneratorExpressionContent* const Content;
   const cmListFileBacktrace Backtrace;
   Result CheckResult;
@@ -16,6 +16,7 @@
 #include <utility>
 
 #include <cm/memory>
+#include <cm/optional>
 #include <cm/string_view>
 #include <cmext/algorithm>
 #include <cmext/string_view>
@@ -52,6 +53,10 @@
 #include "cmTargetPropertyComputer.h"
 #include "cmake.h"
 
+#if !defined(CMAKE_BOOTSTRAP)
+#  include "cmMakefileProfilingData.h"
+#endif
+
 namespace {
 using LinkInterfaceFor = cmGeneratorTarget::LinkInterfaceFor;
 
@@ -6287,6 +6292,15 @@ cmComputeLinkInformation* cmGeneratorTarget::GetLinkInformation(
   std::string key(cmSystemTools::UpperCase(config));
   auto i = this->LinkInformation.find(key);
   if (i == this->LinkInformation.end()) {
+#if !defined(CMAKE_BOOTSTRAP)
+    cmake* cm = this->GetLocalGenerator()->GetCMakeInstance();
+    cm::optional<cmMakefileProfilingData::RAII> profilingRAII;
+    if (cm->IsProfilingEnabled()) {
+      profilingRAII.emplace(cm->GetProfilingOutput(), "link",
+                            cmStrCat(this->GetName(), " (", config, ')'));
+    }
+#endif
+
     // Compute information for this configuration.
     auto info = cm::make_unique<cmComputeLinkInformation>(this, config);
     if (info && !info->Compute()) {
@@ -2,10 +2,14 @@
    file Copyright.txt or https://cmake.org/licensing for details.  */
 #include "cmGlobVerificationManager.h"
 
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
 #include <sstream>
 
 #include "cmsys/FStream.hxx"
 
+#include "cmCachedGlob.h"
 #include "cmGeneratedFileStream.h"
 #include "cmListFileCache.h"
 #include "cmMessageType.h"
@@ -14,6 +18,162 @@
 #include "cmSystemTools.h"
 #include "cmVersion.h"
 
+namespace {
+// Bump this whenever the on-disk layout changes.
+char const kMagic[] = "CMVGS\x01";
+
+class Writer
+{
+public:
+  explicit Writer(std::ostream& os)
+    : OS(os)
+  {
+  }
+
+  void Int(std::int64_t v)
+  {
+    this->OS.write(reinterpret_cast<char const*>(&v), sizeof(v));
+  }
+
+  void String(std::string const& s)
+  {
+    this->Int(static_cast<std::int64_t>(s.size()));
+    this->OS.write(s.data(), static_cast<std::streamsize>(s.size()));
+  }
+
+private:
+  std::ostream& OS;
+};
+
+class Reader
+{
+public:
+  explicit Reader(std::istream& is)
+    : IS(is)
+  {
+  }
+
+  bool Int(std::int64_t& v)
+  {
+    return static_cast<bool>(
+      this->IS.read(reinterpret_cast<char*>(&v), sizeof(v)));
+  }
+
+  bool Count(std::size_t& n)
+  {
+    std::int64_t v;
+    if (!this->Int(v) || v < 0) {
+      return false;
+    }
+    n = static_cast<std::size_t>(v);
+    return true;
+  }
+
+  bool String(std::string& s)
+  {
+    std::size_t n;
+    if (!this->Count(n)) {
+      return false;
+    }
+    s.resize(n);
+    return n == 0 ||
+      static_cast<bool>(this->IS.read(&s[0], static_cast<std::streamsize>(n)));
+  }
+
+private:
+  std::istream& IS;
+};
+
+std::int64_t const FlagRecurse = 1;
+std::int64_t const FlagListDirectories = 2;
+std::int64_t const FlagFollowSymlinks = 4;
+
+struct GlobState
+{
+  std::int64_t Flags = 0;
+  std::string Relative;
+  std::string Expression;
+  std::vector<std::string> Files;
+  std::map<std::string, cmDirectoryListingCache::Stamp> Directories;
+};
+
+void WriteGlob(
+  Writer& w, std::int64_t flags, std::string const& relative,
+  std::string const& expression, std::vector<std::string> const& files,
+  std::map<std::string, cmDirectoryListingCache::Stamp> const& directories)
+{
+  w.Int(flags);
+  w.String(relative);
+  w.String(expression);
+  w.Int(static_cast<std::int64_t>(files.size()));
+  for (std::string const& file : files) {
+    w.String(file);
+  }
+  w.Int(static_cast<std::int64_t>(directories.size()));
+  for (auto const& d : directories) {
+    w.String(d.first);
+    w.Int(d.second.Time);
+    w.Int(d.second.Racy ? 1 : 0);
+  }
+}
+
+bool ReadGlob(Reader& r, GlobState& glob)
+{
+  std::size_t count;
+  if (!r.Int(glob.Flags) || !r.String(glob.Relative) ||
+      !r.String(glob.Expression) || !r.Count(count)) {
+    return false;
+  }
+  glob.Files.resize(count);
+  for (std::string& file : glob.Files) {
+    if (!r.String(file)) {
+      return false;
+    }
+  }
+  if (!r.Count(count)) {
+    return false;
+  }
+  for (std::size_t i = 0; i < count; ++i) {
+    std::string dir;
+    std::int64_t time;
+    std::int64_t racy;
+    if (!r.String(dir) || !r.Int(time) || !r.Int(racy)) {
+      return false;
+    }
+    cmDirectoryListingCache::Stamp& stamp = glob.Directories[dir];
+    stamp.Time = time;
+    stamp.Racy = racy != 0;
+  }
+  return true;
+}
+
+bool SaveState(std::string const& stateFile, std::string const& stampFile,
+               std::vector<GlobState> const& globs)
+{
+  // Write to a temporary file first so that an interrupted write never
+  // leaves a partial state behind.
+  std::string const tmp = cmStrCat(stateFile, ".tmp");
+  {
+    cmsys::ofstream fout(tmp.c_str(), std::ios::out | std::ios::binary);
+    if (!fout) {
+      return false;
+    }
+    fout.write(kMagic, sizeof(kMagic) - 1);
+    Writer w(fout);
+    w.String(stampFile);
+    w.Int(static_cast<std::int64_t>(globs.size()));
+    for (GlobState const& glob : globs) {
+      WriteGlob(w, glob.Flags, glob.Relative, glob.Expression, glob.Files,
+                glob.Directories);
+    }
+    if (!fout) {
+      return false;
+    }
+  }
+  return cmSystemTools::RenameFile(tmp, stateFile);
+}
+}
+
 bool cmGlobVerificationManager::SaveVerificationScript(const std::string& path,
                                                        cmMessenger* messenger)
 {
@@ -85,6 +245,113 @@ bool cmGlobVerificationManager::SaveVerificationScript(const std::string& path,
                      "VerifyGlobs.cmake file\n";
   this->VerifyScript = scriptFile;
   this->VerifyStamp = stampFile;
+
+  // The state is optional, so a failure to write it is not an error.
+  this->SaveVerificationState(cmStrCat(path, "/CMakeFiles/VerifyGlobs.state"),
+                              stampFile);
+  return true;
+}
+
+bool cmGlobVerificationManager::SaveVerificationState(
+  std::string const& stateFile, std::string const& stampFile) const
+{
+  std::vector<GlobState> globs;
+  for (auto const& i : this->Cache) {
+    CacheEntryKey const& k = i.first;
+    CacheEntryValue const& v = i.second;
+    if (!v.Initialized) {
+      continue;
+    }
+    GlobState glob;
+    glob.Flags = (k.Recurse ? FlagRecurse : 0) |
+      (k.ListDirectories ? FlagListDirectories : 0) |
+      (k.FollowSymlinks ? FlagFollowSymlinks : 0);
+    glob.Relative = k.Relative;
+    glob.Expression = k.Expression;
+    glob.Files = v.Files;
+    glob.Directories = v.Directories;
+    globs.push_back(std::move(glob));
+  }
+  if (!SaveState(stateFile, stampFile, globs)) {
+    // Never leave the state of an earlier run behind.
+    cmSystemTools::RemoveFile(stateFile);
+    return false;
+  }
+  return true;
+}
+
+bool cmGlobVerificationManager::CheckVerificationState(
+  std::string const& script)
+{
+  std::string const stateFile =
+    cmStrCat(cmSystemTools::GetFilenamePath(script), "/VerifyGlobs.state");
+  std::string stampFile;
+  std::vector<GlobState> globs;
+  {
+    cmsys::ifstream fin(stateFile.c_str(), std::ios::in | std::ios::binary);
+    if (!fin) {
+      return false;
+    }
+    char magic[sizeof(kMagic) - 1];
+    if (!fin.read(magic, sizeof(magic)) ||
+        !std::equal(magic, magic + sizeof(magic), kMagic)) {
+      return false;
+    }
+    Reader r(fin);
+    std::size_t count;
+    if (!r.String(stampFile) || !r.Count(count)) {
+      return false;
+    }
+    globs.resize(count);
+    for (GlobState& glob : globs) {
+      if (!ReadGlob(r, glob)) {
+        return false;
+      }
+    }
+  }
+
+  bool updated = false;
+  for (GlobState& glob : globs) {
+    bool unchanged = true;
+    for (auto const& d : glob.Directories) {
+      if (!cmDirectoryListingCache::IsUnchanged(d.first, d.second)) {
+        unchanged = false;
+        break;
+      }
+    }
+    if (unchanged) {
+      continue;
+    }
+
+    // Evaluate the glob like the verification script does.
+    bool const recurse = (glob.Flags & FlagRecurse) != 0;
+    bool const listDirectories = (glob.Flags & FlagListDirectories) != 0;
+    cmCachedGlob g;
+    g.SetRecurse(recurse);
+    g.SetRecurseThroughSymlinks(recurse &&
+                                (glob.Flags & FlagFollowSymlinks) != 0);
+    g.SetListDirs(listDirectories);
+    g.SetRecurseListDirs(listDirectories);
+    g.SetRelative(glob.Relative);
+    g.FindFiles(glob.Expression);
+    std::vector<std::string>& files = g.GetFiles();
+    std::sort(files.begin(), files.end());
+    files.erase(std::unique(files.begin(), files.end()), files.end());
+    if (files != glob.Files) {
+      std::cerr << "-- GLOB mismatch!\n";
+      cmSystemTools::Touch(stampFile, false);
+      return true;
+    }
+
+    // The result is the same, so remember the directories as they are
+    // now to skip the glob next time.
+    glob.Directories = g.GetDirectories();
+    updated = true;
+  }
+
+  if (updated) {
+    SaveState(stateFile, stampFile, globs);
+  }
   return true;
 }
 
@@ -147,14 +414,17 @@ void cmGlobVerificationManager::CacheEntryKey::PrintGlobCommand(
 void cmGlobVerificationManager::AddCacheEntry(
   const bool recurse, const bool listDirectories, const bool followSymlinks,
   const std::string& relative, const std::string& expression,
-  const std::vector<std::string>& files, const std::string& variable,
-  const cmListFileBacktrace& backtrace, cmMessenger* messenger)
+  const std::vector<std::string>& files,
+  std::map<std::string, cmDirectoryListingCache::Stamp> const& directories,
+  const std::string& variable, const cmListFileBacktrace& backtrace,
+  cmMessenger* messenger)
 {
   CacheEntryKey key = CacheEntryKey(recurse, listDirectories, followSymlinks,
                                     relative, expression);
   CacheEntryValue& value = this->Cache[key];
   if (!value.Initialized) {
     value.Files = files;
+    value.Directories = directories;
     value.Initialized = true;
     value.Backtraces.emplace_back(variable, backtrace);
   } else if (value.Initialized && value.Files != files) {
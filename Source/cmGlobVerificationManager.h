@@ -10,6 +10,7 @@
 #include <utility>
 #include <vector>
 
+#include "cmDirectoryListingCache.h"
 #include "cmListFileCache.h"
 
 class cmMessenger;
@@ -18,22 +19,33 @@ class cmMessenger;
  * \brief Class for expressing build-time dependencies on glob expressions.
  *
  * Generates a CMake script which verifies glob outputs during prebuild.
- *
+ * The directories read by each glob are saved next to it with their
+ * modification times, so that the build can skip evaluating globs whose
+ * directories did not change.
  */
 class cmGlobVerificationManager
 {
+public:
+  /**
+   * Check the globs of a verification script like running it does, but
+   * using the state saved next to it to evaluate only the globs whose
+   * directories changed.  Return false if there is no usable state.
+   */
+  static bool CheckVerificationState(std::string const& script);
+
 protected:
   //! Save verification script for given makefile.
   //! Saves to output <path>/<CMakeFilesDirectory>/VerifyGlobs.cmake
   bool SaveVerificationScript(const std::string& path, cmMessenger* messenger);
 
   //! Add an entry into the glob cache
-  void AddCacheEntry(bool recurse, bool listDirectories, bool followSymlinks,
-                     const std::string& relative,
-                     const std::string& expression,
-                     const std::vector<std::string>& files,
-                     const std::string& variable,
-                     const cmListFileBacktrace& bt, cmMessenger* messenger);
+  void AddCacheEntry(
+    bool recurse, bool listDirectories, bool followSymlinks,
+    const std::string& relative, const std::string& expression,
+    const std::vector<std::string>& files,
+    std::map<std::string, cmDirectoryListingCache::Stamp> const& directories,
+    const std::string& variable, const cmListFileBacktrace& bt,
+    cmMessenger* messenger);
 
   //! Clear the glob cache for state reset.
   void Reset();
@@ -70,10 +82,14 @@ private:
   {
     bool Initialized = false;
     std::vector<std::string> Files;
+    std::map<std::string, cmDirectoryListingCache::Stamp> Directories;
     std::vector<std::pair<std::string, cmListFileBacktrace>> Backtraces;
   };
 
   using CacheEntryMap = std::map<CacheEntryKey, CacheEntryValue>;
+  bool SaveVerificationState(std::string const& stateFile,
+                             std::string const& stampFile) const;
+
   CacheEntryMap Cache;
   std::string VerifyScript;
   std::string VerifyStamp;
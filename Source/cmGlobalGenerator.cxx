@@ -55,10 +55,14 @@
 #include "cmake.h"
 
 #if !defined(CMAKE_BOOTSTRAP)
+#  include <atomic>
+#  include <thread>
+
 #  include <cm3p/json/value.h>
 #  include <cm3p/json/writer.h>
 
 #  include "cmCryptoHash.h"
+#  include "cmMakefileProfilingData.h"
 #  include "cmQtAutoGenGlobalInitializer.h"
 #endif
 
@@ -71,6 +75,93 @@ const std::string kCMAKE_PLATFORM_INFO_INITIALIZED =
 
 class cmInstalledFile;
 
+#if !defined(CMAKE_BOOTSTRAP)
+namespace {
+// Number of threads used to replace generated files, from the
+// CMAKE_GENERATE_PARALLEL_LEVEL environment variable.  Zero disables
+// deferred replacement.
+unsigned int GetGenerateParallelLevel()
+{
+  std::string level;
+  if (!cmSystemTools::GetEnv("CMAKE_GENERATE_PARALLEL_LEVEL", level)) {
+    return 0;
+  }
+  unsigned long jobs = 0;
+  if (level.empty()) {
+    jobs = std::thread::hardware_concurrency();
+  } else if (!cmStrToULong(level, &jobs)) {
+    jobs = 0;
+  }
+  return jobs > 1 ? static_cast<unsigned int>(jobs) : 0;
+}
+
+// Apply the replacements on a pool of threads.  Each destination file
+// appears only once, so the result does not depend on the order.
+void ApplyReplacements(
+  cmGeneratedFileStreamBase::DeferredReplacements const& deferred,
+  unsigned int jobs)
+{
+  std::vector<cmGeneratedFileStreamBase::Replacement const*> work;
+  work.reserve(deferred.size());
+  for (auto const& d : deferred) {
+    work.push_back(&d.second);
+  }
+
+  std::atomic<std::size_t> next(0);
+  auto worker = [&work, &next]() {
+    for (std::size_t i = next++; i < work.size(); i = next++) {
+      work[i]->Apply();
+    }
+  };
+
+  std::vector<std::thread> threads;
+  jobs = std::min<unsigned int>(jobs, static_cast<unsigned int>(work.size()));
+  for (unsigned int i = 1; i < jobs; ++i) {
+    threads.emplace_back(worker);
+  }
+  worker();
+  for (std::thread& t : threads) {
+    t.join();
+  }
+}
+
+// Defer replacing generated files while in scope.  The replacements are
+// applied by Flush() or, on any other exit path, when the scope ends, so
+// the deferral never outlives the generate step.
+class DeferredReplacementScope
+{
+public:
+  explicit DeferredReplacementScope(unsigned int jobs)
+    : Jobs(jobs)
+  {
+    if (this->Jobs > 0) {
+      cmGeneratedFileStreamBase::SetDeferredReplacements(&this->Deferred);
+    }
+  }
+
+  ~DeferredReplacementScope() { this->Flush(); }
+
+  DeferredReplacementScope(DeferredReplacementScope const&) = delete;
+  DeferredReplacementScope& operator=(DeferredReplacementScope const&) =
+    delete;
+
+  void Flush()
+  {
+    if (this->Jobs > 0) {
+      cmGeneratedFileStreamBase::SetDeferredReplacements(nullptr);
+      ApplyReplacements(this->Deferred, this->Jobs);
+      this->Deferred.clear();
+      this->Jobs = 0;
+    }
+  }
+
+private:
+  cmGeneratedFileStreamBase::DeferredReplacements Deferred;
+  unsigned int Jobs;
+};
+}
+#endif
+
 bool cmTarget::StrictTargetComparison::operator()(cmTarget const* t1,
                                                   cmTarget const* t2) const
 {
@@ -1621,6 +1712,16 @@ void cmGlobalGenerator::Generate()
 
   this->CMakeInstance->UpdateProgress("Generating", 0.1f);
 
+#if !defined(CMAKE_BOOTSTRAP)
+  // Optionally defer replacing the generated files until all local
+  // generators are done, then compare and rename them in parallel.
+  DeferredReplacementScope deferredReplacements(GetGenerateParallelLevel());
+#endif
+
+  // Targets no longer change while the project files are written, so
+  // generator expression results can be reused between local generators.
+  this->GeneratorExpressionMemo.SetEnabled(true);
+
   // Generate project files
   for (unsigned int i = 0; i < this->LocalGenerators.size(); ++i) {
     this->SetCurrentMakefile(this->LocalGenerators[i]->GetMakefile());
@@ -1637,6 +1738,21 @@ void cmGlobalGenerator::Generate()
           static_cast<float>(this->LocalGenerators.size()));
   }
   this->SetCurrentMakefile(nullptr);
+  this->GeneratorExpressionMemo.SetEnabled(false);
+
+#if !defined(CMAKE_BOOTSTRAP)
+  if (this->CMakeInstance->IsProfilingEnabled()) {
+    cmGeneratorExpressionMemo::Statistics const& stats =
+      this->GeneratorExpressionMemo.GetStatistics();
+    this->CMakeInstance->GetProfilingOutput().AddCounters(
+      "generator-expression-memo",
+      { { "hits", stats.Hits },
+        { "misses", stats.Misses },
+        { "uncacheable", stats.Uncacheable } });
+  }
+
+  deferredReplacements.Flush();
+#endif
 
   if (!this->GenerateCPackPropertiesFile()) {
     this->GetCMakeInstance()->IssueMessage(
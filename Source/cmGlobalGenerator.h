@@ -24,6 +24,7 @@
 #include "cmCustomCommandLines.h"
 #include "cmDuration.h"
 #include "cmExportSet.h"
+#include "cmGeneratorExpression.h"
 #include "cmStateSnapshot.h"
 #include "cmStringAlgorithms.h"
 #include "cmSystemTools.h"
@@ -268,6 +269,12 @@ public:
   //! Get the CMake instance
   cmake* GetCMakeInstance() const { return this->CMakeInstance; }
 
+  //! Get the memo of generator expression results used during Generate.
+  cmGeneratorExpressionMemo& GetGeneratorExpressionMemo()
+  {
+    return this->GeneratorExpressionMemo;
+  }
+
   void SetConfiguredFilesPath(cmGlobalGenerator* gen);
   const std::vector<std::unique_ptr<cmMakefile>>& GetMakefiles() const
   {
@@ -715,6 +722,8 @@ private:
   // track files replaced during a Generate
   std::vector<std::string> FilesReplacedDuringGenerate;
 
+  cmGeneratorExpressionMemo GeneratorExpressionMemo;
+
   // Store computed inter-target dependencies.
   using TargetDependMap = std::map<cmGeneratorTarget const*, TargetDependSet>;
   TargetDependMap TargetDependencies;
@@ -749,7 +749,7 @@ void cmGlobalXCodeGenerator::CreateReRunCMakeFile(
     makefileStream << "\t"
                    << this->ConvertToRelativeForMake(
                         cmSystemTools::GetCMakeCommand())
-                   << " -P "
+                   << " -E cmake_verify_globs "
                    << this->ConvertToRelativeForMake(cm->GetGlobVerifyScript())
                    << "\n\n";
   }
@@ -0,0 +1,316 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file Copyright.txt or https://cmake.org/licensing for details.  */
+#include "cmListFileBinaryCache.h"
+
+#include <cstdint>
+#include <utility>
+
+#include "cmsys/FStream.hxx"
+
+#include "cmCryptoHash.h"
+#include "cmMessageType.h"
+#include "cmMessenger.h"
+#include "cmStringAlgorithms.h"
+#include "cmSystemTools.h"
+#include "cmVersion.h"
+
+namespace {
+// Bump this whenever the on-disk layout changes.
+char const kMagic[] = "CMLFC\x01";
+
+class Writer
+{
+public:
+  explicit Writer(std::ostream& os)
+    : OS(os)
+  {
+  }
+
+  void Int(std::int64_t v)
+  {
+    this->OS.write(reinterpret_cast<char const*>(&v), sizeof(v));
+  }
+
+  void String(std::string const& s)
+  {
+    this->Int(static_cast<std::int64_t>(s.size()));
+    this->OS.write(s.data(), static_cast<std::streamsize>(s.size()));
+  }
+
+private:
+  std::ostream& OS;
+};
+
+class Reader
+{
+public:
+  explicit Reader(std::istream& is)
+    : IS(is)
+  {
+  }
+
+  bool Int(std::int64_t& v)
+  {
+    return static_cast<bool>(
+      this->IS.read(reinterpret_cast<char*>(&v), sizeof(v)));
+  }
+
+  bool String(std::string& s)
+  {
+    std::int64_t n;
+    if (!this->Int(n) || n < 0) {
+      return false;
+    }
+    s.resize(static_cast<std::size_t>(n));
+    return n == 0 ||
+      static_cast<bool>(this->IS.read(&s[0], static_cast<std::streamsize>(n)));
+  }
+
+private:
+  std::istream& IS;
+};
+
+std::string HashListFile(std::string const& path)
+{
+  cmCryptoHash hasher(cmCryptoHash::AlgoSHA256);
+  return hasher.HashFile(path);
+}
+
+bool SameFunctions(std::vector<cmListFileFunction> const& l,
+                   std::vector<cmListFileFunction> const& r)
+{
+  if (l.size() != r.size()) {
+    return false;
+  }
+  for (std::size_t i = 0; i < l.size(); ++i) {
+    cmListFileFunction const& lf = l[i];
+    cmListFileFunction const& rf = r[i];
+    if (lf.OriginalName() != rf.OriginalName() || lf.Line() != rf.Line() ||
+        lf.LineEnd() != rf.LineEnd() ||
+        lf.Arguments().size() != rf.Arguments().size()) {
+      return false;
+    }
+    for (std::size_t j = 0; j < lf.Arguments().size(); ++j) {
+      if (lf.Arguments()[j] != rf.Arguments()[j] ||
+          lf.Arguments()[j].Line != rf.Arguments()[j].Line) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+}
+
+cmListFileBinaryCache::cmListFileBinaryCache(Mode mode)
+  : CacheMode(mode)
+{
+}
+
+cmListFileBinaryCache::Entry* cmListFileBinaryCache::Lookup(
+  std::string const& path, unsigned long long size, cmFileTime const& ftm)
+{
+  auto it = this->Entries.find(path);
+  if (it == this->Entries.end()) {
+    return nullptr;
+  }
+  Entry& entry = it->second;
+  if (entry.Size == size && entry.Time == ftm.GetTime()) {
+    return &entry;
+  }
+  // The file was touched.  Its content may still be the same.
+  if (entry.Size == size && !entry.Hash.empty() &&
+      entry.Hash == HashListFile(path)) {
+    entry.Time = ftm.GetTime();
+    return &entry;
+  }
+  ++this->Stats.Stale;
+  this->Entries.erase(it);
+  return nullptr;
+}
+
+bool cmListFileBinaryCache::ParseFile(cmListFile& listFile,
+                                      std::string const& path,
+                                      cmMessenger* messenger,
+                                      cmListFileBacktrace const& lfbt)
+{
+  cmFileTime ftm;
+  if (!ftm.Load(path) || cmSystemTools::FileIsDirectory(path)) {
+    // Let the parser report the problem.
+    return listFile.ParseFile(path.c_str(), messenger, lfbt);
+  }
+  unsigned long long const size = cmSystemTools::FileLength(path);
+
+  if (Entry* entry = this->Lookup(path, size, ftm)) {
+    entry->Used = true;
+    ++this->Stats.Hits;
+    if (this->CacheMode != Mode::Validate) {
+      listFile.Functions = entry->Functions;
+      return true;
+    }
+    if (!listFile.ParseFile(path.c_str(), messenger, lfbt)) {
+      return false;
+    }
+    if (!SameFunctions(entry->Functions, listFile.Functions)) {
+      ++this->Stats.Mismatches;
+      messenger->IssueMessage(
+        MessageType::WARNING,
+        cmStrCat("List file cache entry for\n  ", path,
+                 "\ndoes not match the parsed file content."),
+        lfbt);
+      entry->Functions = listFile.Functions;
+    }
+    return true;
+  }
+
+  ++this->Stats.Misses;
+  if (!listFile.ParseFile(path.c_str(), messenger, lfbt)) {
+    return false;
+  }
+
+  // Files whose parsing produced diagnostics are not cached so that
+  // the diagnostics are issued again on the next run.
+  if (!listFile.HasParseWarnings) {
+    Entry& entry = this->Entries[path];
+    entry.Size = size;
+    entry.Time = ftm.GetTime();
+    entry.Hash = HashListFile(path);
+    entry.Functions = listFile.Functions;
+    entry.Used = true;
+  }
+  return true;
+}
+
+void cmListFileBinaryCache::Load(std::string const& cacheFile)
+{
+  this->CacheFile = cacheFile;
+  this->Entries.clear();
+
+  cmsys::ifstream fin(this->CacheFile.c_str(),
+                      std::ios::in | std::ios::binary);
+  if (!fin) {
+    return;
+  }
+
+  Reader r(fin);
+  std::string magic;
+  std::string version;
+  std::int64_t count;
+  if (!r.String(magic) || magic != kMagic || !r.String(version) ||
+      version != cmVersion::GetCMakeVersion() || !r.Int(count)) {
+    return;
+  }
+
+  std::unordered_map<std::string, Entry> entries;
+  for (std::int64_t e = 0; e < count; ++e) {
+    std::string path;
+    std::int64_t size;
+    std::int64_t time;
+    std::int64_t nfuncs;
+    Entry entry;
+    if (!r.String(path) || !r.Int(size) || !r.Int(time) ||
+        !r.String(entry.Hash) || !r.Int(nfuncs) || nfuncs < 0) {
+      return;
+    }
+    entry.Size = static_cast<unsigned long long>(size);
+    entry.Time = static_cast<cmFileTime::TimeType>(time);
+    entry.Functions.reserve(static_cast<std::size_t>(nfuncs));
+    for (std::int64_t f = 0; f < nfuncs; ++f) {
+      std::string name;
+      std::int64_t line;
+      std::int64_t lineEnd;
+      std::int64_t nargs;
+      if (!r.String(name) || !r.Int(line) || !r.Int(lineEnd) ||
+          !r.Int(nargs) || nargs < 0) {
+        return;
+      }
+      std::vector<cmListFileArgument> args;
+      args.reserve(static_cast<std::size_t>(nargs));
+      for (std::int64_t a = 0; a < nargs; ++a) {
+        std::string value;
+        std::int64_t delim;
+        std::int64_t argLine;
+        if (!r.String(value) || !r.Int(delim) || !r.Int(argLine) ||
+            delim < cmListFileArgument::Unquoted ||
+            delim > cmListFileArgument::Bracket) {
+          return;
+        }
+        args.emplace_back(std::move(value),
+                          static_cast<cmListFileArgument::Delimiter>(delim),
+                          static_cast<long>(argLine));
+      }
+      entry.Functions.emplace_back(std::move(name), static_cast<long>(line),
+                                   static_cast<long>(lineEnd),
+                                   std::move(args));
+    }
+    entries.emplace(std::move(path), std::move(entry));
+  }
+
+  this->Entries = std::move(entries);
+}
+
+bool cmListFileBinaryCache::Save() const
+{
+  if (this->CacheFile.empty()) {
+    return false;
+  }
+
+  // Write to a temporary file and rename so that an interrupted
+  // configure never leaves a truncated cache behind.
+  std::string const tmpFile = cmStrCat(this->CacheFile, ".tmp");
+  {
+    cmsys::ofstream fout(tmpFile.c_str(),
+                         std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!fout) {
+      return false;
+    }
+
+    std::int64_t count = 0;
+    for (auto const& e : this->Entries) {
+      if (e.second.Used) {
+        ++count;
+      }
+    }
+
+    Writer w(fout);
+    w.String(kMagic);
+    w.String(cmVersion::GetCMakeVersion());
+    w.Int(count);
+    for (auto const& e : this->Entries) {
+      Entry const& entry = e.second;
+      if (!entry.Used) {
+        continue;
+      }
+      w.String(e.first);
+      w.Int(static_cast<std::int64_t>(entry.Size));
+      w.Int(static_cast<std::int64_t>(entry.Time));
+      w.String(entry.Hash);
+      w.Int(static_cast<std::int64_t>(entry.Functions.size()));
+      for (cmListFileFunction const& func : entry.Functions) {
+        w.String(func.OriginalName());
+        w.Int(func.Line());
+        w.Int(func.LineEnd());
+        w.Int(static_cast<std::int64_t>(func.Arguments().size()));
+        for (cmListFileArgument const& arg : func.Arguments()) {
+          w.String(arg.Value);
+          w.Int(arg.Delim);
+          w.Int(arg.Line);
+        }
+      }
+    }
+    if (!fout) {
+      return false;
+    }
+  }
+  return cmSystemTools::RenameFile(tmpFile, this->CacheFile);
+}
+
+std::string cmListFileBinaryCache::GetStatisticsReport() const
+{
+  std::string report =
+    cmStrCat("List file cache: ", this->Stats.Hits, " hits, ",
+             this->Stats.Misses, " misses, ", this->Stats.Stale, " stale");
+  if (this->CacheMode == Mode::Validate) {
+    report += cmStrCat(", ", this->Stats.Mismatches, " mismatches");
+  }
+  return report;
+}
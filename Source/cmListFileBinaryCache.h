@@ -0,0 +1,87 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file Copyright.txt or https://cmake.org/licensing for details.  */
+#pragma once
+
+#include "cmConfigure.h" // IWYU pragma: keep
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "cmFileTime.h"
+#include "cmListFileCache.h"
+
+class cmMessenger;
+
+/** \class cmListFileBinaryCache
+ * \brief Persist parsed list files across configure runs.
+ *
+ * cmListFileBinaryCache keeps the parsed cmListFileFunction arrays of every
+ * list file read during a configure step and stores them in a binary file
+ * in the build tree.  On the next run files whose size and modification
+ * time (or, failing that, content hash) are unchanged are answered from
+ * the cache instead of being lexed again.
+ */
+class cmListFileBinaryCache
+{
+public:
+  enum class Mode
+  {
+    /** Answer unchanged list files from the cache.  */
+    On,
+    /** Parse every file anyway and verify cached entries match.  */
+    Validate,
+  };
+
+  struct Statistics
+  {
+    unsigned long Hits = 0;
+    unsigned long Misses = 0;
+    unsigned long Stale = 0;
+    unsigned long Mismatches = 0;
+  };
+
+  cmListFileBinaryCache(Mode mode);
+
+  cmListFileBinaryCache(const cmListFileBinaryCache&) = delete;
+  cmListFileBinaryCache& operator=(const cmListFileBinaryCache&) = delete;
+
+  /**
+   * @brief Parse a list file, consulting the cache first.
+   * @return false if the file could not be read or parsed.
+   */
+  bool ParseFile(cmListFile& listFile, std::string const& path,
+                 cmMessenger* messenger, cmListFileBacktrace const& lfbt);
+
+  /** Load entries from the given cache file.  A missing or corrupt file
+      is treated as an empty cache.  */
+  void Load(std::string const& cacheFile);
+
+  /** Write entries used during this run back to the cache file.  */
+  bool Save() const;
+
+  Mode GetMode() const { return this->CacheMode; }
+  std::string const& GetCacheFile() const { return this->CacheFile; }
+  Statistics const& GetStatistics() const { return this->Stats; }
+
+  /** Human-readable one-line summary of the statistics.  */
+  std::string GetStatisticsReport() const;
+
+private:
+  struct Entry
+  {
+    unsigned long long Size = 0;
+    cmFileTime::TimeType Time = 0;
+    std::string Hash;
+    std::vector<cmListFileFunction> Functions;
+    bool Used = false;
+  };
+
+  Entry* Lookup(std::string const& path, unsigned long long size,
+                cmFileTime const& ftm);
+
+  Mode CacheMode;
+  std::string CacheFile;
+  std::unordered_map<std::string, Entry> Entries;
+  Statistics Stats;
+};
@@ -243,4 +243,7 @@ struct cmListFile
                    cmMessenger* messenger, cmListFileBacktrace const& lfbt);
 
   std::vector<cmListFileFunction> Functions;
+
+  // Set when the parser issued warnings for this file.
+  bool HasParseWarnings = false;
 };
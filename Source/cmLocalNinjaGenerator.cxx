@@ -10,6 +10,7 @@
 #include <sstream>
 #include <utility>
 
+#include <cm/optional>
 #include <cmext/string_view>
 
 #include "cmsys/FStream.hxx"
@@ -37,6 +38,10 @@
 #include "cmValue.h"
 #include "cmake.h"
 
+#if !defined(CMAKE_BOOTSTRAP)
+#  include "cmMakefileProfilingData.h"
+#endif
+
 cmLocalNinjaGenerator::cmLocalNinjaGenerator(cmGlobalGenerator* gg,
                                              cmMakefile* mf)
   : cmLocalCommonGenerator(gg, mf, WorkDir::TopBin)
@@ -117,6 +122,13 @@ void cmLocalNinjaGenerator::Generate()
     if (!target->IsInBuildSystem()) {
       continue;
     }
+#if !defined(CMAKE_BOOTSTRAP)
+    cm::optional<cmMakefileProfilingData::RAII> profilingRAII;
+    if (this->GetCMakeInstance()->IsProfilingEnabled()) {
+      profilingRAII.emplace(this->GetCMakeInstance()->GetProfilingOutput(),
+                            "target", target->GetName());
+    }
+#endif
     auto tg = cmNinjaTargetGenerator::New(target.get());
     if (tg) {
       if (target->Target->IsPerConfig()) {
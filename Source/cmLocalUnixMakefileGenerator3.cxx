@@ -10,6 +10,7 @@
 #include <utility>
 
 #include <cm/memory>
+#include <cm/optional>
 #include <cm/string_view>
 #include <cm/vector>
 #include <cmext/algorithm>
@@ -54,6 +55,10 @@
 #  include "cmDependsJava.h"
 #endif
 
+#if !defined(CMAKE_BOOTSTRAP)
+#  include "cmMakefileProfilingData.h"
+#endif
+
 namespace {
 // Helper function used below.
 std::string cmSplitExtension(std::string const& in, std::string& base)
@@ -161,6 +166,14 @@ void cmLocalUnixMakefileGenerator3::Generate()
       gtVisited.insert(depVisited.begin(), depVisited.end());
     }
 
+#if !defined(CMAKE_BOOTSTRAP)
+    cm::optional<cmMakefileProfilingData::RAII> profilingRAII;
+    if (this->GetCMakeInstance()->IsProfilingEnabled()) {
+      profilingRAII.emplace(this->GetCMakeInstance()->GetProfilingOutput(),
+                            "target", gt->GetName());
+    }
+#endif
+
     std::unique_ptr<cmMakefileTargetGenerator> tg(
       cmMakefileTargetGenerator::New(gt));
     if (tg) {
@@ -813,7 +826,7 @@ void cmLocalUnixMakefileGenerator3::WriteSpecialTargetsBottom(
     cmake* cm = this->GlobalGenerator->GetCMakeInstance();
     if (cm->DoWriteGlobVerifyTarget()) {
       std::string rescanRule =
-        cmStrCat("$(CMAKE_COMMAND) -P ",
+        cmStrCat("$(CMAKE_COMMAND) -E cmake_verify_globs ",
                  this->ConvertToOutputFormat(cm->GetGlobVerifyScript(),
                                              cmOutputConverter::SHELL));
       commands.push_back(rescanRule);
@@ -1440,6 +1453,11 @@ bool cmLocalUnixMakefileGenerator3::UpdateDependencies(
 
     depsManager.SetVerbose(verbose);
     depsManager.SetLocalGenerator(this);
+#ifndef CMAKE_BOOTSTRAP
+    if (this->Makefile->IsOn("CMAKE_DEPENDS_USE_LOG")) {
+      depsManager.SetLogFile(cmStrCat(targetDir, "/compiler_depend.log"));
+    }
+#endif
 
     if (!depsManager.CheckDependencies(
           internalDepFile, depFiles, dependencies,
@@ -1782,7 +1800,7 @@ void cmLocalUnixMakefileGenerator3::WriteLocalAllRules(
     cmake* cm = this->GlobalGenerator->GetCMakeInstance();
     if (cm->DoWriteGlobVerifyTarget()) {
       std::string rescanRule =
-        cmStrCat("$(CMAKE_COMMAND) -P ",
+        cmStrCat("$(CMAKE_COMMAND) -E cmake_verify_globs ",
                  this->ConvertToOutputFormat(cm->GetGlobVerifyScript(),
                                              cmOutputConverter::SHELL));
       commands.push_back(rescanRule);
@@ -1873,6 +1891,12 @@ void cmLocalUnixMakefileGenerator3::WriteDependLanguageInfo(
                         : "OFF")
                   << ")\n\n";
 
+  if (this->Makefile->IsOn("CMAKE_DEPENDS_USE_LOG")) {
+    cmakefileStream << "# Record compiler generated dependencies in the "
+                       "build tree log.\n"
+                    << "set(CMAKE_DEPENDS_USE_LOG ON)\n\n";
+  }
+
   auto const& implicitLangs =
     this->GetImplicitDepends(target, cmDependencyScannerKind::CMake);
 
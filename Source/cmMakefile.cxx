@@ -63,6 +63,7 @@
 #include "cmake.h"
 
 #ifndef CMAKE_BOOTSTRAP
+#  include "cmListFileBinaryCache.h"
 #  include "cmMakefileProfilingData.h"
 #  include "cmVariableWatch.h"
 #endif
@@ -604,8 +605,7 @@ bool cmMakefile::ReadDependentFile(const std::string& filename,
   IncludeScope incScope(this, filenametoread, noPolicyScope);
 
   cmListFile listFile;
-  if (!listFile.ParseFile(filenametoread.c_str(), this->GetMessenger(),
-                          this->Backtrace)) {
+  if (!this->ParseListFile(listFile, filenametoread)) {
     return false;
   }
 
@@ -616,6 +616,20 @@ bool cmMakefile::ReadDependentFile(const std::string& filename,
   return true;
 }
 
+bool cmMakefile::ParseListFile(cmListFile& listFile,
+                               std::string const& filenametoread)
+{
+#if !defined(CMAKE_BOOTSTRAP)
+  if (cmListFileBinaryCache* cache =
+        this->GetCMakeInstance()->GetListFileCache()) {
+    return cache->ParseFile(listFile, filenametoread, this->GetMessenger(),
+                            this->Backtrace);
+  }
+#endif
+  return listFile.ParseFile(filenametoread.c_str(), this->GetMessenger(),
+                            this->Backtrace);
+}
+
 class cmMakefile::ListFileScope
 {
 public:
@@ -705,8 +719,7 @@ bool cmMakefile::ReadListFile(const std::string& filename)
   ListFileScope scope(this, filenametoread);
 
   cmListFile listFile;
-  if (!listFile.ParseFile(filenametoread.c_str(), this->GetMessenger(),
-                          this->Backtrace)) {
+  if (!this->ParseListFile(listFile, filenametoread)) {
     return false;
   }
 
@@ -742,6 +755,14 @@ void cmMakefile::RunListFile(cmListFile const& listFile,
                              std::string const& filenametoread,
                              DeferCommands* defer)
 {
+#if !defined(CMAKE_BOOTSTRAP)
+  cm::optional<cmMakefileProfilingData::RAII> profilingRAII;
+  if (this->GetCMakeInstance()->IsProfilingEnabled()) {
+    profilingRAII.emplace(this->GetCMakeInstance()->GetProfilingOutput(),
+                          "listfile", filenametoread);
+  }
+#endif
+
   // add this list file to the list of dependencies
   this->ListFiles.push_back(filenametoread);
 
@@ -1599,8 +1620,7 @@ void cmMakefile::Configure()
   this->AddDefinition("CMAKE_PARENT_LIST_FILE", currentStart);
 
   cmListFile listFile;
-  if (!listFile.ParseFile(currentStart.c_str(), this->GetMessenger(),
-                          this->Backtrace)) {
+  if (!this->ParseListFile(listFile, currentStart)) {
     return;
   }
   if (this->IsRootMakefile()) {
@@ -1083,6 +1083,8 @@ private:
                    const std::string& filenametoread,
                    DeferCommands* defer = nullptr);
 
+  bool ParseListFile(cmListFile& listFile, std::string const& filenametoread);
+
   bool ParseDefineFlag(std::string const& definition, bool remove);
 
   bool EnforceUniqueDir(const std::string& srcPath,
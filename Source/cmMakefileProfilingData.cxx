@@ -2,10 +2,14 @@
    file Copyright.txt or https://cmake.org/licensing for details.  */
 #include "cmMakefileProfilingData.h"
 
+#include <algorithm>
 #include <chrono>
+#include <iomanip>
 #include <stdexcept>
 #include <vector>
 
+#include <cmext/string_view>
+
 #include <cm3p/json/value.h>
 #include <cm3p/json/writer.h>
 
@@ -16,8 +20,31 @@
 #include "cmStringAlgorithms.h"
 #include "cmSystemTools.h"
 
+namespace {
+// Number of rows in the summary table.
+std::size_t const kSummaryRows = 50;
+
+// Folded stack files separate frames with ';' and the sample count
+// with the last space, so keep frame labels on one line without ';'.
+std::string FoldedLabel(std::string const& category, std::string const& name)
+{
+  std::string label =
+    category == "command"_s ? name : cmStrCat(category, ':', name);
+  std::replace(label.begin(), label.end(), ';', ',');
+  std::replace(label.begin(), label.end(), '\n', ' ');
+  return label;
+}
+
+double Milliseconds(std::chrono::microseconds d)
+{
+  return static_cast<double>(d.count()) / 1000.0;
+}
+}
+
 cmMakefileProfilingData::cmMakefileProfilingData(
-  const std::string& profileStream)
+  const std::string& profileStream, Format format)
+  : OutputFormat(format)
+  , OutputPath(profileStream)
 {
   std::ios::openmode omode = std::ios::out | std::ios::trunc;
   this->ProfileStream.open(profileStream.c_str(), omode);
@@ -28,14 +55,20 @@ cmMakefileProfilingData::cmMakefileProfilingData(
     throw std::runtime_error(std::string("Unable to open: ") + profileStream);
   }
 
-  this->ProfileStream << "[";
+  if (this->OutputFormat == Format::GoogleTrace) {
+    this->ProfileStream << "[";
+  }
 }
 
 cmMakefileProfilingData::~cmMakefileProfilingData() noexcept
 {
   if (this->ProfileStream.good()) {
     try {
-      this->ProfileStream << "]";
+      if (this->OutputFormat == Format::Summary) {
+        this->WriteSummary();
+      } else {
+        this->ProfileStream << "]";
+      }
       this->ProfileStream.close();
     } catch (...) {
       cmSystemTools::Error("Error writing profiling output!");
@@ -45,6 +78,41 @@ cmMakefileProfilingData::~cmMakefileProfilingData() noexcept
 
 void cmMakefileProfilingData::StartEntry(const cmListFileFunction& lff,
                                          cmListFileContext const& lfc)
+{
+  if (this->OutputFormat == Format::Summary) {
+    // Tell find_* calls apart by their first argument, which names the
+    // package or result variable.
+    std::string name = lff.LowerCaseName();
+    if (cmHasLiteralPrefix(name, "find_") && !lff.Arguments().empty()) {
+      name = cmStrCat(name, '(', lff.Arguments().front().Value, ')');
+    }
+    this->PushFrame("command", std::move(name));
+    return;
+  }
+
+  std::string args;
+  for (auto const& a : lff.Arguments()) {
+    args += (args.empty() ? "" : " ") + a.Value;
+  }
+  this->WriteTraceEntry("cmake", lff.LowerCaseName(), args,
+                        lfc.FilePath + ":" + std::to_string(lfc.Line));
+}
+
+void cmMakefileProfilingData::StartEntry(std::string const& category,
+                                         std::string const& name)
+{
+  if (this->OutputFormat == Format::Summary) {
+    this->PushFrame(category, name);
+    return;
+  }
+
+  this->WriteTraceEntry(category, name, std::string(), std::string());
+}
+
+void cmMakefileProfilingData::WriteTraceEntry(std::string const& category,
+                                              std::string const& name,
+                                              std::string const& functionArgs,
+                                              std::string const& location)
 {
   /* Do not try again if we previously failed to write to output. */
   if (!this->ProfileStream.good()) {
@@ -58,8 +126,8 @@ void cmMakefileProfilingData::StartEntry(const cmListFileFunction& lff,
     cmsys::SystemInformation info;
     Json::Value v;
     v["ph"] = "B";
-    v["name"] = lff.LowerCaseName();
-    v["cat"] = "cmake";
+    v["name"] = name;
+    v["cat"] = category;
     v["ts"] = static_cast<Json::Value::UInt64>(
       std::chrono::duration_cast<std::chrono::microseconds>(
         std::chrono::steady_clock::now().time_since_epoch())
@@ -67,15 +135,15 @@ void cmMakefileProfilingData::StartEntry(const cmListFileFunction& lff,
     v["pid"] = static_cast<int>(info.GetProcessId());
     v["tid"] = 0;
     Json::Value argsValue;
-    if (!lff.Arguments().empty()) {
-      std::string args;
-      for (auto const& a : lff.Arguments()) {
-        args += (args.empty() ? "" : " ") + a.Value;
-      }
-      argsValue["functionArgs"] = args;
+    if (!functionArgs.empty()) {
+      argsValue["functionArgs"] = functionArgs;
+    }
+    if (!location.empty()) {
+      argsValue["location"] = location;
+    }
+    if (!argsValue.isNull()) {
+      v["args"] = argsValue;
     }
-    argsValue["location"] = lfc.FilePath + ":" + std::to_string(lfc.Line);
-    v["args"] = argsValue;
 
     this->JsonWriter->write(v, &this->ProfileStream);
   } catch (std::ios_base::failure& fail) {
@@ -86,8 +154,51 @@ void cmMakefileProfilingData::StartEntry(const cmListFileFunction& lff,
   }
 }
 
+void cmMakefileProfilingData::PushFrame(std::string category,
+                                        std::string name)
+{
+  Frame frame;
+  frame.Stack = this->Frames.empty()
+    ? FoldedLabel(category, name)
+    : cmStrCat(this->Frames.back().Stack, ';', FoldedLabel(category, name));
+  frame.Category = std::move(category);
+  frame.Name = std::move(name);
+  frame.Children = Duration::zero();
+  ++this->Active[std::make_pair(frame.Category, frame.Name)];
+  frame.Start = Clock::now();
+  this->Frames.push_back(std::move(frame));
+}
+
 void cmMakefileProfilingData::StopEntry()
 {
+  if (this->OutputFormat == Format::Summary) {
+    if (this->Frames.empty()) {
+      return;
+    }
+    Frame& frame = this->Frames.back();
+    Duration const inclusive =
+      std::chrono::duration_cast<Duration>(Clock::now() - frame.Start);
+    Duration const exclusive = inclusive - frame.Children;
+
+    auto key = std::make_pair(std::move(frame.Category), std::move(frame.Name));
+    Totals& totals = this->Summary[key];
+    ++totals.Calls;
+    totals.Exclusive += exclusive;
+    // Count the inclusive time of recursive calls only once.
+    auto active = this->Active.find(key);
+    if (--active->second == 0) {
+      totals.Inclusive += inclusive;
+      this->Active.erase(active);
+    }
+    this->Folded[frame.Stack] += exclusive;
+
+    this->Frames.pop_back();
+    if (!this->Frames.empty()) {
+      this->Frames.back().Children += inclusive;
+    }
+    return;
+  }
+
   /* Do not try again if we previously failed to write to output. */
   if (!this->ProfileStream.good()) {
     return;
@@ -112,3 +223,143 @@ void cmMakefileProfilingData::StopEntry()
     cmSystemTools::Error("Error writing profiling output!");
   }
 }
+
+void cmMakefileProfilingData::AddCounters(
+  std::string const& name,
+  std::vector<std::pair<std::string, unsigned long>> const& counters)
+{
+  if (this->OutputFormat == Format::Summary) {
+    std::string line = name + ":";
+    for (auto const& counter : counters) {
+      line += cmStrCat(' ', counter.first, '=', counter.second);
+    }
+    this->Counters.push_back(std::move(line));
+    return;
+  }
+
+  /* Do not try again if we previously failed to write to output. */
+  if (!this->ProfileStream.good()) {
+    return;
+  }
+
+  try {
+    if (this->ProfileStream.tellp() > 1) {
+      this->ProfileStream << ",";
+    }
+    cmsys::SystemInformation info;
+    Json::Value v;
+    v["ph"] = "C";
+    v["name"] = name;
+    v["cat"] = "cmake";
+    v["ts"] = static_cast<Json::Value::UInt64>(
+      std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch())
+        .count());
+    v["pid"] = static_cast<int>(info.GetProcessId());
+    v["tid"] = 0;
+    Json::Value argsValue(Json::objectValue);
+    for (auto const& counter : counters) {
+      argsValue[counter.first] =
+        static_cast<Json::Value::UInt64>(counter.second);
+    }
+    v["args"] = argsValue;
+
+    this->JsonWriter->write(v, &this->ProfileStream);
+  } catch (std::ios_base::failure& fail) {
+    cmSystemTools::Error(
+      cmStrCat("Failed to write to profiling output: ", fail.what()));
+  } catch (...) {
+    cmSystemTools::Error("Error writing profiling output!");
+  }
+}
+
+void cmMakefileProfilingData::WriteSummary()
+{
+  // Close entries that are still open, e.g. after a fatal error.
+  while (!this->Frames.empty()) {
+    this->StopEntry();
+  }
+
+  using Row = std::pair<std::pair<std::string, std::string>, Totals>;
+  std::vector<Row> rows(this->Summary.begin(), this->Summary.end());
+  std::stable_sort(rows.begin(), rows.end(), [](Row const& l, Row const& r) {
+    return l.second.Exclusive > r.second.Exclusive;
+  });
+  std::size_t const shown = std::min(rows.size(), kSummaryRows);
+
+  std::ostream& os = this->ProfileStream;
+  os << "Top " << shown << " of " << rows.size()
+     << " entries by exclusive time\n\n";
+  os << std::setw(10) << "Calls" << std::setw(16) << "Inclusive ms"
+     << std::setw(16) << "Exclusive ms"
+     << "  " << std::left << std::setw(10) << "Category" << std::right
+     << "  Name\n";
+  os << std::fixed << std::setprecision(3);
+  for (std::size_t i = 0; i < shown; ++i) {
+    Row const& row = rows[i];
+    os << std::setw(10) << row.second.Calls << std::setw(16)
+       << Milliseconds(row.second.Inclusive) << std::setw(16)
+       << Milliseconds(row.second.Exclusive) << "  " << std::left
+       << std::setw(10) << row.first.first << std::right << "  "
+       << row.first.second << "\n";
+  }
+  if (!this->Counters.empty()) {
+    os << "\nCounters\n\n";
+    for (std::string const& line : this->Counters) {
+      os << "  " << line << "\n";
+    }
+  }
+
+  // Write the stacks in the folded format used by flame graph tools,
+  // one line per unique stack with its exclusive time in microseconds.
+  std::string const foldedPath = cmStrCat(this->OutputPath, ".folded");
+  cmsys::ofstream folded(foldedPath.c_str(), std::ios::out | std::ios::trunc);
+  if (!folded) {
+    cmSystemTools::Error(
+      cmStrCat("Unable to open profiling output: ", foldedPath));
+    return;
+  }
+  for (auto const& stack : this->Folded) {
+    folded << stack.first << ' ' << stack.second.count() << '\n';
+  }
+}
+
+cmMakefileProfilingData::RAII::RAII(cmMakefileProfilingData& data,
+                                    const cmListFileFunction& lff,
+                                    cmListFileContext const& lfc)
+  : Data(&data)
+{
+  this->Data->StartEntry(lff, lfc);
+}
+
+cmMakefileProfilingData::RAII::RAII(cmMakefileProfilingData& data,
+                                    std::string const& category,
+                                    std::string const& name)
+  : Data(&data)
+{
+  this->Data->StartEntry(category, name);
+}
+
+cmMakefileProfilingData::RAII::RAII(RAII&& other) noexcept
+  : Data(other.Data)
+{
+  other.Data = nullptr;
+}
+
+cmMakefileProfilingData::RAII::~RAII()
+{
+  if (this->Data) {
+    this->Data->StopEntry();
+  }
+}
+
+cmMakefileProfilingData::RAII& cmMakefileProfilingData::RAII::operator=(
+  RAII&& other) noexcept
+{
+  if (this->Data) {
+    this->Data->StopEntry();
+  }
+  this->Data = other.Data;
+  other.Data = nullptr;
+  return *this;
+}
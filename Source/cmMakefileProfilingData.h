@@ -1,8 +1,12 @@
 /* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
    file Copyright.txt or https://cmake.org/licensing for details.  */
 #pragma once
+#include <chrono>
+#include <map>
 #include <memory>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "cmsys/FStream.hxx"
 
@@ -16,12 +20,83 @@ class cmListFileFunction;
 class cmMakefileProfilingData
 {
 public:
-  cmMakefileProfilingData(const std::string&);
+  enum class Format
+  {
+    /** One Google Trace event per entry.  */
+    GoogleTrace,
+    /** Aggregated per-entry totals and folded stacks.  */
+    Summary,
+  };
+
+  cmMakefileProfilingData(const std::string&,
+                          Format format = Format::GoogleTrace);
   ~cmMakefileProfilingData() noexcept;
   void StartEntry(const cmListFileFunction& lff, cmListFileContext const& lfc);
+  void StartEntry(std::string const& category, std::string const& name);
   void StopEntry();
 
+  /** Record a set of named counter values at the current time.  */
+  void AddCounters(
+    std::string const& name,
+    std::vector<std::pair<std::string, unsigned long>> const& counters);
+
+  /** Start an entry on construction and stop it on destruction.  */
+  class RAII
+  {
+  public:
+    RAII() = delete;
+    RAII(const RAII&) = delete;
+    RAII(RAII&&) noexcept;
+
+    RAII(cmMakefileProfilingData& data, const cmListFileFunction& lff,
+         cmListFileContext const& lfc);
+    RAII(cmMakefileProfilingData& data, std::string const& category,
+         std::string const& name);
+
+    ~RAII();
+
+    RAII& operator=(const RAII&) = delete;
+    RAII& operator=(RAII&&) noexcept;
+
+  private:
+    cmMakefileProfilingData* Data = nullptr;
+  };
+
 private:
+  using Clock = std::chrono::steady_clock;
+  using Duration = std::chrono::microseconds;
+
+  struct Frame
+  {
+    std::string Category;
+    std::string Name;
+    std::string Stack;
+    Clock::time_point Start;
+    Duration Children;
+  };
+
+  struct Totals
+  {
+    unsigned long Calls = 0;
+    Duration Inclusive = Duration::zero();
+    Duration Exclusive = Duration::zero();
+  };
+
+  void WriteTraceEntry(std::string const& category, std::string const& name,
+                       std::string const& functionArgs,
+                       std::string const& location);
+  void PushFrame(std::string category, std::string name);
+  void WriteSummary();
+
+  Format OutputFormat;
+  std::string OutputPath;
   cmsys::ofstream ProfileStream;
   std::unique_ptr<Json::StreamWriter> JsonWriter;
+
+  // State for the summary format.
+  std::vector<Frame> Frames;
+  std::map<std::pair<std::string, std::string>, Totals> Summary;
+  std::map<std::pair<std::string, std::string>, unsigned int> Active;
+  std::map<std::string, Duration> Folded;
+  std::vector<std::string> Counters;
 };
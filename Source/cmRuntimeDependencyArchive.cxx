@@ -29,6 +29,7 @@
 #include <vector>
 
 #include <cm/memory>
+#include <cmext/algorithm>
 
 #if defined(_WIN32)
 static void AddVisualStudioPath(std::vector<std::string>& paths,
@@ -177,6 +178,11 @@ bool cmRuntimeDependencyArchive::GetRuntimeDependencies(
   const std::vector<std::string>& libraries,
   const std::vector<std::string>& modules)
 {
+  std::vector<std::string> files = executables;
+  cm::append(files, libraries);
+  cm::append(files, modules);
+  this->Linker->PrefetchFiles(files);
+
   for (auto const& exe : executables) {
     if (!this->Linker->ScanDependencies(exe, cmStateEnums::EXECUTABLE)) {
       return false;
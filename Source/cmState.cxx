@@ -238,12 +238,14 @@ bool cmState::SaveVerificationScript(const std::string& path,
 void cmState::AddGlobCacheEntry(
   bool recurse, bool listDirectories, bool followSymlinks,
   const std::string& relative, const std::string& expression,
-  const std::vector<std::string>& files, const std::string& variable,
-  cmListFileBacktrace const& backtrace, cmMessenger* messenger)
+  const std::vector<std::string>& files,
+  std::map<std::string, cmDirectoryListingCache::Stamp> const& directories,
+  const std::string& variable, cmListFileBacktrace const& backtrace,
+  cmMessenger* messenger)
 {
   this->GlobVerificationManager->AddCacheEntry(
     recurse, listDirectories, followSymlinks, relative, expression, files,
-    variable, backtrace, messenger);
+    directories, variable, backtrace, messenger);
 }
 
 void cmState::RemoveCacheEntry(std::string const& key)
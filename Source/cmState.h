@@ -5,6 +5,7 @@
 #include "cmConfigure.h" // IWYU pragma: keep
 
 #include <functional>
+#include <map>
 #include <memory>
 #include <set>
 #include <string>
@@ -18,6 +19,7 @@
 
 #include "cmDefinitions.h"
 #include "cmDependencyProvider.h"
+#include "cmDirectoryListingCache.h"
 #include "cmLinkedTree.h"
 #include "cmPolicies.h"
 #include "cmProperty.h"
@@ -272,13 +274,13 @@ private:
   std::string const& GetGlobVerifyScript() const;
   std::string const& GetGlobVerifyStamp() const;
   bool SaveVerificationScript(const std::string& path, cmMessenger* messenger);
-  void AddGlobCacheEntry(bool recurse, bool listDirectories,
-                         bool followSymlinks, const std::string& relative,
-                         const std::string& expression,
-                         const std::vector<std::string>& files,
-                         const std::string& variable,
-                         cmListFileBacktrace const& bt,
-                         cmMessenger* messenger);
+  void AddGlobCacheEntry(
+    bool recurse, bool listDirectories, bool followSymlinks,
+    const std::string& relative, const std::string& expression,
+    const std::vector<std::string>& files,
+    std::map<std::string, cmDirectoryListingCache::Stamp> const& directories,
+    const std::string& variable, cmListFileBacktrace const& bt,
+    cmMessenger* messenger);
 
   cmPropertyDefinitionMap PropertyDefinitions;
   std::vector<std::string> EnabledLanguages;
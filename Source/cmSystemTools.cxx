@@ -28,6 +28,15 @@
 #include "cmValue.h"
 
 #if !defined(CMAKE_BOOTSTRAP)
+#  include <condition_variable>
+#  include <deque>
+#  include <memory>
+#  include <mutex>
+#  include <set>
+#  include <thread>
+
+#  include <cm/memory>
+
 #  include <cm3p/archive.h>
 #  include <cm3p/archive_entry.h>
 
@@ -67,6 +76,7 @@
 #include <functional>
 #include <iostream>
 #include <sstream>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -107,6 +117,11 @@
 #  include <sys/utsname.h>
 #endif
 
+#ifdef __linux
+#  include <sys/stat.h>
+#  include <sys/syscall.h>
+#endif
+
 namespace {
 
 cmSystemTools::InterruptCallback s_InterruptCallback;
@@ -981,6 +996,61 @@ bool cmMoveFile(std::wstring const& oldname, std::wstring const& newname,
 }
 #endif
 
+namespace {
+// Copy the content of a regular file with copy_file_range so that it
+// does not pass through user space.  Fail for sources that report no
+// size, such as those in /proc, so they are copied blockwise.
+cmsys::Status CopyFileContentInKernel(std::string const& source,
+                                      std::string const& destination)
+{
+#if defined(__linux) && defined(__NR_copy_file_range)
+  int in = open(source.c_str(), O_RDONLY);
+  if (in < 0) {
+    return cmsys::Status::POSIX_errno();
+  }
+  struct stat st;
+  if (fstat(in, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size == 0) {
+    close(in);
+    return cmsys::Status::POSIX(EINVAL);
+  }
+
+  cmSystemTools::RemoveFile(destination);
+  int out = open(destination.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0666);
+  if (out < 0) {
+    cmsys::Status status = cmsys::Status::POSIX_errno();
+    close(in);
+    return status;
+  }
+
+  cmsys::Status status;
+  off_t left = st.st_size;
+  while (left > 0) {
+    long n = syscall(__NR_copy_file_range, in, nullptr, out, nullptr,
+                     static_cast<size_t>(left), 0u);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      // The source shrank or the kernel cannot copy between these files.
+      status = n < 0 ? cmsys::Status::POSIX_errno()
+                     : cmsys::Status::POSIX(EIO);
+      break;
+    }
+    left -= static_cast<off_t>(n);
+  }
+  close(in);
+  if (close(out) != 0 && status) {
+    status = cmsys::Status::POSIX_errno();
+  }
+  return status;
+#else
+  static_cast<void>(source);
+  static_cast<void>(destination);
+  return cmsys::Status::POSIX(ENOSYS);
+#endif
+}
+}
+
 bool cmSystemTools::CopySingleFile(const std::string& oldname,
                                    const std::string& newname)
 {
@@ -1013,7 +1083,11 @@ cmSystemTools::CopyResult cmSystemTools::CopySingleFile(
   cmsys::Status status;
   status = cmsys::SystemTools::CloneFileContent(oldname, newname);
   if (!status) {
-    // if cloning did not succeed, fall back to blockwise copy
+    // if cloning did not succeed, copy within the kernel
+    status = CopyFileContentInKernel(oldname, newname);
+  }
+  if (!status) {
+    // if that did not succeed either, fall back to blockwise copy
     status = cmsys::SystemTools::CopyFileContentBlockwise(oldname, newname);
   }
   if (!status) {
@@ -1617,8 +1691,17 @@ bool cmSystemTools::CreateTar(const std::string& outFileName,
       break;
   }
 
+  // Compress gzip and read the files ahead on all cores.  The gzip stream
+  // is the same for any number of threads above one, so the archive does
+  // not depend on the machine.  The other filters would split their
+  // output differently with threads, so they keep a single one.
+  int threads = 1;
+  if (compress == cmArchiveWrite::CompressGZip) {
+    threads =
+      std::max(2, static_cast<int>(std::thread::hardware_concurrency()));
+  }
   cmArchiveWrite a(fout, compress, format.empty() ? "paxr" : format,
-                   compressionLevel);
+                   compressionLevel, threads);
 
   if (!a.Open()) {
     cmSystemTools::Error(a.GetError());
@@ -1637,6 +1720,10 @@ bool cmSystemTools::CreateTar(const std::string& outFileName,
       tarCreatedSuccessfully = false;
     }
   }
+  if (tarCreatedSuccessfully && !a.Close()) {
+    cmSystemTools::Error(a.GetError());
+    tarCreatedSuccessfully = false;
+  }
   return tarCreatedSuccessfully;
 #else
   (void)outFileName;
@@ -1819,6 +1906,221 @@ bool copy_data(struct archive* ar, struct archive* aw)
 #  endif
 }
 
+// Write small regular files extracted from an archive on other threads,
+// each with its own disk writer, while the archive is decompressed.  The
+// caller writes everything else in archive order, after waiting for the
+// files written here when an entry may refer to them.
+class ParallelDiskWriter
+{
+public:
+  ParallelDiskWriter(int flags, unsigned int threads);
+  ~ParallelDiskWriter();
+  ParallelDiskWriter(const ParallelDiskWriter&) = delete;
+  ParallelDiskWriter& operator=(const ParallelDiskWriter&) = delete;
+
+  // Every disk writer queries the umask by setting it while writing a
+  // header, so headers must be written by one thread at a time.
+  std::mutex& GetHeaderMutex() { return this->HeaderMutex; }
+
+  bool CanWrite(struct archive_entry* entry);
+  // Whether writing the entry may change the working directory, which
+  // the files written on other threads are opened relative to.
+  static bool MayChangeDirectory(struct archive_entry* entry);
+  bool IsPending(std::string const& path);
+  // Queue a file to be written.  Return false if writing any file failed.
+  bool Write(struct archive_entry* entry, std::string content);
+
+  // Wait for all files to be written and report any error.
+  bool Wait();
+
+private:
+  struct File
+  {
+    struct archive_entry* Entry;
+    std::string Path;
+    std::string Content;
+  };
+
+  static size_t const MaxFileSize = 1024 * 1024;
+  static size_t const MaxPending = 64;
+
+  void Work(struct archive* disk);
+  bool WriteFile(struct archive* disk, File& file, std::string& error);
+
+  std::vector<struct archive*> Disks;
+  std::vector<std::thread> Threads;
+  std::mutex HeaderMutex;
+  std::mutex Mutex;
+  std::condition_variable Queued;
+  std::condition_variable Written;
+  std::deque<File> Queue;
+  std::set<std::string> Pending;
+  std::vector<std::string> Errors;
+  bool Stop = false;
+};
+
+ParallelDiskWriter::ParallelDiskWriter(int flags, unsigned int threads)
+{
+  // Create the disk writers here because creating one sets the umask.
+  for (unsigned int i = 0; i < threads; ++i) {
+    struct archive* disk = archive_write_disk_new();
+    archive_write_disk_set_options(disk, flags);
+    this->Disks.push_back(disk);
+  }
+  for (struct archive* disk : this->Disks) {
+    this->Threads.emplace_back(&ParallelDiskWriter::Work, this, disk);
+  }
+}
+
+ParallelDiskWriter::~ParallelDiskWriter()
+{
+  {
+    std::lock_guard<std::mutex> lock(this->Mutex);
+    this->Stop = true;
+  }
+  this->Queued.notify_all();
+  for (std::thread& thread : this->Threads) {
+    thread.join();
+  }
+  for (File& file : this->Queue) {
+    archive_entry_free(file.Entry);
+  }
+  for (struct archive* disk : this->Disks) {
+    archive_write_free(disk);
+  }
+}
+
+bool ParallelDiskWriter::CanWrite(struct archive_entry* entry)
+{
+  return archive_entry_filetype(entry) == AE_IFREG &&
+    !archive_entry_hardlink(entry) && archive_entry_size_is_set(entry) &&
+    archive_entry_size(entry) >= 0 &&
+    static_cast<size_t>(archive_entry_size(entry)) <= MaxFileSize &&
+    archive_entry_sparse_count(entry) == 0 &&
+    !MayChangeDirectory(entry) &&
+    !this->IsPending(cm_archive_entry_pathname(entry));
+}
+
+bool ParallelDiskWriter::MayChangeDirectory(struct archive_entry* entry)
+{
+  // The disk writer changes into a parent directory to shorten paths
+  // longer than PATH_MAX, which is at least this long where it does.
+  return cm_archive_entry_pathname(entry).size() >= 512;
+}
+
+bool ParallelDiskWriter::IsPending(std::string const& path)
+{
+  std::lock_guard<std::mutex> lock(this->Mutex);
+  return this->Pending.count(path) != 0;
+}
+
+bool ParallelDiskWriter::Write(struct archive_entry* entry,
+                               std::string content)
+{
+  File file{ archive_entry_clone(entry), cm_archive_entry_pathname(entry),
+             std::move(content) };
+  {
+    std::unique_lock<std::mutex> lock(this->Mutex);
+    this->Written.wait(
+      lock, [this] { return this->Pending.size() < MaxPending; });
+    if (!this->Errors.empty()) {
+      archive_entry_free(file.Entry);
+      return false;
+    }
+    this->Pending.insert(file.Path);
+    this->Queue.push_back(std::move(file));
+  }
+  this->Queued.notify_one();
+  return true;
+}
+
+bool ParallelDiskWriter::Wait()
+{
+  std::vector<std::string> errors;
+  {
+    std::unique_lock<std::mutex> lock(this->Mutex);
+    this->Written.wait(lock, [this] { return this->Pending.empty(); });
+    errors.swap(this->Errors);
+  }
+  for (std::string const& error : errors) {
+    cmSystemTools::Error(error);
+  }
+  return errors.empty();
+}
+
+void ParallelDiskWriter::Work(struct archive* disk)
+{
+  std::unique_lock<std::mutex> lock(this->Mutex);
+  for (;;) {
+    this->Queued.wait(lock,
+                      [this] { return this->Stop || !this->Queue.empty(); });
+    if (this->Stop) {
+      break;
+    }
+    File file = std::move(this->Queue.front());
+    this->Queue.pop_front();
+    lock.unlock();
+    std::string error;
+    bool const written = this->WriteFile(disk, file, error);
+    archive_entry_free(file.Entry);
+    lock.lock();
+    if (!written) {
+      this->Errors.push_back(std::move(error));
+    }
+    this->Pending.erase(file.Path);
+    this->Written.notify_all();
+  }
+}
+
+bool ParallelDiskWriter::WriteFile(struct archive* disk, File& file,
+                                   std::string& error)
+{
+  int r;
+  {
+    std::lock_guard<std::mutex> lock(this->HeaderMutex);
+    r = archive_write_header(disk, file.Entry);
+  }
+  if (r != ARCHIVE_OK) {
+    const char* e = archive_error_string(disk);
+    error = cmStrCat("Problem with archive_write_header(): ", e ? e : "",
+                     "\nCurrent file: ", file.Path);
+    return false;
+  }
+  if (!file.Content.empty() &&
+      archive_write_data(disk, file.Content.data(), file.Content.size()) <
+        0) {
+    const char* e = archive_error_string(disk);
+    error = cmStrCat("cmake -E tar: error: ", e ? e : "unknown error");
+    return false;
+  }
+  if (archive_write_finish_entry(disk) != ARCHIVE_OK) {
+    const char* e = archive_error_string(disk);
+    error =
+      cmStrCat("Problem with archive_write_finish_entry(): ", e ? e : "");
+    return false;
+  }
+  return true;
+}
+
+// Return 'true' on success
+bool read_data(struct archive* ar, size_t size, std::string& content)
+{
+  content.resize(size);
+  size_t have = 0;
+  while (have < size) {
+    __LA_SSIZE_T const r = archive_read_data(ar, &content[have], size - have);
+    if (r < 0 && !la_diagnostic(ar, r)) {
+      return false;
+    }
+    if (r <= 0) {
+      break;
+    }
+    have += static_cast<size_t>(r);
+  }
+  content.resize(have);
+  return true;
+}
+
 bool extract_tar(const std::string& outFileName,
                  const std::vector<std::string>& files, bool verbose,
                  cmSystemTools::cmTarExtractTimestamps extractTimestamps,
@@ -1853,6 +2155,22 @@ bool extract_tar(const std::string& outFileName,
     archive_read_close(a);
     return false;
   }
+
+  // Overlap writing files to disk with reading large archives.  Starting
+  // the threads costs more than it saves for small ones.
+  std::unique_ptr<ParallelDiskWriter> writer;
+  unsigned int const threads =
+    std::min(std::thread::hardware_concurrency(), 16u);
+  if (extract && threads > 1 &&
+      cmSystemTools::FileLength(outFileName) >= 4 * 1024 * 1024) {
+    int const flags =
+      extractTimestamps == cmSystemTools::cmTarExtractTimestamps::Yes
+      ? ARCHIVE_EXTRACT_TIME
+      : 0;
+    writer = cm::make_unique<ParallelDiskWriter>(flags, threads);
+  }
+  bool writeFailed = false;
+
   for (;;) {
     r = archive_read_next_header(a, &entry);
     if (r == ARCHIVE_EOF) {
@@ -1888,7 +2206,35 @@ bool extract_tar(const std::string& outFileName,
         }
       }
 
-      r = archive_write_header(ext, entry);
+      if (writer && writer->CanWrite(entry)) {
+        std::string content;
+        if (!read_data(a, static_cast<size_t>(archive_entry_size(entry)),
+                       content)) {
+          break;
+        }
+        if (!writer->Write(entry, std::move(content))) {
+          writeFailed = true;
+          break;
+        }
+        continue;
+      }
+      // Links may refer to files still being written, and the files
+      // being written must not see the working directory change.
+      if (writer &&
+          (archive_entry_hardlink(entry) ||
+           ParallelDiskWriter::MayChangeDirectory(entry) ||
+           writer->IsPending(cm_archive_entry_pathname(entry))) &&
+          !writer->Wait()) {
+        writeFailed = true;
+        break;
+      }
+
+      if (writer) {
+        std::lock_guard<std::mutex> lock(writer->GetHeaderMutex());
+        r = archive_write_header(ext, entry);
+      } else {
+        r = archive_write_header(ext, entry);
+      }
       if (r == ARCHIVE_OK) {
         if (!copy_data(a, ext)) {
           break;
@@ -1915,6 +2261,13 @@ bool extract_tar(const std::string& outFileName,
     }
   }
 
+  if (writer) {
+    if (!writer->Wait()) {
+      writeFailed = true;
+    }
+    writer.reset();
+  }
+
   bool error_occured = false;
   if (matching != nullptr) {
     const char* p;
@@ -1938,7 +2291,7 @@ bool extract_tar(const std::string& outFileName,
   archive_write_free(ext);
   archive_read_close(a);
   archive_read_free(a);
-  return r == ARCHIVE_EOF || r == ARCHIVE_OK;
+  return !writeFailed && (r == ARCHIVE_EOF || r == ARCHIVE_OK);
 }
 }
 #endif
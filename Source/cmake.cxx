@@ -64,8 +64,10 @@
 
 #  include <cm3p/json/writer.h>
 
+#  include "cmConfigureInputs.h"
 #  include "cmFileAPI.h"
 #  include "cmGraphVizWriter.h"
+#  include "cmListFileBinaryCache.h"
 #  include "cmVariableWatch.h"
 #endif
 
@@ -1121,6 +1123,23 @@ void cmake::SetArgs(const std::vector<std::string>& args)
       cmSystemTools::ConvertToUnixSlashes(profilingOutput);
       return true;
     });
+  arguments.emplace_back(
+    "--listfile-cache", CommandArgument::Values::ZeroOrOne,
+    [](std::string const& value, cmake* state) -> bool {
+      cmListFileBinaryCache::Mode mode;
+      if (value.empty() || value == "on"_s) {
+        mode = cmListFileBinaryCache::Mode::On;
+      } else if (value == "validate"_s) {
+        mode = cmListFileBinaryCache::Mode::Validate;
+      } else {
+        cmSystemTools::Error(
+          cmStrCat("Invalid value specified for --listfile-cache: ", value,
+                   "\nValid values are on or validate."));
+        return false;
+      }
+      state->ListFileCache = cm::make_unique<cmListFileBinaryCache>(mode);
+      return true;
+    });
   arguments.emplace_back("--preset", "No preset specified for --preset",
                          CommandArgument::Values::One,
                          [&](std::string const& value, cmake*) -> bool {
@@ -1240,10 +1259,14 @@ void cmake::SetArgs(const std::vector<std::string>& args)
         "--profiling-format specified but no --profiling-output!");
       return;
     }
-    if (profilingFormat == "google-trace"_s) {
+    if (profilingFormat == "google-trace"_s ||
+        profilingFormat == "summary"_s) {
       try {
-        this->ProfilingOutput =
-          cm::make_unique<cmMakefileProfilingData>(profilingOutput);
+        this->ProfilingOutput = cm::make_unique<cmMakefileProfilingData>(
+          profilingOutput,
+          profilingFormat == "summary"_s
+            ? cmMakefileProfilingData::Format::Summary
+            : cmMakefileProfilingData::Format::GoogleTrace);
       } catch (std::runtime_error& e) {
         cmSystemTools::Error(
           cmStrCat("Could not start profiling: ", e.what()));
@@ -2245,10 +2268,34 @@ int cmake::ActualConfigure()
 #if !defined(CMAKE_BOOTSTRAP)
   this->FileAPI = cm::make_unique<cmFileAPI>(this);
   this->FileAPI->ReadQueries();
+
+  if (this->ListFileCache) {
+    this->ListFileCache->Load(cmStrCat(this->GetHomeOutputDirectory(),
+                                       "/CMakeFiles/ListFileCache.bin"));
+  }
 #endif
 
   // actually do the configure
-  this->GlobalGenerator->Configure();
+  {
+#if !defined(CMAKE_BOOTSTRAP)
+    cm::optional<cmMakefileProfilingData::RAII> profilingRAII;
+    if (this->IsProfilingEnabled()) {
+      profilingRAII.emplace(*this->ProfilingOutput, "phase", "configure");
+    }
+#endif
+    this->GlobalGenerator->Configure();
+  }
+
+#if !defined(CMAKE_BOOTSTRAP)
+  if (this->ListFileCache) {
+    if (!this->ListFileCache->Save()) {
+      this->IssueMessage(MessageType::WARNING,
+                         cmStrCat("Unable to write list file cache:\n  ",
+                                  this->ListFileCache->GetCacheFile()));
+    }
+    this->UpdateProgress(this->ListFileCache->GetStatisticsReport(), -1);
+  }
+#endif
   // Before saving the cache
   // if the project did not define one of the entries below, add them now
   // so users can edit the values in the cache:
@@ -2521,10 +2568,26 @@ int cmake::Generate()
   if (!this->GlobalGenerator) {
     return -1;
   }
-  if (!this->GlobalGenerator->Compute()) {
-    return -1;
+  {
+#if !defined(CMAKE_BOOTSTRAP)
+    cm::optional<cmMakefileProfilingData::RAII> profilingRAII;
+    if (this->IsProfilingEnabled()) {
+      profilingRAII.emplace(*this->ProfilingOutput, "phase", "compute");
+    }
+#endif
+    if (!this->GlobalGenerator->Compute()) {
+      return -1;
+    }
+  }
+  {
+#if !defined(CMAKE_BOOTSTRAP)
+    cm::optional<cmMakefileProfilingData::RAII> profilingRAII;
+    if (this->IsProfilingEnabled()) {
+      profilingRAII.emplace(*this->ProfilingOutput, "phase", "generate");
+    }
+#endif
+    this->GlobalGenerator->Generate();
   }
-  this->GlobalGenerator->Generate();
   if (!this->GraphVizFile.empty()) {
     std::cout << "Generate graphviz: " << this->GraphVizFile << std::endl;
     this->GenerateGraphViz(this->GraphVizFile);
@@ -2542,6 +2605,29 @@ int cmake::Generate()
 
 #if !defined(CMAKE_BOOTSTRAP)
   this->FileAPI->WriteReplies();
+
+  // Record the inputs of each directory for incremental re-runs.
+  std::string const inputsFile = cmStrCat(this->GetHomeOutputDirectory(),
+                                          "/CMakeFiles/ConfigureInputs.txt");
+  if (this->State->GetInitializedCacheValue("CMAKE_INCREMENTAL_CONFIGURE")
+        .IsOn()) {
+    cmConfigureInputs inputs;
+    inputs.Collect(this->GlobalGenerator.get());
+    inputs.AddInput(
+      cmStrCat(this->GetHomeOutputDirectory(), "/CMakeCache.txt"), true);
+    if (this->DoWriteGlobVerifyTarget()) {
+      inputs.AddInput(this->GetGlobVerifyScript(), true);
+      // The stamp is touched to request a re-run.
+      inputs.AddInput(this->GetGlobVerifyStamp(), false);
+    }
+    if (!inputs.Save(inputsFile)) {
+      this->IssueMessage(
+        MessageType::WARNING,
+        cmStrCat("Unable to write configure inputs:\n  ", inputsFile));
+    }
+  } else {
+    cmSystemTools::RemoveFile(inputsFile);
+  }
 #endif
 
   return 0;
@@ -2580,16 +2666,16 @@ std::string const& cmake::GetGlobVerifyStamp() const
   return this->State->GetGlobVerifyStamp();
 }
 
-void cmake::AddGlobCacheEntry(bool recurse, bool listDirectories,
-                              bool followSymlinks, const std::string& relative,
-                              const std::string& expression,
-                              const std::vector<std::string>& files,
-                              const std::string& variable,
-                              cmListFileBacktrace const& backtrace)
+void cmake::AddGlobCacheEntry(
+  bool recurse, bool listDirectories, bool followSymlinks,
+  const std::string& relative, const std::string& expression,
+  const std::vector<std::string>& files,
+  std::map<std::string, cmDirectoryListingCache::Stamp> const& directories,
+  const std::string& variable, cmListFileBacktrace const& backtrace)
 {
   this->State->AddGlobCacheEntry(recurse, listDirectories, followSymlinks,
-                                 relative, expression, files, variable,
-                                 backtrace, this->Messenger.get());
+                                 relative, expression, files, directories,
+                                 variable, backtrace, this->Messenger.get());
 }
 
 std::vector<std::string> cmake::GetAllExtensions() const
@@ -2991,6 +3077,42 @@ int cmake::CheckBuildSystem()
     int result = 0;
     if (!this->FileTimeCache->Compare(out_oldest, dep_newest, &result) ||
         result < 0) {
+#if !defined(CMAKE_BOOTSTRAP)
+      // With incremental configure, dependencies that were only touched
+      // do not require a re-run.
+      std::string const inputsFile = cmStrCat(
+        this->GetHomeOutputDirectory(), "/CMakeFiles/ConfigureInputs.txt");
+      cmConfigureInputs inputs;
+      if (inputs.Load(inputsFile)) {
+        std::vector<std::string> fullDepends;
+        fullDepends.reserve(depends.size());
+        for (std::string const& d : depends) {
+          fullDepends.push_back(cmSystemTools::CollapseFullPath(
+            d, this->GetHomeOutputDirectory()));
+        }
+        std::vector<std::string> dirty;
+        std::string reason;
+        if (inputs.Check(fullDepends, dirty, reason)) {
+          if (inputs.IsModified()) {
+            inputs.Save(inputsFile);
+          }
+          if (verbose) {
+            cmSystemTools::Stdout(
+              "Skip re-run cmake: configure inputs are unchanged\n");
+          }
+          return 0;
+        }
+        if (verbose) {
+          std::ostringstream msg;
+          msg << "Re-run cmake " << reason << "\n";
+          for (std::string const& d : dirty) {
+            msg << "  changed directory: " << d << "\n";
+          }
+          cmSystemTools::Stdout(msg.str());
+        }
+        return 1;
+      }
+#endif
       if (verbose) {
         std::ostringstream msg;
         msg << "Re-run cmake file: " << out_oldest
@@ -17,6 +17,7 @@
 
 #include <cm/string_view>
 
+#include "cmDirectoryListingCache.h"
 #include "cmGeneratedFileStream.h"
 #include "cmInstalledFile.h"
 #include "cmListFileCache.h"
@@ -41,6 +42,7 @@ class cmGlobalGenerator;
 class cmGlobalGeneratorFactory;
 class cmMakefile;
 #if !defined(CMAKE_BOOTSTRAP)
+class cmListFileBinaryCache;
 class cmMakefileProfilingData;
 #endif
 class cmMessenger;
@@ -366,12 +368,12 @@ public:
   bool DoWriteGlobVerifyTarget() const;
   std::string const& GetGlobVerifyScript() const;
   std::string const& GetGlobVerifyStamp() const;
-  void AddGlobCacheEntry(bool recurse, bool listDirectories,
-                         bool followSymlinks, const std::string& relative,
-                         const std::string& expression,
-                         const std::vector<std::string>& files,
-                         const std::string& variable,
-                         cmListFileBacktrace const& bt);
+  void AddGlobCacheEntry(
+    bool recurse, bool listDirectories, bool followSymlinks,
+    const std::string& relative, const std::string& expression,
+    const std::vector<std::string>& files,
+    std::map<std::string, cmDirectoryListingCache::Stamp> const& directories,
+    const std::string& variable, cmListFileBacktrace const& bt);
 
   /**
    * Get the system information and write it to the file specified
@@ -627,6 +629,12 @@ public:
 #if !defined(CMAKE_BOOTSTRAP)
   cmMakefileProfilingData& GetProfilingOutput();
   bool IsProfilingEnabled() const;
+
+  //! Return the persistent list file cache, or nullptr if not enabled.
+  cmListFileBinaryCache* GetListFileCache() const
+  {
+    return this->ListFileCache.get();
+  }
 #endif
 
 protected:
@@ -753,6 +761,7 @@ private:
 
 #if !defined(CMAKE_BOOTSTRAP)
   std::unique_ptr<cmMakefileProfilingData> ProfilingOutput;
+  std::unique_ptr<cmListFileBinaryCache> ListFileCache;
 #endif
 };
 
@@ -9,6 +9,7 @@
 
 #include "cmConsoleBuf.h"
 #include "cmDuration.h"
+#include "cmGlobVerificationManager.h"
 #include "cmGlobalGenerator.h"
 #include "cmLocalGenerator.h"
 #include "cmMakefile.h"
@@ -58,6 +59,13 @@
 #ifdef _WIN32
 #  include <fcntl.h> // for _O_BINARY
 #  include <io.h>    // for _setmode
+#elif !defined(CMAKE_BOOTSTRAP)
+#  include <cerrno>
+#  include <csignal>
+
+#  include <sys/resource.h>
+#  include <sys/wait.h>
+#  include <unistd.h>
 #endif
 
 #include <cm/string_view>
@@ -521,6 +529,98 @@ struct CoCompileJob
   std::string Command;
   CoCompileHandler Handler;
 };
+
+#if !defined(CMAKE_BOOTSTRAP) && !defined(_WIN32)
+// Run a command, wait for it, and write the resources it used to
+// descriptor 3.  ctest runs its tests through this because its event
+// loop reaps them without their resource usage.  Exit like the command.
+int RunWithResourceUsage(std::vector<std::string> const& args)
+{
+  int const usageFd = 3;
+  auto report = [&](std::string const& line) {
+    ssize_t const n = write(usageFd, line.data(), line.size());
+    static_cast<void>(n);
+  };
+
+  std::vector<char*> argv;
+  for (std::string const& arg : cmMakeRange(args).advance(2)) {
+    argv.push_back(const_cast<char*>(arg.c_str()));
+  }
+  argv.push_back(nullptr);
+
+  // A pipe closed on exec tells whether the command could be executed.
+  int execPipe[2];
+  if (pipe(execPipe) != 0) {
+    return 1;
+  }
+  fcntl(execPipe[0], F_SETFD, FD_CLOEXEC);
+  fcntl(execPipe[1], F_SETFD, FD_CLOEXEC);
+  // The command must not write to the report itself.
+  fcntl(usageFd, F_SETFD, FD_CLOEXEC);
+
+  pid_t const pid = fork();
+  if (pid < 0) {
+    return 1;
+  }
+  if (pid == 0) {
+    close(execPipe[0]);
+    execvp(argv[0], argv.data());
+    int const error = errno;
+    ssize_t const n = write(execPipe[1], &error, sizeof(error));
+    static_cast<void>(n);
+    _exit(127);
+  }
+  close(execPipe[1]);
+
+  // Terminal interrupts reach the command too.  Wait to see how it ends.
+  signal(SIGINT, SIG_IGN);
+  signal(SIGQUIT, SIG_IGN);
+
+  int execError = 0;
+  ssize_t n;
+  do {
+    n = read(execPipe[0], &execError, sizeof(execError));
+  } while (n < 0 && errno == EINTR);
+  close(execPipe[0]);
+
+  int status = 0;
+  struct rusage usage;
+  pid_t r;
+  do {
+    r = wait4(pid, &status, 0, &usage);
+  } while (r < 0 && errno == EINTR);
+
+  if (n == sizeof(execError)) {
+    report(cmStrCat("error ", execError, '\n'));
+    return 127;
+  }
+  if (r < 0) {
+    return 1;
+  }
+
+  long maxrss = usage.ru_maxrss;
+#  if defined(__APPLE__)
+  // The peak resident set size is given in bytes.
+  maxrss /= 1024;
+#  endif
+  report(cmStrCat("usage ", usage.ru_utime.tv_sec, ' ',
+                  usage.ru_utime.tv_usec, ' ', usage.ru_stime.tv_sec, ' ',
+                  usage.ru_stime.tv_usec, ' ', maxrss, ' ', usage.ru_minflt,
+                  ' ', usage.ru_majflt, ' ', usage.ru_inblock, ' ',
+                  usage.ru_oublock, ' ', usage.ru_nvcsw, ' ',
+                  usage.ru_nivcsw, '\n'));
+
+  if (WIFSIGNALED(status)) {
+    // End with the same signal, without a core dump of our own.
+    int const sig = WTERMSIG(status);
+    struct rlimit core = { 0, 0 };
+    setrlimit(RLIMIT_CORE, &core);
+    signal(sig, SIG_DFL);
+    raise(sig);
+  }
+  return WIFEXITED(status) ? WEXITSTATUS(status) : 1;
+}
+#endif
 }
 
 // called when args[0] == "__run_co_compile"
@@ -1301,6 +1401,28 @@ int cmcmd::ExecuteCMakeCommand(std::vector<std::string> const& args,
     }
 #endif
 
+    // Internal CMake glob verification support.
+    if (args[1] == "cmake_verify_globs" && args.size() == 3) {
+      if (cmGlobVerificationManager::CheckVerificationState(args[2])) {
+        return 0;
+      }
+      // Without a usable state run the script itself.
+      int ret = 0;
+      if (!cmSystemTools::RunSingleCommand(
+            { cmSystemTools::GetCMakeCommand(), "-P", args[2] }, nullptr,
+            nullptr, &ret, nullptr, cmSystemTools::OUTPUT_PASSTHROUGH)) {
+        return 1;
+      }
+      return ret;
+    }
+
+#if !defined(CMAKE_BOOTSTRAP) && !defined(_WIN32)
+    // Internal ctest support for the resources used by tests.
+    if (args[1] == "cmake_resource_usage" && args.size() >= 3) {
+      return RunWithResourceUsage(args);
+    }
+#endif
+
     // Internal CMake link script support.
     if (args[1] == "cmake_link_script" && args.size() >= 3) {
       return cmcmd::ExecuteLinkScript(args);
@@ -1593,24 +1715,38 @@ int cmcmd::HashSumFile(std::vector<std::string> const& args,
   }
   int retval = 0;
 
+  // Hash all files together, then report in order.
+  std::vector<std::string> files;
+  std::vector<bool> isDirectory;
   for (auto const& filename : cmMakeRange(args).advance(2)) {
     // Cannot compute sum of a directory
-    if (cmSystemTools::FileIsDirectory(filename)) {
+    isDirectory.push_back(cmSystemTools::FileIsDirectory(filename));
+    if (!isDirectory.back()) {
+      files.push_back(filename);
+    }
+  }
+#ifndef CMAKE_BOOTSTRAP
+  std::vector<std::string> const values = cmCryptoHash::HashFiles(algo, files);
+#else
+  static_cast<void>(algo);
+  std::vector<std::string> const values(files.size());
+#endif
+
+  std::size_t next = 0;
+  for (std::size_t i = 0; i < isDirectory.size(); ++i) {
+    std::string const& filename = args[i + 2];
+    if (isDirectory[i]) {
       std::cerr << "Error: " << filename << " is a directory" << std::endl;
       retval++;
+      continue;
+    }
+    std::string const& value = values[next++];
+    if (value.empty()) {
+      // To mimic "md5sum/shasum" behavior in a shell:
+      std::cerr << filename << ": No such file or directory" << std::endl;
+      retval++;
     } else {
-      std::string value
-#ifndef CMAKE_BOOTSTRAP
-        = cmSystemTools::ComputeFileHash(filename, algo)
-#endif
-        ;
-      if (value.empty()) {
-        // To mimic "md5sum/shasum" behavior in a shell:
-        std::cerr << filename << ": No such file or directory" << std::endl;
-        retval++;
-      } else {
-        std::cout << value << "  " << filename << std::endl;
-      }
+      std::cout << value << "  " << filename << std::endl;
     }
   }
   return retval;
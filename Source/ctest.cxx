@@ -47,6 +47,10 @@ static const char* cmDocumentationOptions[][2] = {
   { "--test-output-truncation <mode>",
     "Truncate 'tail' (default), 'middle' or 'head' of test output once "
     "maximum output size is reached" },
+  { "--test-output-streaming",
+    "Keep only the head and tail of test output in memory" },
+  { "--test-output-spool",
+    "Write the whole output of each test to a compressed file" },
   { "-F", "Enable failover." },
   { "-j <jobs>, --parallel <jobs>",
     "Run the tests in parallel using the "
@@ -116,6 +120,13 @@ static const char* cmDocumentationOptions[][2] = {
   { "--max-width <width>", "Set the max width for a test name to output" },
   { "--interactive-debug-mode [0|1]", "Set the interactive mode to 0 or 1." },
   { "--resource-spec-file <file>", "Set the resource spec file to use." },
+  { "--shard-index <index>",
+    "Run only the tests of the shard with the given 0-based index." },
+  { "--shard-count <count>", "Split the tests into the given number of "
+                             "shards balanced by their cost." },
+  { "--coordinator <socket>",
+    "Share the parallel level and resources with other ctest processes "
+    "through the given socket." },
   { "--no-label-summary", "Disable timing summary information for labels." },
   { "--no-subproject-summary",
     "Disable timing summary information for "
@@ -140,12 +151,17 @@ static const char* cmDocumentationOptions[][2] = {
   { "--test-command", "The test to run with the --build-and-test option." },
   { "--test-timeout", "The time limit in seconds, internal use only." },
   { "--test-load", "CPU load threshold for starting new parallel tests." },
+  { "--test-memory", "Memory limit in MiB for tests run in parallel." },
+  { "--test-list-cache",
+    "Reuse the list of tests while the test files are unchanged." },
   { "--tomorrow-tag", "Nightly or experimental starts with next day tag." },
   { "--overwrite", "Overwrite CTest configuration option." },
   { "--extra-submit <file>[;<file>]", "Submit extra files to the dashboard." },
   { "--force-new-ctest-process",
     "Run child CTest instances as new processes" },
   { "--schedule-random", "Use a random order for scheduling tests" },
+  { "--schedule-critical-path",
+    "Start tests on the longest dependency chains first" },
   { "--submit-index",
     "Submit individual dashboard tests with specific index" },
   { "--timeout <seconds>", "Set the default test timeout." },
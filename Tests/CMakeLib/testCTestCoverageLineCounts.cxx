@@ -0,0 +1,120 @@
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "cmCTestCoverageHandler.h"
+
+namespace {
+
+bool testCounts()
+{
+  std::cout << "testCounts()\n";
+  cmCTestCoverageLineCounts counts;
+  counts.push_back(-1);
+  counts.push_back(0);
+  counts.push_back(70000);
+  counts.resize(5);
+  counts[3] = 65534;
+  counts[4] += 2;
+  ++counts[1];
+
+  std::vector<int> const expected = { -1, 1, 70000, 65534, 1 };
+  if (counts.size() != expected.size()) {
+    std::cout << "Unexpected size " << counts.size() << "\n";
+    return false;
+  }
+  for (std::size_t i = 0; i < expected.size(); ++i) {
+    if (counts[i] != expected[i]) {
+      std::cout << "Line " << i << " has count " << counts[i]
+                << " instead of " << expected[i] << "\n";
+      return false;
+    }
+  }
+
+  counts[2] = 7;
+  counts.resize(3);
+  counts.resize(4);
+  if (counts[2] != 7 || counts[3] != -1) {
+    std::cout << "Counts not reset by resize\n";
+    return false;
+  }
+  return true;
+}
+
+bool testMerge()
+{
+  std::cout << "testMerge()\n";
+  cmCTestCoverageLineCounts a;
+  a.push_back(-1);
+  a.push_back(3);
+  cmCTestCoverageLineCounts b;
+  b.push_back(0);
+  b.push_back(65533);
+  b.push_back(-1);
+  b.push_back(4);
+  a.Merge(b);
+
+  std::vector<int> const expected = { 0, 65536, -1, 4 };
+  if (a.size() != expected.size()) {
+    std::cout << "Unexpected size " << a.size() << "\n";
+    return false;
+  }
+  for (std::size_t i = 0; i < expected.size(); ++i) {
+    if (a[i] != expected[i]) {
+      std::cout << "Line " << i << " has count " << a[i] << " instead of "
+                << expected[i] << "\n";
+      return false;
+    }
+  }
+  return true;
+}
+
+bool testParseFiles()
+{
+  std::cout << "testParseFiles()\n";
+  std::vector<std::string> files;
+  for (int i = 0; i < 100; ++i) {
+    files.push_back(std::to_string(i));
+  }
+
+  // Every "file" covers the first lines of two sources.
+  auto parse = [](cmCTestCoverageHandlerContainer& cont,
+                  std::string const& file) {
+    int const n = std::stoi(file);
+    cont.TotalCoverage["a"].push_back(n);
+    cont.TotalCoverage[n % 2 ? "odd" : "even"].push_back(1);
+    return n != 42;
+  };
+
+  cmCTestCoverageHandlerContainer cont;
+  cont.Error = 0;
+  cont.OFS = nullptr;
+  cont.Quiet = true;
+  cont.ParallelLevel = 4;
+  if (cont.ParseFiles(files, parse)) {
+    std::cout << "Failure of one file not reported\n";
+    return false;
+  }
+  if (cont.TotalCoverage.size() != 3 || cont.TotalCoverage["a"][0] != 4950 ||
+      cont.TotalCoverage["odd"][0] != 50 ||
+      cont.TotalCoverage["even"][0] != 50) {
+    std::cout << "Unexpected merged coverage\n";
+    return false;
+  }
+  return true;
+}
+}
+
+int testCTestCoverageLineCounts(int /*unused*/, char* /*unused*/[])
+{
+  if (!testCounts()) {
+    return 1;
+  }
+  if (!testMerge()) {
+    return 1;
+  }
+  if (!testParseFiles()) {
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,194 @@
+#include <cstddef>
+#include <iostream>
+#include <vector>
+
+#include "cmCTestDependencyGraph.h"
+
+namespace {
+
+using Node = cmCTestDependencyGraph::Node;
+
+std::vector<int> Tests(cmCTestDependencyGraph const& graph,
+                       cmCTestDependencyGraph::NodeRange nodes)
+{
+  std::vector<int> tests;
+  for (Node node : nodes) {
+    tests.push_back(graph.GetTest(node));
+  }
+  return tests;
+}
+
+bool testIndex()
+{
+  std::cout << "testIndex()\n";
+  cmCTestDependencyGraph graph;
+  graph.AddTest(7);
+  graph.AddTest(3);
+  graph.AddTest(5);
+  graph.AddTest(3);
+  graph.AddDependency(7, 5);
+  graph.AddDependency(7, 3);
+  graph.AddDependency(7, 3);
+  graph.AddDependency(5, 3);
+  graph.AddDependency(5, 42);
+  graph.Build();
+
+  if (graph.GetNodeCount() != 3 || graph.GetTest(0) != 3 ||
+      graph.GetTest(2) != 7) {
+    std::cout << "Tests not numbered in order\n";
+    return false;
+  }
+  Node node;
+  if (graph.FindNode(42, node) || !graph.FindNode(5, node) || node != 1) {
+    std::cout << "Unexpected node of test\n";
+    return false;
+  }
+  if (Tests(graph, graph.GetDependencies(2)) != std::vector<int>{ 3, 5 } ||
+      Tests(graph, graph.GetDependencies(1)) != std::vector<int>{ 3 } ||
+      !graph.GetDependencies(0).empty()) {
+    std::cout << "Unexpected dependencies\n";
+    return false;
+  }
+  if (Tests(graph, graph.GetDependents(0)) != std::vector<int>{ 5, 7 } ||
+      !graph.GetDependents(2).empty()) {
+    std::cout << "Unexpected dependents\n";
+    return false;
+  }
+
+  std::vector<Node> const order = graph.GetDependentsFirstOrder();
+  if (order != std::vector<Node>{ 2, 1, 0 }) {
+    std::cout << "Dependents not ordered first\n";
+    return false;
+  }
+  int test;
+  if (graph.FindCycle(test)) {
+    std::cout << "Unexpected cycle for test " << test << "\n";
+    return false;
+  }
+  return true;
+}
+
+bool testCycles()
+{
+  std::cout << "testCycles()\n";
+  cmCTestDependencyGraph graph;
+  for (int test = 1; test <= 6; ++test) {
+    graph.AddTest(test);
+  }
+  // 1 -> 4 -> 5 -> 4 is a cycle not containing 1.
+  graph.AddDependency(1, 4);
+  graph.AddDependency(4, 5);
+  graph.AddDependency(5, 4);
+  graph.AddDependency(2, 3);
+  graph.Build();
+
+  int test = 0;
+  if (!graph.FindCycle(test) || test != 4) {
+    std::cout << "Cycle found for test " << test << " instead of 4\n";
+    return false;
+  }
+  if (graph.GetDependentsFirstOrder().size() != 4) {
+    std::cout << "Tests on a cycle not left out of the order\n";
+    return false;
+  }
+
+  cmCTestDependencyGraph self;
+  self.AddTest(1);
+  self.AddTest(2);
+  self.AddDependency(2, 2);
+  self.Build();
+  if (!self.FindCycle(test) || test != 2) {
+    std::cout << "Self dependency not found as a cycle\n";
+    return false;
+  }
+  return true;
+}
+
+// Build a graph shaped like a large project using fixtures: chains of
+// tests, each group of tests requiring a setup test, and a cleanup test
+// depending on every test of its group.  Check that such a graph is
+// indexed, ordered and searched for cycles correctly.
+bool testLarge()
+{
+  std::cout << "testLarge()\n";
+  int const count = 100000;
+  int const group = 1000;
+
+  cmCTestDependencyGraph graph;
+  for (int test = 1; test <= count; ++test) {
+    graph.AddTest(test);
+    int const first = test - (test - 1) % group;
+    int const last = first + group - 1;
+    if (test == first || test == last) {
+      continue;
+    }
+    graph.AddDependency(test, first);
+    graph.AddDependency(last, test);
+    if ((test - first) % 10 != 1) {
+      graph.AddDependency(test, test - 1);
+    }
+  }
+  graph.Build();
+
+  Node last;
+  if (!graph.FindNode(count, last) ||
+      graph.GetDependencies(last).size() != group - 2) {
+    std::cout << "Unexpected dependencies of test " << count << "\n";
+    return false;
+  }
+
+  int test;
+  if (graph.FindCycle(test)) {
+    std::cout << "Unexpected cycle for test " << test << "\n";
+    return false;
+  }
+
+  std::vector<Node> const order = graph.GetDependentsFirstOrder();
+  if (order.size() != static_cast<std::size_t>(count)) {
+    std::cout << "Ordered " << order.size() << " of " << count
+              << " tests\n";
+    return false;
+  }
+  std::vector<bool> seen(order.size());
+  for (Node node : order) {
+    for (Node dependent : graph.GetDependents(node)) {
+      if (!seen[dependent]) {
+        std::cout << "Test " << graph.GetTest(node)
+                  << " ordered before a test depending on it\n";
+        return false;
+      }
+    }
+    seen[node] = true;
+  }
+
+  // Close a cycle through the whole last group.
+  cmCTestDependencyGraph cyclic;
+  for (int t = 1; t <= count; ++t) {
+    cyclic.AddTest(t);
+    if (t > 1) {
+      cyclic.AddDependency(t, t - 1);
+    }
+  }
+  cyclic.AddDependency(count - group + 1, count);
+  cyclic.Build();
+  if (!cyclic.FindCycle(test) || test != count - group + 1) {
+    std::cout << "Cycle of long chain not found\n";
+    return false;
+  }
+  return true;
+}
+}
+
+int testCTestDependencyGraph(int /*unused*/, char* /*unused*/[])
+{
+  if (!testIndex()) {
+    return 1;
+  }
+  if (!testCycles()) {
+    return 1;
+  }
+  if (!testLarge()) {
+    return 1;
+  }
+  return 0;
+}
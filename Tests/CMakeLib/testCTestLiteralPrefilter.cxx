@@ -0,0 +1,206 @@
+#include <cstddef> // IWYU pragma: keep
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "cmsys/RegularExpression.hxx"
+
+#include "cmCTestLiteralPrefilter.h"
+
+namespace {
+
+// A selection of the default ctest_build expressions.
+const char* const patterns[] = {
+  "^[Bb]us [Ee]rror",
+  ":.*[Pp]ermission [Dd]enied",
+  "([^ :]+):([0-9]+): ([^ \\t])",
+  "^Error ([0-9]+):",
+  "^Fatal",
+  "([^ :]+) : (error|fatal error|catastrophic error)",
+  "([^:]+): (Error:|error|undefined reference|multiply defined)",
+  R"(([^:]+)\(([^\)]+)\) ?: (error|fatal error|catastrophic error))",
+  "^collect2: ld returned 1 exit status",
+  R"(make: \*\*\*.*Error)",
+  R"(make\[.*\]: \*\*\*.*Error)",
+  ": No such file or directory",
+  "^\\[ERROR\\]",
+  "instantiated from ",
+  ": warning",
+  "([^ :]+):([0-9]+): warning:",
+  "^(Warning|Warnung)[ :]",
+  "WARNING: ",
+  ".*file: .* has no symbols",
+  "\\([0-9]*\\): remark #[0-9]*",
+  "^CMake Warning.*:",
+  "warning LNK4089: all references to [^ \\t]+ discarded by .OPT:REF",
+  "cc: warning 422: Unknown option \"\\+b",
+  "ab*c|de+f",
+};
+
+// Representative lines of compiler and build tool output.
+const char* const lines[] = {
+  "[ 42%] Building CXX object Source/CMakeFiles/CMakeLib.dir/cmake.cxx.o",
+  "/src/foo.cxx:12:5: error: use of undeclared identifier 'x'",
+  "/src/foo.cxx:17:3: warning: unused variable 'y' [-Wunused-variable]",
+  "/src/foo.h:3:1: note: in file included from /src/foo.cxx:1:",
+  "foo.cpp(12): error C2065: 'x': undeclared identifier",
+  "foo.cpp(17) : warning C4101: 'y': unreferenced local variable",
+  "/usr/bin/ld: foo.o: undefined reference to `bar()'",
+  "collect2: error: ld returned 1 exit status",
+  "collect2: ld returned 1 exit status",
+  "make[2]: *** [CMakeFiles/foo.dir/build.make:76: foo] Error 1",
+  "make: *** [Makefile:91: all] Error 2",
+  "cc1plus: fatal error: foo.h: No such file or directory",
+  "Bus error (core dumped)",
+  "Warnung: something",
+  "CMake Warning at CMakeLists.txt:3 (message):",
+  "[ERROR] Failed to execute goal",
+  "foo.c(3): remark #1418: external function definition",
+  "libfoo.a(bar.o): file: bar.o has no symbols",
+  "ac",
+  "abbbc",
+  "dxf",
+  "deef",
+  "",
+};
+
+bool testRequiredLiterals()
+{
+  std::cout << "testRequiredLiterals()\n";
+  struct Case
+  {
+    const char* Regex;
+    std::vector<std::string> Literals;
+  };
+  const Case cases[] = {
+    { "^Fatal", { "Fatal" } },
+    { "^[Bb]us [Ee]rror", { "rror" } },
+    { "([^ :]+):([0-9]+): warning:", { ": warning:" } },
+    { R"(make: \*\*\*.*Error)", { "make: ***" } },
+    { "^(Warning|Warnung)[ :]", { "Warning", "Warnung" } },
+    { "([^:]+): (Error:|error|undefined reference)",
+      { "Error:", "error", "undefined reference" } },
+    { "(a|.)b", { "b" } },
+    { "(a|.)", {} },
+    { "ab*c|de+f", { "a", "de" } },
+    { "x?yz", { "yz" } },
+    { "[]a]bc", { "bc" } },
+    { "a.b", { "a" } },
+  };
+  for (Case const& c : cases) {
+    std::vector<std::string> const literals =
+      cmCTestLiteralPrefilter::GetRequiredLiterals(c.Regex);
+    if (literals != c.Literals) {
+      std::cout << "Unexpected literals for \"" << c.Regex << "\":";
+      for (std::string const& literal : literals) {
+        std::cout << " \"" << literal << "\"";
+      }
+      std::cout << "\n";
+      return false;
+    }
+  }
+  return true;
+}
+
+bool testNoFalseNegatives()
+{
+  std::cout << "testNoFalseNegatives()\n";
+  cmCTestLiteralPrefilter prefilter;
+  std::vector<cmsys::RegularExpression> regexes;
+  for (const char* pattern : patterns) {
+    prefilter.Add(pattern);
+    regexes.emplace_back(pattern);
+  }
+  prefilter.Compile();
+
+  for (const char* line : lines) {
+    prefilter.Scan(line);
+    for (std::size_t i = 0; i < regexes.size(); ++i) {
+      if (regexes[i].find(line) && !prefilter.IsCandidate(i)) {
+        std::cout << "Pattern \"" << patterns[i] << "\" matches \"" << line
+                  << "\" but was filtered out\n";
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+// Expressions whose anchors, alternations and character classes the
+// literal extraction must not turn into literals a match may lack.
+bool testTrickyExpressions()
+{
+  std::cout << "testTrickyExpressions()\n";
+  struct Case
+  {
+    const char* Regex;
+    std::vector<const char*> Matching;
+  };
+  const Case cases[] = {
+    { "^$", { "" } },
+    { "rror$", { "error", "Error" } },
+    { "^(abc|)def", { "def", "abcdef" } },
+    { "(^|: )warning", { "warning: x", "a.c: warning" } },
+    { "[Ee][Rr][Rr][Oo][Rr]", { "ERROR", "error", "eRrOr" } },
+    { "[A-Z]+ rror", { "E rror", "FOO rror" } },
+    { "[^a-z]rror", { "Error", "1rror" } },
+    { "(Error|error|ERROR)s?:", { "Errors:", "error:", "ERROR:" } },
+    { "(a(b|c)|d)e", { "abe", "ace", "de" } },
+    { "x(yz)*w", { "xw", "xyzw", "xyzyzw" } },
+    { "x(yz)+w", { "xyzw" } },
+    { "a\\.b\\$", { "a.b$" } },
+    { "[.]c\\(", { ".c(" } },
+    { "f.o|b[^r]r", { "foo", "fxo", "bar" } },
+    { "([^ :]+):([0-9]+):", { "a.c:12:" } },
+    { "^(Warning|Warnung)[ :]", { "Warning: x", "Warnung x" } },
+  };
+
+  cmCTestLiteralPrefilter prefilter;
+  std::vector<cmsys::RegularExpression> regexes;
+  std::vector<const char*> matching;
+  for (Case const& c : cases) {
+    prefilter.Add(c.Regex);
+    regexes.emplace_back(c.Regex);
+    matching.insert(matching.end(), c.Matching.begin(), c.Matching.end());
+  }
+  prefilter.Compile();
+
+  for (std::size_t i = 0; i < regexes.size(); ++i) {
+    for (const char* line : cases[i].Matching) {
+      if (!regexes[i].find(line)) {
+        std::cout << "Pattern \"" << cases[i].Regex << "\" does not match \""
+                  << line << "\"\n";
+        return false;
+      }
+    }
+  }
+
+  // Scan every line, so that each expression is checked against lines
+  // written for the others as well.
+  for (const char* line : matching) {
+    prefilter.Scan(line);
+    for (std::size_t i = 0; i < regexes.size(); ++i) {
+      if (regexes[i].find(line) && !prefilter.IsCandidate(i)) {
+        std::cout << "Pattern \"" << cases[i].Regex << "\" matches \""
+                  << line << "\" but was filtered out\n";
+        return false;
+      }
+    }
+  }
+  return true;
+}
+}
+
+int testCTestLiteralPrefilter(int /*unused*/, char* /*unused*/[])
+{
+  if (!testRequiredLiterals()) {
+    return 1;
+  }
+  if (!testNoFalseNegatives()) {
+    return 1;
+  }
+  if (!testTrickyExpressions()) {
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,134 @@
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "cmsys/FStream.hxx"
+#include "cmsys/Glob.hxx"
+
+#include "cmCachedGlob.h"
+#include "cmSystemTools.h"
+
+namespace {
+
+struct Case
+{
+  char const* Expression;
+  bool Recurse;
+  bool FollowSymlinks;
+  bool ListDirs;
+  bool Relative;
+};
+
+std::string Root;
+
+void WriteFile(std::string const& path)
+{
+  cmsys::ofstream fout((Root + '/' + path).c_str());
+  fout << path << '\n';
+}
+
+void CreateTree()
+{
+  cmSystemTools::RemoveADirectory(Root);
+  cmSystemTools::MakeDirectory(Root + "/sub/deep");
+  cmSystemTools::MakeDirectory(Root + "/other");
+  WriteFile("a.txt");
+  WriteFile("b.c");
+  WriteFile(".hidden.txt");
+  WriteFile("sub/c.txt");
+  WriteFile("sub/deep/d.txt");
+  WriteFile("sub/deep/e.c");
+  WriteFile("other/f.txt");
+#ifndef _WIN32
+  // A link to a directory, a link back to the root and a dangling link.
+  cmSystemTools::CreateSymlink(Root + "/sub", Root + "/other/link");
+  cmSystemTools::CreateSymlink(Root, Root + "/sub/deep/loop");
+  cmSystemTools::CreateSymlink(Root + "/missing", Root + "/dangling.txt");
+#endif
+}
+
+bool testCase(Case const& c)
+{
+  std::string const expr = Root + '/' + c.Expression;
+
+  cmsys::Glob expect;
+  expect.SetRecurse(c.Recurse);
+  expect.SetRecurseThroughSymlinks(c.FollowSymlinks);
+  expect.SetListDirs(c.ListDirs);
+  expect.SetRecurseListDirs(c.ListDirs);
+  if (c.Relative) {
+    expect.SetRelative(Root.c_str());
+  }
+  cmsys::Glob::GlobMessages expectMessages;
+  expect.FindFiles(expr, &expectMessages);
+
+  cmCachedGlob actual;
+  actual.SetRecurse(c.Recurse);
+  actual.SetRecurseThroughSymlinks(c.FollowSymlinks);
+  actual.SetListDirs(c.ListDirs);
+  actual.SetRecurseListDirs(c.ListDirs);
+  if (c.Relative) {
+    actual.SetRelative(Root);
+  }
+  cmsys::Glob::GlobMessages actualMessages;
+  actual.FindFiles(expr, &actualMessages);
+
+  std::vector<std::string> expectFiles = expect.GetFiles();
+  std::vector<std::string> actualFiles = actual.GetFiles();
+  std::sort(expectFiles.begin(), expectFiles.end());
+  std::sort(actualFiles.begin(), actualFiles.end());
+  if (actualFiles != expectFiles) {
+    std::cout << "Files found for " << c.Expression << " (recurse "
+              << c.Recurse << ", symlinks " << c.FollowSymlinks
+              << ", directories " << c.ListDirs << ", relative "
+              << c.Relative << ") differ from cmsys::Glob:\n";
+    for (std::string const& file : actualFiles) {
+      std::cout << "  " << file << "\n";
+    }
+    std::cout << "instead of\n";
+    for (std::string const& file : expectFiles) {
+      std::cout << "  " << file << "\n";
+    }
+    return false;
+  }
+  if (actual.GetFollowedSymlinkCount() != expect.GetFollowedSymlinkCount() ||
+      actualMessages.size() != expectMessages.size()) {
+    std::cout << "Symlinks followed or messages for " << c.Expression
+              << " differ from cmsys::Glob\n";
+    return false;
+  }
+  return true;
+}
+
+bool testMatchesGlob()
+{
+  std::cout << "testMatchesGlob()\n";
+  Case const cases[] = {
+    { "*.txt", false, false, false, false },
+    { "*", false, false, true, false },
+    { "*/*.txt", false, false, false, true },
+    { "s[a-z]b/*", false, false, true, false },
+    { "*.txt", true, false, false, false },
+    { "*.txt", true, true, false, false },
+    { "*", true, false, true, true },
+    { "*", true, true, true, false },
+    { "sub/*.c", true, true, false, true },
+    { "other/*", true, true, false, false },
+  };
+  bool ok = true;
+  for (Case const& c : cases) {
+    ok = testCase(c) && ok;
+  }
+  return ok;
+}
+}
+
+int testCachedGlob(int /*unused*/, char* /*unused*/[])
+{
+  Root = cmSystemTools::GetCurrentWorkingDirectory() + "/testCachedGlob";
+  CreateTree();
+  bool const ok = testMatchesGlob();
+  cmSystemTools::RemoveADirectory(Root);
+  return ok ? 0 : 1;
+}
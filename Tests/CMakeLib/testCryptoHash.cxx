@@ -0,0 +1,162 @@
+#include <cstddef>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <cm3p/rhash.h>
+
+#include "cmsys/FStream.hxx"
+
+#include "cmCryptoHash.h"
+#include "cmSystemTools.h"
+
+namespace {
+
+struct Vector
+{
+  cmCryptoHash::Algo Algo;
+  unsigned int Id;
+  char const* Name;
+};
+
+Vector const Vectors[] = {
+  { cmCryptoHash::AlgoSHA1, RHASH_SHA1, "SHA1" },
+  { cmCryptoHash::AlgoSHA224, RHASH_SHA224, "SHA224" },
+  { cmCryptoHash::AlgoSHA256, RHASH_SHA256, "SHA256" },
+  { cmCryptoHash::AlgoMD5, RHASH_MD5, "MD5" },
+};
+
+std::string RHashString(unsigned int id, std::string const& input)
+{
+  std::vector<unsigned char> hash(rhash_get_digest_size(id));
+  rhash_msg(id, input.data(), input.size(), hash.data());
+  return cmCryptoHash::ByteHashToString(hash);
+}
+
+std::string Data(std::size_t size)
+{
+  std::string data(size, '\0');
+  unsigned int x = 12345;
+  for (char& c : data) {
+    x = x * 1103515245 + 12345;
+    c = static_cast<char>(x >> 16);
+  }
+  return data;
+}
+
+bool testKnown()
+{
+  std::cout << "testKnown()\n";
+  struct Known
+  {
+    cmCryptoHash::Algo Algo;
+    std::string Input;
+    char const* Hash;
+  };
+  Known const known[] = {
+    { cmCryptoHash::AlgoSHA1, "",
+      "da39a3ee5e6b4b0d3255bfef95601890afd80709" },
+    { cmCryptoHash::AlgoSHA1, "abc",
+      "a9993e364706816aba3e25717850c26c9cd0d89d" },
+    { cmCryptoHash::AlgoSHA1, std::string(1000000, 'a'),
+      "34aa973cd4c4daa4f61eeb2bdbad27316534016f" },
+    { cmCryptoHash::AlgoSHA224, "abc",
+      "23097d223405d8228642a477bda255b32aadbce4bda0b3f7e36c9da7" },
+    { cmCryptoHash::AlgoSHA256, "",
+      "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855" },
+    { cmCryptoHash::AlgoSHA256, "abc",
+      "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad" },
+    { cmCryptoHash::AlgoSHA256, std::string(1000000, 'a'),
+      "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0" },
+  };
+  for (Known const& k : known) {
+    std::string const hash = cmCryptoHash(k.Algo).HashString(k.Input);
+    if (hash != k.Hash) {
+      std::cout << "Hash of " << k.Input.size() << " bytes is " << hash
+                << " instead of " << k.Hash << "\n";
+      return false;
+    }
+  }
+  return true;
+}
+
+// Compare with librhash for every length around the padding boundaries,
+// appending the data in pieces of varying sizes.
+bool testLengths()
+{
+  std::cout << "testLengths()\n";
+  std::string const data = Data(300);
+  for (Vector const& v : Vectors) {
+    cmCryptoHash hash(v.Algo);
+    for (std::size_t size = 0; size <= data.size(); ++size) {
+      std::string const input = data.substr(0, size);
+      std::string const expect = RHashString(v.Id, input);
+      for (std::size_t piece : { 1, 7, 64, 100 }) {
+        hash.Initialize();
+        for (std::size_t pos = 0; pos < size; pos += piece) {
+          hash.Append(cm::string_view(input).substr(pos, piece));
+        }
+        std::string const actual = hash.FinalizeHex();
+        if (actual != expect) {
+          std::cout << v.Name << " of " << size << " bytes in pieces of "
+                    << piece << " is " << actual << " instead of " << expect
+                    << "\n";
+          return false;
+        }
+      }
+    }
+  }
+  return true;
+}
+
+bool testHashFiles()
+{
+  std::cout << "testHashFiles()\n";
+  std::vector<std::string> files;
+  std::vector<std::string> expect;
+  for (std::size_t size : { 0, 1, 63, 64, 65, 1000, 70001 }) {
+    files.push_back("testCryptoHash" + std::to_string(size) + ".bin");
+    std::string const data = Data(size);
+    cmsys::ofstream fout(files.back().c_str(), std::ios::binary);
+    fout.write(data.data(), data.size());
+    expect.push_back(RHashString(RHASH_SHA256, data));
+  }
+  files.emplace_back("testCryptoHash-missing.bin");
+
+  std::vector<std::string> const hashes =
+    cmCryptoHash::HashFiles(cmCryptoHash::AlgoSHA256, files);
+
+  bool ok = true;
+  cmCryptoHash hash(cmCryptoHash::AlgoSHA256);
+  for (std::size_t i = 0; i < files.size(); ++i) {
+    if (i < expect.size() && hashes[i] != expect[i]) {
+      std::cout << "Hash of " << files[i] << " differs from librhash\n";
+      ok = false;
+    }
+    if (hashes[i] != hash.HashFile(files[i])) {
+      std::cout << "Hash of " << files[i] << " differs from HashFile\n";
+      ok = false;
+    }
+    cmSystemTools::RemoveFile(files[i]);
+  }
+  if (!hashes.back().empty()) {
+    std::cout << "Missing file has a hash\n";
+    ok = false;
+  }
+  return ok;
+}
+}
+
+int testCryptoHash(int /*unused*/, char* /*unused*/[])
+{
+  if (!testKnown()) {
+    return 1;
+  }
+  if (!testLengths()) {
+    return 1;
+  }
+  if (!testHashFiles()) {
+    return 1;
+  }
+  return 0;
+}
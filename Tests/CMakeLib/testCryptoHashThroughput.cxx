@@ -0,0 +1,129 @@
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <cm3p/rhash.h>
+
+#include "cmsys/FStream.hxx"
+
+#include "cmCryptoHash.h"
+#include "cmSystemTools.h"
+
+namespace {
+
+struct Vector
+{
+  cmCryptoHash::Algo Algo;
+  unsigned int Id;
+  char const* Name;
+};
+
+Vector const Vectors[] = {
+  { cmCryptoHash::AlgoSHA1, RHASH_SHA1, "SHA1" },
+  { cmCryptoHash::AlgoSHA224, RHASH_SHA224, "SHA224" },
+  { cmCryptoHash::AlgoSHA256, RHASH_SHA256, "SHA256" },
+  { cmCryptoHash::AlgoMD5, RHASH_MD5, "MD5" },
+};
+
+std::string RHashString(unsigned int id, std::string const& input)
+{
+  std::vector<unsigned char> hash(rhash_get_digest_size(id));
+  rhash_msg(id, input.data(), input.size(), hash.data());
+  return cmCryptoHash::ByteHashToString(hash);
+}
+
+std::string Data(std::size_t size)
+{
+  std::string data(size, '\0');
+  unsigned int x = 12345;
+  for (char& c : data) {
+    x = x * 1103515245 + 12345;
+    c = static_cast<char>(x >> 16);
+  }
+  return data;
+}
+
+double MegabytesPerSecond(std::size_t bytes,
+                          std::chrono::steady_clock::duration time)
+{
+  double const seconds = std::chrono::duration<double>(time).count();
+  return seconds > 0 ? static_cast<double>(bytes) / seconds / 1e6 : 0;
+}
+
+bool testStringThroughput()
+{
+  std::cout << "testStringThroughput()\n";
+  std::string const data = Data(64 << 20);
+  for (Vector const& v : Vectors) {
+    auto start = std::chrono::steady_clock::now();
+    std::string const hash = cmCryptoHash(v.Algo).HashString(data);
+    auto const ours = std::chrono::steady_clock::now() - start;
+    start = std::chrono::steady_clock::now();
+    std::string const expect = RHashString(v.Id, data);
+    auto const theirs = std::chrono::steady_clock::now() - start;
+    std::cout << "  " << v.Name << ": "
+              << MegabytesPerSecond(data.size(), ours) << " MB/s, librhash "
+              << MegabytesPerSecond(data.size(), theirs) << " MB/s\n";
+    if (hash != expect) {
+      std::cout << v.Name << " differs from librhash\n";
+      return false;
+    }
+  }
+  return true;
+}
+
+bool testFilesThroughput()
+{
+  std::cout << "testFilesThroughput()\n";
+  std::size_t const count = 16;
+  std::vector<std::string> files;
+  std::size_t bytes = 0;
+  for (std::size_t i = 0; i < count; ++i) {
+    files.push_back("testCryptoHashThroughput" + std::to_string(i) + ".bin");
+    std::string const data = Data((i + 1) << 20);
+    cmsys::ofstream fout(files.back().c_str(), std::ios::binary);
+    fout.write(data.data(), data.size());
+    bytes += data.size();
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::string> const hashes =
+    cmCryptoHash::HashFiles(cmCryptoHash::AlgoSHA256, files);
+  auto const parallel = std::chrono::steady_clock::now() - start;
+  start = std::chrono::steady_clock::now();
+  bool ok = true;
+  cmCryptoHash hash(cmCryptoHash::AlgoSHA256);
+  for (std::size_t i = 0; i < files.size(); ++i) {
+    if (hashes[i] != hash.HashFile(files[i])) {
+      std::cout << "Hash of " << files[i] << " differs from HashFile\n";
+      ok = false;
+    }
+  }
+  auto const serial = std::chrono::steady_clock::now() - start;
+  std::cout << "  " << count
+            << " files: " << MegabytesPerSecond(bytes, parallel)
+            << " MB/s, one at a time " << MegabytesPerSecond(bytes, serial)
+            << " MB/s\n";
+
+  for (std::string const& file : files) {
+    cmSystemTools::RemoveFile(file);
+  }
+  return ok;
+}
+}
+
+// Print how fast cmCryptoHash is.  This only runs when configured with
+// CMake_TEST_THROUGHPUT because its output is only meaningful on an idle
+// machine.
+int testCryptoHashThroughput(int /*unused*/, char* /*unused*/[])
+{
+  if (!testStringThroughput()) {
+    return 1;
+  }
+  if (!testFilesThroughput()) {
+    return 1;
+  }
+  return 0;
+}
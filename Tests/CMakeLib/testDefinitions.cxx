@@ -0,0 +1,185 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file Copyright.txt or https://cmake.org/licensing for details.  */
+
+#include <algorithm>
+#include <cstddef>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "cmDefinitions.h"
+#include "cmLinkedTree.h"
+#include "cmValue.h"
+
+#define ASSERT_TRUE(x)                                                        \
+  do {                                                                        \
+    if (!(x)) {                                                               \
+      std::cout << "ASSERT_TRUE(" #x ") failed on line " << __LINE__ << "\n"; \
+      return false;                                                           \
+    }                                                                         \
+  } while (false)
+
+using Tree = cmLinkedTree<cmDefinitions>;
+using StackIter = Tree::iterator;
+
+static bool testSetGet()
+{
+  std::cout << "testSetGet()\n";
+  Tree tree;
+  StackIter root = tree.Push(tree.Root());
+  root->Set("A", "a");
+  StackIter child = tree.Push(root);
+
+  cmValue v = cmDefinitions::Get("A", child, tree.Root());
+  ASSERT_TRUE(v && *v == "a");
+  ASSERT_TRUE(!cmDefinitions::Get("NEVER_SET", child, tree.Root()));
+  ASSERT_TRUE(cmDefinitions::HasKey("A", child, tree.Root()));
+  ASSERT_TRUE(!cmDefinitions::HasKey("NEVER_SET", child, tree.Root()));
+
+  // A local unset shadows the parent definition.
+  child->Unset("A");
+  ASSERT_TRUE(!cmDefinitions::Get("A", child, tree.Root()));
+  ASSERT_TRUE(cmDefinitions::HasKey("A", child, tree.Root()));
+  v = cmDefinitions::Get("A", root, tree.Root());
+  ASSERT_TRUE(v && *v == "a");
+  return true;
+}
+
+static bool testLookupCache()
+{
+  std::cout << "testLookupCache()\n";
+  Tree tree;
+  StackIter root = tree.Push(tree.Root());
+  StackIter mid = tree.Push(root);
+  StackIter leaf = tree.Push(mid);
+
+  // Cache a negative result, then define the name in an ancestor.
+  ASSERT_TRUE(!cmDefinitions::Get("B", leaf, tree.Root()));
+  root->Set("B", "1");
+  cmValue v = cmDefinitions::Get("B", leaf, tree.Root());
+  ASSERT_TRUE(v && *v == "1");
+
+  // Changing the ancestor value must invalidate the cached value.
+  root->Set("B", "2");
+  v = cmDefinitions::Get("B", leaf, tree.Root());
+  ASSERT_TRUE(v && *v == "2");
+
+  // A closer ancestor now shadows it.
+  mid->Set("B", "3");
+  v = cmDefinitions::Get("B", leaf, tree.Root());
+  ASSERT_TRUE(v && *v == "3");
+  mid->Unset("B");
+  ASSERT_TRUE(!cmDefinitions::Get("B", leaf, tree.Root()));
+  return true;
+}
+
+static bool testRaise()
+{
+  std::cout << "testRaise()\n";
+  Tree tree;
+  StackIter root = tree.Push(tree.Root());
+  root->Set("C", "c");
+  StackIter child = tree.Push(root);
+
+  // Localize, then change the parent; the child keeps the old value.
+  cmDefinitions::Raise("C", child, tree.Root());
+  root->Set("C", "changed");
+  cmValue v = cmDefinitions::Get("C", child, tree.Root());
+  ASSERT_TRUE(v && *v == "c");
+  return true;
+}
+
+static bool testClosure()
+{
+  std::cout << "testClosure()\n";
+  Tree tree;
+  StackIter root = tree.Push(tree.Root());
+  root->Set("D", "d");
+  root->Set("E", "e");
+  StackIter child = tree.Push(root);
+  child->Unset("E");
+  child->Set("F", "f");
+
+  std::vector<std::string> keys =
+    cmDefinitions::ClosureKeys(child, tree.Root());
+  std::sort(keys.begin(), keys.end());
+  ASSERT_TRUE((keys == std::vector<std::string>{ "D", "F" }));
+
+  cmDefinitions closure = cmDefinitions::MakeClosure(child, tree.Root());
+  StackIter copy = tree.Push(tree.Root(), closure);
+  ASSERT_TRUE(cmDefinitions::Get("D", copy, tree.Root()));
+  ASSERT_TRUE(!cmDefinitions::Get("E", copy, tree.Root()));
+  ASSERT_TRUE(cmDefinitions::Get("F", copy, tree.Root()));
+  return true;
+}
+
+// Look up, set and raise variables through a deep function call stack.
+static bool testDeepStack()
+{
+  std::cout << "testDeepStack()\n";
+  std::size_t const depth = 64;
+  std::size_t const nvars = 32;
+
+  std::vector<std::string> names;
+  names.reserve(nvars);
+  for (std::size_t i = 0; i < nvars; ++i) {
+    names.push_back("DEEP_VARIABLE_" + std::to_string(i));
+  }
+
+  Tree tree;
+  StackIter top = tree.Push(tree.Root());
+  for (std::string const& name : names) {
+    top->Set(name, "global");
+  }
+  std::vector<StackIter> frames;
+  for (std::size_t d = 0; d < depth; ++d) {
+    top = tree.Push(top);
+    frames.push_back(top);
+  }
+
+  for (std::string const& name : names) {
+    cmValue v = cmDefinitions::Get(name, top, tree.Root());
+    ASSERT_TRUE(v && *v == "global");
+  }
+
+  for (std::string const& name : names) {
+    top->Set(name, "local");
+  }
+  for (std::string const& name : names) {
+    cmValue v = cmDefinitions::Get(name, top, tree.Root());
+    ASSERT_TRUE(v && *v == "local");
+    v = cmDefinitions::Get(name, frames.front(), tree.Root());
+    ASSERT_TRUE(v && *v == "global");
+  }
+
+  for (StackIter frame : frames) {
+    for (std::string const& name : names) {
+      cmDefinitions::Raise(name, frame, tree.Root());
+    }
+  }
+  cmValue v = cmDefinitions::Get(names.front(), frames.front(), tree.Root());
+  ASSERT_TRUE(v && *v == "global");
+  v = cmDefinitions::Get(names.back(), top, tree.Root());
+  ASSERT_TRUE(v && *v == "local");
+  return true;
+}
+
+int testDefinitions(int /*unused*/, char* /*unused*/ [])
+{
+  if (!testSetGet()) {
+    return 1;
+  }
+  if (!testLookupCache()) {
+    return 1;
+  }
+  if (!testRaise()) {
+    return 1;
+  }
+  if (!testClosure()) {
+    return 1;
+  }
+  if (!testDeepStack()) {
+    return 1;
+  }
+  return 0;
+}
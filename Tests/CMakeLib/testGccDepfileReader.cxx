@@ -9,6 +9,7 @@
 
 #include "cmsys/FStream.hxx"
 
+#include "cmGccDepfileLexerHelper.h"
 #include "cmGccDepfileReader.h"
 #include "cmGccDepfileReaderTypes.h" // for cmGccDepfileContent, cmGccStyle...
 #include "cmSystemTools.h"
@@ -103,6 +104,114 @@ void dump(const char* label, const cmGccDepfileContent& dfc)
   }
 }
 
+// Read a depfile with the lexer and with the buffer scanner and check
+// that both give the same result.
+bool compareScanners(const std::string& depfile)
+{
+  cmGccDepfileLexerHelper lexer;
+  cmGccDepfileLexerHelper scanner;
+  bool const lexed = lexer.readFile(depfile.c_str());
+  bool const scanned = scanner.readFileBuffered(depfile.c_str());
+  if (lexed != scanned) {
+    std::cerr << "Reading " << depfile << " with the lexer "
+              << (lexed ? "succeeded" : "failed") << " but with the scanner "
+              << (scanned ? "succeeded" : "failed") << std::endl;
+    return false;
+  }
+  auto const expected = std::move(lexer).extractContent();
+  auto const actual = std::move(scanner).extractContent();
+  if (!compare(actual, expected)) {
+    dump("scanner", actual);
+    dump("lexer", expected);
+    return false;
+  }
+  return true;
+}
+
+bool writeFile(const std::string& path, const std::string& content)
+{
+  cmsys::ofstream os(path.c_str(), std::ios::out | std::ios::binary);
+  os << content;
+  return static_cast<bool>(os);
+}
+
+bool testScannerEdgeCases()
+{
+  std::cout << "testScannerEdgeCases()\n";
+  static const char* const cases[] = {
+    "",
+    "\n",
+    "a.o: b.h\n",
+    "a.o: b\\ c.h d\\\\ e.h f\\\\\\ g.h\n",
+    "a.o x.o: \\\n  b.h \\\r\n  c.h\\\n",
+    "a.o:\\\nb.h\n",
+    "a.o:\nb.o: c.h\n",
+    "a.o:\r\nb.o:\tc.h\r\n",
+    "a$$b.o: c$d.h \\#e.h \\\\#f.h \\x.h\n",
+    "c\\:\\path\\a.o: c\\:\\path\\b.h\n",
+    "a.o: b.h: c.h\n",
+    "a.o b.o\n",
+    "a\rb.o: c\rd.h\n",
+    "a.o: \"quoted name.h\" *?;&.h\n",
+    "a.o: b.h\n\nc.o: d.h \\\n\n",
+    "\\ a.o \\\\ : b.h",
+    "\\\\\\\n a.o: b.h",
+  };
+  const std::string depfile = "testGccDepfileReader_edge.d";
+  for (const char* c : cases) {
+    if (!writeFile(depfile, c) || !compareScanners(depfile)) {
+      std::cerr << "Case: " << c << std::endl;
+      return false;
+    }
+  }
+  // NUL bytes cannot be part of the C strings above.
+  if (!writeFile(depfile, std::string("a.o: b\0c.h d.h\n", 16)) ||
+      !compareScanners(depfile)) {
+    std::cerr << "Case with NUL byte" << std::endl;
+    return false;
+  }
+  cmSystemTools::RemoveFile(depfile);
+  return true;
+}
+
+// Compare the lexer and the buffer scanner on a large depfile like
+// those written for a C++ source including many system headers.
+bool testLargeDepfile()
+{
+  std::cout << "testLargeDepfile()\n";
+  std::string content = "CMakeFiles/target.dir/some/long/path/source.cxx.o: "
+                        "/home/user/project/some/long/path/source.cxx \\\n";
+  std::size_t expected = 2;
+  for (int i = 0; i < 4000; ++i) {
+    content += "  /usr/include/c++/12/bits/header_with_a_long_name_" +
+      std::to_string(i) + ".h \\\n";
+    ++expected;
+    if (i % 100 == 0) {
+      content += "  /home/user/project/dir\\ with\\ spaces/h" +
+        std::to_string(i) + ".h \\\n";
+      ++expected;
+    }
+  }
+  content += "  /usr/include/stdc-predef.h\n";
+  const std::string depfile = "testGccDepfileReader_large.d";
+  if (!writeFile(depfile, content) || !compareScanners(depfile)) {
+    return false;
+  }
+
+  cmGccDepfileLexerHelper helper;
+  if (!helper.readFileBuffered(depfile.c_str())) {
+    std::cerr << "Reading " << depfile << " failed\n";
+    return false;
+  }
+  cmGccDepfileContent const result = std::move(helper).extractContent();
+  cmSystemTools::RemoveFile(depfile);
+  if (result.size() != 1 || result[0].paths.size() != expected) {
+    std::cerr << "Unexpected content read from " << depfile << "\n";
+    return false;
+  }
+  return true;
+}
+
 } // anonymous namespace
 
 int testGccDepfileReader(int argc, char* argv[])
@@ -120,6 +229,9 @@ int testGccDepfileReader(int argc, char* argv[])
     const std::string depfile = base + ".d";
     const std::string plainDepfile = base + ".txt";
     std::cout << "Comparing " << base << " with " << plainDepfile << std::endl;
+    if (!compareScanners(depfile)) {
+      return 1;
+    }
     const auto actual = cmReadGccDepfile(depfile.c_str());
     if (cmSystemTools::FileExists(plainDepfile)) {
       if (!actual) {
@@ -138,5 +250,11 @@ int testGccDepfileReader(int argc, char* argv[])
     }
   }
 
+  if (!testScannerEdgeCases()) {
+    return 1;
+  }
+  if (!testLargeDepfile()) {
+    return 1;
+  }
   return 0;
 }
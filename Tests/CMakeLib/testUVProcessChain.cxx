@@ -11,6 +11,7 @@
 #include <cm3p/uv.h>
 
 #include "cmGetPipes.h"
+#include "cmSystemTools.h"
 #include "cmUVHandlePtr.h"
 #include "cmUVProcessChain.h"
 #include "cmUVStreambuf.h"
@@ -314,6 +315,40 @@ bool testUVProcessChainNone(const char* helperCommand)
   return true;
 }
 
+bool testUVProcessChainCwd(const char* helperCommand)
+{
+  std::string const helper = cmSystemTools::CollapseFullPath(helperCommand);
+  std::string const dir = cmSystemTools::GetFilenamePath(helper);
+  cmUVProcessChainBuilder builder;
+  builder.AddCommand({ helper, "pwd" })
+    .SetBuiltinStream(cmUVProcessChainBuilder::Stream_OUTPUT)
+    .SetWorkingDirectory(dir);
+
+  auto chain = builder.Start();
+  if (!chain.Valid()) {
+    std::cout << "Valid() returned false, should be true" << std::endl;
+    return false;
+  }
+  std::string const output = getInput(*chain.OutputStream());
+  if (!chain.Wait()) {
+    std::cout << "Wait() timed out" << std::endl;
+    return false;
+  }
+  auto const* status = chain.GetStatus(0);
+  if (!status || status->ExitStatus != 0) {
+    std::cout << "pwd failed" << std::endl;
+    return false;
+  }
+
+  if (!cmSystemTools::SameFile(output, dir)) {
+    std::cout << "Working directory was \"" << output << "\", expected \""
+              << dir << "\"" << std::endl;
+    return false;
+  }
+
+  return true;
+}
+
 int testUVProcessChain(int argc, char** const argv)
 {
   if (argc < 2) {
@@ -336,5 +371,10 @@ int testUVProcessChain(int argc, char** const argv)
     return -1;
   }
 
+  if (!testUVProcessChainCwd(argv[1])) {
+    std::cout << "While executing testUVProcessChainCwd().\n";
+    return -1;
+  }
+
   return 0;
 }
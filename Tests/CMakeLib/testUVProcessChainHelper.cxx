@@ -7,6 +7,13 @@
 #include <string>
 #include <thread>
 
+#ifdef _WIN32
+#  include <direct.h>
+#  define getcwd _getcwd
+#else
+#  include <unistd.h>
+#endif
+
 static std::string getStdin()
 {
   char buffer[1024];
@@ -68,5 +75,14 @@ int main(int argc, char** argv)
 #endif
   }
 
+  if (command == "pwd") {
+    char buffer[4096];
+    if (!getcwd(buffer, sizeof(buffer))) {
+      return 1;
+    }
+    std::cout << buffer << std::flush;
+    return 0;
+  }
+
   return -1;
 }
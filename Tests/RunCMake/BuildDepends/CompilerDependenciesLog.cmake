@@ -0,0 +1,32 @@
+enable_language(C)
+
+set(CMAKE_DEPENDS_USE_LOG ON)
+
+add_executable(main ${CMAKE_CURRENT_BINARY_DIR}/main.c)
+
+file(GENERATE OUTPUT ${CMAKE_CURRENT_BINARY_DIR}/check-$<LOWER_CASE:$<CONFIG>>.cmake CONTENT "
+set(check_pairs
+  \"$<TARGET_FILE:main>|${CMAKE_CURRENT_BINARY_DIR}/main.c\"
+  \"$<TARGET_FILE:main>|${CMAKE_CURRENT_BINARY_DIR}/main.h\"
+  )
+set(check_exes
+  \"$<TARGET_FILE:main>\"
+  )
+
+if (check_step EQUAL 2)
+  set(TARGET_DIR \"${CMAKE_CURRENT_BINARY_DIR}/CMakeFiles/main.dir\")
+  set(LOG_FILE \"\${TARGET_DIR}/compiler_depend.log\")
+  if (NOT EXISTS \"\${LOG_FILE}\")
+    set(RunCMake_TEST_FAILED \"File \${LOG_FILE} not found.\")
+  else()
+    file(READ \"\${TARGET_DIR}/compiler_depend.internal\" INTERNAL_CONTENT)
+    file(READ \"\${TARGET_DIR}/compiler_depend.make\" DEPENDS_CONTENT)
+    if (INTERNAL_CONTENT MATCHES \"main.h\")
+      set(RunCMake_TEST_FAILED \"Dependencies recorded in '\${TARGET_DIR}/compiler_depend.internal' instead of the log.\")
+    elseif(NOT DEPENDS_CONTENT MATCHES \"main.c\"
+        OR NOT DEPENDS_CONTENT MATCHES \"main.h\")
+      set(RunCMake_TEST_FAILED \"Dependency file '\${TARGET_DIR}/compiler_depend.make' badly generated.\")
+    endif()
+  endif()
+endif()
+")
@@ -166,6 +166,7 @@ if ((RunCMake_GENERATOR STREQUAL "Unix Makefiles"
       AND MSVC_VERSION GREATER 1300
       AND CMAKE_C_COMPILER_ID STREQUAL "MSVC"))
   run_BuildDepends(CompilerDependencies)
+  run_BuildDepends(CompilerDependenciesLog)
   run_BuildDepends(CustomCommandDependencies)
 endif()
 
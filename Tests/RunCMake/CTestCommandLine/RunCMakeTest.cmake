@@ -225,6 +225,26 @@ add_test(Echo \"${CMAKE_COMMAND}\" -E echo \"EchoTest\")
 endfunction()
 run_SerialFailed()
 
+function(run_ScheduleCriticalPath)
+  set(RunCMake_TEST_BINARY_DIR ${RunCMake_BINARY_DIR}/ScheduleCriticalPath)
+  set(RunCMake_TEST_NO_CLEAN 1)
+  file(REMOVE_RECURSE "${RunCMake_TEST_BINARY_DIR}")
+  file(MAKE_DIRECTORY "${RunCMake_TEST_BINARY_DIR}")
+  file(WRITE "${RunCMake_TEST_BINARY_DIR}/CTestTestfile.cmake" "
+add_test(Short1 \"${CMAKE_COMMAND}\" -E echo \"Short1\")
+add_test(Short2 \"${CMAKE_COMMAND}\" -E echo \"Short2\")
+add_test(Chain3 \"${CMAKE_COMMAND}\" -E echo \"Chain3\")
+add_test(Chain2 \"${CMAKE_COMMAND}\" -E echo \"Chain2\")
+add_test(Chain1 \"${CMAKE_COMMAND}\" -E echo \"Chain1\")
+set_tests_properties(Chain3 PROPERTIES DEPENDS Chain2)
+set_tests_properties(Chain2 PROPERTIES FIXTURES_REQUIRED Fixture)
+set_tests_properties(Chain1 PROPERTIES FIXTURES_SETUP Fixture)
+")
+  run_cmake_command(ScheduleCriticalPath ${CMAKE_CTEST_COMMAND} -j2
+    --schedule-critical-path)
+endfunction()
+run_ScheduleCriticalPath()
+
 function(run_TestLoad name load)
   set(RunCMake_TEST_BINARY_DIR ${RunCMake_BINARY_DIR}/TestLoad)
   set(RunCMake_TEST_NO_CLEAN 1)
@@ -256,6 +276,167 @@ run_TestLoad(test-load-pass 10)
 
 unset(ENV{__CTEST_FAKE_LOAD_AVERAGE_FOR_TESTING})
 
+function(run_TestMemory name)
+  set(RunCMake_TEST_BINARY_DIR ${RunCMake_BINARY_DIR}/TestMemory)
+  set(RunCMake_TEST_NO_CLEAN 1)
+  file(REMOVE_RECURSE "${RunCMake_TEST_BINARY_DIR}")
+  file(MAKE_DIRECTORY "${RunCMake_TEST_BINARY_DIR}")
+  file(WRITE "${RunCMake_TEST_BINARY_DIR}/CTestTestfile.cmake" "
+  add_test(TestMemory1 \"${CMAKE_COMMAND}\" -E sleep 1)
+  add_test(TestMemory2 \"${CMAKE_COMMAND}\" -E sleep 1)
+")
+  # Both tests used 600 MiB in their last run.
+  file(WRITE "${RunCMake_TEST_BINARY_DIR}/Testing/Temporary/CTestCostData.txt"
+    "TestMemory1 1 1 614400\nTestMemory2 1 1 614400\n---\n")
+  run_cmake_command(${name} ${CMAKE_CTEST_COMMAND} -j2 ${ARGN})
+endfunction()
+
+# Verify that a test does not start while the tests running use too much
+# of the memory limit or of the memory available.
+run_TestMemory(test-memory-limit --test-memory 1000)
+run_TestMemory(test-memory-pass --test-memory 2000)
+set(ENV{__CTEST_FAKE_MEMORY_AVAILABLE_FOR_TESTING} 1000)
+run_TestMemory(test-memory-available --test-memory 2000)
+unset(ENV{__CTEST_FAKE_MEMORY_AVAILABLE_FOR_TESTING})
+
+function(run_TestListCache)
+  set(RunCMake_TEST_BINARY_DIR ${RunCMake_BINARY_DIR}/TestListCache)
+  set(RunCMake_TEST_NO_CLEAN 1)
+  file(REMOVE_RECURSE "${RunCMake_TEST_BINARY_DIR}")
+  file(MAKE_DIRECTORY "${RunCMake_TEST_BINARY_DIR}/sub")
+  file(WRITE "${RunCMake_TEST_BINARY_DIR}/CTestTestfile.cmake" "
+  subdirs(sub)
+")
+  file(WRITE "${RunCMake_TEST_BINARY_DIR}/sub/CTestTestfile.cmake" "
+  add_test(TestListCache1 \"${CMAKE_COMMAND}\" -E echo 1)
+  set_tests_properties(TestListCache1 PROPERTIES LABELS first)
+  set_directory_properties(PROPERTIES LABELS sub)
+")
+  # The first run reads the test files and the second one the cache.
+  run_cmake_command(test-list-cache-write
+    ${CMAKE_CTEST_COMMAND} -N -V --test-list-cache -L sub)
+  run_cmake_command(test-list-cache-read
+    ${CMAKE_CTEST_COMMAND} -N -V --test-list-cache -L sub)
+
+  # A change to the test files is seen.
+  execute_process(COMMAND ${CMAKE_COMMAND} -E sleep 1.25)
+  file(APPEND "${RunCMake_TEST_BINARY_DIR}/sub/CTestTestfile.cmake" "
+  add_test(TestListCache2 \"${CMAKE_COMMAND}\" -E echo 2)
+")
+  run_cmake_command(test-list-cache-changed
+    ${CMAKE_CTEST_COMMAND} -N -V --test-list-cache)
+endfunction()
+run_TestListCache()
+
+function(run_Shards name)
+  set(RunCMake_TEST_BINARY_DIR ${RunCMake_BINARY_DIR}/Shards)
+  set(RunCMake_TEST_NO_CLEAN 1)
+  file(REMOVE_RECURSE "${RunCMake_TEST_BINARY_DIR}")
+  file(MAKE_DIRECTORY "${RunCMake_TEST_BINARY_DIR}")
+  file(WRITE "${RunCMake_TEST_BINARY_DIR}/CTestTestfile.cmake" "
+  foreach(name IN ITEMS A B C D E)
+    add_test(Shard\${name} \"${CMAKE_COMMAND}\" -E echo \${name})
+  endforeach()
+  # ShardE has no cost, so it is assumed to cost the average of 5.
+  set_tests_properties(ShardA PROPERTIES COST 8)
+  set_tests_properties(ShardB PROPERTIES COST 5)
+  set_tests_properties(ShardC PROPERTIES COST 4)
+  set_tests_properties(ShardD PROPERTIES COST 3)
+")
+  run_cmake_command(${name} ${CMAKE_CTEST_COMMAND} -N ${ARGN})
+endfunction()
+run_Shards(shard-0 --shard-index 0 --shard-count 2)
+run_Shards(shard-1 --shard-index 1 --shard-count 2)
+run_Shards(shard-bad --shard-index 2 --shard-count 2)
+
+function(run_ShardsUnion)
+  set(RunCMake_TEST_BINARY_DIR ${RunCMake_BINARY_DIR}/ShardsUnion)
+  set(RunCMake_TEST_NO_CLEAN 1)
+  file(REMOVE_RECURSE "${RunCMake_TEST_BINARY_DIR}")
+  file(MAKE_DIRECTORY "${RunCMake_TEST_BINARY_DIR}")
+  file(WRITE "${RunCMake_TEST_BINARY_DIR}/record.cmake" [[
+file(APPEND "${CMAKE_CURRENT_LIST_DIR}/ran.txt" "${name}\n")
+]])
+  # Each run rewrites the cost data, which must not move tests between
+  # the shards still to run.
+  file(WRITE "${RunCMake_TEST_BINARY_DIR}/CTestTestfile.cmake" "
+  foreach(name IN ITEMS A B C D E F G H)
+    add_test(Shard\${name} \"${CMAKE_COMMAND}\"
+      -Dname=\${name} -P \"${RunCMake_TEST_BINARY_DIR}/record.cmake\")
+  endforeach()
+  set_tests_properties(ShardA PROPERTIES COST 3)
+  set_tests_properties(ShardB PROPERTIES COST 2)
+")
+  foreach(index IN ITEMS 0 1 2)
+    run_cmake_command(shards-union-${index}
+      ${CMAKE_CTEST_COMMAND} --shard-index ${index} --shard-count 3)
+  endforeach()
+endfunction()
+run_ShardsUnion()
+
+function(run_Coordinator)
+  set(RunCMake_TEST_BINARY_DIR ${RunCMake_BINARY_DIR}/Coordinator)
+  set(RunCMake_TEST_NO_CLEAN 1)
+  file(REMOVE_RECURSE "${RunCMake_TEST_BINARY_DIR}")
+  file(MAKE_DIRECTORY "${RunCMake_TEST_BINARY_DIR}")
+  file(WRITE "${RunCMake_TEST_BINARY_DIR}/CTestTestfile.cmake" "
+  add_test(Coordinator1 \"${CMAKE_COMMAND}\" -E echo 1)
+  add_test(Coordinator2 \"${CMAKE_COMMAND}\" -E echo 2)
+  add_test(Coordinator3 \"${CMAKE_COMMAND}\" -E echo 3)
+")
+  run_cmake_command(coordinator
+    ${CMAKE_CTEST_COMMAND} -j2 --coordinator
+                           "${RunCMake_TEST_BINARY_DIR}/coordinator.sock")
+  # The socket is removed once the coordinator stops.
+  if(NOT WIN32 AND EXISTS "${RunCMake_TEST_BINARY_DIR}/coordinator.sock")
+    message(SEND_ERROR "Coordinator socket not removed")
+  endif()
+endfunction()
+run_Coordinator()
+
+function(run_CoordinatorShared)
+  set(RunCMake_TEST_BINARY_DIR ${RunCMake_BINARY_DIR}/CoordinatorShared)
+  set(RunCMake_TEST_NO_CLEAN 1)
+  file(REMOVE_RECURSE "${RunCMake_TEST_BINARY_DIR}")
+  file(MAKE_DIRECTORY "${RunCMake_TEST_BINARY_DIR}")
+  # Each test records when it starts and ends.
+  file(WRITE "${RunCMake_TEST_BINARY_DIR}/marker.cmake" [[
+string(TIMESTAMP start "%s%f")
+file(WRITE "${MARKER}" "${start}\n")
+execute_process(COMMAND "${CMAKE_COMMAND}" -E sleep 0.5)
+string(TIMESTAMP end "%s%f")
+file(APPEND "${MARKER}" "${end}\n")
+]])
+  foreach(p A B)
+    file(WRITE "${RunCMake_TEST_BINARY_DIR}/${p}/CTestTestfile.cmake" "")
+    foreach(t 1 2)
+      file(APPEND "${RunCMake_TEST_BINARY_DIR}/${p}/CTestTestfile.cmake" "
+  add_test(Shared${p}${t} \"${CMAKE_COMMAND}\"
+    -DMARKER=${RunCMake_TEST_BINARY_DIR}/${p}${t}.marker
+    -P ${RunCMake_TEST_BINARY_DIR}/marker.cmake)
+")
+    endforeach()
+  endforeach()
+  # Run two processes at once sharing a budget of one job slot.
+  set(socket "${RunCMake_TEST_BINARY_DIR}/coordinator.sock")
+  file(WRITE "${RunCMake_TEST_BINARY_DIR}/run.cmake" "
+execute_process(
+  COMMAND \"${CMAKE_CTEST_COMMAND}\" -j1 --coordinator \"${socket}\"
+    --test-dir \"${RunCMake_TEST_BINARY_DIR}/A\"
+  COMMAND \"${CMAKE_CTEST_COMMAND}\" -j1 --coordinator \"${socket}\"
+    --test-dir \"${RunCMake_TEST_BINARY_DIR}/B\"
+  RESULTS_VARIABLE results
+  OUTPUT_QUIET
+  )
+if(NOT results STREQUAL \"0;0\")
+  message(FATAL_ERROR \"ctest failed: \${results}\")
+endif()
+")
+  run_cmake_command(coordinator-shared
+    ${CMAKE_COMMAND} -P "${RunCMake_TEST_BINARY_DIR}/run.cmake")
+endfunction()
+run_CoordinatorShared()
+
 function(run_TestOutputSize)
   set(RunCMake_TEST_BINARY_DIR ${RunCMake_BINARY_DIR}/TestOutputSize)
   set(RunCMake_TEST_NO_CLEAN 1)
@@ -274,6 +455,61 @@ function(run_TestOutputSize)
 endfunction()
 run_TestOutputSize()
 
+function(run_TestOutputStreaming)
+  set(RunCMake_TEST_BINARY_DIR ${RunCMake_BINARY_DIR}/TestOutputStreaming)
+  set(RunCMake_TEST_NO_CLEAN 1)
+  file(REMOVE_RECURSE "${RunCMake_TEST_BINARY_DIR}")
+  file(MAKE_DIRECTORY "${RunCMake_TEST_BINARY_DIR}")
+  file(WRITE "${RunCMake_TEST_BINARY_DIR}/ChattyTest.cmake" [[
+message(STATUS "ChattyHead")
+foreach(i RANGE 1 500)
+  message(STATUS "Chatty line ${i}")
+endforeach()
+message(STATUS "ChattyTail")
+]])
+  file(WRITE "${RunCMake_TEST_BINARY_DIR}/CTestTestfile.cmake" "
+  add_test(ChattyTest \"${CMAKE_COMMAND}\" -P ChattyTest.cmake)
+  set_tests_properties(ChattyTest PROPERTIES
+    PASS_REGULAR_EXPRESSION \"Chatty line 250\"
+    FAIL_REGULAR_EXPRESSION \"Chatty line 501\")
+")
+  run_cmake_command(TestOutputStreaming
+    ${CMAKE_CTEST_COMMAND} -M Experimental -T Test
+                           --no-compress-output
+                           --test-output-size-passed 40
+                           --test-output-truncation middle
+                           --test-output-spool
+    )
+endfunction()
+run_TestOutputStreaming()
+
+function(run_TestOutputStreamingFull)
+  set(RunCMake_TEST_BINARY_DIR ${RunCMake_BINARY_DIR}/TestOutputStreamingFull)
+  set(RunCMake_TEST_NO_CLEAN 1)
+  file(REMOVE_RECURSE "${RunCMake_TEST_BINARY_DIR}")
+  file(MAKE_DIRECTORY "${RunCMake_TEST_BINARY_DIR}")
+  file(WRITE "${RunCMake_TEST_BINARY_DIR}/ChattyTest.cmake" [[
+foreach(i RANGE 1 500)
+  message(STATUS "Chatty line ${i}")
+  if(i EQUAL 250)
+    message(STATUS "CTEST_FULL_OUTPUT")
+  endif()
+endforeach()
+message(STATUS "<DartMeasurement name=\"open\" type=\"text/string\">")
+message(STATUS "Never closed")
+]])
+  file(WRITE "${RunCMake_TEST_BINARY_DIR}/CTestTestfile.cmake" "
+  add_test(ChattyTest \"${CMAKE_COMMAND}\" -P ChattyTest.cmake)
+")
+  run_cmake_command(TestOutputStreamingFull
+    ${CMAKE_CTEST_COMMAND} -M Experimental -T Test
+                           --no-compress-output
+                           --test-output-size-passed 40
+                           --test-output-streaming
+    )
+endfunction()
+run_TestOutputStreamingFull()
+
 # Test --test-output-truncation
 function(run_TestOutputTruncation mode expected)
   set(RunCMake_TEST_BINARY_DIR ${RunCMake_BINARY_DIR}/TestOutputTruncation_${mode})
@@ -0,0 +1,16 @@
+file(GLOB test_xml_file "${RunCMake_TEST_BINARY_DIR}/Testing/*/Test.xml")
+if(test_xml_file)
+  file(READ "${test_xml_file}" test_xml)
+  if(NOT "${test_xml}" MATCHES [[<Test Status="passed">]])
+    set(RunCMake_TEST_FAILED "Test.xml does not contain a passed test:\n ${test_xml}")
+  elseif(NOT "${test_xml}" MATCHES [[<Value>-- ChattyHead.*40 bytes.*ChattyTail]])
+    set(RunCMake_TEST_FAILED "Test.xml test output not truncated in the middle:\n ${test_xml}")
+  endif()
+else()
+  set(RunCMake_TEST_FAILED "Test.xml not found")
+endif()
+
+set(spool_file "${RunCMake_TEST_BINARY_DIR}/Testing/Temporary/TestOutput/1.log.gz")
+if(NOT EXISTS "${spool_file}")
+  set(RunCMake_TEST_FAILED "Test output not spooled to:\n ${spool_file}")
+endif()
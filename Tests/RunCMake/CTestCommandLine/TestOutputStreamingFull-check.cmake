@@ -0,0 +1,17 @@
+file(GLOB test_xml_file "${RunCMake_TEST_BINARY_DIR}/Testing/*/Test.xml")
+if(test_xml_file)
+  file(READ "${test_xml_file}" test_xml)
+  if(NOT "${test_xml}" MATCHES [[<Value>-- Chatty line 1
+-- Chatty line 2
+]])
+    set(RunCMake_TEST_FAILED "Test.xml test output does not start with the first lines:\n ${test_xml}")
+  elseif("${test_xml}" MATCHES "bytes of the test output|removed since it")
+    set(RunCMake_TEST_FAILED "Test.xml test output was truncated:\n ${test_xml}")
+  elseif(NOT "${test_xml}" MATCHES "Chatty line 137\n.*Chatty line 500\n")
+    set(RunCMake_TEST_FAILED "Test.xml test output is not complete:\n ${test_xml}")
+  elseif(NOT "${test_xml}" MATCHES "DartMeasurement name=[^\n]*\n-- Never closed")
+    set(RunCMake_TEST_FAILED "Test.xml does not retain the open measurement:\n ${test_xml}")
+  endif()
+else()
+  set(RunCMake_TEST_FAILED "Test.xml not found")
+endif()
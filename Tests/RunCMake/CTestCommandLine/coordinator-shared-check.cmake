@@ -0,0 +1,27 @@
+set(tests A1 A2 B1 B2)
+foreach(t IN LISTS tests)
+  set(marker "${RunCMake_TEST_BINARY_DIR}/${t}.marker")
+  if(NOT EXISTS "${marker}")
+    string(APPEND RunCMake_TEST_FAILED "Test ${t} did not run.\n")
+    return()
+  endif()
+  file(STRINGS "${marker}" times)
+  list(LENGTH times n)
+  if(NOT n EQUAL 2)
+    string(APPEND RunCMake_TEST_FAILED "Test ${t} did not finish.\n")
+    return()
+  endif()
+  list(GET times 0 start_${t})
+  list(GET times 1 end_${t})
+endforeach()
+
+# With one job slot shared by both processes no two tests may overlap.
+foreach(a IN LISTS tests)
+  foreach(b IN LISTS tests)
+    if(NOT a STREQUAL b AND
+        start_${a} LESS end_${b} AND start_${b} LESS end_${a})
+      string(APPEND RunCMake_TEST_FAILED
+        "Tests ${a} and ${b} ran at the same time.\n")
+    endif()
+  endforeach()
+endforeach()
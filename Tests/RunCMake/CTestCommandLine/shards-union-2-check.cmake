@@ -0,0 +1,7 @@
+set(expect A B C D E F G H)
+file(STRINGS "${RunCMake_TEST_BINARY_DIR}/ran.txt" ran)
+list(SORT ran)
+if(NOT ran STREQUAL expect)
+  set(RunCMake_TEST_FAILED
+    "Shards ran tests\n  ${ran}\ninstead of each of\n  ${expect}")
+endif()
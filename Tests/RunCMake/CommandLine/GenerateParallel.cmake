@@ -0,0 +1,5 @@
+foreach(i RANGE 1 8)
+  set(dir "${CMAKE_CURRENT_BINARY_DIR}/src${i}")
+  file(WRITE "${dir}/CMakeLists.txt" "add_custom_target(t${i} ALL)\n")
+  add_subdirectory("${dir}" "${CMAKE_CURRENT_BINARY_DIR}/dir${i}")
+endforeach()
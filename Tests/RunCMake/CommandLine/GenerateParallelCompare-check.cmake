@@ -0,0 +1,26 @@
+if(NOT DEFINED GenerateParallelCompare_SERIAL_DIR)
+  return()
+endif()
+
+# The tree generated in parallel must be byte-identical to the serial one.
+file(GLOB_RECURSE serial_files LIST_DIRECTORIES false
+  RELATIVE "${GenerateParallelCompare_SERIAL_DIR}"
+  "${GenerateParallelCompare_SERIAL_DIR}/*")
+file(GLOB_RECURSE parallel_files LIST_DIRECTORIES false
+  RELATIVE "${RunCMake_TEST_BINARY_DIR}" "${RunCMake_TEST_BINARY_DIR}/*")
+list(SORT serial_files)
+list(SORT parallel_files)
+if(NOT serial_files STREQUAL parallel_files)
+  string(REPLACE ";" "\n  " serial_files "${serial_files}")
+  string(REPLACE ";" "\n  " parallel_files "${parallel_files}")
+  string(CONCAT RunCMake_TEST_FAILED "Generated files differ.  Serial:\n"
+    "  ${serial_files}\nParallel:\n  ${parallel_files}")
+  return()
+endif()
+foreach(f IN LISTS serial_files)
+  file(SHA256 "${GenerateParallelCompare_SERIAL_DIR}/${f}" serial_hash)
+  file(SHA256 "${RunCMake_TEST_BINARY_DIR}/${f}" parallel_hash)
+  if(NOT serial_hash STREQUAL parallel_hash)
+    string(APPEND RunCMake_TEST_FAILED "${f} differs\n")
+  endif()
+endforeach()
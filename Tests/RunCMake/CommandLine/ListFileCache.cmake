@@ -0,0 +1,4 @@
+function(listfile_cache_helper)
+  message(STATUS "helper")
+endfunction()
+listfile_cache_helper()
@@ -0,0 +1,19 @@
+file(READ "${ProfilingTestOutput}" summary)
+if (NOT summary MATCHES "generator-expression-memo: hits=([0-9]+) ")
+  set(RunCMake_TEST_FAILED "Memo counters not found in\n${summary}")
+  return()
+endif()
+if (CMAKE_MATCH_1 LESS 3)
+  set(RunCMake_TEST_FAILED
+    "Expected at least 3 memo hits, got ${CMAKE_MATCH_1} in\n${summary}")
+  return()
+endif()
+
+file(READ "${RunCMake_TEST_BINARY_DIR}/cmake_install.cmake" install)
+foreach(n RANGE 1 4)
+  if (NOT install MATCHES "message\\(\"${n}: [^\"]*/include\"\\)")
+    set(RunCMake_TEST_FAILED
+      "Include directory ${n} not found in\n${install}")
+    return()
+  endif()
+endforeach()
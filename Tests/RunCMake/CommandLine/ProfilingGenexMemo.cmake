@@ -0,0 +1,13 @@
+add_library(iface INTERFACE)
+target_include_directories(iface INTERFACE
+  "$<BUILD_INTERFACE:${CMAKE_CURRENT_SOURCE_DIR}/include>")
+add_library(consumer INTERFACE)
+target_link_libraries(consumer INTERFACE iface)
+
+# Each install(CODE) is evaluated on its own, so the include directories
+# of iface are evaluated under a fresh DAG checker every time and can be
+# answered from the memo after the first one.
+set(dirs "$<TARGET_PROPERTY:consumer,INTERFACE_INCLUDE_DIRECTORIES>")
+foreach(n RANGE 1 4)
+  install(CODE "message(\"${n}: ${dirs}\")")
+endforeach()
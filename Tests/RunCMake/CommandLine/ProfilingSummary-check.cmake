@@ -0,0 +1,31 @@
+if (NOT EXISTS "${ProfilingTestOutput}")
+  set(RunCMake_TEST_FAILED "Expected ${ProfilingTestOutput} to exist")
+  return()
+endif()
+if (NOT EXISTS "${ProfilingTestOutput}.folded")
+  set(RunCMake_TEST_FAILED "Expected ${ProfilingTestOutput}.folded to exist")
+  return()
+endif()
+
+file(READ "${ProfilingTestOutput}" summary)
+if (NOT summary MATCHES "^Top [0-9]+ of [0-9]+ entries by exclusive time")
+  set(RunCMake_TEST_FAILED "Summary header not found in\n${summary}")
+  return()
+endif()
+foreach(row IN ITEMS
+    "  2  [ 0-9.]+  command     __testing_summary_function\n"
+    "  1  [ 0-9.]+  phase       configure\n"
+    "  1  [ 0-9.]+  phase       generate\n"
+    "listfile    [^\n]*/ProfilingSummary.cmake\n"
+    "generator-expression-memo: hits=[0-9]+ misses=[0-9]+ uncacheable=[0-9]+")
+  if (NOT summary MATCHES "${row}")
+    set(RunCMake_TEST_FAILED "Summary row\n  ${row}\nnot found in\n${summary}")
+    return()
+  endif()
+endforeach()
+
+file(STRINGS "${ProfilingTestOutput}.folded" stacks
+  REGEX "^phase:configure;.*;__testing_summary_function [0-9]+$")
+if (NOT stacks)
+  set(RunCMake_TEST_FAILED "Function call stack not found in folded output")
+endif()
@@ -0,0 +1,5 @@
+function(__testing_summary_function)
+endfunction()
+
+__testing_summary_function()
+__testing_summary_function()
@@ -29,3 +29,11 @@ if (NOT numInvocations EQUAL 1)
   set(RunCMake_TEST_FAILED
       "Unexpected number of lowercase command names: ${numInvocations}")
 endif()
+
+file(STRINGS ${ProfilingTestOutput} memoCounters
+  REGEX [["name"[ ]*:[ ]*"generator-expression-memo"]])
+list(LENGTH memoCounters numMemoCounters)
+if (NOT numMemoCounters EQUAL 1)
+  set(RunCMake_TEST_FAILED
+      "Unexpected number of generator expression memo counters: ${numMemoCounters}")
+endif()
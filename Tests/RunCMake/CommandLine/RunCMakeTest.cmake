@@ -1015,6 +1015,58 @@ set(RunCMake_TEST_OPTIONS --profiling-format=google-trace --profiling-output=${P
 run_cmake(ProfilingTest)
 unset(RunCMake_TEST_OPTIONS)
 
+set(RunCMake_TEST_BINARY_DIR "${RunCMake_BINARY_DIR}/profiling-summary")
+set(ProfilingTestOutput ${RunCMake_TEST_BINARY_DIR}/profile.txt)
+set(RunCMake_TEST_OPTIONS --profiling-format=summary --profiling-output=${ProfilingTestOutput})
+run_cmake(ProfilingSummary)
+unset(RunCMake_TEST_OPTIONS)
+
+set(RunCMake_TEST_BINARY_DIR "${RunCMake_BINARY_DIR}/profiling-genex-memo")
+set(ProfilingTestOutput ${RunCMake_TEST_BINARY_DIR}/profile.txt)
+set(RunCMake_TEST_OPTIONS --profiling-format=summary --profiling-output=${ProfilingTestOutput}
+  -DCMAKE_POLICY_DEFAULT_CMP0087=NEW)
+run_cmake(ProfilingGenexMemo)
+unset(RunCMake_TEST_OPTIONS)
+
+function(run_ListFileCache)
+  set(RunCMake_TEST_BINARY_DIR "${RunCMake_BINARY_DIR}/ListFileCache-build")
+  run_cmake_with_options(ListFileCache --listfile-cache=validate)
+  set(RunCMake_TEST_NO_CLEAN 1)
+  run_cmake_command(ListFileCache-rerun ${CMAKE_COMMAND}
+    --listfile-cache=validate ${RunCMake_TEST_BINARY_DIR})
+endfunction()
+run_ListFileCache()
+run_cmake_command(ListFileCache-invalid ${CMAKE_COMMAND} -B DummyBuildDir
+  --listfile-cache=bogus)
+
+function(run_GenerateParallel)
+  set(RunCMake_TEST_BINARY_DIR "${RunCMake_BINARY_DIR}/GenerateParallel-build")
+  set(ENV{CMAKE_GENERATE_PARALLEL_LEVEL} 4)
+  run_cmake(GenerateParallel)
+  set(RunCMake_TEST_NO_CLEAN 1)
+  set(RunCMake_TEST_VARIANT_DESCRIPTION "-rerun")
+  run_cmake(GenerateParallel)
+  unset(ENV{CMAKE_GENERATE_PARALLEL_LEVEL})
+endfunction()
+run_GenerateParallel()
+
+function(run_GenerateParallelCompare)
+  # Generate the same build tree serially and then in parallel.
+  set(RunCMake_TEST_BINARY_DIR
+    "${RunCMake_BINARY_DIR}/GenerateParallelCompare-build")
+  set(serial "${RunCMake_BINARY_DIR}/GenerateParallelCompare-serial")
+  set(RunCMake_TEST_VARIANT_DESCRIPTION "-serial")
+  run_cmake(GenerateParallelCompare)
+  file(REMOVE_RECURSE "${serial}")
+  file(RENAME "${RunCMake_TEST_BINARY_DIR}" "${serial}")
+  set(ENV{CMAKE_GENERATE_PARALLEL_LEVEL} 4)
+  set(RunCMake_TEST_VARIANT_DESCRIPTION "-parallel")
+  set(GenerateParallelCompare_SERIAL_DIR "${serial}")
+  run_cmake(GenerateParallelCompare)
+  unset(ENV{CMAKE_GENERATE_PARALLEL_LEVEL})
+endfunction()
+run_GenerateParallelCompare()
+
 if(RunCMake_GENERATOR MATCHES "^Visual Studio 10 2010")
   run_cmake_with_options(DeprecateVS10-WARN-ON -DCMAKE_WARN_VS10=ON)
   unset(ENV{CMAKE_WARN_VS10})
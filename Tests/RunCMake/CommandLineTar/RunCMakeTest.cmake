@@ -25,6 +25,7 @@ external_command_test(7zip-gz            tar cvzf bad.tar "--format=7zip" ${CMAK
 run_cmake(7zip)
 run_cmake(gnutar)
 run_cmake(gnutar-gz)
+run_cmake(gnutar-gz-large)
 run_cmake(pax)
 run_cmake(pax-xz)
 run_cmake(pax-zstd)
@@ -0,0 +1,27 @@
+set(OUTPUT_NAME "test.tar.gz")
+
+set(COMPRESSION_FLAGS -cvzf)
+set(COMPRESSION_OPTIONS --format=gnutar)
+
+set(DECOMPRESSION_FLAGS -xvzf)
+
+# Compress many 128 KiB blocks on multiple threads and make the archive
+# large enough to be extracted on multiple threads too.  Random content
+# keeps the compressed archive above 4 MiB.
+string(RANDOM LENGTH 1 RANDOM_SEED 1 unused)
+set(CUSTOM_CHECK_FILES "f1.txt")
+foreach(i RANGE 127)
+  string(RANDOM LENGTH 65536 content)
+  file(WRITE ${CMAKE_CURRENT_BINARY_DIR}/compress_dir/large/f${i}.txt
+    "${content}")
+  list(APPEND CUSTOM_CHECK_FILES "large/f${i}.txt")
+endforeach()
+
+include(${CMAKE_CURRENT_LIST_DIR}/roundtrip.cmake)
+
+check_magic("1f8b" LIMIT 2 HEX)
+
+file(SIZE ${FULL_OUTPUT_NAME} size)
+if(size LESS 4194304)
+  message(FATAL_ERROR "Archive of ${size} bytes is smaller than 4 MiB")
+endif()
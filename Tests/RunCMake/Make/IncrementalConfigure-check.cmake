@@ -0,0 +1,3 @@
+if(NOT EXISTS "${RunCMake_TEST_BINARY_DIR}/CMakeFiles/ConfigureInputs.txt")
+  set(RunCMake_TEST_FAILED "CMakeFiles/ConfigureInputs.txt not written")
+endif()
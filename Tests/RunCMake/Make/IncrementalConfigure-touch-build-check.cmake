@@ -0,0 +1,3 @@
+if(actual_stdout MATCHES "Reading input.cmake")
+  set(RunCMake_TEST_FAILED "CMake re-ran although its inputs are unchanged:\n${actual_stdout}")
+endif()
@@ -0,0 +1,5 @@
+set(input "${CMAKE_CURRENT_BINARY_DIR}/input.cmake")
+if(NOT EXISTS "${input}")
+  file(WRITE "${input}" "message(STATUS \"Reading input.cmake\")\n")
+endif()
+include("${input}")
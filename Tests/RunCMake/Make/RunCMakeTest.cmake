@@ -41,6 +41,25 @@ run_VerboseBuild()
 
 run_cmake(IncludeRegexSubdir)
 
+function(run_IncrementalConfigure)
+  set(RunCMake_TEST_BINARY_DIR ${RunCMake_BINARY_DIR}/IncrementalConfigure-build)
+  set(RunCMake_TEST_OPTIONS -DCMAKE_INCREMENTAL_CONFIGURE=ON)
+  run_cmake(IncrementalConfigure)
+  set(RunCMake_TEST_NO_CLEAN 1)
+  set(input "${RunCMake_TEST_BINARY_DIR}/input.cmake")
+
+  # Touching an input without changing it does not re-run CMake.
+  execute_process(COMMAND ${CMAKE_COMMAND} -E sleep 1)
+  file(TOUCH "${input}")
+  run_cmake_command(IncrementalConfigure-touch-build ${CMAKE_COMMAND} --build .)
+
+  # Changing an input does.
+  execute_process(COMMAND ${CMAKE_COMMAND} -E sleep 1)
+  file(APPEND "${input}" "# changed\n")
+  run_cmake_command(IncrementalConfigure-change-build ${CMAKE_COMMAND} --build .)
+endfunction()
+run_IncrementalConfigure()
+
 function(run_MakefileConflict)
   run_cmake(MakefileConflict)
   set(RunCMake_TEST_NO_CLEAN 1)
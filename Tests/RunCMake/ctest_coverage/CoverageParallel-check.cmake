@@ -0,0 +1,15 @@
+file(GLOB coverage_xml_file "${RunCMake_TEST_BINARY_DIR}/Testing/*/Coverage.xml")
+if(coverage_xml_file)
+  file(READ "${coverage_xml_file}" coverage_xml)
+  foreach(n IN ITEMS 1 2 3)
+    if(NOT coverage_xml MATCHES "<File Name=\"cov${n}.c\"[^>]*>[ \t\n]*<LOCTested>3</LOCTested>[ \t\n]*<LOCUnTested>1</LOCUnTested>")
+      string(REPLACE "\n" "\n  " coverage_xml "  ${coverage_xml}")
+      set(RunCMake_TEST_FAILED
+        "Coverage.xml does not have expected coverage of cov${n}.c:\n${coverage_xml}"
+        )
+      break()
+    endif()
+  endforeach()
+else()
+  set(RunCMake_TEST_FAILED "Coverage.xml not found")
+endif()
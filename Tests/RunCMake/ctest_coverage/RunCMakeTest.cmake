@@ -8,3 +8,30 @@ function(run_ctest_coverage CASE_NAME)
 endfunction()
 
 run_ctest_coverage(CoverageQuiet QUIET)
+
+if(CMAKE_C_COMPILER_ID STREQUAL "GNU" AND
+   RunCMake_GENERATOR MATCHES "Make|Ninja")
+  set(CASE_CMAKELISTS_SUFFIX_CODE [[
+enable_language(C)
+add_compile_options(--coverage)
+add_link_options(--coverage)
+foreach(n IN ITEMS 1 2 3)
+  file(WRITE "${CMAKE_CURRENT_SOURCE_DIR}/cov${n}.c"
+    "int cov${n}(int x)\n{\n  if (x > ${n}) {\n"
+    "    return x;\n  }\n  return ${n};\n}\n")
+endforeach()
+file(WRITE "${CMAKE_CURRENT_SOURCE_DIR}/main.c" [=[
+int cov1(int x);
+int cov2(int x);
+int cov3(int x);
+int main(void)
+{
+  return cov1(2) + cov2(2) + cov3(2) == 7 ? 0 : 1;
+}
+]=])
+add_executable(main main.c cov1.c cov2.c cov3.c)
+add_test(NAME main COMMAND main)
+]])
+  run_ctest_coverage(CoverageParallel PARALLEL_LEVEL 2)
+  unset(CASE_CMAKELISTS_SUFFIX_CODE)
+endif()
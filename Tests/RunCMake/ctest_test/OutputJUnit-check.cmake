@@ -16,6 +16,10 @@ if(junit_xml_file)
   if(NOT "${junit_xml}" MATCHES "<testcase name=\"RunCMakeVersion\" classname=\"RunCMakeVersion\"")
     set(RunCMake_TEST_FAILED "RunCMakeVersion not found when expected")
   endif()
+  if(CMAKE_HOST_SYSTEM_NAME MATCHES "Linux|Darwin|BSD|Windows" AND
+      NOT "${junit_xml}" MATCHES "<property name=\"User Time\" value=\"[0-9.]+\"")
+    set(RunCMake_TEST_FAILED "User Time property not found when expected")
+  endif()
   if(NOT "${junit_xml}" MATCHES "<system-out>cmake version")
     set(RunCMake_TEST_FAILED "<system-out>cmake version not found when expected")
   endif()
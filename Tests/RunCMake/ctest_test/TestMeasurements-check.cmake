@@ -38,3 +38,11 @@ if(NOT _test_contents MATCHES [[NamedMeasurement name="another_test_input_data"
   string(APPEND RunCMake_TEST_FAILED
     "Could not find expected <NamedMeasurement> tag(2) for type='file' in Test.xml")
 endif()
+# Check resource usage measurements.  Every test runs a cmake process, so
+# its peak memory is known and cannot be zero.
+if(CMAKE_HOST_SYSTEM_NAME MATCHES "Linux|Darwin|BSD|Windows" AND
+    NOT _test_contents MATCHES [[NamedMeasurement type="numeric/integer" name="Peak Memory">[
+	]*<Value>[1-9][0-9]*</Value>]])
+  string(APPEND RunCMake_TEST_FAILED
+    "Could not find expected <NamedMeasurement> tag for 'Peak Memory' in Test.xml")
+endif()
@@ -64,6 +64,12 @@ elseif(CMAKE_HOST_SYSTEM_NAME STREQUAL "Linux")
   if(NOT CMAKE_C_COMPILER_ID MATCHES "^XL")
     run_install_test(linux)
     run_install_test(file-filter)
+
+    set(RunCMake_TEST_OPTIONS -DCMAKE_GET_RUNTIME_DEPENDENCIES_TOOL=builtin)
+    set(RunCMake_TEST_VARIANT_DESCRIPTION "-builtin")
+    run_install_test(linux)
+    unset(RunCMake_TEST_OPTIONS)
+    unset(RunCMake_TEST_VARIANT_DESCRIPTION)
   endif()
   run_install_test(linux-unresolved)
   run_install_test(linux-conflict)
@@ -0,0 +1,10 @@
+set(src "${CMAKE_CURRENT_BINARY_DIR}/src/data.txt")
+set(dst "${CMAKE_CURRENT_BINARY_DIR}/dst")
+file(WRITE "${src}" "new content")
+# Write a destination of another size within the same second.
+file(WRITE "${dst}/data.txt" "old")
+file(COPY "${src}" DESTINATION "${dst}")
+file(READ "${dst}/data.txt" content)
+if(NOT content STREQUAL "new content")
+  message(FATAL_ERROR "Destination of another size not replaced:\n ${content}")
+endif()
@@ -0,0 +1,2 @@
+file(GLOB_RECURSE CONTENT_LIST CONFIGURE_DEPENDS
+  "${CMAKE_CURRENT_BINARY_DIR}/test/*")
@@ -65,6 +65,8 @@ run_cmake_script(COPY_FILE-link-to-file)
 run_cmake_script(COPY_FILE-arg-missing)
 run_cmake_script(COPY_FILE-arg-unknown)
 
+run_cmake_script(COPY-size-differs)
+
 run_cmake_script(RENAME-file-replace)
 run_cmake_script(RENAME-file-to-file)
 run_cmake_script(RENAME-file-to-dir-capture)
@@ -186,4 +188,31 @@ else()
   unset(RunCMake_TEST_BINARY_DIR)
   unset(RunCMake_TEST_NO_CLEAN)
   unset(RunCMake_DEFAULT_stderr)
+
+  # Check when cmake_verify_globs trusts the recorded directory times.
+  # The verification script is made to fail so that any run of it shows.
+  set(RunCMake_TEST_BINARY_DIR ${RunCMake_BINARY_DIR}/GLOB-CONFIGURE_DEPENDS-verify-build)
+  set(RunCMake_TEST_NO_CLEAN 1)
+  file(REMOVE_RECURSE "${RunCMake_TEST_BINARY_DIR}")
+  file(MAKE_DIRECTORY "${RunCMake_TEST_BINARY_DIR}/test")
+  file(WRITE "${RunCMake_TEST_BINARY_DIR}/test/1.txt" "1")
+  # Directories modified within two seconds of being listed are not trusted.
+  execute_process(COMMAND ${CMAKE_COMMAND} -E sleep 2.5)
+  run_cmake(GLOB-CONFIGURE_DEPENDS-verify)
+  set(verify_script "${RunCMake_TEST_BINARY_DIR}/CMakeFiles/VerifyGlobs.cmake")
+  set(verify_state "${RunCMake_TEST_BINARY_DIR}/CMakeFiles/VerifyGlobs.state")
+  file(APPEND "${verify_script}" "message(FATAL_ERROR \"VerifyGlobs.cmake was run\")\n")
+  run_cmake_command(GLOB-CONFIGURE_DEPENDS-verify-unchanged
+    ${CMAKE_COMMAND} -E cmake_verify_globs "${verify_script}")
+  file(WRITE "${RunCMake_TEST_BINARY_DIR}/test/2.txt" "2")
+  run_cmake_command(GLOB-CONFIGURE_DEPENDS-verify-added
+    ${CMAKE_COMMAND} -E cmake_verify_globs "${verify_script}")
+  file(WRITE "${verify_state}" "corrupt")
+  run_cmake_command(GLOB-CONFIGURE_DEPENDS-verify-corrupt
+    ${CMAKE_COMMAND} -E cmake_verify_globs "${verify_script}")
+  file(REMOVE "${verify_state}")
+  run_cmake_command(GLOB-CONFIGURE_DEPENDS-verify-missing
+    ${CMAKE_COMMAND} -E cmake_verify_globs "${verify_script}")
+  unset(RunCMake_TEST_BINARY_DIR)
+  unset(RunCMake_TEST_NO_CLEAN)
 endif()
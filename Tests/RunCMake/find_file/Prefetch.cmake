@@ -0,0 +1,20 @@
+set(CMAKE_FIND_PREFETCH_DIRECTORIES ON)
+
+set(dirs ${CMAKE_CURRENT_SOURCE_DIR}/include)
+foreach(i RANGE 1 8)
+  file(MAKE_DIRECTORY ${CMAKE_CURRENT_BINARY_DIR}/dir${i})
+  list(APPEND dirs ${CMAKE_CURRENT_BINARY_DIR}/dir${i})
+endforeach()
+file(WRITE ${CMAKE_CURRENT_BINARY_DIR}/dir5/Prefetch.h "")
+
+find_file(Prefetch_Found NAMES Prefetch.h PATHS ${dirs} NO_DEFAULT_PATH NO_CACHE)
+message(STATUS "Prefetch_Found='${Prefetch_Found}'")
+find_file(Prefetch_Source NAMES PrefixInPATH.h PATHS ${dirs} NO_DEFAULT_PATH NO_CACHE)
+message(STATUS "Prefetch_Source='${Prefetch_Source}'")
+
+# Files created after a search are found by later searches.
+find_file(Prefetch_Created NAMES Created.h PATHS ${dirs} NO_DEFAULT_PATH NO_CACHE)
+message(STATUS "Prefetch_Created='${Prefetch_Created}'")
+file(WRITE ${CMAKE_CURRENT_BINARY_DIR}/dir3/Created.h "")
+find_file(Prefetch_Created NAMES Created.h PATHS ${dirs} NO_DEFAULT_PATH NO_CACHE)
+message(STATUS "Prefetch_Created='${Prefetch_Created}'")
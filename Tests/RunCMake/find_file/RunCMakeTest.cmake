@@ -5,6 +5,7 @@ run_cmake(FromPrefixPath)
 run_cmake(PrefixInPATH)
 run_cmake(Required)
 run_cmake(NO_CACHE)
+run_cmake(Prefetch)
 run_cmake(REGISTRY_VIEW-no-view)
 run_cmake(REGISTRY_VIEW-wrong-view)
 run_cmake(VALIDATOR-no-function)
@@ -0,0 +1,68 @@
+enable_language(C)
+
+set(CMAKE_TRY_COMPILE_CACHE_DIR "${CMAKE_CURRENT_BINARY_DIR}/tc-cache")
+file(REMOVE_RECURSE "${CMAKE_TRY_COMPILE_CACHE_DIR}")
+
+try_compile(RESULT_GOOD "${CMAKE_CURRENT_BINARY_DIR}"
+  SOURCES "${CMAKE_CURRENT_SOURCE_DIR}/src.c"
+  OUTPUT_VARIABLE out_good
+  )
+if(NOT RESULT_GOOD)
+  message(FATAL_ERROR "try_compile failed:\n${out_good}")
+endif()
+try_compile(RESULT_BAD "${CMAKE_CURRENT_BINARY_DIR}"
+  SOURCES "${CMAKE_CURRENT_SOURCE_DIR}/src.c"
+  COMPILE_DEFINITIONS -DPP_ERROR
+  OUTPUT_VARIABLE out_bad
+  )
+if(RESULT_BAD)
+  message(FATAL_ERROR "try_compile with invalid source succeeded")
+endif()
+
+file(GLOB_RECURSE entries "${CMAKE_TRY_COMPILE_CACHE_DIR}/*")
+list(LENGTH entries n)
+if(NOT n EQUAL 2)
+  message(FATAL_ERROR "Expected 2 cached results, got:\n  ${entries}")
+endif()
+
+# Calls with the same inputs report the stored results.
+try_compile(RESULT_GOOD2 "${CMAKE_CURRENT_BINARY_DIR}"
+  SOURCES "${CMAKE_CURRENT_SOURCE_DIR}/src.c"
+  OUTPUT_VARIABLE out_good2
+  )
+try_compile(RESULT_BAD2 "${CMAKE_CURRENT_BINARY_DIR}"
+  SOURCES "${CMAKE_CURRENT_SOURCE_DIR}/src.c"
+  COMPILE_DEFINITIONS -DPP_ERROR
+  OUTPUT_VARIABLE out_bad2
+  )
+if(NOT RESULT_GOOD2 OR RESULT_BAD2)
+  message(FATAL_ERROR "Cached results differ: '${RESULT_GOOD2}' '${RESULT_BAD2}'")
+endif()
+# The output names the target of the current call.
+foreach(out IN ITEMS out_good out_good2 out_bad out_bad2)
+  string(REGEX REPLACE "cmTC_[0-9a-f]+" "cmTC" ${out} "${${out}}")
+endforeach()
+if(NOT out_good2 STREQUAL out_good OR NOT out_bad2 STREQUAL out_bad)
+  message(FATAL_ERROR "Cached output differs")
+endif()
+
+# A stored result is used without building the project.
+foreach(entry IN LISTS entries)
+  file(WRITE "${entry}" "cmake-try-compile-result 1\n1\nstored output\n")
+endforeach()
+try_compile(RESULT_STORED "${CMAKE_CURRENT_BINARY_DIR}"
+  SOURCES "${CMAKE_CURRENT_SOURCE_DIR}/src.c"
+  OUTPUT_VARIABLE out_stored
+  )
+if(RESULT_STORED OR NOT out_stored STREQUAL "stored output\n")
+  message(FATAL_ERROR "Stored result not used: '${RESULT_STORED}' '${out_stored}'")
+endif()
+
+# Calls that need the built binary do not use the cache.
+try_compile(RESULT_COPY "${CMAKE_CURRENT_BINARY_DIR}"
+  SOURCES "${CMAKE_CURRENT_SOURCE_DIR}/src.c"
+  COPY_FILE "${CMAKE_CURRENT_BINARY_DIR}/ResultCache.bin"
+  )
+if(NOT RESULT_COPY OR NOT EXISTS "${CMAKE_CURRENT_BINARY_DIR}/ResultCache.bin")
+  message(FATAL_ERROR "try_compile with COPY_FILE used the cache")
+endif()